@@ -80,7 +80,18 @@ SOURCES += main.cpp\
 	analyzer/updater/aa230firmwareupdater.cpp \
 	analyzer/updater/firmwareupdater.cpp \
 	analyzer/updater/hidfirmwareupdater.cpp \
-	ProgressDlg.cpp
+	ProgressDlg.cpp \
+	tracelookup.cpp \
+	measurementfile.cpp \
+	touchstone.cpp \
+	exportengine.cpp \
+	sweepjournal.cpp \
+	sessionarchive.cpp \
+	sweepcatalog.cpp \
+	catalogdialog.cpp \
+	measurementlistmodel.cpp \
+	calibrationcache.cpp \
+	waterfall.cpp
 
 HEADERS  += mainwindow.h \
 		qcustomplot.h \
@@ -116,7 +127,18 @@ HEADERS  += mainwindow.h \
 	analyzer/updater/aa230firmwareupdater.h \
 	analyzer/updater/firmwareupdater.h \
 	analyzer/updater/hidfirmwareupdater.h \
-	ProgressDlg.h
+	ProgressDlg.h \
+	tracelookup.h \
+	measurementfile.h \
+	touchstone.h \
+	exportengine.h \
+	sweepjournal.h \
+	sessionarchive.h \
+	sweepcatalog.h \
+	catalogdialog.h \
+	measurementlistmodel.h \
+	calibrationcache.h \
+	waterfall.h
 
 # TODO these files dont exist and are not generated
 #        ui_mainwindow.h \
@@ -135,11 +157,15 @@ FORMS    += mainwindow.ui \
 		print.ui \
 		export.ui \
 		antscopeupdatedialog.ui \
-	ProgressDlg.ui
+	ProgressDlg.ui \
+	catalogdialog.ui \
+	waterfall.ui
 
 INCLUDEPATH +=  $$PWD/analyzer \
 			$$PWD/analyzer/updater
 
+include(core/core.pri)
+
 win32{
 	SOURCES += analyzer/usbhid/hidapi/windows/hid.c
 	LIBS += -lsetupapi
@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Builds the core library first, then AntScope2 and AntScope2Cli.
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS = core app cli
+
+core.file = core/core.pro
+
+app.file = AntScope.pro
+app.depends = core
+
+cli.file = cli/AntScopeCli.pro
+cli.depends = core
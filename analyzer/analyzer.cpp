@@ -283,6 +283,26 @@ void Analyzer::on_measureContinuous(qint64 fqFrom, qint64 fqTo, qint32 dotsNumbe
     }
 }
 
+void Analyzer::on_measureSegment(qint64 fqFrom, qint64 fqTo, qint32 dotsNumber)
+{
+    if(!m_isMeasuring)
+    {
+        m_isMeasuring = true;
+        m_dotsNumber = dotsNumber;
+        m_chartCounter = 0;
+        if(m_comAnalyzerFound)
+        {
+            m_comAnalyzer->startMeasure(fqFrom,fqTo,dotsNumber);
+        }else if (m_hidAnalyzerFound)
+        {
+            m_hidAnalyzer->startMeasure(fqFrom,fqTo,dotsNumber);
+        }
+        PopUpIndicator::setIndicatorVisible(true);
+    } else {
+        on_stopMeasure();
+    }
+}
+
 void Analyzer::on_stopMeasure()
 {
     PopUpIndicator::setIndicatorVisible(false);
@@ -579,7 +599,7 @@ void Analyzer::setAnalyzerModel (int model)
     }
 }
 
-void Analyzer::on_measureCalib(int dotsNumber)
+void Analyzer::on_measureCalib(int dotsNumber, qint64 fqFrom, qint64 fqTo)
 {
     m_isMeasuring = true;
     m_dotsNumber = dotsNumber;
@@ -592,6 +612,12 @@ void Analyzer::on_measureCalib(int dotsNumber)
             maxFq_ = ca->maxFq().toULongLong();
         }
     }
+    // a band calibration, the whole range else
+    if(fqTo > fqFrom)
+    {
+        minFq_ = qMax(minFq_, fqFrom);
+        maxFq_ = qMin(maxFq_, fqTo);
+    }
     if(m_comAnalyzerFound)
     {
         m_comAnalyzer->startMeasure(minFq_, maxFq_, dotsNumber);
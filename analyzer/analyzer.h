@@ -115,6 +115,8 @@ public slots:
     void on_hidAnalyzerDisconnected ();
     void on_measure (qint64 fqFrom, qint64 fqTo, qint32 dotsNumber);
     void on_measureContinuous(qint64 fqFrom, qint64 fqTo, qint32 dotsNumber);
+    // a sweep that adds to the last measurement, see Measurements::beginMerge()
+    void on_measureSegment(qint64 fqFrom, qint64 fqTo, qint32 dotsNumber);
     void on_newData(rawData _rawData);
     void on_analyzerDataStringArrived(QString str);
     void on_stopMeasuring();
@@ -132,7 +134,7 @@ public slots:
     void readFile(QString pathToFw);
     void on_internetUpdate();
     void on_progress(qint64 downloaded,qint64 total);
-    void on_measureCalib(int dotsNumber);
+    void on_measureCalib(int dotsNumber, qint64 fqFrom = 0, qint64 fqTo = 0);
     void setCalibrationMode(bool enabled);
     void on_stopMeasure();
     void on_changedAutoDetectMode(bool state);
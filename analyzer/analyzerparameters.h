@@ -3,6 +3,7 @@
 
 #include <QVector>
 #include <qcustomplot.h>
+#include <core/rawdata.h>
 
 //#define SETTINGS_PATH "AntScope2.ini"
 
@@ -167,24 +168,6 @@ enum parse{
     FULLINFO
 };
 
-struct rawData{
-    double fq;
-    double r;
-    double x;
-    void read (const QJsonObject &json)
-    {
-        fq = json["fq"].toDouble();
-        r = json["r"].toDouble();
-        x = json["x"].toDouble();
-    }
-    void write (QJsonObject &json) const
-    {
-        json["fq"] = fq;
-        json["r"] = r;
-        json["x"] = x;
-    }
-};
-
 struct measurement{
 
     qint64 qint64Fq;
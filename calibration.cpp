@@ -1,10 +1,22 @@
 #include "calibration.h"
 #include "settings.h"
+#include "calibrationcache.h"
+#include <QFileInfo>
 
 Calibration::Calibration(QObject *parent) : QObject(parent),
     m_state(CALIB_NONE),
     m_dotsCount(0),
     m_dotsNumber(500),
+    m_averages(1),
+    m_sweep(0),
+    m_bandCaptureEnabled(false),
+    m_bandCapture(false),
+    m_sweepFrom(0),
+    m_sweepTo(0),
+    m_captureFrom(0),
+    m_captureTo(0),
+    m_active(NULL),
+    m_loaded(false),
     m_onlyOneCalib(false),
     m_Z0(50),
     m_OSLCalibrationEnabled(false),
@@ -34,7 +46,10 @@ Calibration::Calibration(QObject *parent) : QObject(parent),
     m_shortCalibFilePath = m_settings->value("ShortPath", "Not chosen").toString();
     m_loadCalibFilePath = m_settings->value("LoadPath", "Not chosen").toString();
     setDotsNumber(m_settings->value("DotsNumber", 500).toInt());
+    setAverages(m_settings->value("Averages", 1).toInt());
     m_settings->endGroup();
+
+    CalKitFile::read(kitFilePath(), m_kit);
 }
 
 Calibration::~Calibration()
@@ -48,6 +63,7 @@ Calibration::~Calibration()
     m_settings->setValue("ShortPath", m_shortCalibFilePath);
     m_settings->setValue("LoadPath", m_loadCalibFilePath);
     m_settings->setValue("DotsNumber", dotsNumber());
+    m_settings->setValue("Averages", averages());
 
     m_settings->endGroup();
 }
@@ -57,26 +73,18 @@ void Calibration::start(void)
     QString notChoosed = tr("Not chosen");
     if(m_OSLCalibrationPerformed)
     {
-        if(m_openCalibFilePath != "")
+        // the files are read by load() on the first calibrated measurement
+        if(!QFileInfo(m_openCalibFilePath).isFile())
         {
-            if(!m_openData.loadData(m_openCalibFilePath,&m_Z0))
-            {
-                m_openCalibFilePath = notChoosed;
-            }
+            m_openCalibFilePath = notChoosed;
         }
-        if(m_shortCalibFilePath != "")
+        if(!QFileInfo(m_shortCalibFilePath).isFile())
         {
-            if(!m_shortData.loadData(m_shortCalibFilePath,&m_Z0))
-            {
-                m_shortCalibFilePath = notChoosed;
-            }
+            m_shortCalibFilePath = notChoosed;
         }
-        if(m_loadCalibFilePath != "")
+        if(!QFileInfo(m_loadCalibFilePath).isFile())
         {
-            if(!m_loadData.loadData(m_loadCalibFilePath,&m_Z0))
-            {
-                m_loadCalibFilePath = notChoosed;
-            }
+            m_loadCalibFilePath = notChoosed;
         }
 
         if( (m_openCalibFilePath != notChoosed) &&
@@ -90,6 +98,142 @@ void Calibration::start(void)
             m_OSLCalibrationPerformed = false;
         }
     }
+    m_loaded = false;
+}
+
+void Calibration::load(void)
+{
+    if(m_loaded)
+    {
+        return;
+    }
+    loadBands();
+    if(!m_OSLCalibrationPerformed ||
+       !readCache(m_openCalibFilePath, m_shortCalibFilePath, m_loadCalibFilePath))
+    {
+        QString notChoosed = tr("Not chosen");
+        if(m_OSLCalibrationPerformed)
+        {
+            if(!m_openData.loadData(m_openCalibFilePath,&m_Z0))
+            {
+                m_openCalibFilePath = notChoosed;
+            }
+            if(!m_shortData.loadData(m_shortCalibFilePath,&m_Z0))
+            {
+                m_shortCalibFilePath = notChoosed;
+            }
+            if(!m_loadData.loadData(m_loadCalibFilePath,&m_Z0))
+            {
+                m_loadCalibFilePath = notChoosed;
+            }
+            m_OSLCalibrationPerformed = (m_openCalibFilePath != notChoosed) &&
+                                        (m_shortCalibFilePath != notChoosed) &&
+                                        (m_loadCalibFilePath != notChoosed);
+        }
+        updateStandards();
+        writeCache();
+    }
+    m_loaded = true;
+}
+
+void Calibration::setZ0(double _Z0)
+{
+    if(_Z0 == m_Z0)
+    {
+        return;
+    }
+    m_Z0 = _Z0;
+    // the actual standards of the kit are computed for Z0
+    if(m_loaded)
+    {
+        loadBands();
+        updateStandards();
+        writeCache();
+    }
+}
+
+const OslStandards &Calibration::standards()
+{
+    load();
+    return (m_active != NULL) ? *m_active : m_standards;
+}
+
+const OslStandards &Calibration::standards(double fqFrom, double fqTo)
+{
+    load();
+    const OslStandards *set = m_set.cover(fqFrom, fqTo);
+    return (set != NULL) ? *set : m_standards;
+}
+
+QStringList Calibration::cacheSources(const QString &open, const QString &shortPath, const QString &loadPath) const
+{
+    QStringList files;
+    files << open << shortPath << loadPath;
+    // a changed kit definition changes the actual standards
+    if(QFileInfo(kitFilePath()).isFile())
+    {
+        files << kitFilePath();
+    }
+    return files;
+}
+
+bool Calibration::readCache(const QString &open, const QString &shortPath, const QString &loadPath)
+{
+    QByteArray key = CalibrationCache::key(cacheSources(open, shortPath, loadPath), m_Z0);
+    OslStandards cached;
+    double Z0;
+    if(key.isEmpty() ||
+       !CalibrationCache::read(CalibrationCache::path(cacheDir(), key), key, cached, Z0))
+    {
+        return false;
+    }
+    m_Z0 = Z0;
+    // the standards as if the files were read, for captures of a single one
+    CalibData *data[3] = {&m_openData, &m_shortData, &m_loadData};
+    const QVector <double> *re[3] = {&cached.openRe, &cached.shortRe, &cached.loadRe};
+    const QVector <double> *im[3] = {&cached.openIm, &cached.shortIm, &cached.loadIm};
+    for(int n = 0; n < 3; ++n)
+    {
+        data[n]->clear();
+        for(int i = 0; i < cached.fq.size(); ++i)
+        {
+            double R, X;
+            SweepMath::impedance(m_Z0, re[n]->at(i), im[n]->at(i), R, X);
+            data[n]->setData(cached.fq.at(i), re[n]->at(i), im[n]->at(i), R, X);
+        }
+    }
+    m_standards = cached;
+    updateSet();
+    return true;
+}
+
+void Calibration::writeCache()
+{
+    if(!m_standards.isValid())
+    {
+        return;
+    }
+    QByteArray key = CalibrationCache::key(cacheSources(m_openCalibFilePath, m_shortCalibFilePath,
+                                                        m_loadCalibFilePath), m_Z0);
+    if(key.isEmpty())
+    {
+        return;
+    }
+    QDir dir(cacheDir());
+    QDir().mkpath(dir.absolutePath());
+    CalibrationCache::write(CalibrationCache::path(dir.absolutePath(), key), key, m_standards, m_Z0);
+
+    // the newest ones are enough to switch between the usual kits
+    QFileInfoList files = dir.entryInfoList(QStringList() << "*.acc", QDir::Files, QDir::Time);
+    for(int i = MAX_CALIBRATION_CACHE_FILES; i < files.size(); ++i)
+    {
+        QFile::remove(files.at(i).absoluteFilePath());
+    }
+}
+
+QString Calibration::cacheDir() const
+{
+    return QDir(m_calibrationPath).absoluteFilePath("Cache");
 }
 
 bool Calibration::getCalibrationPerformed(void)
@@ -147,45 +291,59 @@ void Calibration::on_newData(rawData _rawData)
     double R = _rawData.r;
     double X = _rawData.x;
 
-    double Gre = (R*R-m_Z0*m_Z0+X*X)/((R+m_Z0)*(R+m_Z0)+X*X);
-    double Gim = (2*m_Z0*X)/((R+m_Z0)*(R+m_Z0)+X*X);
+    double Gre, Gim;
+    SweepMath::reflection(m_Z0, R, X, Gre, Gim);
 
-    switch (m_state)
+    // the sweeps of a standard go to the running average, the standard
+    // gets the mean once the last one is complete
+    if((m_sweep == 0) && (m_dotsCount == 0))
     {
-    case CALIB_OPEN:
-        m_openData.setData(_rawData.fq, Gre, Gim, R, X);
-        break;
-    case CALIB_SHORT:
-        m_shortData.setData(_rawData.fq, Gre, Gim, R, X);
-        break;
-    case CALIB_LOAD:
-        m_loadData.setData(_rawData.fq, Gre, Gim, R, X);
-        break;
-    default:
-        break;
+        m_average.reset(m_dotsNumber + 1);
+        m_averageFq.fill(0, m_dotsNumber + 1);
     }
+    if((m_sweep == 0) && (m_dotsCount < m_averageFq.size()))
+    {
+        m_averageFq[m_dotsCount] = _rawData.fq;
+    }
+    m_average.add(m_dotsCount, Gre, Gim);
 
     ++m_dotsCount;
-    int percent = 100*m_dotsCount/dotsNumber();
+    int sweeps = averages();
+    int percent = 100*(m_sweep*(dotsNumber() + 1) + m_dotsCount)/(sweeps*(dotsNumber() + 1));
     if(percent > 100)
     {
         percent = 100;
     }
+
+    bool complete = (m_dotsCount == m_dotsNumber+1);
+    if(complete && (m_sweep + 1 < sweeps))
+    {
+        // next sweep of the same standard
+        m_dotsCount = 0;
+        ++m_sweep;
+        emit progress(m_state, qMin(percent, 99));
+        measureStandard();
+        return;
+    }
+    if(complete)
+    {
+        finishAverage();
+    }
     emit progress(m_state, percent);
 
-    if(m_dotsCount == m_dotsNumber+1)
+    if(complete)
     {
         m_dotsCount = 0;
+        m_sweep = 0;
 
 //        m_measurements->setCalibrationMode(false);//TODO
         emit setCalibrationMode(false);
 //        m_analyzer->setCalibrationMode(false);
-        QDir dir = m_calibrationPath;
+        updateStandards();
         switch (m_state)
         {
         case CALIB_OPEN:
-            m_openData.saveData(dir.absoluteFilePath("cal_open.s1p"),m_Z0);
-            m_openCalibFilePath = dir.absoluteFilePath("cal_open.s1p");
+            saveCapture(CALIB_OPEN);
             if(!m_onlyOneCalib)
             {
                 if (QMessageBox::information(NULL, tr("Short"),
@@ -200,8 +358,7 @@ void Calibration::on_newData(rawData _rawData)
             }
             break;
         case CALIB_SHORT:
-            m_shortData.saveData(dir.absoluteFilePath("cal_short.s1p"),m_Z0);
-            m_shortCalibFilePath = dir.absoluteFilePath("cal_short.s1p");
+            saveCapture(CALIB_SHORT);
             if(!m_onlyOneCalib)
             {
                 if (QMessageBox::information(NULL, tr("Load"),
@@ -216,12 +373,14 @@ void Calibration::on_newData(rawData _rawData)
             }
             break;
         case CALIB_LOAD:
-            m_loadData.saveData(dir.absoluteFilePath("cal_load.s1p"),m_Z0);
-            m_loadCalibFilePath = dir.absoluteFilePath("cal_load.s1p");
+            saveCapture(CALIB_LOAD);
             m_state = CALIB_NONE;
-            if(!m_onlyOneCalib)
+            if(!m_onlyOneCalib && !m_bandCapture)
             {
                 m_OSLCalibrationPerformed = true;
+            }
+            if(!m_onlyOneCalib)
+            {
                 QMessageBox::information(NULL, tr("Finish"),
                              tr("Calibration finished!"));
             }
@@ -236,69 +395,267 @@ void Calibration::on_newData(rawData _rawData)
     }
 }
 
+void Calibration::finishAverage()
+{
+    CalibData *data = captureData(m_state);
+    if(data == NULL)
+    {
+        return;
+    }
+    QVector <double> &variance = m_variance[m_state];
+    variance.resize(m_dotsNumber + 1);
+    data->clear();
+    for(int i = 0; i < variance.size(); ++i)
+    {
+        double Gre = m_average.re.at(i);
+        double Gim = m_average.im.at(i);
+        double R, X;
+        SweepMath::impedance(m_Z0, Gre, Gim, R, X);
+        data->setData(m_averageFq.at(i), Gre, Gim, R, X);
+        variance[i] = m_average.variance(i);
+    }
+    m_average.reset(0);
+    m_averageFq.clear();
+}
+
+double Calibration::maxDeviation(int standard) const
+{
+    if((standard <= CALIB_NONE) || (standard >= CALIB_NUM))
+    {
+        return 0;
+    }
+    const QVector <double> &variance = m_variance[standard];
+    double max = 0;
+    for(int i = 0; i < variance.size(); ++i)
+    {
+        max = qMax(max, variance.at(i));
+    }
+    return sqrt(max);
+}
+
 void Calibration::clearCalibration(void)
 {
-    m_openData.clear();
-    m_shortData.clear();
-    m_loadData.clear();
+    captureData(CALIB_OPEN)->clear();
+    captureData(CALIB_SHORT)->clear();
+    captureData(CALIB_LOAD)->clear();
+    updateStandards();
+}
+
+CalibData *Calibration::captureData(int standard)
+{
+    switch (standard)
+    {
+    case CALIB_OPEN:
+        return m_bandCapture ? &m_bandData[0] : &m_openData;
+    case CALIB_SHORT:
+        return m_bandCapture ? &m_bandData[1] : &m_shortData;
+    case CALIB_LOAD:
+        return m_bandCapture ? &m_bandData[2] : &m_loadData;
+    default:
+        return NULL;
+    }
+}
+
+void Calibration::beginCapture()
+{
+    // band captures sweep the range of the last measurement
+    m_bandCapture = m_bandCaptureEnabled && (m_sweepTo > m_sweepFrom);
+    m_captureFrom = m_sweepFrom;
+    m_captureTo = m_sweepTo;
+    m_dotsCount = 0;
+    m_sweep = 0;
+    if(m_bandCapture)
+    {
+        // recapturing one standard keeps the other two of the band
+        for(int standard = CALIB_OPEN; standard <= CALIB_LOAD; ++standard)
+        {
+            double Z0 = m_Z0;
+            m_bandData[standard - 1].loadData(bandFilePath(m_captureFrom, m_captureTo, standard), &Z0);
+        }
+    }
+}
+
+void Calibration::measureStandard()
+{
+    if(m_bandCapture)
+    {
+        m_analyzer->on_measureCalib(dotsNumber(), m_captureFrom, m_captureTo);
+    }else
+    {
+        m_analyzer->on_measureCalib(dotsNumber());
+    }
+}
+
+QString Calibration::bandFilePath(qint64 fqFrom, qint64 fqTo, int standard) const
+{
+    static const char *names[CALIB_NUM] = {"", "open", "short", "load"};
+    return QDir(m_calibrationPath).absoluteFilePath(QString("Bands/%1-%2_%3.s1p")
+                                                    .arg(fqFrom/1000).arg(fqTo/1000).arg(names[standard]));
+}
+
+void Calibration::saveCapture(int standard)
+{
+    static const char *names[CALIB_NUM] = {"", "cal_open.s1p", "cal_short.s1p", "cal_load.s1p"};
+    CalibData *data = captureData(standard);
+    if(m_bandCapture)
+    {
+        QDir(m_calibrationPath).mkdir("Bands");
+        data->saveData(bandFilePath(m_captureFrom, m_captureTo, standard), m_Z0);
+        // the band is used once all three standards are captured
+        OslStandards band = makeStandards(m_bandData[0], m_bandData[1], m_bandData[2]);
+        if(band.isValid())
+        {
+            m_bands.insert(band);
+            updateSet();
+        }
+        return;
+    }
+    QString path = QDir(m_calibrationPath).absoluteFilePath(names[standard]);
+    data->saveData(path, m_Z0);
+    switch (standard)
+    {
+    case CALIB_OPEN:
+        m_openCalibFilePath = path;
+        break;
+    case CALIB_SHORT:
+        m_shortCalibFilePath = path;
+        break;
+    case CALIB_LOAD:
+        m_loadCalibFilePath = path;
+        break;
+    default:
+        break;
+    }
+}
+
+void Calibration::loadBands()
+{
+    m_bands.clear();
+    QDir dir(QDir(m_calibrationPath).absoluteFilePath("Bands"));
+    foreach (const QString &file, dir.entryList(QStringList() << "*_open.s1p", QDir::Files, QDir::Name))
+    {
+        QString prefix = file.left(file.size() - QString("open.s1p").size());
+        CalibData data[3];
+        double Z0 = m_Z0;
+        if(data[0].loadData(dir.absoluteFilePath(file), &Z0) &&
+           data[1].loadData(dir.absoluteFilePath(prefix + "short.s1p"), &Z0) &&
+           data[2].loadData(dir.absoluteFilePath(prefix + "load.s1p"), &Z0))
+        {
+            m_bands.insert(makeStandards(data[0], data[1], data[2]));
+        }
+    }
+}
+
+QStringList Calibration::bandFilePaths() const
+{
+    QStringList paths;
+    QDir dir(QDir(m_calibrationPath).absoluteFilePath("Bands"));
+    foreach (const QString &file, dir.entryList(QStringList() << "*.s1p", QDir::Files, QDir::Name))
+    {
+        paths << dir.absoluteFilePath(file);
+    }
+    return paths;
+}
+
+void Calibration::setBandCapture(bool enabled)
+{
+    m_bandCaptureEnabled = enabled;
+}
+
+void Calibration::on_sweepRange(qint64 fqFrom, qint64 fqTo, int dotsNumber)
+{
+    Q_UNUSED(dotsNumber);
+    m_sweepFrom = fqFrom;
+    m_sweepTo = fqTo;
+    selectStandards();
+}
+
+void Calibration::selectStandards()
+{
+    m_active = m_set.cover(m_sweepFrom/1000000.0, m_sweepTo/1000000.0);
+}
+
+void Calibration::updateSet()
+{
+    // the bands replace the full range set where they cover the sweep more densely
+    m_set.clear();
+    m_set.insert(m_standards);
+    for(int i = 0; i < m_bands.count(); ++i)
+    {
+        m_set.insert(m_bands.at(i));
+    }
+    selectStandards();
 }
 
 void Calibration::on_startCalibration()
 {
     if(m_state == CALIB_NONE)
     {
+        load();
+        beginCapture();
         clearCalibration();
         connect(m_analyzer,SIGNAL(newData(rawData)),
                 this, SLOT(on_newData(rawData)));
     }
     m_state++;
+    m_dotsCount = 0;
+    m_sweep = 0;
 
     if(m_analyzer != NULL)
     {
         emit setCalibrationMode(true);
-        m_analyzer->on_measureCalib(dotsNumber());
+        measureStandard();
     }
 }
 
 void Calibration::on_startCalibrationOpen()
 {
+    load();
     m_state = CALIB_OPEN;
     m_onlyOneCalib = true;
-    m_openData.clear();
+    beginCapture();
+    captureData(m_state)->clear();
+    updateStandards();
     if(m_analyzer != NULL)
     {
         connect(m_analyzer,SIGNAL(newData(rawData)),
                 this, SLOT(on_newData(rawData)));
         emit setCalibrationMode(true);
-        m_analyzer->on_measureCalib(dotsNumber());
+        measureStandard();
     }
 }
 
 void Calibration::on_startCalibrationShort()
 {
+    load();
     m_state = CALIB_SHORT;
     m_onlyOneCalib = true;
-    m_shortData.clear();
+    beginCapture();
+    captureData(m_state)->clear();
+    updateStandards();
     if(m_analyzer != NULL)
     {
         connect(m_analyzer,SIGNAL(newData(rawData)),
                 this, SLOT(on_newData(rawData)));
         emit setCalibrationMode(true);
-        m_analyzer->on_measureCalib(dotsNumber());
+        measureStandard();
     }
 }
 
 void Calibration::on_startCalibrationLoad()
 {
+    load();
     m_state = CALIB_LOAD;
     m_onlyOneCalib = true;
-    m_loadData.clear();
+    beginCapture();
+    captureData(m_state)->clear();
+    updateStandards();
     if(m_analyzer != NULL)
     {
         connect(m_analyzer,SIGNAL(newData(rawData)),
                 this, SLOT(on_newData(rawData)));
         emit setCalibrationMode(true);
-        m_analyzer->on_measureCalib(dotsNumber());
+        measureStandard();
     }
 }
 
@@ -306,9 +663,19 @@ void Calibration::on_openOpenFile(QString path)
 {
     QString notChoosed = tr("Not chosen");
 
-    if(m_openData.loadData(path,&m_Z0))
+    load();
+    // a set of files used before is taken from the cache
+    if(readCache(path, m_shortCalibFilePath, m_loadCalibFilePath))
+    {
+        m_openCalibFilePath = path;
+    }else if(m_openData.loadData(path,&m_Z0))
     {
         m_openCalibFilePath = path;
+        updateStandards();
+        writeCache();
+    }else
+    {
+        updateStandards();
     }
     if( (m_openCalibFilePath != notChoosed) &&
          (m_shortCalibFilePath != notChoosed) &&
@@ -322,9 +689,19 @@ void Calibration::on_shortOpenFile(QString path)
 {
     QString notChoosed = tr("Not chosen");
 
-    if(m_shortData.loadData(path,&m_Z0))
+    load();
+    // a set of files used before is taken from the cache
+    if(readCache(m_openCalibFilePath, path, m_loadCalibFilePath))
+    {
+        m_shortCalibFilePath = path;
+    }else if(m_shortData.loadData(path,&m_Z0))
     {
         m_shortCalibFilePath = path;
+        updateStandards();
+        writeCache();
+    }else
+    {
+        updateStandards();
     }
     if( (m_openCalibFilePath != notChoosed) &&
          (m_shortCalibFilePath != notChoosed) &&
@@ -338,9 +715,19 @@ void Calibration::on_loadOpenFile(QString path)
 {
     QString notChoosed = tr("Not chosen");
 
-    if(m_loadData.loadData(path,&m_Z0))
+    load();
+    // a set of files used before is taken from the cache
+    if(readCache(m_openCalibFilePath, m_shortCalibFilePath, path))
+    {
+        m_loadCalibFilePath = path;
+    }else if(m_loadData.loadData(path,&m_Z0))
     {
         m_loadCalibFilePath = path;
+        updateStandards();
+        writeCache();
+    }else
+    {
+        updateStandards();
     }
     if( (m_openCalibFilePath != notChoosed) &&
          (m_shortCalibFilePath != notChoosed) &&
@@ -350,113 +737,39 @@ void Calibration::on_loadOpenFile(QString path)
     }
 }
 
-bool Calibration::interpolateS(double fq, double &reO, double &imO, double &reS, double &imS, double &reL, double &imL)
+void Calibration::updateStandards(void)
 {
-    if(m_openData.getSize() == 0)
-    {
-        return false;
-    }
-    if (m_openData.getSize() != m_shortData.getSize() || m_openData.getSize() != m_loadData.getSize())
-    {
-        return false;
-    }
+    m_standards = makeStandards(m_openData, m_shortData, m_loadData);
+    updateSet();
+}
 
-    double alf = 0;
-    int i;
-    for(i = 0; i < m_openData.getSize()-1; ++i)
+OslStandards Calibration::makeStandards(CalibData &open, CalibData &shortData, CalibData &load) const
+{
+    OslStandards standards;
+    int size = open.getSize();
+    if((size < 2) || (shortData.getSize() != size) || (load.getSize() != size))
     {
-        double fq1 = m_openData.getFq(i);
-        double fq2 = m_openData.getFq(i+1);
-        if((fq >= fq1) && (fq <= fq2))
-        {
-            alf = (fq-fq1)/(fq2-fq1);
-            break;
-        }
-        if (fq < fq1)
-        {
-            alf = 0;
-            break;
-        }
+        return standards;
     }
-
-    if(i >= m_openData.getSize()-2)
+    standards.fq.resize(size);
+    standards.openRe.resize(size);
+    standards.openIm.resize(size);
+    standards.shortRe.resize(size);
+    standards.shortIm.resize(size);
+    standards.loadRe.resize(size);
+    standards.loadIm.resize(size);
+    for(int i = 0; i < size; ++i)
     {
-        //return false;
-        i--;
+        standards.fq[i] = open.getFq(i);
+        standards.openRe[i] = open.getRe(i);
+        standards.openIm[i] = open.getIm(i);
+        standards.shortRe[i] = shortData.getRe(i);
+        standards.shortIm[i] = shortData.getIm(i);
+        standards.loadRe[i] = load.getRe(i);
+        standards.loadIm[i] = load.getIm(i);
     }
-
-    reO = m_openData.getRe(i)*(1-alf) + m_openData.getRe(i+1)*alf;
-    imO = m_openData.getIm(i)*(1-alf) + m_openData.getIm(i+1)*alf;
-
-    reS = m_shortData.getRe(i)*(1-alf) + m_shortData.getRe(i+1)*alf;
-    imS = m_shortData.getIm(i)*(1-alf) + m_shortData.getIm(i+1)*alf;
-
-    reL = m_loadData.getRe(i)*(1-alf) + m_loadData.getRe(i+1)*alf;
-    imL = m_loadData.getIm(i)*(1-alf) + m_loadData.getIm(i+1)*alf;
-    return true;
-}
-
-void Calibration::applyCalibration(double MMR, double MMI, // Measured
-                      double MOR, double MOI, double MSR, double MSI, double MLR, double MLI, // Measured parameters of cal standards
-                      double SOR, double SOI, double SSR, double SSI, double SLR, double SLI, // Actual parameters of cal standards
-                      double& MAR, double& MAI) // Actual
-{
-
-        // Calculate coefficients
-
-        double	K1R = MLR - MSR,
-                K1I = MLI - MSI,
-                K2R = MSR - MOR,
-                K2I = MSI - MOI,
-                K3R = MOR - MLR,
-                K3I = MOI - MLI;
-
-        double	K4R = K1R*(SLR*SSR-SLI*SSI) - K1I*(SLR*SSI+SLI*SSR),
-                K4I = K1R*(SLR*SSI+SLI*SSR) + K1I*(SLR*SSR-SLI*SSI);
-
-        double	K5R = K2R*(SOR*SSR-SOI*SSI) - K2I*(SOR*SSI+SOI*SSR),
-                K5I = K2R*(SOR*SSI+SOI*SSR) + K2I*(SOR*SSR-SOI*SSI);
-
-        double	K6R = K3R*(SLR*SOR-SLI*SOI) - K3I*(SLR*SOI+SLI*SOR),
-                K6I = K3R*(SLR*SOI+SLI*SOR) + K3I*(SLR*SOR-SLI*SOI);
-
-        double	K7R = SOR*K1R - SOI*K1I,
-                K7I = SOR*K1I + SOI*K1R;
-
-        double	K8R = SLR*K2R - SLI*K2I,
-                K8I = SLR*K2I + SLI*K2R;
-
-        double	K9R = SSR*K3R - SSI*K3I,
-                K9I = SSR*K3I + SSI*K3R;
-
-        double	DR = K4R + K5R + K6R,
-                DI = K4I + K5I + K6I;
-
-        double	AnumR = MOR*K7R - MOI*K7I + MLR*K8R - MLI*K8I + MSR*K9R - MSI*K9I,
-                AnumI = MOR*K7I + MOI*K7R + MLR*K8I + MLI*K8R + MSR*K9I + MSI*K9R;
-
-        double	BnumR = MOR*K4R - MOI*K4I + MLR*K5R - MLI*K5I + MSR*K6R - MSI*K6I,
-                BnumI = MOR*K4I + MOI*K4R + MLR*K5I + MLI*K5R + MSR*K6I + MSI*K6R;
-
-        double	CnumR = K7R + K8R + K9R,
-                CnumI = K7I + K8I + K9I;
-
-        double	AR = (AnumR*DR + AnumI*DI)/(DR*DR + DI*DI),
-                AI = (AnumI*DR - AnumR*DI)/(DR*DR + DI*DI);
-
-        double	BR = (BnumR*DR + BnumI*DI)/(DR*DR + DI*DI),
-                BI = (BnumI*DR - BnumR*DI)/(DR*DR + DI*DI);
-
-        double	CR = (CnumR*DR + CnumI*DI)/(DR*DR + DI*DI),
-                CI = (CnumI*DR - CnumR*DI)/(DR*DR + DI*DI);
-
-        double	MAnumR = MMR - BR,
-                MAnumI = MMI - BI,
-                MAdenR = AR + CI*MMI - CR*MMR,
-                MAdenI = AI - CR*MMI - CI*MMR;
-
-        MAR = (MAnumR*MAdenR + MAnumI*MAdenI)/(MAdenR*MAdenR + MAdenI*MAdenI);
-        MAI = (MAnumI*MAdenR - MAnumR*MAdenI)/(MAdenR*MAdenR + MAdenI*MAdenI);
+    standards.setKit(m_kit, m_Z0);
+    return standards;
 }
 
 void Calibration::on_enableOSLCalibration(bool enabled)
@@ -5,8 +5,14 @@
 #include <analyzer/analyzerparameters.h>
 #include <analyzer/analyzer.h>
 #include <QSettings>
+#include <QDir>
+#include <touchstone.h>
+#include <core/sweepmath.h>
+#include <core/calkit.h>
 //#include <shlobj.h>
 
+#define MAX_CALIBRATION_CACHE_FILES     16
+
 enum {CALIB_NONE = 0, CALIB_OPEN, CALIB_SHORT, CALIB_LOAD, CALIB_NUM};
 
 class CalibData
@@ -56,195 +62,40 @@ public:
     {
         clear();
 
-        QString sPathName = path;
-
-        if (sPathName.isEmpty())
+        if (path.isEmpty())
         {
             return false;
         }
 
-        QFile ifs(sPathName);
-
-        if (!ifs.open(QFile::ReadWrite))
+        QVector <rawData> data;
+        TouchstoneReader reader;
+        if (!reader.read(path, data) || (data.size() < 2))
         {
             return false;
         }
-        QTextStream in(&ifs);
-        bool bGood = true;
-
-        int iLines=0, iPoints=0;
-
-        double  fqmul = 1000.0; // Default is GHz
-        int iUnit = 1; // Default is S
-        int iFormat = 1; // Default is MA
-
-        QString line;// Whole string
-        char strn[5][100]; // Substrings
-
-        double f, param1, param2; // for reading S11 data lines
-
-
-        do
+        *Z0 = reader.Z0();
+
+        m_fq.reserve(data.size());
+        m_re.reserve(data.size());
+        m_im.reserve(data.size());
+        m_r.reserve(data.size());
+        m_x.reserve(data.size());
+        for (int i = 0; i < data.size(); ++i)
         {
-            line = in.readLine();
-            iLines++;
-
-            if ( (line.length() > 2) && (line[0] == '#')) // Option line
-            {
-                line.remove(0,1);
-                bool bErr = false;
-
-                int ns = sscanf(line.toLocal8Bit(), "%s %s %s %s %s", strn[0], strn[1], strn[2], strn[3], strn[4]);
-
-                for (int i=0; i<ns; i++)
-                {
-                    // Frequency unit
-
-                    if (!strcmp(strn[i], "GHz"))
-                        fqmul = 1000.0;
-                    else
-                    if (!strcmp(strn[i], "MHz"))
-                        fqmul = 1.0;
-                    else
-                    if (!strcmp(strn[i], "KHz"))
-                        fqmul = 0.001;
-                    else
-                    if (!strcmp(strn[i], "Hz"))
-                        fqmul = 0.000001;
-                    else
-
-                    // Parameter
-
-                    if (!strcmp(strn[i], "S"))
-                        iUnit = 1;
-                    else
-                    if (!strcmp(strn[i], "Z"))
-                        iUnit = 2;
-                    else
-
-                    // Format
-
-                    if (!strcmp(strn[i], "MA"))
-                        iFormat = 1;
-                    else
-                    if (!strcmp(strn[i], "RI"))
-                        iFormat = 2;
-                    else
-
-                    // R n
-
-                    if (!strcmp(strn[i], "R"))
-                    {
-                        if ( i < (ns-1) )
-                        {
-                            i++;
-
-                            *Z0 = atof(strn[i]);
-
-                            if ( (*Z0<=0) || (*Z0>10000) )
-                            {
-                                bErr = true;
-                                break;
-                            }
-                        }
-                        else
-                        {
-                            bErr = true;
-                            break;
-                        }
-                    }
-                    else
-                    {
-                        bErr = true;
-                        break;
-                    }
-                }
-
-                // Check possible combinations
-
-                if ( (iUnit == 1) && (iFormat == 1) ) // S, MA
-                {
-                }
-                else
-                if ( (iUnit == 1) && (iFormat == 2) ) // S, RI
-                {
-                }
-                else
-                if ( (iUnit == 2) && (iFormat == 2) ) // Z, RI
-                {
-                }
-                else
-                {
-                    bErr = true;
-                }
-
-                if (bErr == true)
-                {
-                    return false;
-                }
-
-                continue;
-            }
-
-            if ( (strstr(line.toLocal8Bit(), "!") != NULL) || (strstr(line.toLocal8Bit(), ".") == NULL) ) // Comment or void line
-                continue;
-
-            // Scan data lines
-
-            if ( sscanf(line.toLocal8Bit(), "%lf %lf %lf", &f, &param1, &param2) != 3)
-            {
-                return false;
-            }
-
-            double r = 0,x = 0;
-
-            if ( (iUnit == 1) && (iFormat == 1) ) // S, MA
-            {
-                    // param1=|G|, param2=angle(deg)
-                    double Gr = param1 * cos(param2/180.0*M_PI);
-                    double Gi = param1 * sin(param2/180.0*M_PI);
-
-                    r = (1-Gr*Gr-Gi*Gi)/((1-Gr)*(1-Gr)+Gi*Gi);
-                    x = (2*Gi)/((1-Gr)*(1-Gr)+Gi*Gi);
-            }
-            else
-            if ( (iUnit == 1) && (iFormat == 2) ) // S, RI
-            {
-                    // param1=Gr, param2=Gi
-                    r = (1-param1*param1-param2*param2)/((1-param1)*(1-param1)+param2*param2);
-                    x = (2*param2)/((1-param1)*(1-param1)+param2*param2);
-            }
-            else
-            if ( (iUnit == 2) && (iFormat == 2) ) // Z, RI
-            {
-                    r = param1;
-                    x = param2;
-            }
-
-            if ( qIsNaN(r) || (r<0) )
-                r = 0;
-            if ( qIsNaN(x) )
-                x = 0;
+            const rawData &point = data.at(i);
+            double r = point.r/(*Z0);
+            double x = point.x/(*Z0);
 
             double Gre = (r*r-1+x*x)/((r+1)*(r+1)+x*x);
             double Gim = (2*x)/((r+1)*(r+1)+x*x);
 
-            m_fq.append(f*fqmul);
+            m_fq.append(point.fq);
             m_re.append(Gre);
             m_im.append(Gim);
-            m_r.append(r*(*Z0));
-            m_x.append(x*(*Z0));
-            iPoints++;
-        }while (!line.isNull());
-
-        if (bGood && (iPoints>1) )
-        {
-            return true;
-        }
-        else
-        {
-            return false;
+            m_r.append(point.r);
+            m_x.append(point.x);
         }
+        return true;
     }
     bool saveData(QString name, double Z0)
     {
@@ -331,25 +182,57 @@ public:
     bool getCalibrationEnabled(void);
     void setAnalyzer(Analyzer *analyzer);//, Measurements *measurements);
     bool isCalibrationPerformed(){return m_OSLCalibrationPerformed;}
-    bool interpolateS(double fq, double &reO, double &imO, double &reS, double &imS, double &reL, double &imL);
-    void applyCalibration(double MMR, double MMI, // Measured
-                          double MOR, double MOI, double MSR, double MSI, double MLR, double MLI, // Measured parameters of cal standards
-                          double SOR, double SOI, double SSR, double SSI, double SLR, double SLI, // Actual parameters of cal standards
-                          double& MAR, double& MAI);
+    // the open, short and load measurements for SweepMath::calibrate(), the
+    // densest band that covers the sweep being measured or the full range set;
+    // the files are read on the first call, from the cache if they were before;
+    // GUI thread only, workers get the returned set
+    const OslStandards &standards();
+    // the same for data of another range, loaded or imported, fq in MHz
+    const OslStandards &standards(double fqFrom, double fqTo);
+    // band calibrations captured with setBandCapture()
+    const OslStandardsSet &bands() const { return m_bands; }
+    // the next capture sweeps only the range of the last measurement
+    void setBandCapture(bool enabled);
+    bool bandCapture() const { return m_bandCaptureEnabled; }
 
     QString getOpenFileName();
     QString getShortFileName();
     QString getLoadFileName();
+    // full paths of the open, short and load files and of the kit definition
+    QStringList filePaths() const { return QStringList() << m_openCalibFilePath
+                                                         << m_shortCalibFilePath << m_loadCalibFilePath
+                                                         << kitFilePath() << bandFilePaths(); }
+    QStringList bandFilePaths() const;
+    // the standards are ideal unless calkit.ini in the calibration folder defines them
+    QString kitFilePath() const { return QDir(m_calibrationPath).absoluteFilePath("calkit.ini"); }
+    const CalKit &kit() const { return m_kit; }
 
     double getZ0 () const {return m_Z0;}
-    void setZ0 (double _Z0) {m_Z0 = _Z0;}
+    void setZ0 (double _Z0);
     int dotsNumber() { return ((m_dotsNumber < 0) ? 500 : m_dotsNumber); }
     void setDotsNumber(int _dots) { m_dotsNumber = (_dots > 2000) ? 2000 : _dots; }
+    // sweeps averaged per standard
+    int averages() const { return m_averages; }
+    void setAverages(int _averages) { m_averages = qBound(1, _averages, 100); }
+    // largest standard deviation of the reflection over the averaged sweeps of
+    // the last capture of a standard, 0 for a single sweep
+    double maxDeviation(int standard) const;
+    const QVector<double> &variance(int standard) const { return m_variance[standard]; }
 
 private:
     CalibData m_openData;
     CalibData m_shortData;
     CalibData m_loadData;
+    CalibData m_bandData[3];    // open, short and load of the band being captured
+    OslStandards m_standards;
+    OslStandardsSet m_bands;
+    OslStandardsSet m_set;      // m_standards and m_bands, for the lookup
+    const OslStandards *m_active;
+    bool m_loaded;              // the files of start() are read
+    CalKit m_kit;
+    ComplexAverage m_average;
+    QVector <double> m_averageFq;
+    QVector <double> m_variance[CALIB_NUM];
 
     int m_state;
     int m_dotsCount;
@@ -369,8 +252,32 @@ private:
     QString m_loadCalibFilePath;
 
     void clearCalibration(void);
+    void finishAverage(void);
+    void updateStandards(void);
+    OslStandards makeStandards(CalibData &open, CalibData &shortData, CalibData &load) const;
+    CalibData *captureData(int standard);
+    void beginCapture();
+    void measureStandard();
+    void saveCapture(int standard);
+    QString bandFilePath(qint64 fqFrom, qint64 fqTo, int standard) const;
+    void loadBands();
+    void load(void);
+    QStringList cacheSources(const QString &open, const QString &shortPath, const QString &loadPath) const;
+    bool readCache(const QString &open, const QString &shortPath, const QString &loadPath);
+    void writeCache();
+    QString cacheDir() const;
+    void updateSet();
+    void selectStandards();
     QString m_calibrationPath;
     int m_dotsNumber;
+    int m_averages;
+    int m_sweep;                // sweep of the current standard, 0 to m_averages-1
+    bool m_bandCaptureEnabled;
+    bool m_bandCapture;         // the running capture is a band one
+    qint64 m_sweepFrom;         // Hz, range of the last measurement
+    qint64 m_sweepTo;
+    qint64 m_captureFrom;
+    qint64 m_captureTo;
 
 
 signals:
@@ -379,6 +286,7 @@ signals:
 
 public slots:
     void on_newData(rawData _rawData);
+    void on_sweepRange(qint64 fqFrom, qint64 fqTo, int dotsNumber);
     void on_startCalibration();
     void on_startCalibrationOpen();
     void on_startCalibrationShort();
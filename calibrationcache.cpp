@@ -0,0 +1,170 @@
+#include "calibrationcache.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+#include <crc32.h>
+#include <stddef.h>
+#include <string.h>
+
+// the layout is part of the file format
+Q_STATIC_ASSERT(sizeof(CalibrationCacheHeader) == 56);
+
+#define MAX_CACHE_POINTS        1000000
+
+static void putDouble(uchar *dest, double value)
+{
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian<quint64>(bits, dest);
+}
+
+static double getDouble(const uchar *src)
+{
+    quint64 bits = qFromLittleEndian<quint64>(src);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// the order of the columns in the file
+static QVector<QVector<double> *> columns(OslStandards &standards, bool actual)
+{
+    QVector <QVector<double> *> list;
+    list << &standards.fq
+         << &standards.openRe << &standards.openIm
+         << &standards.shortRe << &standards.shortIm
+         << &standards.loadRe << &standards.loadIm
+         << &standards.termARe << &standards.termAIm
+         << &standards.termBRe << &standards.termBIm
+         << &standards.termCRe << &standards.termCIm;
+    if(actual)
+    {
+        list << &standards.actualOpenRe << &standards.actualOpenIm
+             << &standards.actualShortRe << &standards.actualShortIm
+             << &standards.actualLoadRe << &standards.actualLoadIm;
+    }
+    return list;
+}
+
+QByteArray CalibrationCache::key(const QStringList &files, double Z0)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    foreach (const QString &path, files)
+    {
+        QFile file(path);
+        if(!file.open(QFile::ReadOnly))
+        {
+            return QByteArray();
+        }
+        hash.addData(&file);
+        // the size separates the files
+        hash.addData(QByteArray::number(file.size()));
+    }
+    hash.addData(QByteArray::number(Z0, 'g', 17));
+    return hash.result();
+}
+
+QString CalibrationCache::path(const QString &dir, const QByteArray &key)
+{
+    return QDir(dir).absoluteFilePath(QString::fromLatin1(key.toHex()) + ".acc");
+}
+
+bool CalibrationCache::read(const QString &path, const QByteArray &key, OslStandards &standards, double &fileZ0)
+{
+    if(key.size() != 20)
+    {
+        return false;
+    }
+    QFile file(path);
+    if(!file.open(QFile::ReadOnly))
+    {
+        return false;
+    }
+    QByteArray header = file.read(sizeof(CalibrationCacheHeader));
+    const uchar *p = reinterpret_cast<const uchar *>(header.constData());
+    if((header.size() != sizeof(CalibrationCacheHeader)) ||
+       (memcmp(p, CALIBRATION_CACHE_MAGIC, 4) != 0) ||
+       (qFromLittleEndian<quint32>(p + offsetof(CalibrationCacheHeader, version)) != CALIBRATION_CACHE_VERSION) ||
+       (memcmp(p + offsetof(CalibrationCacheHeader, key), key.constData(), 20) != 0))
+    {
+        return false;
+    }
+    quint32 flags = qFromLittleEndian<quint32>(p + offsetof(CalibrationCacheHeader, flags));
+    quint32 points = qFromLittleEndian<quint32>(p + offsetof(CalibrationCacheHeader, points));
+    if((points < 2) || (points > MAX_CACHE_POINTS))
+    {
+        return false;
+    }
+    file.seek(qFromLittleEndian<quint32>(p + offsetof(CalibrationCacheHeader, headerSize)));
+
+    OslStandards result;
+    QVector <QVector<double> *> list = columns(result, flags & HasActual);
+    QByteArray data = file.read(qint64(list.size())*points*sizeof(double));
+    if((data.size() != list.size()*int(points)*int(sizeof(double))) ||
+       (CRC32::crc(0xffffffff, data) != qFromLittleEndian<quint32>(p + offsetof(CalibrationCacheHeader, crc))))
+    {
+        return false;
+    }
+    const uchar *src = reinterpret_cast<const uchar *>(data.constData());
+    for(int n = 0; n < list.size(); ++n)
+    {
+        QVector <double> &column = *list.at(n);
+        column.resize(points);
+        for(quint32 i = 0; i < points; ++i, src += sizeof(double))
+        {
+            column[i] = getDouble(src);
+        }
+    }
+    if(!result.isValid() || !result.hasTerms())
+    {
+        return false;
+    }
+    standards = result;
+    fileZ0 = getDouble(p + offsetof(CalibrationCacheHeader, Z0));
+    return true;
+}
+
+bool CalibrationCache::write(const QString &path, const QByteArray &key, const OslStandards &standards, double fileZ0)
+{
+    if((key.size() != 20) || !standards.isValid() || !standards.hasTerms())
+    {
+        return false;
+    }
+    OslStandards copy = standards;
+    bool actual = standards.hasActual();
+    QVector <QVector<double> *> list = columns(copy, actual);
+    int points = standards.fq.size();
+
+    QByteArray data(list.size()*points*int(sizeof(double)), 0);
+    uchar *dest = reinterpret_cast<uchar *>(data.data());
+    for(int n = 0; n < list.size(); ++n)
+    {
+        const QVector <double> &column = *list.at(n);
+        for(int i = 0; i < points; ++i, dest += sizeof(double))
+        {
+            putDouble(dest, column.at(i));
+        }
+    }
+
+    uchar header[sizeof(CalibrationCacheHeader)];
+    memset(header, 0, sizeof(header));
+    memcpy(header, CALIBRATION_CACHE_MAGIC, 4);
+    qToLittleEndian<quint32>(CALIBRATION_CACHE_VERSION, header + offsetof(CalibrationCacheHeader, version));
+    qToLittleEndian<quint32>(sizeof(CalibrationCacheHeader), header + offsetof(CalibrationCacheHeader, headerSize));
+    qToLittleEndian<quint32>(actual ? HasActual : 0, header + offsetof(CalibrationCacheHeader, flags));
+    qToLittleEndian<quint32>(points, header + offsetof(CalibrationCacheHeader, points));
+    qToLittleEndian<quint32>(CRC32::crc(0xffffffff, data), header + offsetof(CalibrationCacheHeader, crc));
+    putDouble(header + offsetof(CalibrationCacheHeader, Z0), fileZ0);
+    memcpy(header + offsetof(CalibrationCacheHeader, key), key.constData(), 20);
+
+    QSaveFile file(path);
+    if(!file.open(QFile::WriteOnly))
+    {
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    file.write(data);
+    return file.commit();
+}
@@ -0,0 +1,49 @@
+#ifndef CALIBRATIONCACHE_H
+#define CALIBRATIONCACHE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <core/sweepmath.h>
+
+#define CALIBRATION_CACHE_MAGIC     "ACC1"
+#define CALIBRATION_CACHE_VERSION   1
+
+// Layout of a calibration cache file, all fields little-endian: a
+// CalibrationCacheHeader and the columns of OslStandards as doubles, fq, the
+// measured standards, the error terms and, with HasActual, the actual
+// standards. The CRC32 covers the columns.
+struct CalibrationCacheHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 headerSize;
+    quint32 flags;
+    quint32 points;
+    quint32 crc;
+    double Z0;              // of the source files
+    quint8 key[20];
+    quint32 reserved;
+};
+
+// Prepared OslStandards of one set of calibration files, so the Touchstone
+// files are parsed and the error terms computed only once. A cache file
+// belongs to the hash of the files it was made from and the system Z0.
+class CalibrationCache
+{
+public:
+    enum Flags
+    {
+        HasActual = 1
+    };
+
+    // SHA-1 over the contents of the files and Z0, empty if a file is missing
+    static QByteArray key(const QStringList &files, double Z0);
+    // file of the key in dir
+    static QString path(const QString &dir, const QByteArray &key);
+
+    static bool read(const QString &path, const QByteArray &key, OslStandards &standards, double &fileZ0);
+    static bool write(const QString &path, const QByteArray &key, const OslStandards &standards, double fileZ0);
+};
+
+#endif // CALIBRATIONCACHE_H
@@ -0,0 +1,244 @@
+#include "catalogdialog.h"
+#include "ui_catalogdialog.h"
+#include <QDateTime>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <algorithm>
+
+enum CatalogColumn
+{
+    ColumnDate,
+    ColumnAntenna,
+    ColumnName,
+    ColumnFqFrom,
+    ColumnFqTo,
+    ColumnMinSwr,
+    ColumnMinSwrFq,
+    ColumnResonance,
+    ColumnBand,
+    ColumnCount
+};
+
+static QString number(double value, int decimals)
+{
+    return qIsNaN(value) ? QString() : QString::number(value, 'f', decimals);
+}
+
+CatalogModel::CatalogModel(SweepCatalog *catalog, QObject *parent) :
+    QAbstractTableModel(parent),
+    m_catalog(catalog)
+{
+}
+
+void CatalogModel::setRows(const QVector<int> &rows)
+{
+    beginResetModel();
+    m_rows = rows;
+    endResetModel();
+}
+
+int CatalogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int CatalogModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant CatalogModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || (role != Qt::DisplayRole) || (index.row() >= m_rows.size()))
+    {
+        return QVariant();
+    }
+    const CatalogEntry &entry = m_catalog->entry(m_rows.at(index.row()));
+    switch(index.column())
+    {
+    case ColumnDate:
+        return QDateTime::fromMSecsSinceEpoch(entry.timestamp).toString("yyyy-MM-dd hh:mm:ss");
+    case ColumnAntenna:
+        return entry.antenna;
+    case ColumnName:
+        return entry.name;
+    case ColumnFqFrom:
+        return number(entry.fqFrom, 3);
+    case ColumnFqTo:
+        return number(entry.fqTo, 3);
+    case ColumnMinSwr:
+        return number(entry.minSwr, 2);
+    case ColumnMinSwrFq:
+        return number(entry.minSwrFq, 3);
+    case ColumnResonance:
+        return number(entry.resonance, 3);
+    case ColumnBand:
+        if(qIsNaN(entry.bandLower))
+        {
+            return QVariant();
+        }
+        return QString("%1 - %2").arg(number(entry.bandLower, 3), number(entry.bandUpper, 3));
+    }
+    return QVariant();
+}
+
+QVariant CatalogModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if((orientation != Qt::Horizontal) || (role != Qt::DisplayRole))
+    {
+        return QVariant();
+    }
+    switch(section)
+    {
+    case ColumnDate: return tr("Date");
+    case ColumnAntenna: return tr("Antenna");
+    case ColumnName: return tr("Name");
+    case ColumnFqFrom: return tr("From, MHz");
+    case ColumnFqTo: return tr("To, MHz");
+    case ColumnMinSwr: return tr("Min SWR");
+    case ColumnMinSwrFq: return tr("at, MHz");
+    case ColumnResonance: return tr("Resonance, MHz");
+    case ColumnBand: return tr("SWR < %1, MHz").arg(CATALOG_SWR_LIMIT);
+    }
+    return QVariant();
+}
+
+CatalogDialog::CatalogDialog(SweepCatalog *catalog, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::CatalogDialog),
+    m_catalog(catalog)
+{
+    ui->setupUi(this);
+
+    m_model = new CatalogModel(m_catalog, this);
+    ui->resultsView->setModel(m_model);
+    ui->resultsView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    QDate today = QDate::currentDate();
+    QDate first = today.addYears(-1);
+    if(m_catalog->count() > 0)
+    {
+        first = QDateTime::fromMSecsSinceEpoch(m_catalog->entry(0).timestamp).date();
+    }
+    ui->fromDateEdit->setDate(first);
+    ui->toDateEdit->setDate(today);
+    updateAntennas();
+
+    QString path = Settings::setIniFile();
+    m_settings = new QSettings(path, QSettings::IniFormat);
+    m_settings->beginGroup("Catalog");
+    QRect rect = m_settings->value("geometry", 0).toRect();
+    if(rect.x() != 0)
+    {
+        this->setGeometry(rect);
+    }
+    m_settings->endGroup();
+
+    on_searchBtn_clicked();
+}
+
+CatalogDialog::~CatalogDialog()
+{
+    m_settings->beginGroup("Catalog");
+    m_settings->setValue("geometry", this->geometry());
+    m_settings->endGroup();
+    delete m_settings;
+
+    delete ui;
+}
+
+void CatalogDialog::setAntenna(QString antenna)
+{
+    ui->antennaLineEdit->setText(antenna);
+}
+
+QString CatalogDialog::antenna() const
+{
+    return ui->antennaLineEdit->text().trimmed();
+}
+
+void CatalogDialog::updateAntennas()
+{
+    QString current = ui->antennaComboBox->currentIndex() > 0 ? ui->antennaComboBox->currentText() : QString();
+    ui->antennaComboBox->clear();
+    ui->antennaComboBox->addItem(tr("All antennas"));
+    ui->antennaComboBox->addItems(m_catalog->antennas());
+    int index = ui->antennaComboBox->findText(current);
+    ui->antennaComboBox->setCurrentIndex((index > 0) ? index : 0);
+}
+
+void CatalogDialog::on_searchBtn_clicked()
+{
+    CatalogQuery query;
+    query.from = QDateTime(ui->fromDateEdit->date()).toMSecsSinceEpoch();
+    query.to = QDateTime(ui->toDateEdit->date().addDays(1)).toMSecsSinceEpoch() - 1;
+    query.fqFrom = ui->fqFromSpinBox->value();
+    query.fqTo = ui->fqToSpinBox->value();
+    if(ui->antennaComboBox->currentIndex() > 0)
+    {
+        query.antenna = ui->antennaComboBox->currentText();
+    }
+    QVector <int> rows = m_catalog->query(query);
+    // newest first
+    std::reverse(rows.begin(), rows.end());
+    m_model->setRows(rows);
+    ui->countLabel->setText(tr("%1 of %2 sweeps").arg(rows.size()).arg(m_catalog->count()));
+}
+
+QVector<int> CatalogDialog::selectedEntries() const
+{
+    QVector <int> entries;
+    foreach (const QModelIndex &index, ui->resultsView->selectionModel()->selectedRows())
+    {
+        entries.append(m_model->entryIndex(index.row()));
+    }
+    std::sort(entries.begin(), entries.end());
+    return entries;
+}
+
+void CatalogDialog::on_openBtn_clicked()
+{
+    // oldest first, so the newest sweep ends up as the active measurement
+    foreach (int entry, selectedEntries())
+    {
+        emit openSweep(entry);
+    }
+}
+
+void CatalogDialog::on_resultsView_doubleClicked(const QModelIndex &index)
+{
+    if(index.isValid())
+    {
+        emit openSweep(m_model->entryIndex(index.row()));
+    }
+}
+
+void CatalogDialog::on_deleteBtn_clicked()
+{
+    QVector <int> entries = selectedEntries();
+    if(entries.isEmpty())
+    {
+        return;
+    }
+    if(QMessageBox::question(this, tr("Catalog"), tr("Remove %1 sweeps from the catalog?").arg(entries.size()),
+                             QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes)
+    {
+        return;
+    }
+    // from the back, removing an entry shifts the ones behind it
+    for(int i = entries.size() - 1; i >= 0; --i)
+    {
+        if(!m_catalog->remove(entries.at(i)))
+        {
+            QMessageBox::information(this, tr("Error"), m_catalog->errorString());
+            break;
+        }
+    }
+    updateAntennas();
+    on_searchBtn_clicked();
+}
+
+void CatalogDialog::on_closeBtn_clicked()
+{
+    close();
+}
@@ -0,0 +1,65 @@
+#ifndef CATALOGDIALOG_H
+#define CATALOGDIALOG_H
+
+#include <QDialog>
+#include <QAbstractTableModel>
+#include <QSettings>
+#include <settings.h>
+#include <sweepcatalog.h>
+
+namespace Ui {
+class CatalogDialog;
+}
+
+// Rows of a catalog query, the view only asks for the visible ones.
+class CatalogModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit CatalogModel(SweepCatalog *catalog, QObject *parent = 0);
+
+    void setRows(const QVector<int> &rows);
+    int entryIndex(int row) const { return m_rows.at(row); }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+private:
+    SweepCatalog *m_catalog;
+    QVector <int> m_rows;
+};
+
+class CatalogDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit CatalogDialog(SweepCatalog *catalog, QWidget *parent = 0);
+    ~CatalogDialog();
+
+    void setAntenna(QString antenna);
+    QString antenna() const;
+
+signals:
+    void openSweep(int index);
+
+private:
+    Ui::CatalogDialog *ui;
+    SweepCatalog *m_catalog;
+    CatalogModel *m_model;
+    QSettings *m_settings;
+
+    void updateAntennas();
+    QVector<int> selectedEntries() const;
+
+private slots:
+    void on_searchBtn_clicked();
+    void on_openBtn_clicked();
+    void on_deleteBtn_clicked();
+    void on_closeBtn_clicked();
+    void on_resultsView_doubleClicked(const QModelIndex &index);
+};
+
+#endif // CATALOGDIALOG_H
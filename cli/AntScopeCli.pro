@@ -0,0 +1,46 @@
+#-------------------------------------------------
+#
+# Headless batch analysis of saved sweeps.
+# Built by AntScopeAll.pro after the core library.
+#
+#-------------------------------------------------
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+QT       += core
+QT       += concurrent
+QT       -= gui
+
+DEFINES += ANTSCOPE2VER='\\"1.0.14.BETA2\\"'
+
+TARGET = AntScope2Cli
+TEMPLATE = app
+
+CONFIG += debug
+CONFIG -= release
+
+CONFIG(release) {
+	DESTDIR = $${PWD}/../build/release
+}
+else {
+	DESTDIR = $${PWD}/../build/debug
+}
+
+OBJECTS_DIR = $$DESTDIR/.obj-cli
+MOC_DIR = $$DESTDIR/.moc-cli
+
+INCLUDEPATH += $$PWD/..
+
+include(../core/core.pri)
+
+SOURCES += main.cpp \
+	batchanalysis.cpp \
+	../touchstone.cpp \
+	../sessionarchive.cpp \
+	../crc32.cpp
+
+HEADERS  += batchanalysis.h \
+	../touchstone.h \
+	../sessionarchive.h \
+	../crc32.h
@@ -0,0 +1,408 @@
+#include "batchanalysis.h"
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtConcurrent/QtConcurrentMap>
+#include <sessionarchive.h>
+#include <touchstone.h>
+
+static bool setError(QString *error, const QString &text)
+{
+    if(error != NULL)
+    {
+        *error = text;
+    }
+    return false;
+}
+
+static bool isSweepFile(const QString &path)
+{
+    QString suffix = QFileInfo(path).suffix().toLower();
+    return (suffix == "asd") || (suffix == "asz") ||
+           (TouchstoneReader::portsFromFileName(path) > 0);
+}
+
+static bool isSession(const QString &path)
+{
+    return QFileInfo(path).suffix().toLower() == "asz";
+}
+
+// every measurement of a session archive is analyzed on its own as "archive#index"
+static void appendSession(const QString &path, QStringList &files)
+{
+    SessionReader reader;
+    if(!reader.open(path))
+    {
+        // loadSweep() reports the error
+        files.append(path);
+        return;
+    }
+    for(int i = 0; i < reader.count(); ++i)
+    {
+        files.append(QString("%1#%2").arg(path).arg(i));
+    }
+}
+
+QStringList BatchAnalysis::collectFiles(const QStringList &paths)
+{
+    QStringList files;
+    foreach (const QString &path, paths)
+    {
+        if(!QFileInfo(path).isDir())
+        {
+            if(isSession(path))
+            {
+                appendSession(path, files);
+            }else
+            {
+                files.append(path);
+            }
+            continue;
+        }
+        QStringList found;
+        QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories);
+        while(it.hasNext())
+        {
+            QString file = it.next();
+            if(isSweepFile(file))
+            {
+                found.append(file);
+            }
+        }
+        found.sort();
+        foreach (const QString &file, found)
+        {
+            if(isSession(file))
+            {
+                appendSession(file, files);
+            }else
+            {
+                files.append(file);
+            }
+        }
+    }
+    return files;
+}
+
+bool BatchAnalysis::loadSweep(const QString &path, QVector<rawData> &data, QString *error)
+{
+    data.clear();
+    int hash = path.lastIndexOf('#');
+    if((hash > 0) && isSession(path.left(hash)))
+    {
+        SessionReader reader;
+        SessionMeasurement item;
+        if(!reader.open(path.left(hash)) || !reader.read(path.mid(hash + 1).toInt(), item))
+        {
+            return setError(error, reader.errorString());
+        }
+        data = item.data;
+        return true;
+    }
+    if(isSession(path))
+    {
+        SessionReader reader;
+        if(!reader.open(path))
+        {
+            return setError(error, reader.errorString());
+        }
+        return setError(error, QString("No measurements in the archive."));
+    }
+    if(TouchstoneReader::portsFromFileName(path) > 0)
+    {
+        TouchstoneReader reader;
+        if(!reader.read(path, data))
+        {
+            return setError(error, reader.errorString());
+        }
+        return true;
+    }
+    if(QFileInfo(path).suffix().toLower() != "asd")
+    {
+        return setError(error, QString("Unknown measurement format."));
+    }
+
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return setError(error, file.errorString());
+    }
+    QJsonArray measureArray = QJsonDocument::fromJson(file.readAll()).object()["Measurements"].toArray();
+    data.resize(measureArray.size());
+    for(int i = 0; i < measureArray.size(); ++i)
+    {
+        data[i].read(measureArray[i].toObject());
+    }
+    return true;
+}
+
+bool BatchAnalysis::loadStandards(const QString &openPath, const QString &shortPath,
+                                  const QString &loadPath, OslStandards &standards,
+                                  QString *error)
+{
+    QString paths[3] = {openPath, shortPath, loadPath};
+    QVector <double> *columns[3][2] = {
+        {&standards.openRe, &standards.openIm},
+        {&standards.shortRe, &standards.shortIm},
+        {&standards.loadRe, &standards.loadIm}
+    };
+    standards = OslStandards();
+    for(int n = 0; n < 3; ++n)
+    {
+        QVector <rawData> data;
+        TouchstoneReader reader;
+        if(!reader.read(paths[n], data) || (data.size() < 2))
+        {
+            return setError(error, QString("%1: %2").arg(paths[n],
+                            reader.errorString().isEmpty() ? QString("Too few points.") : reader.errorString()));
+        }
+        if(n == 0)
+        {
+            standards.fq.resize(data.size());
+            for(int i = 0; i < data.size(); ++i)
+            {
+                standards.fq[i] = data.at(i).fq;
+            }
+        }else if(data.size() != standards.fq.size())
+        {
+            return setError(error, QString("%1: The standards are not measured on the same points.").arg(paths[n]));
+        }
+        QVector <double> &re = *columns[n][0];
+        QVector <double> &im = *columns[n][1];
+        re.resize(data.size());
+        im.resize(data.size());
+        for(int i = 0; i < data.size(); ++i)
+        {
+            SweepMath::reflection(reader.Z0(), data.at(i).r, data.at(i).x, re[i], im[i]);
+        }
+    }
+    return true;
+}
+
+SweepReport BatchAnalysis::analyze(const QString &path, const BatchOptions &options)
+{
+    SweepReport report;
+    report.file = path;
+
+    QVector <rawData> data;
+    if(!loadSweep(path, data, &report.error))
+    {
+        return report;
+    }
+    if(data.isEmpty())
+    {
+        report.error = "No points.";
+        return report;
+    }
+    int count = data.size();
+    if(options.calibrate)
+    {
+        SweepMath::calibrate(options.standards, options.Z0, data.constData(), data.data(), count);
+    }
+    SweepMath::transformCable(options.cable, data.constData(), data.data(), count);
+
+    QVector <double> fq(count);
+    QVector <double> swr(count);
+    for(int i = 0; i < count; ++i)
+    {
+        fq[i] = data.at(i).fq;
+        if(!SweepMath::swr(options.Z0, data.at(i).r, data.at(i).x, &swr[i], NULL))
+        {
+            swr[i] = qQNaN();
+        }
+    }
+
+    report.points = count;
+    report.fqFrom = data.first().fq;
+    report.fqTo = data.last().fq;
+    int best = SweepMath::minimumSwr(swr.constData(), count);
+    if(best >= 0)
+    {
+        report.minSwr = swr.at(best);
+        report.minSwrFq = fq.at(best);
+        report.minSwrR = data.at(best).r;
+        report.minSwrX = data.at(best).x;
+        report.hasBandwidth = SweepMath::bandwidth(fq.constData(), swr.constData(), count, best,
+                                                   options.swrLimit, report.bandwidthLower,
+                                                   report.bandwidthUpper);
+        if(report.hasBandwidth && (report.bandwidthLower > report.fqFrom) &&
+           (report.bandwidthUpper < report.fqTo))
+        {
+            report.q = SweepTracker::q(report.minSwrFq, report.bandwidthLower,
+                                       report.bandwidthUpper, options.swrLimit);
+        }
+    }
+    report.resonances = SweepMath::resonances(data.constData(), count);
+
+    QVector <double> impulse;
+    QVector <double> step;
+    double range = 0;
+    int bins = SweepMath::tdr(data.constData(), count, options.cable.velocityFactor,
+                              impulse, step, &range);
+    if(bins > 0)
+    {
+        // the second half of the transform is negative time
+        int half = bins/2;
+        report.tdrRange = range/2;
+        QVector <int> peaks = SweepMath::faults(impulse.constData(), half, options.faultThreshold);
+        foreach (int peak, peaks)
+        {
+            report.faultDistance.append(peak*range/bins);
+            report.faultAmplitude.append(impulse.at(peak));
+        }
+    }
+    return report;
+}
+
+struct AnalyzeFunctor
+{
+    typedef SweepReport result_type;
+
+    explicit AnalyzeFunctor(const BatchOptions &options) : m_options(options) {}
+    SweepReport operator()(const QString &path) const
+    {
+        return BatchAnalysis::analyze(path, m_options);
+    }
+
+    BatchOptions m_options;
+};
+
+QList<SweepReport> BatchAnalysis::run(const QStringList &files, const BatchOptions &options)
+{
+    return QtConcurrent::blockingMapped<QList<SweepReport> >(files, AnalyzeFunctor(options));
+}
+
+static QString number(double value)
+{
+    return QString::number(value, 'g', 10);
+}
+
+static QString join(const QVector<double> &values)
+{
+    QStringList list;
+    foreach (double value, values)
+    {
+        list.append(number(value));
+    }
+    return list.join(' ');
+}
+
+// quoted as in RFC 4180 if it holds a separator, a quote or a line break; readers
+// set up for ',' split there as well
+static QString csvField(const QString &text)
+{
+    if(!text.contains(';') && !text.contains(',') && !text.contains('"') &&
+       !text.contains('\n') && !text.contains('\r'))
+    {
+        return text;
+    }
+    return '"' + QString(text).replace('"', "\"\"") + '"';
+}
+
+QByteArray BatchAnalysis::csv(const QList<SweepReport> &reports)
+{
+    QByteArray out("File;Points;FqFrom(MHz);FqTo(MHz);MinSWR;MinSWRFq(MHz);R;X;"
+                   "BandLower(MHz);BandUpper(MHz);Resonances(MHz);TdrRange(m);"
+                   "FaultDistances(m);FaultAmplitudes;Error\n");
+    foreach (const SweepReport &report, reports)
+    {
+        QStringList row;
+        row << csvField(report.file);
+        if(report.error.isEmpty())
+        {
+            row << QString::number(report.points) << number(report.fqFrom) << number(report.fqTo)
+                << number(report.minSwr) << number(report.minSwrFq)
+                << number(report.minSwrR) << number(report.minSwrX);
+            if(report.hasBandwidth)
+            {
+                row << number(report.bandwidthLower) << number(report.bandwidthUpper);
+            }else
+            {
+                row << QString() << QString();
+            }
+            row << join(report.resonances) << number(report.tdrRange)
+                << join(report.faultDistance) << join(report.faultAmplitude) << QString();
+        }else
+        {
+            for(int i = 0; i < 13; ++i)
+            {
+                row << QString();
+            }
+            row << csvField(report.error);
+        }
+        out += row.join(';').toUtf8();
+        out += '\n';
+    }
+    return out;
+}
+
+static QJsonArray jsonArray(const QVector<double> &values)
+{
+    QJsonArray array;
+    foreach (double value, values)
+    {
+        array.append(value);
+    }
+    return array;
+}
+
+QByteArray BatchAnalysis::json(const QList<SweepReport> &reports)
+{
+    QJsonArray array;
+    foreach (const SweepReport &report, reports)
+    {
+        QJsonObject obj;
+        obj["file"] = report.file;
+        if(!report.error.isEmpty())
+        {
+            obj["error"] = report.error;
+            array.append(obj);
+            continue;
+        }
+        obj["points"] = report.points;
+        obj["fqFrom"] = report.fqFrom;
+        obj["fqTo"] = report.fqTo;
+
+        QJsonObject minimum;
+        minimum["swr"] = report.minSwr;
+        minimum["fq"] = report.minSwrFq;
+        minimum["r"] = report.minSwrR;
+        minimum["x"] = report.minSwrX;
+        obj["minSwr"] = minimum;
+        if(report.hasBandwidth)
+        {
+            QJsonObject band;
+            band["lower"] = report.bandwidthLower;
+            band["upper"] = report.bandwidthUpper;
+            band["width"] = report.bandwidthUpper - report.bandwidthLower;
+            if(!qIsNaN(report.q))
+            {
+                band["q"] = report.q;
+            }
+            obj["bandwidth"] = band;
+        }
+        obj["resonances"] = jsonArray(report.resonances);
+        if(report.tdrRange > 0)
+        {
+            QJsonObject tdr;
+            tdr["range"] = report.tdrRange;
+            QJsonArray faults;
+            for(int i = 0; i < report.faultDistance.size(); ++i)
+            {
+                QJsonObject fault;
+                fault["distance"] = report.faultDistance.at(i);
+                fault["amplitude"] = report.faultAmplitude.at(i);
+                faults.append(fault);
+            }
+            tdr["faults"] = faults;
+            obj["tdr"] = tdr;
+        }
+        array.append(obj);
+    }
+    QJsonObject mainObj;
+    mainObj["Reports"] = array;
+    return QJsonDocument(mainObj).toJson();
+}
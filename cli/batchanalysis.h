@@ -0,0 +1,67 @@
+#ifndef BATCHANALYSIS_H
+#define BATCHANALYSIS_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <core/rawdata.h>
+#include <core/sweepmath.h>
+#include <core/sweeptracker.h>
+
+struct BatchOptions
+{
+    double Z0;
+    bool calibrate;
+    OslStandards standards;
+    CableModel cable;
+    double swrLimit;        // SWR that defines the bandwidth
+    double faultThreshold;  // minimum TDR impulse reported as a fault
+
+    BatchOptions() : Z0(50), calibrate(false), swrLimit(2.0), faultThreshold(0.1) {}
+};
+
+struct SweepReport
+{
+    QString file;
+    QString error;          // empty if the file was analyzed
+    int points;
+    double fqFrom;          // MHz
+    double fqTo;
+    double minSwr;
+    double minSwrFq;
+    double minSwrR;
+    double minSwrX;
+    bool hasBandwidth;
+    double bandwidthLower;  // MHz, edges where SWR crosses swrLimit
+    double bandwidthUpper;
+    double q;               // from the bandwidth, NaN if the sweep cuts the band
+    QVector <double> resonances;
+    double tdrRange;        // m, 0 if the sweep is not suitable for TDR
+    QVector <double> faultDistance;
+    QVector <double> faultAmplitude;
+
+    SweepReport() : points(0), fqFrom(0), fqTo(0), minSwr(0), minSwrFq(0),
+        minSwrR(0), minSwrX(0), hasBandwidth(false), bandwidthLower(0),
+        bandwidthUpper(0), q(qQNaN()), tdrRange(0) {}
+};
+
+// Headless analysis of saved sweeps (.asd, .asz, .sNp) for the command line tool.
+// analyze() is reentrant, run() spreads the files over the global thread pool.
+class BatchAnalysis
+{
+public:
+    static QStringList collectFiles(const QStringList &paths);
+    static bool loadSweep(const QString &path, QVector<rawData> &data, QString *error = NULL);
+    static bool loadStandards(const QString &openPath, const QString &shortPath,
+                              const QString &loadPath, OslStandards &standards,
+                              QString *error = NULL);
+
+    static SweepReport analyze(const QString &path, const BatchOptions &options);
+    static QList<SweepReport> run(const QStringList &files, const BatchOptions &options);
+
+    static QByteArray csv(const QList<SweepReport> &reports);
+    static QByteArray json(const QList<SweepReport> &reports);
+};
+
+#endif // BATCHANALYSIS_H
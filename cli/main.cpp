@@ -0,0 +1,227 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QThreadPool>
+#include <stdio.h>
+#include "batchanalysis.h"
+#include <core/calkit.h>
+
+static const char *notChosen = "Not chosen";
+
+// Z0, calibration and cable as the GUI stored them in AntScope2.ini
+static bool readIniFile(const QString &path, BatchOptions &options,
+                        QString &openPath, QString &shortPath, QString &loadPath, QString &kitPath)
+{
+    if(!QFileInfo(path).isFile())
+    {
+        return false;
+    }
+    QSettings settings(path, QSettings::IniFormat);
+    settings.beginGroup("MainWindow");
+    options.Z0 = settings.value("systemImpedance", options.Z0).toDouble();
+    settings.endGroup();
+
+    settings.beginGroup("Calibration");
+    if(settings.value("Enabled", false).toBool())
+    {
+        openPath = settings.value("OpenPath", notChosen).toString();
+        shortPath = settings.value("ShortPath", notChosen).toString();
+        loadPath = settings.value("LoadPath", notChosen).toString();
+        // the GUI keeps the kit definition in the Calibration folder next to the ini
+        kitPath = QFileInfo(path).dir().absoluteFilePath("Calibration/calkit.ini");
+    }
+    settings.endGroup();
+
+    settings.beginGroup("Cable");
+    CableModel &cable = options.cable;
+    cable.velocityFactor = settings.value("VelFactor", cable.velocityFactor).toDouble();
+    cable.resistance = settings.value("R0", cable.resistance).toDouble();
+    cable.lossConductive = settings.value("ConductiveLoss", cable.lossConductive).toDouble();
+    cable.lossDielectric = settings.value("DielectricLoss", cable.lossDielectric).toDouble();
+    cable.lossUnits = settings.value("LossUnits", cable.lossUnits).toInt();
+    cable.lossAtAnyFq = settings.value("LossAtAnyFrequency", 0).toInt() != 0;
+    cable.length = settings.value("Length", cable.length).toDouble();
+    cable.mode = settings.value("FarEndMeasurement", cable.mode).toInt();
+    settings.endGroup();
+    return true;
+}
+
+static bool takeDouble(const QCommandLineParser &parser, const QString &name, double &value)
+{
+    if(!parser.isSet(name))
+    {
+        return true;
+    }
+    bool ok;
+    double result = parser.value(name).toDouble(&ok);
+    if(ok)
+    {
+        value = result;
+    }else
+    {
+        fprintf(stderr, "Invalid value for --%s: %s\n", qPrintable(name), qPrintable(parser.value(name)));
+    }
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("AntScope2Cli");
+    QCoreApplication::setApplicationVersion(ANTSCOPE2VER);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Analyzes saved AntScope2 sweeps (.asd, .asz, .s1p) without a GUI and "
+                                     "writes SWR minimum, bandwidth, resonances and TDR faults per file.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("files", "Sweep files or folders to analyze.", "files...");
+    parser.addOptions({
+        {{"o", "output"}, "Write the report to <file> instead of stdout.", "file"},
+        {{"f", "format"}, "Report format, csv or json. Default: suffix of the output file, else csv.", "format"},
+        {{"j", "jobs"}, "Number of files analyzed in parallel. Default: all cores.", "n"},
+        {"settings", "Take Z0, calibration and cable settings from an AntScope2.ini.", "ini"},
+        {"z0", "System impedance in Ohm. Default: 50.", "ohm"},
+        {"open", "Open standard of an OSL calibration (.s1p).", "file"},
+        {"short", "Short standard of an OSL calibration (.s1p).", "file"},
+        {"load", "Load standard of an OSL calibration (.s1p).", "file"},
+        {"calkit", "Definition of the open, short and load standards. Default: ideal standards.", "ini"},
+        {"cable", "Cable transform: none, subtract or add.", "mode"},
+        {"cable-length", "Cable length.", "length"},
+        {"cable-vf", "Cable velocity factor.", "vf"},
+        {"cable-z0", "Cable characteristic impedance in Ohm.", "ohm"},
+        {"cable-loss-conductive", "Conductive loss of the cable.", "loss"},
+        {"cable-loss-dielectric", "Dielectric loss of the cable.", "loss"},
+        {"cable-loss-units", "Loss units: 0=dB/100ft, 1=dB/ft, 2=dB/100m, 3=dB/m.", "units"},
+        {"cable-loss-any-fq", "The loss is the same at every frequency."},
+        {"swr-limit", "SWR that defines the bandwidth. Default: 2.", "swr"},
+        {"fault-threshold", "Smallest TDR impulse reported as a fault. Default: 0.1.", "level"}
+    });
+    parser.process(a);
+
+    BatchOptions options;
+    QString openPath = notChosen;
+    QString shortPath = notChosen;
+    QString loadPath = notChosen;
+    QString kitPath;
+    if(parser.isSet("settings") &&
+       !readIniFile(parser.value("settings"), options, openPath, shortPath, loadPath, kitPath))
+    {
+        fprintf(stderr, "Couldn't read %s\n", qPrintable(parser.value("settings")));
+        return 2;
+    }
+
+    bool ok = takeDouble(parser, "z0", options.Z0) &&
+              takeDouble(parser, "cable-length", options.cable.length) &&
+              takeDouble(parser, "cable-vf", options.cable.velocityFactor) &&
+              takeDouble(parser, "cable-z0", options.cable.resistance) &&
+              takeDouble(parser, "cable-loss-conductive", options.cable.lossConductive) &&
+              takeDouble(parser, "cable-loss-dielectric", options.cable.lossDielectric) &&
+              takeDouble(parser, "swr-limit", options.swrLimit) &&
+              takeDouble(parser, "fault-threshold", options.faultThreshold);
+    if(!ok)
+    {
+        return 2;
+    }
+    if(parser.isSet("cable-loss-units"))
+    {
+        options.cable.lossUnits = qBound(0, parser.value("cable-loss-units").toInt(), 3);
+    }
+    if(parser.isSet("cable-loss-any-fq"))
+    {
+        options.cable.lossAtAnyFq = true;
+    }
+    if(parser.isSet("cable"))
+    {
+        QString mode = parser.value("cable").toLower();
+        if(mode == "subtract")
+        {
+            options.cable.mode = CableModel::Subtract;
+        }else if(mode == "add")
+        {
+            options.cable.mode = CableModel::Add;
+        }else if(mode == "none")
+        {
+            options.cable.mode = CableModel::None;
+        }else
+        {
+            fprintf(stderr, "Unknown cable mode %s\n", qPrintable(mode));
+            return 2;
+        }
+    }
+
+    if(parser.isSet("open")) openPath = parser.value("open");
+    if(parser.isSet("short")) shortPath = parser.value("short");
+    if(parser.isSet("load")) loadPath = parser.value("load");
+    if(parser.isSet("calkit")) kitPath = parser.value("calkit");
+    if((openPath != notChosen) || (shortPath != notChosen) || (loadPath != notChosen))
+    {
+        QString error;
+        if(!BatchAnalysis::loadStandards(openPath, shortPath, loadPath, options.standards, &error))
+        {
+            fprintf(stderr, "Calibration: %s\n", qPrintable(error));
+            return 2;
+        }
+        CalKit kit;
+        if(!kitPath.isEmpty() && !CalKitFile::read(kitPath, kit) && parser.isSet("calkit"))
+        {
+            fprintf(stderr, "Couldn't read %s\n", qPrintable(kitPath));
+            return 2;
+        }
+        options.standards.setKit(kit, options.Z0);
+        options.calibrate = true;
+    }
+
+    if(parser.isSet("jobs"))
+    {
+        int jobs = parser.value("jobs").toInt();
+        if(jobs > 0)
+        {
+            QThreadPool::globalInstance()->setMaxThreadCount(jobs);
+        }
+    }
+
+    QStringList files = BatchAnalysis::collectFiles(parser.positionalArguments());
+    if(files.isEmpty())
+    {
+        parser.showHelp(2);
+    }
+
+    QString output = parser.value("output");
+    QString format = parser.value("format").toLower();
+    if(format.isEmpty())
+    {
+        format = (QFileInfo(output).suffix().toLower() == "json") ? "json" : "csv";
+    }
+    if((format != "csv") && (format != "json"))
+    {
+        fprintf(stderr, "Unknown report format %s\n", qPrintable(format));
+        return 2;
+    }
+
+    QList <SweepReport> reports = BatchAnalysis::run(files, options);
+    QByteArray report = (format == "json") ? BatchAnalysis::json(reports) : BatchAnalysis::csv(reports);
+
+    QFile file(output);
+    bool opened = output.isEmpty() ? file.open(stdout, QIODevice::WriteOnly)
+                                   : file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if(!opened || (file.write(report) != report.size()))
+    {
+        fprintf(stderr, "Couldn't write the report: %s\n", qPrintable(file.errorString()));
+        return 1;
+    }
+
+    int failed = 0;
+    foreach (const SweepReport &sweep, reports)
+    {
+        if(!sweep.error.isEmpty())
+        {
+            fprintf(stderr, "%s: %s\n", qPrintable(sweep.file), qPrintable(sweep.error));
+            ++failed;
+        }
+    }
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+#include "calkit.h"
+#include <QFileInfo>
+#include <QSettings>
+
+static void readOffset(QSettings &ini, CalStandard &standard)
+{
+    standard.delay = ini.value("Delay", 0).toDouble();
+    standard.loss = ini.value("Loss", 0).toDouble();
+    standard.offsetZ0 = ini.value("Z0", 0).toDouble();
+}
+
+static void writeOffset(QSettings &ini, const CalStandard &standard)
+{
+    ini.setValue("Delay", standard.delay);
+    ini.setValue("Loss", standard.loss);
+    ini.setValue("Z0", standard.offsetZ0);
+}
+
+bool CalKitFile::read(const QString &path, CalKit &kit)
+{
+    kit = CalKit();
+    if(!QFileInfo(path).isFile())
+    {
+        return false;
+    }
+    QSettings ini(path, QSettings::IniFormat);
+    if(ini.status() != QSettings::NoError)
+    {
+        return false;
+    }
+
+    ini.beginGroup("Open");
+    kit.open.c0 = ini.value("C0", 0).toDouble();
+    kit.open.c1 = ini.value("C1", 0).toDouble();
+    kit.open.c2 = ini.value("C2", 0).toDouble();
+    kit.open.c3 = ini.value("C3", 0).toDouble();
+    readOffset(ini, kit.open);
+    ini.endGroup();
+
+    ini.beginGroup("Short");
+    kit.shortStandard.l0 = ini.value("L0", 0).toDouble();
+    kit.shortStandard.l1 = ini.value("L1", 0).toDouble();
+    kit.shortStandard.l2 = ini.value("L2", 0).toDouble();
+    kit.shortStandard.l3 = ini.value("L3", 0).toDouble();
+    readOffset(ini, kit.shortStandard);
+    ini.endGroup();
+
+    ini.beginGroup("Load");
+    kit.load.resistance = ini.value("R", 0).toDouble();
+    readOffset(ini, kit.load);
+    ini.endGroup();
+    return true;
+}
+
+bool CalKitFile::write(const QString &path, const CalKit &kit)
+{
+    QSettings ini(path, QSettings::IniFormat);
+
+    ini.beginGroup("Open");
+    ini.setValue("C0", kit.open.c0);
+    ini.setValue("C1", kit.open.c1);
+    ini.setValue("C2", kit.open.c2);
+    ini.setValue("C3", kit.open.c3);
+    writeOffset(ini, kit.open);
+    ini.endGroup();
+
+    ini.beginGroup("Short");
+    ini.setValue("L0", kit.shortStandard.l0);
+    ini.setValue("L1", kit.shortStandard.l1);
+    ini.setValue("L2", kit.shortStandard.l2);
+    ini.setValue("L3", kit.shortStandard.l3);
+    writeOffset(ini, kit.shortStandard);
+    ini.endGroup();
+
+    ini.beginGroup("Load");
+    ini.setValue("R", kit.load.resistance);
+    writeOffset(ini, kit.load);
+    ini.endGroup();
+
+    ini.sync();
+    return ini.status() == QSettings::NoError;
+}
@@ -0,0 +1,21 @@
+#ifndef CALKIT_H
+#define CALKIT_H
+
+#include <QString>
+#include <core/sweepmath.h>
+
+// Cal kit definition in an INI file, the values use the units of CalStandard:
+//
+//   [Open]   C0 C1 C2 C3 Delay Loss Z0
+//   [Short]  L0 L1 L2 L3 Delay Loss Z0
+//   [Load]   R Delay Loss Z0
+//
+// missing keys are 0, a missing file is the ideal kit.
+class CalKitFile
+{
+public:
+    static bool read(const QString &path, CalKit &kit);
+    static bool write(const QString &path, const CalKit &kit);
+};
+
+#endif // CALKIT_H
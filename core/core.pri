@@ -0,0 +1,32 @@
+# Links AntScopeCore, include it from the application projects.
+# AntScopeAll.pro builds core/core.pro first and the applications link the
+# library. A project built on its own, with no library built yet, compiles
+# the core sources in instead.
+
+CORE_ROOT = $$PWD/..
+
+CONFIG(release) {
+	CORE_LIBDIR = $$CORE_ROOT/build/release
+}
+else {
+	CORE_LIBDIR = $$CORE_ROOT/build/debug
+}
+
+win32-msvc* {
+	CORE_LIB = $$CORE_LIBDIR/AntScopeCore.lib
+}
+else {
+	CORE_LIB = $$CORE_LIBDIR/libAntScopeCore.a
+}
+
+INCLUDEPATH += $$CORE_ROOT
+
+exists($$CORE_LIB) {
+	LIBS += -L$$CORE_LIBDIR -lAntScopeCore
+	PRE_TARGETDEPS += $$CORE_LIB
+}
+else {
+	include(core_files.pri)
+	SOURCES += $$CORE_SOURCES
+	HEADERS += $$CORE_HEADERS
+}
@@ -0,0 +1,34 @@
+#-------------------------------------------------
+#
+# Measurement math shared by AntScope2, AntScope2Cli and tools.
+# Pure functions over rawData arrays, no GUI or settings dependency.
+#
+#-------------------------------------------------
+
+CONFIG += c++11 staticlib
+
+QT       += core
+QT       -= gui
+
+TARGET = AntScopeCore
+TEMPLATE = lib
+
+CONFIG += debug
+CONFIG -= release
+
+CONFIG(release) {
+	DESTDIR = $${PWD}/../build/release
+}
+else {
+	DESTDIR = $${PWD}/../build/debug
+}
+
+OBJECTS_DIR = $$DESTDIR/.obj-core
+
+INCLUDEPATH += $$PWD/..
+
+include(core_files.pri)
+
+SOURCES += $$CORE_SOURCES
+
+HEADERS  += $$CORE_HEADERS
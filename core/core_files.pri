@@ -0,0 +1,16 @@
+# Sources of AntScopeCore, shared by core.pro and core.pri.
+
+CORE_SOURCES = $$PWD/sweepmath.cpp \
+	$$PWD/calkit.cpp \
+	$$PWD/sweepstats.cpp \
+	$$PWD/sweeptracker.cpp \
+	$$PWD/tuningplanner.cpp \
+	$$PWD/zoomplanner.cpp
+
+CORE_HEADERS = $$PWD/rawdata.h \
+	$$PWD/sweepmath.h \
+	$$PWD/calkit.h \
+	$$PWD/sweepstats.h \
+	$$PWD/sweeptracker.h \
+	$$PWD/tuningplanner.h \
+	$$PWD/zoomplanner.h
@@ -0,0 +1,26 @@
+#ifndef RAWDATA_H
+#define RAWDATA_H
+
+#include <QJsonObject>
+
+// One point of a sweep as the analyzer delivers it: fq in MHz, r and x in Ohm.
+// Kept free of any GUI header so file readers and the math can be used headless.
+struct rawData{
+    double fq;
+    double r;
+    double x;
+    void read (const QJsonObject &json)
+    {
+        fq = json["fq"].toDouble();
+        r = json["r"].toDouble();
+        x = json["x"].toDouble();
+    }
+    void write (QJsonObject &json) const
+    {
+        json["fq"] = fq;
+        json["r"] = r;
+        json["x"] = x;
+    }
+};
+
+#endif // RAWDATA_H
@@ -0,0 +1,803 @@
+#include "sweepmath.h"
+#include <complex>
+#include <algorithm>
+
+typedef std::complex <double> Complex;
+
+static const double SpeedOfLight = 299792458.0;
+static const double FeetInMeter = 3.2808399;
+static const double Neper = 8.68588963806504;  // = 20 / Ln(10)
+static const int TdrMaxSize = 20000;            // the size of the TDR arrays in Measurements
+static const double TdrDeviceR = 50.0;          // bridge impedance of the analyzer
+static const double TdrMinAmplitude = 0.015;
+
+bool OslStandards::isValid() const
+{
+    int size = fq.size();
+    return (size >= 2) &&
+           (openRe.size() == size) && (openIm.size() == size) &&
+           (shortRe.size() == size) && (shortIm.size() == size) &&
+           (loadRe.size() == size) && (loadIm.size() == size);
+}
+
+bool CalKit::isIdeal() const
+{
+    const CalStandard *standards[3] = {&open, &shortStandard, &load};
+    for(int i = 0; i < 3; ++i)
+    {
+        const CalStandard &s = *standards[i];
+        if((s.c0 != 0) || (s.c1 != 0) || (s.c2 != 0) || (s.c3 != 0) ||
+           (s.l0 != 0) || (s.l1 != 0) || (s.l2 != 0) || (s.l3 != 0) ||
+           (s.resistance != 0) || (s.delay != 0) || (s.loss != 0))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void OslStandards::setKit(const CalKit &kit, double Z0)
+{
+    int size = kit.isIdeal() ? 0 : fq.size();
+    int terms = isValid() ? fq.size() : 0;
+    actualOpenRe.resize(size);
+    actualOpenIm.resize(size);
+    actualShortRe.resize(size);
+    actualShortIm.resize(size);
+    actualLoadRe.resize(size);
+    actualLoadIm.resize(size);
+    for(int i = 0; i < size; ++i)
+    {
+        SweepMath::standardReflection(kit.open, CalKit::Open, fq.at(i), Z0,
+                                      actualOpenRe[i], actualOpenIm[i]);
+        SweepMath::standardReflection(kit.shortStandard, CalKit::Short, fq.at(i), Z0,
+                                      actualShortRe[i], actualShortIm[i]);
+        SweepMath::standardReflection(kit.load, CalKit::Load, fq.at(i), Z0,
+                                      actualLoadRe[i], actualLoadIm[i]);
+    }
+
+    termARe.resize(terms);
+    termAIm.resize(terms);
+    termBRe.resize(terms);
+    termBIm.resize(terms);
+    termCRe.resize(terms);
+    termCIm.resize(terms);
+    for(int i = 0; i < terms; ++i)
+    {
+        bool actual = (size != 0);
+        SweepMath::oslTerms(openRe.at(i), openIm.at(i), shortRe.at(i), shortIm.at(i),
+                            loadRe.at(i), loadIm.at(i),
+                            actual ? actualOpenRe.at(i) : 1, actual ? actualOpenIm.at(i) : 0,
+                            actual ? actualShortRe.at(i) : -1, actual ? actualShortIm.at(i) : 0,
+                            actual ? actualLoadRe.at(i) : 0, actual ? actualLoadIm.at(i) : 0,
+                            termARe[i], termAIm[i], termBRe[i], termBIm[i], termCRe[i], termCIm[i]);
+    }
+}
+
+bool OslStandards::interpolateTerms(double _fq, double &reA, double &imA, double &reB, double &imB,
+                                    double &reC, double &imC) const
+{
+    if(!isValid() || !hasTerms())
+    {
+        return false;
+    }
+    double alf;
+    int i = locate(_fq, alf);
+
+    reA = termARe.at(i)*(1-alf) + termARe.at(i+1)*alf;
+    imA = termAIm.at(i)*(1-alf) + termAIm.at(i+1)*alf;
+    reB = termBRe.at(i)*(1-alf) + termBRe.at(i+1)*alf;
+    imB = termBIm.at(i)*(1-alf) + termBIm.at(i+1)*alf;
+    reC = termCRe.at(i)*(1-alf) + termCRe.at(i+1)*alf;
+    imC = termCIm.at(i)*(1-alf) + termCIm.at(i+1)*alf;
+    return true;
+}
+
+int OslStandards::locate(double _fq, double &alf) const
+{
+    const double *grid = fq.constData();
+    int last = fq.size() - 1;
+    int i = int(std::upper_bound(grid, grid + last + 1, _fq) - grid) - 1;
+    if(i < 0)
+    {
+        alf = 0;
+        return 0;
+    }else if(i >= last)
+    {
+        alf = 1;
+        return last - 1;
+    }
+    alf = (_fq - grid[i])/(grid[i+1] - grid[i]);
+    return i;
+}
+
+bool OslStandards::interpolate(double _fq, double &reO, double &imO, double &reS, double &imS,
+                               double &reL, double &imL) const
+{
+    if(!isValid())
+    {
+        return false;
+    }
+    double alf;
+    int i = locate(_fq, alf);
+
+    reO = openRe.at(i)*(1-alf) + openRe.at(i+1)*alf;
+    imO = openIm.at(i)*(1-alf) + openIm.at(i+1)*alf;
+    reS = shortRe.at(i)*(1-alf) + shortRe.at(i+1)*alf;
+    imS = shortIm.at(i)*(1-alf) + shortIm.at(i+1)*alf;
+    reL = loadRe.at(i)*(1-alf) + loadRe.at(i+1)*alf;
+    imL = loadIm.at(i)*(1-alf) + loadIm.at(i+1)*alf;
+    return true;
+}
+
+bool OslStandards::interpolateActual(double _fq, double &reO, double &imO, double &reS, double &imS,
+                                     double &reL, double &imL) const
+{
+    if(!isValid() || !hasActual())
+    {
+        return false;
+    }
+    double alf;
+    int i = locate(_fq, alf);
+
+    reO = actualOpenRe.at(i)*(1-alf) + actualOpenRe.at(i+1)*alf;
+    imO = actualOpenIm.at(i)*(1-alf) + actualOpenIm.at(i+1)*alf;
+    reS = actualShortRe.at(i)*(1-alf) + actualShortRe.at(i+1)*alf;
+    imS = actualShortIm.at(i)*(1-alf) + actualShortIm.at(i+1)*alf;
+    reL = actualLoadRe.at(i)*(1-alf) + actualLoadRe.at(i+1)*alf;
+    imL = actualLoadIm.at(i)*(1-alf) + actualLoadIm.at(i+1)*alf;
+    return true;
+}
+
+static bool sameRange(const OslStandards &a, double fqFrom, double fqTo)
+{
+    // the grids come from kHz steps
+    return (qAbs(a.fq.first() - fqFrom) < 0.0005) && (qAbs(a.fq.last() - fqTo) < 0.0005);
+}
+
+void OslStandardsSet::insert(const OslStandards &standards)
+{
+    if(!standards.isValid())
+    {
+        return;
+    }
+    for(int i = 0; i < m_sets.size(); ++i)
+    {
+        if(sameRange(m_sets.at(i), standards.fq.first(), standards.fq.last()))
+        {
+            m_sets[i] = standards;
+            return;
+        }
+    }
+    m_sets.append(standards);
+}
+
+bool OslStandardsSet::remove(double fqFrom, double fqTo)
+{
+    for(int i = 0; i < m_sets.size(); ++i)
+    {
+        if(sameRange(m_sets.at(i), fqFrom, fqTo))
+        {
+            m_sets.remove(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const OslStandards *OslStandardsSet::cover(double fqFrom, double fqTo) const
+{
+    const OslStandards *best = NULL;
+    double bestDensity = 0;
+    const OslStandards *widest = NULL;
+    double widestSpan = 0;
+    for(int i = 0; i < m_sets.size(); ++i)
+    {
+        const OslStandards &set = m_sets.at(i);
+        double span = set.fq.last() - set.fq.first();
+        if((widest == NULL) || (span > widestSpan))
+        {
+            widest = &set;
+            widestSpan = span;
+        }
+        if((set.fq.first() > fqFrom + 0.0005) || (set.fq.last() < fqTo - 0.0005))
+        {
+            continue;
+        }
+        double density = (set.fq.size() - 1)/qMax(span, 1e-9);
+        if((best == NULL) || (density > bestDensity))
+        {
+            best = &set;
+            bestDensity = density;
+        }
+    }
+    return (best != NULL) ? best : widest;
+}
+
+void ComplexAverage::reset(int points)
+{
+    count.fill(0, points);
+    re.fill(0, points);
+    im.fill(0, points);
+    m2.fill(0, points);
+}
+
+void ComplexAverage::add(int index, double valueRe, double valueIm)
+{
+    if((index < 0) || (index >= count.size()) || qIsNaN(valueRe) || qIsNaN(valueIm))
+    {
+        return;
+    }
+    int n = ++count[index];
+    double dRe = valueRe - re.at(index);
+    double dIm = valueIm - im.at(index);
+    re[index] += dRe/n;
+    im[index] += dIm/n;
+    m2[index] += dRe*(valueRe - re.at(index)) + dIm*(valueIm - im.at(index));
+}
+
+double ComplexAverage::variance(int index) const
+{
+    int n = count.at(index);
+    return (n > 1) ? m2.at(index)/(n - 1) : 0;
+}
+
+quint32 SweepMath::swr(double Z0, double R, double X, double *VSWR, double *RL)
+{
+    if (R <= 0)
+    {
+        R = 0.001;
+    }
+    double SWR, Gamma;
+    double XX = X * X;								// always >= 0
+    double denominator = (R + Z0) * (R + Z0) + XX;
+
+    if (denominator == 0)
+    {
+        return 0;
+    }
+    Gamma = sqrt(((R - Z0) * (R - Z0) + XX) / denominator);
+    if (Gamma == 1.0)
+    {
+        return 0;
+    }
+    SWR = (1 + Gamma) / (1 - Gamma);
+
+    if ((SWR > 200) || (Gamma > 0.99))
+    {
+        SWR = 200;
+    } else if (SWR < 1)
+    {
+        SWR = 1;
+    }
+    if (VSWR)
+    {
+        *VSWR = SWR;
+    }
+    if (RL)
+    {
+        if (Gamma == 0)
+        {
+            return 0;
+        }
+        *RL = -20 * log10(Gamma);
+    }
+    return 1;
+}
+
+void SweepMath::reflection(double Z0, double R, double X, double &re, double &im)
+{
+    double denominator = (R+Z0)*(R+Z0)+X*X;
+    re = (R*R-Z0*Z0+X*X)/denominator;
+    im = (2*Z0*X)/denominator;
+}
+
+void SweepMath::impedance(double Z0, double re, double im, double &R, double &X)
+{
+    double denominator = (1-re)*(1-re)+im*im;
+    R = Z0*(1-re*re-im*im)/denominator;
+    X = Z0*(2*im)/denominator;
+}
+
+void SweepMath::applyOsl(double MMR, double MMI, // Measured
+                         double MOR, double MOI, double MSR, double MSI, double MLR, double MLI, // Measured parameters of cal standards
+                         double SOR, double SOI, double SSR, double SSI, double SLR, double SLI, // Actual parameters of cal standards
+                         double &MAR, double &MAI) // Actual
+{
+    double AR, AI, BR, BI, CR, CI;
+    oslTerms(MOR, MOI, MSR, MSI, MLR, MLI,
+             SOR, SOI, SSR, SSI, SLR, SLI,
+             AR, AI, BR, BI, CR, CI);
+    applyTerms(MMR, MMI, AR, AI, BR, BI, CR, CI, MAR, MAI);
+}
+
+void SweepMath::oslTerms(double MOR, double MOI, double MSR, double MSI, double MLR, double MLI,
+                         double SOR, double SOI, double SSR, double SSI, double SLR, double SLI,
+                         double &AR, double &AI, double &BR, double &BI, double &CR, double &CI)
+{
+    // Calculate coefficients
+
+    double	K1R = MLR - MSR,
+            K1I = MLI - MSI,
+            K2R = MSR - MOR,
+            K2I = MSI - MOI,
+            K3R = MOR - MLR,
+            K3I = MOI - MLI;
+
+    double	K4R = K1R*(SLR*SSR-SLI*SSI) - K1I*(SLR*SSI+SLI*SSR),
+            K4I = K1R*(SLR*SSI+SLI*SSR) + K1I*(SLR*SSR-SLI*SSI);
+
+    double	K5R = K2R*(SOR*SSR-SOI*SSI) - K2I*(SOR*SSI+SOI*SSR),
+            K5I = K2R*(SOR*SSI+SOI*SSR) + K2I*(SOR*SSR-SOI*SSI);
+
+    double	K6R = K3R*(SLR*SOR-SLI*SOI) - K3I*(SLR*SOI+SLI*SOR),
+            K6I = K3R*(SLR*SOI+SLI*SOR) + K3I*(SLR*SOR-SLI*SOI);
+
+    double	K7R = SOR*K1R - SOI*K1I,
+            K7I = SOR*K1I + SOI*K1R;
+
+    double	K8R = SLR*K2R - SLI*K2I,
+            K8I = SLR*K2I + SLI*K2R;
+
+    double	K9R = SSR*K3R - SSI*K3I,
+            K9I = SSR*K3I + SSI*K3R;
+
+    double	DR = K4R + K5R + K6R,
+            DI = K4I + K5I + K6I;
+
+    double	AnumR = MOR*K7R - MOI*K7I + MLR*K8R - MLI*K8I + MSR*K9R - MSI*K9I,
+            AnumI = MOR*K7I + MOI*K7R + MLR*K8I + MLI*K8R + MSR*K9I + MSI*K9R;
+
+    double	BnumR = MOR*K4R - MOI*K4I + MLR*K5R - MLI*K5I + MSR*K6R - MSI*K6I,
+            BnumI = MOR*K4I + MOI*K4R + MLR*K5I + MLI*K5R + MSR*K6I + MSI*K6R;
+
+    double	CnumR = K7R + K8R + K9R,
+            CnumI = K7I + K8I + K9I;
+
+    AR = (AnumR*DR + AnumI*DI)/(DR*DR + DI*DI);
+    AI = (AnumI*DR - AnumR*DI)/(DR*DR + DI*DI);
+
+    BR = (BnumR*DR + BnumI*DI)/(DR*DR + DI*DI);
+    BI = (BnumI*DR - BnumR*DI)/(DR*DR + DI*DI);
+
+    CR = (CnumR*DR + CnumI*DI)/(DR*DR + DI*DI);
+    CI = (CnumI*DR - CnumR*DI)/(DR*DR + DI*DI);
+}
+
+void SweepMath::applyTerms(double MMR, double MMI,
+                           double AR, double AI, double BR, double BI, double CR, double CI,
+                           double &MAR, double &MAI)
+{
+    double	MAnumR = MMR - BR,
+            MAnumI = MMI - BI,
+            MAdenR = AR + CI*MMI - CR*MMR,
+            MAdenI = AI - CR*MMI - CI*MMR;
+
+    MAR = (MAnumR*MAdenR + MAnumI*MAdenI)/(MAdenR*MAdenR + MAdenI*MAdenI);
+    MAI = (MAnumI*MAdenR - MAnumR*MAdenI)/(MAdenR*MAdenR + MAdenI*MAdenI);
+}
+
+void SweepMath::calibrate(const OslStandards &standards, double Z0,
+                          const rawData *in, rawData *out, int count)
+{
+    if(!standards.isValid())
+    {
+        if(out != in)
+        {
+            std::copy(in, in + count, out);
+        }
+        return;
+    }
+    // the error terms are computed once per grid point, only interpolated here
+    bool terms = standards.hasTerms();
+    // ideal open, short and load unless the kit defines them
+    bool actual = standards.hasActual();
+    double SOR = 1, SOI = 0;
+    double SSR = -1, SSI = 0;
+    double SLR = 0, SLI = 0;
+    for(int i = 0; i < count; ++i)
+    {
+        double R = in[i].r;
+        double X = in[i].x;
+        if (qIsNaN(R) || (R<0.001) )
+        {
+            R = 0.01;
+        }
+        if (qIsNaN(X))
+        {
+            X = 0;
+        }
+        double Gre, Gim;
+        reflection(Z0, R, X, Gre, Gim);
+
+        double GreOut, GimOut;
+        if(terms)
+        {
+            double AR, AI, BR, BI, CR, CI;
+            standards.interpolateTerms(in[i].fq, AR, AI, BR, BI, CR, CI);
+            applyTerms(Gre, Gim, AR, AI, BR, BI, CR, CI, GreOut, GimOut);
+        }else
+        {
+            double COR, COI; // CalibrationReOpen, CalibrationImOpen
+            double CSR, CSI; // CalibrationReShort, CalibrationImShort
+            double CLR, CLI; // CalibrationReLoad, CalibrationImLoad
+            standards.interpolate(in[i].fq, COR, COI, CSR, CSI, CLR, CLI);
+
+            if(actual)
+            {
+                standards.interpolateActual(in[i].fq, SOR, SOI, SSR, SSI, SLR, SLI);
+            }
+
+            applyOsl(Gre, Gim,
+                     COR, COI, CSR, CSI, CLR, CLI,
+                     SOR, SOI, SSR, SSI, SLR, SLI,
+                     GreOut, GimOut);
+        }
+
+        out[i].fq = in[i].fq;
+        impedance(Z0, GreOut, GimOut, out[i].r, out[i].x);
+    }
+}
+
+void SweepMath::standardReflection(const CalStandard &standard, int type, double fq, double Z0,
+                                   double &re, double &im)
+{
+    double f = fq*1000000;
+    double w = 2*M_PI*f;
+    double Zc0 = (standard.offsetZ0 > 0) ? standard.offsetZ0 : Z0;
+    double delay = standard.delay*1e-12;
+
+    // the termination, as reflection against the offset line
+    Complex Zc = Zc0;
+    Complex alphaBeta(0, w*delay);
+    if((standard.loss != 0) && (f > 0))
+    {
+        double root = sqrt(f/1e9);
+        double loss = standard.loss*1e9;
+        double alpha = loss*delay/(2*Zc0)*root;
+        alphaBeta = Complex(alpha, w*delay + alpha);
+        Zc = Complex(Zc0 + loss/(2*w)*root, -loss/(2*w)*root);
+    }
+
+    Complex termination;
+    if(type == CalKit::Open)
+    {
+        double C = (standard.c0 + f*(standard.c1*1e-12 + f*(standard.c2*1e-21 + f*standard.c3*1e-30)))*1e-15;
+        Complex jwcz = Complex(0, w*C)*Zc;
+        termination = (1.0 - jwcz)/(1.0 + jwcz);
+    }else if(type == CalKit::Short)
+    {
+        double L = (standard.l0 + f*(standard.l1*1e-12 + f*(standard.l2*1e-21 + f*standard.l3*1e-30)))*1e-12;
+        Complex jwl(0, w*L);
+        termination = (jwl - Zc)/(jwl + Zc);
+    }else
+    {
+        double R = (standard.resistance > 0) ? standard.resistance : Z0;
+        termination = (R - Zc)/(R + Zc);
+    }
+
+    // through the offset line and back to the system impedance
+    Complex g = termination*std::exp(-2.0*alphaBeta);
+    Complex gamma = ((1.0 + g)*Zc - (1.0 - g)*Z0)/((1.0 + g)*Zc + (1.0 - g)*Z0);
+    re = gamma.real();
+    im = gamma.imag();
+}
+
+rawData SweepMath::transformCable(const CableModel &cable, const rawData &point)
+{
+    if(cable.mode == CableModel::None)
+    {
+        return point;
+    }
+    double fq = point.fq;
+    double Klen = 1;
+    switch (cable.lossUnits)
+    {
+        case 0: Klen = 1; break;
+        case 1: Klen = 1*100.0; break;
+        case 2: Klen = 1/FeetInMeter; break;
+        case 3: Klen = 1/FeetInMeter*100.0; break;
+    }
+
+    Complex Zload = Complex(point.r, point.x);
+
+    double dMatchedLossDb;  // Note that K1/K2 are in dB/100 ft
+    if(!cable.lossAtAnyFq)
+        dMatchedLossDb = cable.lossConductive*Klen*sqrt(fq/1000.0) + cable.lossDielectric*Klen*fq/1000.0;
+    else
+        dMatchedLossDb = cable.lossConductive*Klen + cable.lossDielectric*Klen;
+
+    double Alpha = dMatchedLossDb / 100.0 / Neper; // Nepers (attenuation) per foot
+    double Beta = (2*M_PI * fq/1000.0) / (SpeedOfLight*FeetInMeter/1000000.0 * cable.velocityFactor); // Radians (phase constant) per foot
+
+    double Alphal = Alpha * cable.length;
+    double Betal = Beta * cable.length;
+
+    if(cable.mode == CableModel::Subtract)
+    {
+        Alphal = -Alphal;
+        Betal = -Betal;
+    }
+    if (cable.lossUnits==0)
+    {
+        Alphal *= FeetInMeter;
+        Betal *= FeetInMeter;
+    }
+
+    Complex Sinh_gl = Complex( cos(Betal) * sinh(Alphal), sin(Betal) * cosh(Alphal) );
+    Complex Cosh_gl = Complex( cos(Betal) * cosh(Alphal), sin(Betal) * sinh(Alphal) );
+
+    Complex Zo = Complex(cable.resistance, -cable.resistance * (Alpha / Beta));
+
+    Complex ZIZL = Zo * ( (Zload*Cosh_gl + Zo*Sinh_gl) /  (Zo*Cosh_gl + Zload*Sinh_gl) );
+
+    rawData result = point;
+    result.r = ZIZL.real();
+    if(result.r < 0.0001)
+        result.r = 0.0001;
+    result.x = ZIZL.imag();
+    return result;
+}
+
+void SweepMath::transformCable(const CableModel &cable, const rawData *in, rawData *out, int count)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        out[i] = transformCable(cable, in[i]);
+    }
+}
+
+int SweepMath::tdr(const rawData *data, int asize, double velocityFactor,
+                   QVector<double> &impulse, QVector<double> &step, double *range)
+{
+    impulse.clear();
+    step.clear();
+    if (asize < 200)
+    {
+        return 0;
+    }
+
+    double minfq = data[0].fq;
+    if ( minfq > 0.1 )
+    {
+        return 0; // Wrong fq
+    }
+
+    double maxfq = data[asize-1].fq;
+
+    int fftSize = 0;
+    int i;
+    for (i=0; ; i++)
+    {
+        fftSize = (1<<i);
+        if ( (fftSize/2) >= (asize-1) )
+            break;
+
+        if (i==14)
+            return 0;
+    }
+
+    fftSize *= 8;
+
+    if (fftSize > TdrMaxSize)
+            return 0;
+
+    double resolution = 1.0/(maxfq-minfq)/4*SpeedOfLight*velocityFactor / (fftSize/2) * (asize-1);
+    if (range)
+    {
+        *range = resolution*fftSize/1000000;
+    }
+
+    QVector <double> real(fftSize, 0.0);
+    QVector <double> imag(fftSize, 0.0);
+    double *TdrReal = real.data();
+    double *TdrImag = imag.data();
+
+    for (i=0; i<=fftSize/2; i++)
+    {
+        if (i < asize)
+        {
+            double Gre, Gim;
+            reflection(TdrDeviceR, data[i].r, data[i].x, Gre, Gim);
+
+            if ( i==0)
+            {
+                double farEndImpedance = 50;
+                Gre = (farEndImpedance-TdrDeviceR)/(farEndImpedance+TdrDeviceR);
+                Gim = 0;
+            }
+
+            double KP = 1.0/0.53836;
+            double k = 0.53836-0.46146*cos(M_PI+M_PI*i/(asize-1));
+
+            TdrReal[i] = Gre*fftSize/asize/2.0*k*KP;
+            TdrImag[i] = Gim*fftSize/asize/2.0*k*KP;
+        }
+    }
+
+    // Interpolate zero frequency
+    double newreal = sqrt(TdrReal[1]*TdrReal[1]+TdrImag[1]*TdrImag[1]);
+    TdrReal[0] = (TdrReal[1] < 0) ? -newreal : newreal;
+    TdrImag[0] = 0;
+
+    // Mirror
+    for (i=1; i<fftSize/2; i++)
+    {
+        TdrReal[fftSize-i] = TdrReal[i];
+        TdrImag[fftSize-i] = -TdrImag[i];
+    }
+    TdrReal[fftSize/2] = 0;
+    TdrImag[fftSize/2] = 0;
+
+    fft(TdrReal, TdrImag, fftSize, true);
+
+    impulse.resize(fftSize);
+    step.resize(fftSize);
+    double ig = 0;
+    for (i=0; i<fftSize; i++)
+    {
+        double Amp = TdrReal[i];
+        if((Amp > TdrMinAmplitude) || (Amp < -TdrMinAmplitude))
+        {
+            impulse[i] = Amp;
+            ig += Amp/2/(((double)fftSize)/asize/2);
+        }else
+        {
+            impulse[i] = 0;
+        }
+        step[i] = ig;
+    }
+    return fftSize;
+}
+
+void SweepMath::fft(double *real, double *imag, int length, bool inverse)
+{
+    double wreal, wpreal, wimag, wpimag, theta;
+    double tempreal, tempimag, tempwreal;
+
+    // direction of rotating phasor, positive for the IFFT
+    double direction = inverse ? 1.0 : -1.0;
+
+    // bit-reverse the addresses of both the real and imaginary arrays
+    for (int Addr=0; Addr<length; Addr++)
+    {
+        int BitRevAddr = 0;
+        int Position = length >> 1;
+        int Mask = Addr;
+        while (Mask)
+        {
+            if(Mask & 1)
+                BitRevAddr += Position;
+            Mask >>= 1;
+            Position >>= 1;
+        }
+
+        if (BitRevAddr > Addr)
+        {
+            std::swap(real[BitRevAddr], real[Addr]);
+            std::swap(imag[BitRevAddr], imag[Addr]);
+        }
+    }
+
+    // FFT, IFFT Kernel
+    for (int k=1; k < length; k <<= 1)
+    {
+        theta = direction * M_PI / (double)k;
+        wpimag = sin(theta);
+        wpreal = cos(theta);
+        wreal = 1.0;
+        wimag = 0.0;
+
+        for (int m=0; m < k; m++)
+        {
+            for (int Addr = m; Addr < length; Addr += (k*2))
+            {
+                int PairAddr = Addr + k;
+
+                tempreal = wreal * real[PairAddr] - wimag * imag[PairAddr];
+                tempimag = wreal * imag[PairAddr] + wimag * real[PairAddr];
+
+                real[PairAddr] = real[Addr] - tempreal;
+                imag[PairAddr] = imag[Addr] - tempimag;
+                real[Addr] += tempreal;
+                imag[Addr] += tempimag;
+            }
+            tempwreal = wreal;
+            wreal = wreal * wpreal - wimag * wpimag;
+            wimag = wimag * wpreal + tempwreal * wpimag;
+        }
+    }
+
+    if(inverse)     // Normalize the IFFT coefficients
+    {
+        for(int i=0; i<length; i++)
+        {
+            real[i] /= (double)length;
+            imag[i] /= (double)length;
+        }
+    }
+}
+
+int SweepMath::minimumSwr(const double *swr, int count)
+{
+    int index = -1;
+    for(int i = 0; i < count; ++i)
+    {
+        if(!qIsNaN(swr[i]) && ((index < 0) || (swr[i] < swr[index])))
+        {
+            index = i;
+        }
+    }
+    return index;
+}
+
+static double crossing(double fq1, double swr1, double fq2, double swr2, double limit)
+{
+    if(swr1 == swr2)
+    {
+        return fq1;
+    }
+    return fq1 + (fq2 - fq1)*(limit - swr1)/(swr2 - swr1);
+}
+
+bool SweepMath::bandwidth(const double *fq, const double *swr, int count, int center,
+                          double limit, double &lower, double &upper)
+{
+    if((center < 0) || (center >= count) || !(swr[center] <= limit))
+    {
+        return false;
+    }
+    int first = center;
+    while((first > 0) && (swr[first-1] <= limit))
+    {
+        --first;
+    }
+    int last = center;
+    while((last < count-1) && (swr[last+1] <= limit))
+    {
+        ++last;
+    }
+    lower = (first == 0) ? fq[0] : crossing(fq[first-1], swr[first-1], fq[first], swr[first], limit);
+    upper = (last == count-1) ? fq[last] : crossing(fq[last], swr[last], fq[last+1], swr[last+1], limit);
+    return true;
+}
+
+QVector<double> SweepMath::resonances(const rawData *data, int count)
+{
+    QVector <double> result;
+    for(int i = 1; i < count; ++i)
+    {
+        double x1 = data[i-1].x;
+        double x2 = data[i].x;
+        if(qIsNaN(x1) || qIsNaN(x2) || (x1 == x2))
+        {
+            continue;
+        }
+        // a zero lying on a point is reported once, with the interval it starts
+        if(((x1 < 0) && (x2 >= 0)) || ((x1 > 0) && (x2 <= 0)))
+        {
+            result.append(data[i-1].fq + (data[i].fq - data[i-1].fq)*(-x1)/(x2 - x1));
+        }
+    }
+    return result;
+}
+
+QVector<int> SweepMath::faults(const double *impulse, int count, double threshold)
+{
+    QVector <int> result;
+    for(int i = 0; i < count; ++i)
+    {
+        double amplitude = fabs(impulse[i]);
+        if(amplitude < threshold)
+        {
+            continue;
+        }
+        if(((i > 0) && (amplitude < fabs(impulse[i-1]))) ||
+           ((i < count-1) && (amplitude <= fabs(impulse[i+1]))))
+        {
+            continue;
+        }
+        result.append(i);
+    }
+    return result;
+}
@@ -0,0 +1,207 @@
+#ifndef SWEEPMATH_H
+#define SWEEPMATH_H
+
+#include <QVector>
+#include <math.h>
+#include <core/rawdata.h>
+
+// Cable between the analyzer and the load, the fields of the Cable settings.
+struct CableModel
+{
+    enum Mode
+    {
+        None = 0,
+        Subtract = 1,   // measured at the near end, show the far end
+        Add = 2
+    };
+
+    int mode;
+    double length;
+    double velocityFactor;
+    double resistance;      // characteristic impedance, Ohm
+    double lossConductive;
+    double lossDielectric;
+    int lossUnits;          // 0=dB/100ft, 1=dB/ft, 2=dB/100m, 3=dB/m
+    bool lossAtAnyFq;
+
+    CableModel() :
+        mode(None), length(0), velocityFactor(0.66), resistance(50),
+        lossConductive(0), lossDielectric(0), lossUnits(0), lossAtAnyFq(false) {}
+};
+
+// One standard of a cal kit as network analyzer kit definitions describe
+// it: a lossy offset line terminated by the fringing capacitance of an open,
+// the inductance of a short or the resistance of a load.
+struct CalStandard
+{
+    double c0;              // open capacitance, 1e-15 F
+    double c1;              // 1e-27 F/Hz
+    double c2;              // 1e-36 F/Hz^2
+    double c3;              // 1e-45 F/Hz^3
+    double l0;              // short inductance, 1e-12 H
+    double l1;              // 1e-24 H/Hz
+    double l2;              // 1e-33 H/Hz^2
+    double l3;              // 1e-42 H/Hz^3
+    double resistance;      // load, Ohm, 0 for the system impedance
+    double delay;           // offset delay, ps
+    double loss;            // offset loss, GOhm/s
+    double offsetZ0;        // Ohm, 0 for the system impedance
+
+    CalStandard() :
+        c0(0), c1(0), c2(0), c3(0), l0(0), l1(0), l2(0), l3(0),
+        resistance(0), delay(0), loss(0), offsetZ0(0) {}
+};
+
+struct CalKit
+{
+    enum Standard
+    {
+        Open,
+        Short,
+        Load
+    };
+
+    CalStandard open;
+    CalStandard shortStandard;
+    CalStandard load;
+
+    // an ideal kit needs no actual values, calibration uses 1, -1 and 0
+    bool isIdeal() const;
+};
+
+// Measured reflection coefficients of the open, short and load standards,
+// one column per value on a common ascending frequency grid (MHz).
+struct OslStandards
+{
+    QVector <double> fq;
+    QVector <double> openRe;
+    QVector <double> openIm;
+    QVector <double> shortRe;
+    QVector <double> shortIm;
+    QVector <double> loadRe;
+    QVector <double> loadIm;
+
+    // actual reflection of the standards on the same grid, computed once by
+    // setKit(), empty for an ideal kit
+    QVector <double> actualOpenRe;
+    QVector <double> actualOpenIm;
+    QVector <double> actualShortRe;
+    QVector <double> actualShortIm;
+    QVector <double> actualLoadRe;
+    QVector <double> actualLoadIm;
+
+    // error terms of the one port model, Gm = (A*G + B)/(C*G + 1), computed
+    // by setKit() from the measured and the actual standards
+    QVector <double> termARe;
+    QVector <double> termAIm;
+    QVector <double> termBRe;
+    QVector <double> termBIm;
+    QVector <double> termCRe;
+    QVector <double> termCIm;
+
+    bool isValid() const;
+    bool hasActual() const { return !actualOpenRe.isEmpty() && (actualOpenRe.size() == fq.size()); }
+    bool hasTerms() const { return !termARe.isEmpty() && (termARe.size() == fq.size()); }
+    // actual values and error terms, call it once the measured columns are filled
+    void setKit(const CalKit &kit, double Z0);
+    // linear interpolation, clamped to the first and last point
+    bool interpolate(double fq, double &reO, double &imO, double &reS, double &imS,
+                     double &reL, double &imL) const;
+    bool interpolateActual(double fq, double &reO, double &imO, double &reS, double &imS,
+                           double &reL, double &imL) const;
+    bool interpolateTerms(double fq, double &reA, double &imA, double &reB, double &imB,
+                          double &reC, double &imC) const;
+
+private:
+    int locate(double fq, double &alf) const;
+};
+
+// Calibrations of the same port at several resolutions, typically one coarse
+// set over the whole analyzer range and denser ones captured for single bands.
+class OslStandardsSet
+{
+public:
+    void clear() { m_sets.clear(); }
+    int count() const { return m_sets.size(); }
+    const OslStandards &at(int index) const { return m_sets.at(index); }
+    // replaces the set with the same range, else adds it; invalid sets are ignored
+    void insert(const OslStandards &standards);
+    bool remove(double fqFrom, double fqTo);
+    // the densest set covering fqFrom..fqTo (MHz), the widest one if none covers
+    // it, NULL without sets; the pointer is valid until the next insert or remove
+    const OslStandards *cover(double fqFrom, double fqTo) const;
+
+private:
+    QVector <OslStandards> m_sets;
+};
+
+// Running mean and variance of a complex value per point (Welford's method),
+// the memory does not grow with the number of sweeps added.
+struct ComplexAverage
+{
+    QVector <int> count;
+    QVector <double> re;
+    QVector <double> im;
+    QVector <double> m2;        // sum of |value - mean|^2
+
+    void reset(int points);
+    int size() const { return count.size(); }
+    void add(int index, double valueRe, double valueIm);
+    // sample variance of the point, 0 with less than two values
+    double variance(int index) const;
+};
+
+// Impedance and reflection math of AntScope2 as pure functions over plain
+// values and contiguous arrays. Nothing here touches widgets or settings,
+// so every function may run on any thread.
+class SweepMath
+{
+public:
+    // 0 if SWR can't be computed, SWR is limited to 1..200 as on the graphs
+    static quint32 swr(double Z0, double r, double x, double *vswr, double *rl);
+    static double z(double r, double x) { return sqrt(r*r + x*x); }
+    static void reflection(double Z0, double r, double x, double &re, double &im);
+    static void impedance(double Z0, double re, double im, double &r, double &x);
+
+    // error terms of the one port model from measured and actual standards
+    static void oslTerms(double MOR, double MOI, double MSR, double MSI, double MLR, double MLI, // Measured cal standards
+                         double SOR, double SOI, double SSR, double SSI, double SLR, double SLI, // Actual cal standards
+                         double &AR, double &AI, double &BR, double &BI, double &CR, double &CI);
+    static void applyTerms(double MMR, double MMI,
+                           double AR, double AI, double BR, double BI, double CR, double CI,
+                           double &MAR, double &MAI);
+    // one port OSL error correction
+    static void applyOsl(double MMR, double MMI, // Measured
+                         double MOR, double MOI, double MSR, double MSI, double MLR, double MLI, // Measured cal standards
+                         double SOR, double SOI, double SSR, double SSI, double SLR, double SLI, // Actual cal standards
+                         double &MAR, double &MAI);
+    // reflection of a kit standard at fq (MHz) in a Z0 system
+    static void standardReflection(const CalStandard &standard, int type, double fq, double Z0,
+                                   double &re, double &im);
+    // corrects count points against the actual values of the standards, ideal
+    // ones if there are none; in and out may be the same array;
+    // without valid standards the points are copied unchanged
+    static void calibrate(const OslStandards &standards, double Z0,
+                          const rawData *in, rawData *out, int count);
+
+    // impedance at the other end of the cable, in and out may be the same array
+    static rawData transformCable(const CableModel &cable, const rawData &point);
+    static void transformCable(const CableModel &cable, const rawData *in, rawData *out, int count);
+
+    // time domain reflectometry of a sweep starting near 0 Hz, returns the
+    // number of bins in impulse and step, 0 if the sweep is not suitable
+    static int tdr(const rawData *data, int count, double velocityFactor,
+                   QVector<double> &impulse, QVector<double> &step, double *range);
+    static void fft(double *real, double *imag, int length, bool inverse);
+
+    static int minimumSwr(const double *swr, int count);
+    // edges of the band around center where SWR stays at or below limit
+    static bool bandwidth(const double *fq, const double *swr, int count, int center,
+                          double limit, double &lower, double &upper);
+    // frequencies where the reactance crosses zero
+    static QVector<double> resonances(const rawData *data, int count);
+    // bins of the local impulse maxima at or above threshold
+    static QVector<int> faults(const double *impulse, int count, double threshold);
+};
+
+#endif // SWEEPMATH_H
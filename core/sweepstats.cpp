@@ -0,0 +1,105 @@
+#include "sweepstats.h"
+#include <core/sweepmath.h>
+
+SweepStatistics::SweepStatistics() :
+    m_points(0),
+    m_size(0),
+    m_sweeps(0)
+{
+}
+
+void SweepStatistics::reset(int points)
+{
+    m_points = qMax(points, 0);
+    m_fq.fill(0, m_points);
+    for(int q = 0; q < QuantityCount; ++q)
+    {
+        m_value[q].fill(0, m_points);
+        m_count[q].fill(0, m_points);
+        m_min[q].fill(0, m_points);
+        m_max[q].fill(0, m_points);
+        m_mean[q].fill(0, m_points);
+        m_m2[q].fill(0, m_points);
+    }
+    clear();
+}
+
+void SweepStatistics::clear()
+{
+    m_size = 0;
+    m_sweeps = 0;
+    m_fq.fill(qQNaN());
+    for(int q = 0; q < QuantityCount; ++q)
+    {
+        m_count[q].fill(0);
+        m_min[q].fill(qQNaN());
+        m_max[q].fill(qQNaN());
+        m_mean[q].fill(qQNaN());
+        m_m2[q].fill(0);
+    }
+}
+
+void SweepStatistics::add(const rawData *data, int count, double Z0)
+{
+    count = qMin(count, m_points);
+    if(count <= 0)
+    {
+        return;
+    }
+    // the derived values first, then one pass per column
+    double *swr = m_value[Swr].data();
+    double *gamma = m_value[Gamma].data();
+    double *r = m_value[R].data();
+    double *x = m_value[X].data();
+    double *fq = m_fq.data();
+    for(int i = 0; i < count; ++i)
+    {
+        const rawData &point = data[i];
+        fq[i] = point.fq;
+        r[i] = point.r;
+        x[i] = point.x;
+        if(!SweepMath::swr(Z0, point.r, point.x, &swr[i], NULL))
+        {
+            swr[i] = qQNaN();
+        }
+        double re, im;
+        SweepMath::reflection(Z0, point.r, point.x, re, im);
+        gamma[i] = sqrt(re*re + im*im);
+    }
+
+    for(int q = 0; q < QuantityCount; ++q)
+    {
+        const double *value = m_value[q].constData();
+        quint32 *n = m_count[q].data();
+        double *minimum = m_min[q].data();
+        double *maximum = m_max[q].data();
+        double *mean = m_mean[q].data();
+        double *m2 = m_m2[q].data();
+        for(int i = 0; i < count; ++i)
+        {
+            double v = value[i];
+            if(qIsNaN(v))
+            {
+                continue;
+            }
+            if(n[i]++ == 0)
+            {
+                minimum[i] = maximum[i] = mean[i] = v;
+                continue;
+            }
+            minimum[i] = qMin(minimum[i], v);
+            maximum[i] = qMax(maximum[i], v);
+            double delta = v - mean[i];
+            mean[i] += delta/n[i];
+            m2[i] += delta*(v - mean[i]);
+        }
+    }
+    m_size = qMax(m_size, count);
+    ++m_sweeps;
+}
+
+double SweepStatistics::deviation(Quantity quantity, int index) const
+{
+    quint32 n = m_count[quantity].at(index);
+    return (n > 1) ? sqrt(m_m2[quantity].at(index)/(n - 1)) : 0;
+}
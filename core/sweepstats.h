@@ -0,0 +1,51 @@
+#ifndef SWEEPSTATS_H
+#define SWEEPSTATS_H
+
+#include <QVector>
+#include <core/rawdata.h>
+
+// Running statistics of repeated sweeps over one grid, per frequency bin:
+// minimum (min-hold), maximum (max-hold), mean and deviation after Welford.
+// Every quantity is a column allocated by reset(), add() walks the columns
+// once, so a sweep costs O(points) however many sweeps came before.
+class SweepStatistics
+{
+public:
+    enum Quantity {Swr = 0, R, X, Gamma, QuantityCount};
+
+    SweepStatistics();
+
+    // allocates the columns for sweeps of up to points points
+    void reset(int points);
+    void clear();
+    int points() const { return m_points; }
+    // bins of the longest sweep added
+    int size() const { return m_size; }
+    quint64 sweeps() const { return m_sweeps; }
+
+    // folds a sweep in, points past points() are dropped and values that
+    // can't be computed leave their bin as it is
+    void add(const rawData *data, int count, double Z0);
+
+    // NaN where no value was added
+    const double *fq() const { return m_fq.constData(); }
+    const double *minimum(Quantity quantity) const { return m_min[quantity].constData(); }
+    const double *maximum(Quantity quantity) const { return m_max[quantity].constData(); }
+    const double *mean(Quantity quantity) const { return m_mean[quantity].constData(); }
+    // sample standard deviation of the bin, 0 with less than two values
+    double deviation(Quantity quantity, int index) const;
+
+private:
+    int m_points;
+    int m_size;
+    quint64 m_sweeps;
+    QVector <double> m_fq;
+    QVector <double> m_value[QuantityCount];    // the sweep being added
+    QVector <quint32> m_count[QuantityCount];
+    QVector <double> m_min[QuantityCount];
+    QVector <double> m_max[QuantityCount];
+    QVector <double> m_mean[QuantityCount];
+    QVector <double> m_m2[QuantityCount];       // sum of (value - mean)^2
+};
+
+#endif // SWEEPSTATS_H
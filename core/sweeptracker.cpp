@@ -0,0 +1,165 @@
+#include "sweeptracker.h"
+#include <core/sweepmath.h>
+
+static double crossing(double fq1, double value1, double fq2, double value2, double level)
+{
+    if(value1 == value2)
+    {
+        return fq1;
+    }
+    return fq1 + (fq2 - fq1)*(level - value1)/(value2 - value1);
+}
+
+static void clearBand(TrackerBand &band)
+{
+    band.lower = qQNaN();
+    band.upper = qQNaN();
+    band.lowerOpen = false;
+    band.upperOpen = false;
+}
+
+SweepTracker::SweepTracker() :
+    m_Z0(50)
+{
+    reset();
+}
+
+void SweepTracker::reset()
+{
+    m_result.points = 0;
+    m_result.minSwr = qQNaN();
+    m_result.minSwrFq = qQNaN();
+    m_result.resonance = qQNaN();
+    m_result.resonances = 0;
+    m_result.q = qQNaN();
+    clearBand(m_result.band15);
+    clearBand(m_result.band2);
+    for(int i = 0; i < LimitCount; ++i)
+    {
+        m_bands[i].inBand = false;
+        m_bands[i].runLower = qQNaN();
+        m_bands[i].runLowerOpen = false;
+        m_bands[i].runHasMinimum = false;
+    }
+    m_hasLast = false;
+    m_lastSwr = qQNaN();
+    m_lastCrossing = qQNaN();
+    m_crossingBefore = qQNaN();
+    m_crossingAfter = qQNaN();
+}
+
+void SweepTracker::add(const rawData &point)
+{
+    ++m_result.points;
+    double swr;
+    if(!SweepMath::swr(m_Z0, point.r, point.x, &swr, NULL))
+    {
+        swr = qQNaN();
+    }
+
+    // the reactance zero between the last point and this one, counted as
+    // SweepMath::resonances() does
+    bool crossed = false;
+    if(m_hasLast && !qIsNaN(m_last.x) && !qIsNaN(point.x) && (m_last.x != point.x) &&
+       (((m_last.x < 0) && (point.x >= 0)) || ((m_last.x > 0) && (point.x <= 0))))
+    {
+        m_lastCrossing = crossing(m_last.fq, m_last.x, point.fq, point.x, 0);
+        ++m_result.resonances;
+        crossed = true;
+    }
+
+    bool minimum = !qIsNaN(swr) && (qIsNaN(m_result.minSwr) || (swr < m_result.minSwr));
+    if(minimum)
+    {
+        m_result.minSwr = swr;
+        m_result.minSwrFq = point.fq;
+        m_crossingBefore = m_lastCrossing;
+        m_crossingAfter = qQNaN();
+    }else if(crossed && qIsNaN(m_crossingAfter) && !qIsNaN(m_result.minSwr))
+    {
+        m_crossingAfter = m_lastCrossing;
+    }
+
+    for(int i = 0; i < LimitCount; ++i)
+    {
+        updateBand(Limit(i), swr, point.fq, minimum);
+    }
+
+    m_hasLast = true;
+    m_last = point;
+    m_lastSwr = swr;
+    updateResult();
+}
+
+// the band of a limit only changes with the run of points the minimum is in
+void SweepTracker::updateBand(Limit limit, double swr, double fq, bool minimum)
+{
+    BandState &state = m_bands[limit];
+    TrackerBand &band = (limit == Limit15) ? m_result.band15 : m_result.band2;
+    double level = SweepTracker::limit(limit);
+    bool below = !qIsNaN(swr) && (swr <= level);
+
+    if(below && !state.inBand)
+    {
+        state.inBand = true;
+        state.runHasMinimum = false;
+        if(!m_hasLast || qIsNaN(m_lastSwr))
+        {
+            state.runLower = fq;
+            state.runLowerOpen = !m_hasLast;
+        }else
+        {
+            state.runLower = crossing(m_last.fq, m_lastSwr, fq, swr, level);
+            state.runLowerOpen = false;
+        }
+    }else if(!below && state.inBand)
+    {
+        state.inBand = false;
+        if(state.runHasMinimum)
+        {
+            band.upper = qIsNaN(swr) ? m_last.fq : crossing(m_last.fq, m_lastSwr, fq, swr, level);
+            band.upperOpen = false;
+        }
+    }
+
+    if(below && minimum)
+    {
+        state.runHasMinimum = true;
+        band.lower = state.runLower;
+        band.lowerOpen = state.runLowerOpen;
+    }
+    if(below && state.runHasMinimum)
+    {
+        band.upper = fq;
+        band.upperOpen = true;
+    }
+}
+
+void SweepTracker::updateResult()
+{
+    double fq = m_result.minSwrFq;
+    if(qIsNaN(m_crossingBefore))
+    {
+        m_result.resonance = m_crossingAfter;
+    }else if(qIsNaN(m_crossingAfter))
+    {
+        m_result.resonance = m_crossingBefore;
+    }else
+    {
+        m_result.resonance = ((fq - m_crossingBefore) <= (m_crossingAfter - fq)) ?
+                    m_crossingBefore : m_crossingAfter;
+    }
+
+    const TrackerBand &band = m_result.band2;
+    m_result.q = band.isClosed() ? q(fq, band.lower, band.upper, limit(Limit2)) : qQNaN();
+}
+
+double SweepTracker::q(double fq, double lower, double upper, double limit)
+{
+    double width = upper - lower;
+    if(!(width > 0) || !(limit > 1))
+    {
+        return qQNaN();
+    }
+    return fq*(limit - 1)/(sqrt(limit)*width);
+}
@@ -0,0 +1,82 @@
+#ifndef SWEEPTRACKER_H
+#define SWEEPTRACKER_H
+
+#include <QtGlobal>
+#include <core/rawdata.h>
+
+// band around the SWR minimum where SWR stays at or below a limit, the
+// edges are interpolated; an edge at the end of the sweep so far is open
+struct TrackerBand
+{
+    double lower;           // MHz, NaN if SWR never got down to the limit
+    double upper;
+    bool lowerOpen;
+    bool upperOpen;
+
+    bool isValid() const { return !qIsNaN(lower); }
+    bool isClosed() const { return isValid() && !lowerOpen && !upperOpen; }
+};
+
+// what SweepTracker knows after the points added so far
+struct TrackerResult
+{
+    int points;
+    double minSwr;          // NaN before the first point with a SWR
+    double minSwrFq;        // MHz
+    // reactance zero crossing next to the SWR minimum, NaN if there is none
+    double resonance;
+    int resonances;         // zero crossings in the sweep
+    TrackerBand band15;     // SWR 1.5
+    TrackerBand band2;      // SWR 2
+    // loaded Q from the closed 2:1 band, NaN otherwise
+    double q;
+};
+
+// Resonance and bandwidth of a sweep while its points arrive. add() is O(1):
+// the SWR minimum, the interpolated reactance zero crossings on both sides
+// of it and the SWR 1.5 and 2 bands containing it are carried along, so the
+// result is current after every point without another pass over the sweep.
+class SweepTracker
+{
+public:
+    enum Limit {Limit15 = 0, Limit2, LimitCount};
+
+    SweepTracker();
+
+    void setZ0(double Z0) { m_Z0 = Z0; }
+    double Z0() const { return m_Z0; }
+
+    // starts a new sweep
+    void reset();
+    // the next point of the sweep, ascending in frequency
+    void add(const rawData &point);
+    const TrackerResult &result() const { return m_result; }
+
+    static double limit(Limit limit) { return (limit == Limit15) ? 1.5 : 2.0; }
+    // Q of a matched resonator from the band where SWR stays below limit
+    static double q(double fq, double lower, double upper, double limit);
+
+private:
+    struct BandState
+    {
+        bool inBand;            // the last point is at or below the limit
+        double runLower;        // lower edge of the run of points in the band
+        bool runLowerOpen;
+        bool runHasMinimum;     // the SWR minimum lies in the current run
+    };
+
+    double m_Z0;
+    TrackerResult m_result;
+    BandState m_bands[LimitCount];
+    bool m_hasLast;
+    rawData m_last;
+    double m_lastSwr;           // NaN if the last point had no SWR
+    double m_lastCrossing;      // latest reactance zero crossing
+    double m_crossingBefore;    // the latest one before the SWR minimum
+    double m_crossingAfter;     // the first one after it
+
+    void updateBand(Limit limit, double swr, double fq, bool minimum);
+    void updateResult();
+};
+
+#endif // SWEEPTRACKER_H
@@ -0,0 +1,82 @@
+#include "tuningplanner.h"
+
+TuningPlanner::TuningPlanner() :
+    m_fqMin(0),
+    m_fqMax(0),
+    m_rate(TUNING_RATE)
+{
+    m_window.fqFrom = 0;
+    m_window.fqTo = 0;
+    m_window.dots = TUNING_MIN_DOTS;
+}
+
+void TuningPlanner::setLimits(double fqMin, double fqMax)
+{
+    m_fqMin = fqMin;
+    m_fqMax = qMax(fqMax, fqMin + TUNING_MIN_SPAN);
+}
+
+void TuningPlanner::start(double fqFrom, double fqTo, int dots)
+{
+    m_window.dots = qBound(TUNING_MIN_DOTS, dots, TUNING_MAX_DOTS);
+    place((fqFrom + fqTo)/2, fqTo - fqFrom);
+}
+
+// keeps the span if it fits and moves the window inside the limits
+void TuningPlanner::place(double center, double span)
+{
+    span = qBound(TUNING_MIN_SPAN, span, m_fqMax - m_fqMin);
+    double from = qBound(m_fqMin, center - span/2, m_fqMax - span);
+    m_window.fqFrom = from;
+    m_window.fqTo = from + span;
+}
+
+const TuningWindow &TuningPlanner::next(const TrackerResult &result, qint64 elapsed)
+{
+    // points for the rate, measured on the sweep just done
+    if((elapsed > 0) && (result.points > 0))
+    {
+        double perPoint = double(elapsed)/result.points;
+        int dots = qBound(TUNING_MIN_DOTS, int(1000.0/m_rate/perPoint) - 1, TUNING_MAX_DOTS);
+        // a new grid restarts the continuous traces, timing jitter must not
+        if(qAbs(dots - m_window.dots) > m_window.dots/5)
+        {
+            m_window.dots = dots;
+        }
+    }
+    if(qIsNaN(result.minSwr))
+    {
+        return m_window;
+    }
+
+    double span = m_window.span();
+    double center = result.minSwrFq*1000;
+    double step = span/qMax(result.points - 1, 1);
+    const TrackerBand &band = result.band2;
+    double target;
+    if((center - m_window.fqFrom < step) || (m_window.fqTo - center < step))
+    {
+        // the dip is at an edge and may lie outside, follow it at the same width
+        target = span;
+    }else if(band.isClosed())
+    {
+        target = TUNING_BAND_SPANS*(band.upper - band.lower)*1000;
+    }else if(band.isValid())
+    {
+        // the window cuts the band, look wider
+        target = span*2;
+    }else
+    {
+        target = span/2;
+    }
+    // no more than a factor of two per sweep, the loop must not overshoot
+    target = qBound(span/2, target, span*2);
+
+    // small corrections would only make the graph jitter
+    if((qAbs(center - m_window.center()) < span/10) && (qAbs(target - span) < span/5))
+    {
+        return m_window;
+    }
+    place(center, target);
+    return m_window;
+}
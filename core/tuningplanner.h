@@ -0,0 +1,53 @@
+#ifndef TUNINGPLANNER_H
+#define TUNINGPLANNER_H
+
+#include <QtGlobal>
+#include <core/sweeptracker.h>
+
+#define TUNING_RATE         10.0    // sweeps per second aimed at
+#define TUNING_MIN_DOTS     20
+#define TUNING_MAX_DOTS     200
+#define TUNING_MIN_SPAN     10.0    // kHz
+#define TUNING_BAND_SPANS   3.0     // window width in 2:1 bandwidths
+
+// range and points of a tuning sweep, frequencies in kHz as on the graphs
+struct TuningWindow
+{
+    double fqFrom;
+    double fqTo;
+    int dots;
+
+    double center() const { return (fqFrom + fqTo)/2; }
+    double span() const { return fqTo - fqFrom; }
+};
+
+// Closed loop of the fast tuning mode: from the tracker result of a sweep
+// and the time it took, next() gives the window of the following one. The
+// window follows the SWR dip and narrows to a few 2:1 bandwidths around it,
+// the points are chosen so that a sweep takes about 1/rate seconds.
+class TuningPlanner
+{
+public:
+    TuningPlanner();
+
+    // frequency range of the analyzer, kHz
+    void setLimits(double fqMin, double fqMax);
+    void setRate(double sweepsPerSecond) { m_rate = qMax(sweepsPerSecond, 0.1); }
+    double rate() const { return m_rate; }
+
+    // the first window, as the user set it
+    void start(double fqFrom, double fqTo, int dots);
+    // the window after the sweep that gave result and lasted elapsed ms
+    const TuningWindow &next(const TrackerResult &result, qint64 elapsed);
+    const TuningWindow &window() const { return m_window; }
+
+private:
+    TuningWindow m_window;
+    double m_fqMin;
+    double m_fqMax;
+    double m_rate;
+
+    void place(double center, double span);
+};
+
+#endif // TUNINGPLANNER_H
@@ -0,0 +1,110 @@
+#include "zoomplanner.h"
+#include <qmath.h>
+
+ZoomPlanner::ZoomPlanner() :
+    m_next(0)
+{
+}
+
+void ZoomPlanner::clear()
+{
+    m_segments.resize(0);
+    m_next = 0;
+}
+
+void ZoomPlanner::addSegment(double fqFrom, double fqTo, int dots)
+{
+    ZoomSegment segment;
+    segment.fqFrom = fqFrom;
+    segment.fqTo = fqTo;
+    segment.dots = dots;
+    m_segments.append(segment);
+}
+
+int ZoomPlanner::plan(const QVector<rawData> &cached, double fqFrom, double fqTo, int dots)
+{
+    clear();
+    double span = fqTo - fqFrom;
+    if(!(span > 0) || (dots < 1))
+    {
+        return 0;
+    }
+    double step = span/dots;
+    double limit = step*ZOOM_DENSITY_SLACK;
+
+    // points closer than limit to a neighbour are dense enough to keep, the
+    // gaps between them are filled at the grid of the window; a point just
+    // outside the window still bounds the gap at its edge
+    int count = cached.size();
+    double lower = fqFrom;
+    bool lowerEdge = true;
+    for(int i = 0; i <= count; ++i)
+    {
+        double fq;
+        bool upperEdge = (i == count);
+        if(upperEdge)
+        {
+            fq = fqTo;
+        }else
+        {
+            fq = cached.at(i).fq*1000;
+            if(fq < fqFrom - limit)
+            {
+                continue;
+            }
+            if(fq > fqTo + limit)
+            {
+                fq = fqTo;
+                upperEdge = true;
+            }else if(!(((i > 0) && (fq - cached.at(i - 1).fq*1000 <= limit)) ||
+                       ((i + 1 < count) && (cached.at(i + 1).fq*1000 - fq <= limit))))
+            {
+                continue;
+            }
+        }
+
+        double width = fq - lower;
+        if(width > limit)
+        {
+            int n = qCeil(width/limit);
+            if(lowerEdge && upperEdge)
+            {
+                addSegment(fqFrom, fqTo, dots);
+            }else if(lowerEdge)
+            {
+                addSegment(lower, fq - width/n, n - 1);
+            }else if(upperEdge)
+            {
+                addSegment(lower + width/n, fq, n - 1);
+            }else
+            {
+                // a sweep has two points at least
+                n = qMax(n, 3);
+                addSegment(lower + width/n, fq - width/n, n - 2);
+            }
+        }
+        if(upperEdge)
+        {
+            break;
+        }
+        lower = fq;
+        lowerEdge = false;
+    }
+
+    // every sweep costs its start on the analyzer, many small gaps are
+    // cheaper measured together
+    if(m_segments.size() > ZOOM_MAX_SEGMENTS)
+    {
+        double from = m_segments.first().fqFrom;
+        double to = m_segments.last().fqTo;
+        clear();
+        addSegment(from, to, qMax(qCeil((to - from)/limit), 1));
+    }
+
+    int points = 0;
+    for(int i = 0; i < m_segments.size(); ++i)
+    {
+        points += m_segments.at(i).dots + 1;
+    }
+    return points;
+}
@@ -0,0 +1,44 @@
+#ifndef ZOOMPLANNER_H
+#define ZOOMPLANNER_H
+
+#include <QVector>
+#include <core/rawdata.h>
+
+#define ZOOM_MAX_SEGMENTS   4       // more gaps than this are swept in one go
+#define ZOOM_DENSITY_SLACK  1.01    // rounding of the measured grid
+
+// one sweep of the plan, frequencies in kHz as on the graphs, dots+1 points
+struct ZoomSegment
+{
+    double fqFrom;
+    double fqTo;
+    int dots;
+};
+
+// Sweeps for a new view window over a measurement already on screen. Its
+// points are reused wherever they lie at least as dense as the window asks
+// for, only the stretches without them are planned: panning measures the
+// strip that came into view, zooming out the two edges, zooming in the
+// whole window at the finer grid.
+class ZoomPlanner
+{
+public:
+    ZoomPlanner();
+
+    // cached ascending in frequency, the window wants dots+1 points;
+    // returns the number of points to measure
+    int plan(const QVector<rawData> &cached, double fqFrom, double fqTo, int dots);
+    void clear();
+
+    bool isEmpty() const { return m_next >= m_segments.size(); }
+    const ZoomSegment &takeNext() { return m_segments.at(m_next++); }
+    const QVector<ZoomSegment> &segments() const { return m_segments; }
+
+private:
+    QVector<ZoomSegment> m_segments;
+    int m_next;
+
+    void addSegment(double fqFrom, double fqTo, int dots);
+};
+
+#endif // ZOOMPLANNER_H
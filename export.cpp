@@ -1,5 +1,10 @@
 #include "export.h"
 #include "ui_export.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <QRegExp>
+#include <QSet>
 
 Export::Export(QWidget *parent) :
     QDialog(parent),
@@ -20,10 +25,19 @@ Export::Export(QWidget *parent) :
     }
 
     m_settings->endGroup();
+
+    m_job = new ExportJob(this);
+    connect(m_job, SIGNAL(progress(int,int)), this, SLOT(on_jobProgress(int,int)));
+    connect(m_job, SIGNAL(finished()), this, SLOT(on_jobFinished()));
+    ui->progressBar->setVisible(false);
 }
 
 Export::~Export()
 {
+    // unfinished files are completed, the rest of the job is dropped
+    m_job->cancel();
+    delete m_job;
+
     m_settings->beginGroup("Export");
     m_settings->setValue("lastExportPath", m_lastExportPath);
     m_settings->setValue("geometry", this->geometry());
@@ -40,95 +54,161 @@ void Export::setMeasurements(Measurements * _measurements, quint32 number)
 
 void Export::on_csvBtn_clicked()
 {
-    if(m_measurements != NULL)
-    {
-        if(m_lastExportPath.indexOf('.') >= 0)
-        {
-            m_lastExportPath.remove(m_lastExportPath.indexOf('.'),4);
-            m_lastExportPath.append(".csv");
-        }
-        QString path = QFileDialog::getSaveFileName(this, "Export", m_lastExportPath, "Comma Separated Values (*.csv)");
-
-        if(!path.isEmpty())
-        {
-            m_lastExportPath = path;
-            m_measurements->exportData(path, 0, m_measureNumber);
-        }
-    }
+    exportTo("csv", "Comma Separated Values (*.csv)", 0);
 }
 
 void Export::on_nwlBtn_clicked()
 {
-    if(m_measurements != NULL)
+    exportTo("nwl", "APAK-EL (*.nwl)", 0);
+}
+
+void Export::on_zRiBtn_clicked()
+{
+    exportTo("s1p", "Touchstone (*.s1p)", ExportEngine::TouchstoneZRI);
+}
+
+void Export::on_sRiBtn_clicked()
+{
+    exportTo("s1p", "Touchstone (*.s1p)", ExportEngine::TouchstoneSRI);
+}
+
+void Export::on_sMaBtn_clicked()
+{
+    exportTo("s1p", "Touchstone (*.s1p)", ExportEngine::TouchstoneSMA);
+}
+
+void Export::on_asbBtn_clicked()
+{
+    exportTo("asb", "AntScope2 binary (*.asb)", 0);
+}
+
+void Export::exportTo(QString suffix, QString filter, int type)
+{
+    if(m_measurements == NULL)
     {
-        if(m_lastExportPath.indexOf('.') >= 0)
-        {
-            m_lastExportPath.remove(m_lastExportPath.indexOf('.'),4);
-            m_lastExportPath.append(".nwl");
-        }
-        QString path = QFileDialog::getSaveFileName(this, "Export", m_lastExportPath, "APAK-EL (*.nwl)");
+        return;
+    }
+    if(ui->sourceComboBox->currentIndex() != 0)
+    {
+        exportBatch(suffix, type);
+        return;
+    }
+    if(m_lastExportPath.indexOf('.') >= 0)
+    {
+        m_lastExportPath.remove(m_lastExportPath.indexOf('.'),4);
+        m_lastExportPath.append("." + suffix);
+    }
+    QString path = QFileDialog::getSaveFileName(this, "Export", m_lastExportPath, filter);
 
-        if(!path.isEmpty())
-        {
-            m_lastExportPath = path;
-            m_measurements->exportData(path, 0, m_measureNumber);
-        }
+    if(!path.isEmpty())
+    {
+        m_lastExportPath = path;
+        m_measurements->exportData(path, type, m_measureNumber);
     }
 }
 
-void Export::on_zRiBtn_clicked()
+void Export::exportBatch(QString suffix, int type)
 {
-    if(m_measurements != NULL)
+    QString lastDir = QFileInfo(m_lastExportPath).absolutePath();
+    QList <ExportItem> items;
+    QSet <QString> used;
+    QString sourceDir;
+    if(ui->sourceComboBox->currentIndex() == 2)
     {
-        if(m_lastExportPath.indexOf('.') >= 0)
+        sourceDir = QFileDialog::getExistingDirectory(this, tr("Folder with saved measurements"), lastDir);
+        if(sourceDir.isEmpty())
         {
-            m_lastExportPath.remove(m_lastExportPath.indexOf('.'),4);
-            m_lastExportPath.append(".s1p");
+            return;
         }
-        QString path = QFileDialog::getSaveFileName(this, "Export", m_lastExportPath, "Touchstone (*.s1p)");
+    }
+    QString targetDir = QFileDialog::getExistingDirectory(this, tr("Export to folder"), lastDir);
+    if(targetDir.isEmpty())
+    {
+        return;
+    }
 
-        if(!path.isEmpty())
+    QStringList names;
+    if(sourceDir.isEmpty())
+    {
+        for(int i = 0; i < m_measurements->getMeasurementLength(); ++i)
+        {
+            names << m_measurements->getMeasurementName(i);
+        }
+    }else
+    {
+        QFileInfoList files = QDir(sourceDir).entryInfoList(QStringList() << "*.asd" << "*.asb",
+                                                            QDir::Files, QDir::Name);
+        for(int i = 0; i < files.size(); ++i)
         {
-            m_lastExportPath = path;
-            m_measurements->exportData(path, 0, m_measureNumber);
+            ExportItem item;
+            item.source = files.at(i).absoluteFilePath();
+            items << item;
+            names << files.at(i).completeBaseName();
         }
     }
-}
 
-void Export::on_sRiBtn_clicked()
-{
-    if(m_measurements != NULL)
+    for(int i = 0; i < names.size(); ++i)
     {
-        if(m_lastExportPath.indexOf('.') >= 0)
+        QString name = names.at(i);
+        name.replace(QRegExp("[\\\\/:*?\"<>|]"), "_");
+        name = name.trimmed();
+        if(name.isEmpty())
+        {
+            name = "measurement";
+        }
+        QString unique = name;
+        for(int n = 2; used.contains(unique.toLower()); ++n)
         {
-            m_lastExportPath.remove(m_lastExportPath.indexOf('.'),4);
-            m_lastExportPath.append(".s1p");
+            unique = QString("%1_%2").arg(name).arg(n);
         }
-        QString path = QFileDialog::getSaveFileName(this, "Export", m_lastExportPath, "Touchstone (*.s1p)");
+        used.insert(unique.toLower());
+        QString target = QDir(targetDir).filePath(unique + "." + suffix);
 
-        if(!path.isEmpty())
+        if(sourceDir.isEmpty())
+        {
+            items << m_measurements->exportItem(i, target, type);
+        }else
         {
-            m_lastExportPath = path;
-            m_measurements->exportData(path, 1, m_measureNumber);
+            ExportItem &item = items[i];
+            item.target = target;
+            item.type = type;
+            item.Z0 = m_measurements->getZ0();
+            item.calibrationEnabled = m_measurements->getCalibrationEnabled();
         }
     }
+    if(items.isEmpty())
+    {
+        return;
+    }
+    m_lastExportPath = QDir(targetDir).filePath(QFileInfo(m_lastExportPath).fileName());
+    setBusy(true);
+    m_job->start(items);
 }
 
-void Export::on_sMaBtn_clicked()
+void Export::setBusy(bool busy)
 {
-    if(m_measurements != NULL)
-    {
-        if(m_lastExportPath.indexOf('.') >= 0)
-        {
-            m_lastExportPath.remove(m_lastExportPath.indexOf('.'),4);
-            m_lastExportPath.append(".s1p");
-        }
-        QString path = QFileDialog::getSaveFileName(this, "Export", m_lastExportPath, "Touchstone (*.s1p)");
+    ui->csvBtn->setEnabled(!busy);
+    ui->nwlBtn->setEnabled(!busy);
+    ui->zRiBtn->setEnabled(!busy);
+    ui->sRiBtn->setEnabled(!busy);
+    ui->sMaBtn->setEnabled(!busy);
+    ui->asbBtn->setEnabled(!busy);
+    ui->sourceComboBox->setEnabled(!busy);
+    ui->progressBar->setVisible(busy);
+}
 
-        if(!path.isEmpty())
-        {
-            m_lastExportPath = path;
-            m_measurements->exportData(path, 2, m_measureNumber);
-        }
+void Export::on_jobProgress(int done, int total)
+{
+    ui->progressBar->setRange(0, total);
+    ui->progressBar->setValue(done);
+}
+
+void Export::on_jobFinished()
+{
+    setBusy(false);
+    QStringList errors = m_job->errors();
+    if(!errors.isEmpty())
+    {
+        QMessageBox::warning(this, tr("Export"), errors.join("\n"));
     }
 }
@@ -6,6 +6,7 @@
 #include <analyzer/analyzerparameters.h>
 #include <QSettings>
 #include <settings.h>
+#include <exportengine.h>
 
 namespace Ui {
 class Export;
@@ -25,16 +26,24 @@ private:
     Ui::Export *ui;
     Measurements * m_measurements;
     QSettings * m_settings;
+    ExportJob * m_job;
 
     quint32 m_measureNumber;
     QString m_lastExportPath;
 
+    void exportTo(QString suffix, QString filter, int type);
+    void exportBatch(QString suffix, int type);
+    void setBusy(bool busy);
+
 private slots:
     void on_csvBtn_clicked();
     void on_zRiBtn_clicked();
     void on_sRiBtn_clicked();
     void on_sMaBtn_clicked();
     void on_nwlBtn_clicked();
+    void on_asbBtn_clicked();
+    void on_jobProgress(int done, int total);
+    void on_jobFinished();
 };
 
 #endif // EXPORT_H
@@ -0,0 +1,449 @@
+#include "exportengine.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtConcurrent/QtConcurrentMap>
+#include <measurementfile.h>
+#include <math.h>
+
+#define EXPORT_BLOCK_SIZE (1024*1024)
+
+static const double s_pow10[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,
+    1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18
+};
+
+// writes n with `decimals` digits after the point, right aligned at end
+static char *formatDigits(char *end, quint64 n, int decimals)
+{
+    char *p = end;
+    for(int i = 0; i < decimals; ++i)
+    {
+        *--p = char('0' + n % 10);
+        n /= 10;
+    }
+    if(decimals > 0)
+    {
+        *--p = '.';
+    }
+    do
+    {
+        *--p = char('0' + n % 10);
+        n /= 10;
+    }while(n != 0);
+    return p;
+}
+
+// rounds to the nearest integer, false if the product is too close to a tie
+// to know which way the exact decimal value rounds
+static bool roundScaled(double scaled, quint64 &n)
+{
+    double whole = floor(scaled);
+    double fraction = scaled - whole;
+    if(fabs(fraction - 0.5) <= scaled*1e-15)
+    {
+        return false;
+    }
+    n = quint64(whole) + ((fraction > 0.5) ? 1 : 0);
+    return true;
+}
+
+void ExportEngine::appendFixed(QByteArray &out, double value, int decimals)
+{
+    double scaled = fabs(value) * s_pow10[decimals];
+    quint64 n = 0;
+    // the comparison is also false for nan and inf
+    if((decimals > 9) || !(scaled < 1e15) || !roundScaled(scaled, n))
+    {
+        out += QByteArray::number(value, 'f', decimals);
+        return;
+    }
+    char buffer[32];
+    char *end = buffer + sizeof(buffer);
+    char *p = formatDigits(end, n, decimals);
+    if(value < 0)
+    {
+        *--p = '-';
+    }
+    out.append(p, int(end - p));
+}
+
+void ExportEngine::appendGeneral(QByteArray &out, double value, int precision)
+{
+    double magnitude = fabs(value);
+    if(magnitude == 0)
+    {
+        out += '0';
+        return;
+    }
+    if((precision < 1) || (precision > 12) || !(magnitude >= 1e-4) || !(magnitude < 1e15))
+    {
+        out += QByteArray::number(value, 'g', precision);
+        return;
+    }
+    int exponent = int(floor(log10(magnitude)));
+    int decimals = precision - 1 - exponent;
+    if(decimals < 0)
+    {
+        out += QByteArray::number(value, 'g', precision);
+        return;
+    }
+    quint64 n = 0;
+    if(!roundScaled(magnitude * s_pow10[decimals], n))
+    {
+        out += QByteArray::number(value, 'g', precision);
+        return;
+    }
+    // log10 may be one off near powers of ten, rounding may carry into the next one
+    if(n >= quint64(s_pow10[precision]))
+    {
+        exponent++;
+        decimals--;
+    }else if(n < quint64(s_pow10[precision-1]))
+    {
+        exponent--;
+        decimals++;
+    }
+    if((exponent < -4) || (exponent >= precision) || !roundScaled(magnitude * s_pow10[decimals], n))
+    {
+        out += QByteArray::number(value, 'g', precision);
+        return;
+    }
+
+    char buffer[32];
+    char *end = buffer + sizeof(buffer);
+    char *p = formatDigits(end, n, decimals);
+    if(decimals > 0)
+    {
+        while(*(end-1) == '0')
+        {
+            --end;
+        }
+        if(*(end-1) == '.')
+        {
+            --end;
+        }
+    }
+    if(value < 0)
+    {
+        *--p = '-';
+    }
+    out.append(p, int(end - p));
+}
+
+static bool flushBuffer(QFile &file, QByteArray &buffer, bool force)
+{
+    if(!force && (buffer.size() < EXPORT_BLOCK_SIZE))
+    {
+        return true;
+    }
+    bool result = (file.write(buffer) == buffer.size());
+    buffer.resize(0);
+    return result;
+}
+
+static void appendTouchstoneValue(QByteArray &out, double value, bool valid)
+{
+    if(valid)
+    {
+        ExportEngine::appendGeneral(out, value, 4);
+    }else
+    {
+        out += '0';
+    }
+}
+
+static bool writeTouchstone(QFile &file, const QVector <rawData> &data, int type, double Rswr)
+{
+    QByteArray out;
+    out.reserve(EXPORT_BLOCK_SIZE + 256);
+
+    QByteArray R = QByteArray::number(Rswr);
+    out += "! Touchstone file generated by AntScope2\n";
+    if(type == ExportEngine::TouchstoneZRI)
+    {
+        out += "# MHz Z RI R " + R + "\n";
+        out += "! Format: Frequency Z-real Z-imaginary (normalized to " + R + " Ohm)\n";
+    }else if(type == ExportEngine::TouchstoneSRI)
+    {
+        out += "# MHz S RI R " + R + "\n";
+        out += "! Format: Frequency S-real S-imaginary (normalized to " + R + " Ohm)\n";
+    }else if(type == ExportEngine::TouchstoneSMA)
+    {
+        out += "# MHz S MA R " + R + "\n";
+        out += "! Format: Frequency S-magnitude S-angle (normalized to " + R + " Ohm, angle in degrees)\n";
+    }
+
+    for(int i = 0; i < data.size(); ++i)
+    {
+        const rawData &point = data.at(i);
+        ExportEngine::appendFixed(out, point.fq, 6);
+        out += ' ';
+
+        double X = point.x;
+        double R = point.r;
+        if(type == ExportEngine::TouchstoneZRI)
+        {
+            appendTouchstoneValue(out, R/Rswr, !qIsNaN(R));
+            out += ' ';
+            appendTouchstoneValue(out, X/Rswr, !qIsNaN(X));
+        }else
+        {
+            double Gre = (R*R-Rswr*Rswr+X*X)/((R+Rswr)*(R+Rswr)+X*X);
+            double Gim = (2*Rswr*X)/((R+Rswr)*(R+Rswr)+X*X);
+            if(type == ExportEngine::TouchstoneSRI)
+            {
+                appendTouchstoneValue(out, Gre, !qIsNaN(Gre));
+                out += ' ';
+                appendTouchstoneValue(out, Gim, !qIsNaN(Gim));
+            }else
+            {
+                appendTouchstoneValue(out, sqrt(Gre*Gre+Gim*Gim), !qIsNaN(Gre));
+                out += ' ';
+                appendTouchstoneValue(out, atan2(Gim,Gre)/3.1415926*180.0, !qIsNaN(Gim));
+            }
+        }
+        out += '\n';
+        if(!flushBuffer(file, out, false))
+        {
+            return false;
+        }
+    }
+    return flushBuffer(file, out, true);
+}
+
+// .csv and .nwl, frequency and series R, X in Ohm
+static bool writeColumns(QFile &file, const QVector <rawData> &data, const char *header, char separator)
+{
+    QByteArray out;
+    out.reserve(EXPORT_BLOCK_SIZE + 256);
+    out += header;
+    out += "\r\n";
+    for(int i = 0; i < data.size(); ++i)
+    {
+        const rawData &point = data.at(i);
+        ExportEngine::appendFixed(out, point.fq, 6);
+        out += separator;
+        ExportEngine::appendFixed(out, point.r, 2);
+        out += separator;
+        ExportEngine::appendFixed(out, point.x, 2);
+        out += "\r\n";
+        if(!flushBuffer(file, out, false))
+        {
+            return false;
+        }
+    }
+    return flushBuffer(file, out, true);
+}
+
+static bool writeJson(QFile &file, const QVector <rawData> &data)
+{
+    QJsonObject mainObj;
+    mainObj["DotsNumber"] = data.length();
+
+    QJsonArray measurementsArray;
+    for(int i = 0; i < data.length(); ++i)
+    {
+        QJsonObject obj;
+        data.at(i).write(obj);
+        measurementsArray.append(obj);
+    }
+    mainObj["Measurements"] = measurementsArray;
+
+    QByteArray json = QJsonDocument(mainObj).toJson();
+    return file.write(json) == json.size();
+}
+
+static bool setError(QString *error, const QString &text)
+{
+    if(error != NULL)
+    {
+        *error = text;
+    }
+    return false;
+}
+
+bool ExportEngine::write(const ExportItem &item, QString *error)
+{
+    ExportData loaded;
+    const ExportData *data = &item.data;
+    if(!item.source.isEmpty())
+    {
+        if(!load(item.source, loaded, error))
+        {
+            return false;
+        }
+        data = &loaded;
+    }
+    // files saved without calibration have no calibrated column
+    bool calibrated = item.calibrationEnabled &&
+                      (item.source.isEmpty() || !data->dataRXCalib.isEmpty());
+    const QVector <rawData> &column = calibrated ? data->dataRXCalib : data->dataRX;
+
+    QString suffix = QFileInfo(item.target).suffix().toLower();
+    if(suffix == "asb")
+    {
+        if(!MeasurementFile::save(item.target, data->fq, data->sw, data->dots, data->dataRX,
+                                  data->dataRXCalib, item.Z0, item.calibrationEnabled))
+        {
+            return setError(error, tr("Couldn't write %1.").arg(item.target));
+        }
+        return true;
+    }
+    if((suffix != "s1p") && (suffix != "csv") && (suffix != "nwl") && (suffix != "asd"))
+    {
+        return setError(error, tr("Unknown export format '%1'.").arg(suffix));
+    }
+
+    QFile file(item.target);
+    QIODevice::OpenMode mode = QIODevice::WriteOnly | QIODevice::Truncate;
+    if(suffix == "s1p")
+    {
+        mode |= QIODevice::Text;
+    }
+    if(!file.open(mode))
+    {
+        return setError(error, file.errorString());
+    }
+
+    bool result = false;
+    if(suffix == "s1p")
+    {
+        result = writeTouchstone(file, column, item.type, item.Z0);
+    }else if(suffix == "csv")
+    {
+        result = writeColumns(file, column, "#Frequency(MHz);R;X", ',');
+    }else if(suffix == "nwl")
+    {
+        result = writeColumns(file, column, "/\"Freq(MHz)\" \"Rs\" \"Xs\"/", ' ');
+    }else
+    {
+        result = writeJson(file, column);
+    }
+    if(!result)
+    {
+        return setError(error, file.errorString());
+    }
+    return true;
+}
+
+bool ExportEngine::load(const QString &path, ExportData &data, QString *error)
+{
+    QString suffix = QFileInfo(path).suffix().toLower();
+    if(suffix == "asb")
+    {
+        MeasurementFile file;
+        if(!file.open(path))
+        {
+            return setError(error, file.errorString());
+        }
+        data.fq = file.fq();
+        data.sw = file.sw();
+        data.dots = file.sweepDots();
+        data.dataRX.resize(file.dots());
+        for(int i = 0; i < file.dots(); ++i)
+        {
+            data.dataRX[i] = file.point(i);
+        }
+        if(file.hasCalibrated())
+        {
+            data.dataRXCalib.resize(file.dots());
+            for(int i = 0; i < file.dots(); ++i)
+            {
+                data.dataRXCalib[i] = file.point(i, true);
+            }
+        }
+        return true;
+    }
+    if(suffix != "asd")
+    {
+        return setError(error, tr("Unknown measurement format '%1'.").arg(suffix));
+    }
+
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return setError(error, file.errorString());
+    }
+    QJsonArray measureArray = QJsonDocument::fromJson(file.readAll()).object()["Measurements"].toArray();
+    data.dots = measureArray.size();
+    data.dataRX.resize(measureArray.size());
+    for(int i = 0; i < measureArray.size(); ++i)
+    {
+        data.dataRX[i].read(measureArray[i].toObject());
+    }
+    return true;
+}
+
+struct ExportFunctor
+{
+    typedef QString result_type;
+
+    QString operator()(const ExportItem &item) const
+    {
+        QString error;
+        if(ExportEngine::write(item, &error))
+        {
+            return QString();
+        }
+        return QString("%1: %2").arg(QFileInfo(item.target).fileName(), error);
+    }
+};
+
+ExportJob::ExportJob(QObject *parent) :
+    QObject(parent),
+    m_total(0)
+{
+    connect(&m_watcher, SIGNAL(progressValueChanged(int)), this, SLOT(on_progressValueChanged(int)));
+    connect(&m_watcher, SIGNAL(finished()), this, SLOT(on_finished()));
+}
+
+ExportJob::~ExportJob()
+{
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+}
+
+void ExportJob::start(const QList<ExportItem> &items)
+{
+    if(isRunning())
+    {
+        return;
+    }
+    m_errors.clear();
+    m_total = items.size();
+    emit progress(0, m_total);
+    m_watcher.setFuture(QtConcurrent::mapped(items, ExportFunctor()));
+}
+
+void ExportJob::cancel()
+{
+    m_watcher.cancel();
+}
+
+bool ExportJob::isRunning() const
+{
+    return m_watcher.isRunning();
+}
+
+void ExportJob::on_progressValueChanged(int value)
+{
+    emit progress(value, m_total);
+}
+
+void ExportJob::on_finished()
+{
+    QFuture<QString> future = m_watcher.future();
+    for(int i = 0; i < future.resultCount(); ++i)
+    {
+        QString error = future.resultAt(i);
+        if(!error.isEmpty())
+        {
+            m_errors.append(error);
+        }
+    }
+    emit finished();
+}
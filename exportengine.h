@@ -0,0 +1,89 @@
+#ifndef EXPORTENGINE_H
+#define EXPORTENGINE_H
+
+#include <QObject>
+#include <QCoreApplication>
+#include <QList>
+#include <QStringList>
+#include <QFutureWatcher>
+#include <analyzer/analyzerparameters.h>
+
+// The part of a measurement an export writes: sweep parameters as in
+// measurement and the raw and calibrated points.
+struct ExportData
+{
+    qint64 fq;
+    qint64 sw;
+    qint64 dots;
+    QVector <rawData> dataRX;
+    QVector <rawData> dataRXCalib;
+
+    ExportData() : fq(0), sw(0), dots(0) {}
+};
+
+// One file to write. The raw columns are implicitly shared copies, so a
+// measurement can keep growing on the GUI thread while it is exported.
+struct ExportItem
+{
+    QString source;             // .asd/.asb file to convert, empty if data is filled
+    QString target;             // the extension selects the format
+    int type;                   // Touchstone flavour, ExportEngine::TouchstoneType
+    double Z0;
+    bool calibrationEnabled;    // text formats write the calibrated column
+    ExportData data;
+
+    ExportItem() : type(0), Z0(50), calibrationEnabled(false) {}
+};
+
+// Writes .s1p, .csv, .nwl, .asd and .asb files. Numbers are formatted by a
+// locale independent formatter straight into a buffer that goes to the file
+// in large blocks. write() is reentrant and used from the export threads.
+class ExportEngine
+{
+    Q_DECLARE_TR_FUNCTIONS(ExportEngine)
+public:
+    enum TouchstoneType
+    {
+        TouchstoneZRI = 0,
+        TouchstoneSRI = 1,
+        TouchstoneSMA = 2
+    };
+
+    static bool write(const ExportItem &item, QString *error = NULL);
+    static bool load(const QString &path, ExportData &data, QString *error = NULL);
+
+    // same text as QString::number(value, 'f', decimals) and (value, 'g', precision)
+    static void appendFixed(QByteArray &out, double value, int decimals);
+    static void appendGeneral(QByteArray &out, double value, int precision);
+};
+
+// Exports a list of items on the global thread pool. progress() reports the
+// number of finished files, finished() comes once everything is written or
+// the job was cancelled; errors() then has one line per failed file.
+class ExportJob : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ExportJob(QObject *parent = 0);
+    ~ExportJob();
+
+    void start(const QList<ExportItem> &items);
+    void cancel();
+    bool isRunning() const;
+    QStringList errors() const { return m_errors; }
+
+signals:
+    void progress(int done, int total);
+    void finished();
+
+private slots:
+    void on_progressValueChanged(int value);
+    void on_finished();
+
+private:
+    QFutureWatcher<QString> m_watcher;
+    QStringList m_errors;
+    int m_total;
+};
+
+#endif // EXPORTENGINE_H
@@ -33,7 +33,16 @@ MainWindow::MainWindow(QWidget *parent) :
     m_autoDetectMode(true),
     m_languageNumber(0),
     m_addingMarker(false),
-    m_bInterrupted(false)
+    m_bInterrupted(false),
+    m_sweepJournal(NULL),
+    m_sweepJournalEnabled(false),
+    m_journalRun(0),
+    m_catalog(NULL),
+    m_catalogEnabled(false),
+    m_waterfall(NULL),
+    m_zoomSweep(true),
+    m_zoomSweeping(false),
+    m_zoomPending(false)
 {
     ui->setupUi(this);
 
@@ -122,8 +131,7 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->singleStart->setStyleSheet(style);
     ui->continuousStartBtn->setStyleSheet(style);
 
-    ui->tableWidget_measurments->setColumnCount(1);
-    ui->tableWidget_measurments->setSelectionBehavior(QAbstractItemView::SelectRows );
+    ui->tableView_measurments->setSelectionBehavior(QAbstractItemView::SelectRows );
 
     style = "QGroupBox {border: 2px solid rgb(1, 178, 255); margin-top: 1ex;}"
             "QGroupBox::title {"
@@ -169,6 +177,7 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(m_analyzer,SIGNAL(analyzerDisconnected()),this,SLOT(on_analyzerDisconnected()));
     connect(this,SIGNAL(measure(qint64,qint64,int)),m_analyzer,SLOT(on_measure(qint64,qint64,int)));
     connect(this,SIGNAL(measureContinuous(qint64,qint64,int)),m_analyzer,SLOT(on_measureContinuous(qint64,qint64,int)));
+    connect(this,SIGNAL(measureSegment(qint64,qint64,int)),m_analyzer,SLOT(on_measureSegment(qint64,qint64,int)));
     connect(m_analyzer,SIGNAL(measurementComplete()),this,SLOT(on_measurementComplete()), Qt::QueuedConnection);
     connect(this,SIGNAL(stopMeasure()), m_analyzer, SLOT(on_stopMeasure()));
 
@@ -202,6 +211,9 @@ MainWindow::MainWindow(QWidget *parent) :
     QShortcut *shortF10 = new QShortcut(QKeySequence("F10"),this);
     connect(shortF10,SIGNAL(activated()),this,SLOT(on_pressF10()));
 
+    QShortcut *shortF11 = new QShortcut(QKeySequence("F11"),this);
+    connect(shortF11,SIGNAL(activated()),this,SLOT(on_pressF11()));
+
     QShortcut *shortDelete = new QShortcut(QKeySequence("Delete"),this);
     connect(shortDelete,SIGNAL(activated()),this,SLOT(on_pressDelete()));
 
@@ -252,7 +264,7 @@ MainWindow::MainWindow(QWidget *parent) :
                                m_rlWidget,
                                m_tdrWidget,
                                m_smithWidget,
-                               ui->tableWidget_measurments);
+                               ui->tableView_measurments);
     connect(m_analyzer, SIGNAL(newData(rawData)), m_measurements, SLOT(on_newDataRedraw(rawData)));
     connect(m_analyzer, SIGNAL(newMeasurement(QString)), m_measurements, SLOT(on_newMeasurement(QString)));
     connect(m_analyzer, SIGNAL(continueMeasurement(qint64, qint64, qint32)), m_measurements, SLOT(on_continueMeasurement(qint64, qint64, qint32)));
@@ -263,6 +275,7 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(this, SIGNAL(mainWindowPos(int,int)), m_measurements,SLOT(on_mainWindowPos(int,int)));
     connect(m_measurements, SIGNAL(calibrationChanged()), this,SLOT(on_calibrationChanged()));
     connect(m_measurements, &Measurements::import_finished, this, &MainWindow::on_importFinished);
+    connect(m_measurements, &Measurements::sessionSettingsLoaded, this, &MainWindow::on_sessionSettingsLoaded);
 
     QString name = "AntScope2 v." + QString(ANTSCOPE2VER);
     name += tr(" - Analyzer not connected");
@@ -294,6 +307,11 @@ MainWindow::MainWindow(QWidget *parent) :
     m_calibration->start();
     connect(m_calibration,SIGNAL(setCalibrationMode(bool)),
             m_analyzer,SLOT(setCalibrationMode(bool)));
+    // the calibration picks the band set that covers the sweep
+    connect(this,SIGNAL(measure(qint64,qint64,int)),
+            m_calibration,SLOT(on_sweepRange(qint64,qint64,int)));
+    connect(this,SIGNAL(measureContinuous(qint64,qint64,int)),
+            m_calibration,SLOT(on_sweepRange(qint64,qint64,int)));
     connect(m_calibration,SIGNAL(setCalibrationMode(bool)),
             m_measurements,SLOT(setCalibrationMode(bool)));
     m_measurements->setCalibration(m_calibration);
@@ -318,6 +336,8 @@ MainWindow::MainWindow(QWidget *parent) :
 
     QSettings settings1 ("HKEY_CLASSES_ROOT", QSettings::NativeFormat);
     settings1.setValue (".asd/.", "AntScope2.file");
+    settings1.setValue (".asb/.", "AntScope2.file");
+    settings1.setValue (".asz/.", "AntScope2.file");
     settings1.setValue ("AntScope2.file/.", tr("File of AntScope2"));
     settings1.setValue ("AntScope2.file/shell/open/command/.",
                         "\"" + QDir::toNativeSeparators (QCoreApplication::applicationFilePath()) + "\"" + " \"%1\"");
@@ -383,10 +403,22 @@ MainWindow::MainWindow(QWidget *parent) :
     m_autoUpdateEnabled = m_settings->value("autoUpdate", true).toBool();
     m_autoDetectMode = m_settings->value("autoDetectMode",true).toBool();
     m_serialPort = m_settings->value("serialPort","").toString();
+    m_sweepJournalEnabled = m_settings->value("sweepJournal", false).toBool();
+    m_catalogEnabled = m_settings->value("catalog", false).toBool();
+    m_catalogAntenna = m_settings->value("catalogAntenna", "").toString();
+    m_tuning.setRate(m_settings->value("tuningRate", TUNING_RATE).toDouble());
+    m_zoomSweep = m_settings->value("zoomSweep", true).toBool();
 
     m_analyzer->on_changedAutoDetectMode(m_autoDetectMode);
     m_analyzer->on_changedSerialPort(m_serialPort);
 
+    m_sweepJournal = new SweepJournal(this);
+    on_sweepJournalChanged(m_sweepJournalEnabled);
+    QTimer::singleShot(0, this, SLOT(recoverJournal()));
+
+    m_catalog = new SweepCatalog();
+    on_catalogChanged(m_catalogEnabled);
+
     /* ???
     m_swrZoomState = m_settings->value("swrZoomState", 10).toInt();
     m_phaseZoomState = m_settings->value("phaseZoomState", 10).toInt();
@@ -520,6 +552,10 @@ MainWindow::~MainWindow()
     {
         delete m_updateDialog;
     }
+    if(m_catalog)
+    {
+        delete m_catalog;
+    }
     m_settings->beginGroup("MainWindow");
     m_settings->setValue("geometry", this->geometry());
     m_settings->setValue("fullScreen", this->isMaximized());
@@ -547,6 +583,12 @@ MainWindow::~MainWindow()
     m_settings->setValue("autoUpdate", m_autoUpdateEnabled);
     m_settings->setValue("autoDetectMode", m_autoDetectMode);
     m_settings->setValue("serialPort",m_serialPort);
+    m_settings->setValue("sweepJournal", m_sweepJournalEnabled);
+    m_settings->setValue("sweepJournalRun", 0);
+    m_settings->setValue("catalog", m_catalogEnabled);
+    m_settings->setValue("catalogAntenna", m_catalogAntenna);
+    m_settings->setValue("tuningRate", m_tuning.rate());
+    m_settings->setValue("zoomSweep", m_zoomSweep);
 
     m_settings->setValue("swrZoomState", m_swrZoomState);
     m_settings->setValue("phaseZoomState", m_phaseZoomState);
@@ -659,6 +701,18 @@ void MainWindow::setWidgetsSettings()
         }
     }
 
+    // band shading and the Smith grid live on a cached layer between grid and graphs,
+    // the traces are rasterized off the GUI thread
+    QList<QCustomPlot*> widgets;
+    widgets << m_swrWidget << m_phaseWidget << m_rsWidget << m_rpWidget
+            << m_rlWidget << m_tdrWidget << m_smithWidget;
+    foreach (QCustomPlot *widget, widgets)
+    {
+        widget->addLayer("static", widget->layer("grid"), QCustomPlot::limAbove);
+        widget->setCachedLayer(widget->layer("static"));
+        widget->setRenderMode(QCustomPlot::rmThreaded);
+    }
+
     //-------SWR Widget---------------------------------------------
     m_swrWidget->addGraph();//graph(0) - SWR
     setBands(m_swrWidget, bands, MIN_SWR, MAX_SWR);
@@ -839,6 +893,7 @@ void MainWindow::setBands(QCustomPlot * widget, QStringList* bands, double y1, d
 void MainWindow::addBand (QCustomPlot * widget, double x1, double x2, double y1, double y2)
 {
     QCPItemRect * xRectItem = new QCPItemRect( widget );
+    xRectItem->setLayer("static");
     m_itemRectList.append(xRectItem);
 
     xRectItem->setVisible          (true);
@@ -908,6 +963,11 @@ void MainWindow::on_pressF10 ()
     ui->continuousStartBtn->setChecked(!ui->continuousStartBtn->isChecked());
 }
 
+void MainWindow::on_pressF11 ()
+{
+    ui->tuningCheckBox->toggle();
+}
+
 void MainWindow::on_pressDelete ()
 {
     emit on_measurmentsDeleteBtn_clicked();
@@ -1139,6 +1199,7 @@ void MainWindow::on_pressPlus ()
         }
         m_tdrWidget->replot();
     }
+    sweepZoomWindow();
 }
 
 void MainWindow::on_pressCtrlPlus ()
@@ -1449,6 +1510,7 @@ void MainWindow::on_pressMinus ()
         }
         m_tdrWidget->replot();
     }
+    sweepZoomWindow();
 }
 
 void MainWindow::on_pressCtrlMinus ()
@@ -1789,6 +1851,7 @@ void MainWindow::on_pressLeft()
         }
         m_tdrWidget->replot();
     }
+    sweepZoomWindow();
 }
 
 void MainWindow::on_pressRight()
@@ -1975,6 +2038,7 @@ void MainWindow::on_pressRight()
         }
         m_tdrWidget->replot();
     }
+    sweepZoomWindow();
 }
 
 void MainWindow::on_pressCtrlC ()
@@ -2005,6 +2069,8 @@ void MainWindow::on_pressCtrlC ()
         plot = m_smithWidget;
     }
 
+    // draw synchronously, a threaded frame might still be in flight
+    plot->replot(QCustomPlot::rpImmediate);
     QPixmap pixmap = plot->grab();
     QClipboard *pClipboard = QApplication::clipboard();
     pClipboard->setPixmap(pixmap);
@@ -2104,11 +2170,10 @@ void MainWindow::on_mouseMove_swr(QMouseEvent *e)
     {
         if(y >= m_swrWidget->yAxis->range().lower && y <= m_swrWidget->yAxis->range().upper)
         {
-            QList <QTableWidgetItem *> list = ui->tableWidget_measurments->selectedItems();
-            if(!list.isEmpty())
+            int row = selectedMeasurementRow();
+            if(row >= 0)
             {
-                QTableWidgetItem * item = list.at(0);
-                emit newCursorFq(x, item->row(), QCursor::pos().x(), QCursor::pos().y());
+                emit newCursorFq(x, row, QCursor::pos().x(), QCursor::pos().y());
             }
         }
     }
@@ -2174,11 +2239,10 @@ void MainWindow::on_mouseMove_phase(QMouseEvent *e)
     {
         if(y >= m_phaseWidget->yAxis->range().lower && y <= m_phaseWidget->yAxis->range().upper)
         {
-            QList <QTableWidgetItem *> list = ui->tableWidget_measurments->selectedItems();
-            if(!list.isEmpty())
+            int row = selectedMeasurementRow();
+            if(row >= 0)
             {
-                QTableWidgetItem * item = list.at(0);
-                emit newCursorFq(x, item->row(), QCursor::pos().x(), QCursor::pos().y());
+                emit newCursorFq(x, row, QCursor::pos().x(), QCursor::pos().y());
             }
         }
     }
@@ -2284,11 +2348,10 @@ void MainWindow::on_mouseMove_rs(QMouseEvent *e)
     {
         if(y >= m_rsWidget->yAxis->range().lower && y <= m_rsWidget->yAxis->range().upper)
         {
-            QList <QTableWidgetItem *> list = ui->tableWidget_measurments->selectedItems();
-            if(!list.isEmpty())
+            int row = selectedMeasurementRow();
+            if(row >= 0)
             {
-                QTableWidgetItem * item = list.at(0);
-                emit newCursorFq(x, item->row(), QCursor::pos().x(), QCursor::pos().y());
+                emit newCursorFq(x, row, QCursor::pos().x(), QCursor::pos().y());
             }
         }
     }
@@ -2393,11 +2456,10 @@ void MainWindow::on_mouseMove_rp(QMouseEvent *e)
     {
         if(y >= m_rpWidget->yAxis->range().lower && y <= m_rpWidget->yAxis->range().upper)
         {
-            QList <QTableWidgetItem *> list = ui->tableWidget_measurments->selectedItems();
-            if(!list.isEmpty())
+            int row = selectedMeasurementRow();
+            if(row >= 0)
             {
-                QTableWidgetItem * item = list.at(0);
-                emit newCursorFq(x, item->row(), QCursor::pos().x(), QCursor::pos().y());
+                emit newCursorFq(x, row, QCursor::pos().x(), QCursor::pos().y());
             }
         }
     }
@@ -2489,11 +2551,10 @@ void MainWindow::on_mouseMove_rl(QMouseEvent *e)
     {
         if(y >= m_rlWidget->yAxis->range().lower && y <= m_rlWidget->yAxis->range().upper)
         {
-            QList <QTableWidgetItem *> list = ui->tableWidget_measurments->selectedItems();
-            if(!list.isEmpty())
+            int row = selectedMeasurementRow();
+            if(row >= 0)
             {
-                QTableWidgetItem * item = list.at(0);
-                emit newCursorFq(x, item->row(), QCursor::pos().x(), QCursor::pos().y());
+                emit newCursorFq(x, row, QCursor::pos().x(), QCursor::pos().y());
             }
         }
     }
@@ -2559,11 +2620,10 @@ void MainWindow::on_mouseMove_tdr(QMouseEvent * e)
     double x = m_tdrWidget->xAxis->pixelToCoord(e->pos().x());
     if( (x >= m_tdrWidget->xAxis->range().lower) && (x <= m_tdrWidget->xAxis->range().upper))
     {
-        QList <QTableWidgetItem *> list = ui->tableWidget_measurments->selectedItems();
-        if(!list.isEmpty())
+        int row = selectedMeasurementRow();
+        if(row >= 0)
         {
-            QTableWidgetItem * item = list.at(0);
-            emit newCursorFq(x, item->row(), e->pos().x(), e->pos().y());
+            emit newCursorFq(x, row, e->pos().x(), e->pos().y());
         }
     }
 }
@@ -2572,11 +2632,10 @@ void MainWindow::on_mouseMove_smith(QMouseEvent * e)
 {
     double x = m_smithWidget->xAxis->pixelToCoord(e->pos().x());
     double y = m_smithWidget->yAxis->pixelToCoord(e->pos().y());
-    QList <QTableWidgetItem *> list = ui->tableWidget_measurments->selectedItems();
-    if(!list.isEmpty())
+    int row = selectedMeasurementRow();
+    if(row >= 0)
     {
-        QTableWidgetItem * item = list.at(0);
-        emit newCursorSmithPos( x, y, item->row());
+        emit newCursorSmithPos( x, y, row);
     }
 }
 
@@ -2815,14 +2874,13 @@ void MainWindow::on_pressetsUpBtn_clicked()
 
 void MainWindow::on_exportBtn_clicked()
 {
-    QList <QTableWidgetItem *> list = ui->tableWidget_measurments->selectedItems();
-    if(!list.isEmpty())
+    int row = selectedMeasurementRow();
+    if(row >= 0)
     {
-        QTableWidgetItem * item = list.at(0);
         m_exportDialog = new Export(this);
         m_exportDialog->setAttribute(Qt::WA_DeleteOnClose);
         m_exportDialog->setWindowTitle(tr("Export"));
-        m_exportDialog->setMeasurements(m_measurements, item->row());
+        m_exportDialog->setMeasurements(m_measurements, row);
         m_exportDialog->exec();
     }
 }
@@ -2844,8 +2902,12 @@ void MainWindow::on_tabWidget_currentChanged(int index)
 {
     Q_UNUSED(index)
     QString str = ui->tabWidget->currentWidget()->objectName();
-    updateGraph();
-    emit currentTab (str);    
+    if(str == "tab_7")
+    {
+        resizeWnd();
+    }
+    // Measurements rebuilds the tab if it went stale while hidden and replots it once
+    emit currentTab (str);
     QTimer::singleShot(20, m_markers, SLOT(redraw()));
 }
 
@@ -3060,7 +3122,13 @@ void MainWindow::on_continuousStartBtn_clicked(bool checked)
         m_settings->setValue("dotsNumber", m_dotsNumber);
         m_settings->endGroup();
 
-        emit measure(start*1000, stop*1000, m_dotsNumber);
+        int dots = m_dotsNumber;
+        if(ui->tuningCheckBox->isChecked())
+        {
+            startTuning(start, stop);
+            dots = m_tuning.window().dots;
+        }
+        emit measure(start*1000, stop*1000, dots);
         ui->measurmentsSaveBtn->setEnabled(true);
         ui->exportBtn->setEnabled(true);
         ui->measurmentsDeleteBtn->setEnabled(false);
@@ -3075,6 +3143,29 @@ void MainWindow::on_continuousStartBtn_clicked(bool checked)
 void MainWindow::on_measurementComplete()
 {    
     QTimer::singleShot(5, m_markers, SLOT(redraw()));
+    if(m_zoomSweeping)
+    {
+        m_measurements->endMerge();
+        if(!m_bInterrupted && !m_zoomPlanner.isEmpty())
+        {
+            nextZoomSegment();
+            return;
+        }
+        m_zoomSweeping = false;
+        m_zoomPlanner.clear();
+        ui->measurmentsDeleteBtn->setEnabled(true);
+        ui->measurmentsClearBtn->setEnabled(true);
+        m_analyzer->setIsMeasuring(false);
+        PopUpIndicator::setIndicatorVisible(false);
+        bool pending = m_zoomPending && !m_bInterrupted;
+        m_zoomPending = false;
+        m_bInterrupted = true;
+        if(pending)
+        {
+            sweepZoomWindow();
+        }
+        return;
+    }
     if(m_isContinuos)
     {
         double start;
@@ -3114,6 +3205,26 @@ void MainWindow::on_measurementComplete()
                 setFqFrom((stop+start)/2);
             }
         }
+        int dots = m_dotsNumber;
+        if(ui->tuningCheckBox->isChecked() && !m_bInterrupted)
+        {
+            // the tracker is current with the last point, so the next window
+            // is ready as soon as the sweep ends
+            const TuningWindow &window = m_tuning.next(m_measurements->trackerResult(),
+                                                       m_tuningTimer.restart());
+            start = window.fqFrom;
+            stop = window.fqTo;
+            dots = window.dots;
+            if(!m_isRange)
+            {
+                setFqFrom(start);
+                setFqTo(stop);
+            }else
+            {
+                setFqFrom((stop+start)/2);
+                setFqTo((stop-start)/2);
+            }
+        }
         QCPRange range(start, stop);
         m_swrWidget->xAxis->setRange(range);
         m_phaseWidget->xAxis->setRange(range);
@@ -3122,9 +3233,32 @@ void MainWindow::on_measurementComplete()
         m_rlWidget->xAxis->setRange(range);
         if (!m_bInterrupted)
         {
-            emit measureContinuous(start*1000, stop*1000, m_dotsNumber);
+            if(m_sweepJournal->isOpen() && (m_measurements->getMeasurementLength() > 0))
+            {
+                // queued only, the journal writes and syncs on its own thread
+                const QVector <rawData> &sweep = m_measurements->getMeasurement(0)->dataRX;
+                if(!sweep.isEmpty())
+                {
+                    if(m_journalRun == 0)
+                    {
+                        // stays set until the run ends, after a crash recoverJournal() finds it
+                        m_journalRun = QDateTime::currentMSecsSinceEpoch();
+                        m_settings->setValue("sweepJournalRun", m_journalRun);
+                        m_settings->sync();
+                    }
+                    m_sweepJournal->append(qint64(sweep.first().fq*1000000),
+                                           qint64(sweep.last().fq*1000000),
+                                           m_Z0, sweep);
+                }
+            }
+            emit measureContinuous(start*1000, stop*1000, dots);
         } else {
             m_bInterrupted = true;
+            if(m_journalRun != 0)
+            {
+                m_journalRun = 0;
+                m_settings->setValue("sweepJournalRun", 0);
+            }
             ui->measurmentsDeleteBtn->setEnabled(true);
             ui->measurmentsClearBtn->setEnabled(true);
             m_analyzer->setContinuos(false);
@@ -3132,6 +3266,28 @@ void MainWindow::on_measurementComplete()
             PopUpIndicator::setIndicatorVisible(false);
         }
     } else {
+        int count = m_measurements->getMeasurementLength();
+        // the sweep takes the gaps of later zooms and pans
+        m_zoomMeasurement.clear();
+        if((count > 0) && (m_measurements->getMeasurement(0)->dataRX.size() > 1))
+        {
+            m_zoomMeasurement = m_measurements->getMeasurementName(count - 1);
+        }
+        if(m_catalog->isOpen() && (count > 0) && (m_measurements->getMeasurement(0)->dataRX.size() > 1))
+        {
+            const measurement *sweep = m_measurements->getMeasurement(0);
+            SessionMeasurement item;
+            item.name = m_measurements->getMeasurementName(count - 1);
+            item.fq = sweep->qint64Fq;
+            item.sw = sweep->qint64Sw;
+            item.dots = sweep->qint64Dots;
+            item.data = sweep->dataRX;
+            item.calibrated = sweep->dataRXCalib;
+            if(m_catalog->add(item, m_catalogAntenna, m_Z0, QDateTime::currentMSecsSinceEpoch()) < 0)
+            {
+                qWarning() << "Catalog:" << m_catalog->errorString();
+            }
+        }
         m_bInterrupted = true;
         ui->singleStart->setChecked(false);
         ui->measurmentsDeleteBtn->setEnabled(true);
@@ -3197,6 +3353,8 @@ void MainWindow::on_settingsBtn_clicked()
     m_settingsDialog->setCableIndex(m_cableIndex);
     m_settingsDialog->setFirmwareAutoUpdate(m_autoFirmwareUpdateEnabled);
     m_settingsDialog->setAntScopeAutoUpdate(m_autoUpdateEnabled);
+    m_settingsDialog->setSweepJournal(m_sweepJournalEnabled);
+    m_settingsDialog->setCatalog(m_catalogEnabled);
     m_settingsDialog->setAntScopeVersion(ANTSCOPE2VER);
     m_settingsDialog->setAutoDetectMode(m_autoDetectMode, m_serialPort);
 
@@ -3277,6 +3435,9 @@ void MainWindow::on_settingsBtn_clicked()
 
     connect(m_settingsDialog,SIGNAL(antScopeAutoUpdateStateChanged(bool)),this, SLOT(on_antScopeAutoUpdateStateChanged(bool)));
 
+    connect(m_settingsDialog, SIGNAL(sweepJournalChanged(bool)), this, SLOT(on_sweepJournalChanged(bool)));
+    connect(m_settingsDialog, SIGNAL(catalogChanged(bool)), this, SLOT(on_catalogChanged(bool)));
+
     connect(m_settingsDialog, SIGNAL(changedAutoDetectMode(bool)), this, SLOT(on_changedAutoDetectMode(bool)));
 
     connect(m_settingsDialog, SIGNAL(changedSerialPort(QString)), this, SLOT(on_changedSerialPort(QString)));
@@ -3313,15 +3474,14 @@ void MainWindow::on_measurmentsDeleteBtn_clicked()
     {
         return;
     }
-    QList <QTableWidgetItem *> list = ui->tableWidget_measurments->selectedItems();
-    for(int i = 0; i < list.length(); ++i)
+    int row = selectedMeasurementRow();
+    if(row >= 0)
     {
-        QTableWidgetItem * item = list.at(i);
-        int rowNumber = item->row();
-        m_measurements->deleteRow(rowNumber);
+        m_measurements->deleteRow(row);
     }
 
-    if(ui->tableWidget_measurments->rowCount() == 0)
+    int rowCount = ui->tableView_measurments->model()->rowCount();
+    if(rowCount == 0)
     {
 //        m_settings->beginGroup("MainWindow");
 //        qint64 from = m_settings->value("rangeLower",0).toULongLong();
@@ -3340,7 +3500,7 @@ void MainWindow::on_measurmentsDeleteBtn_clicked()
     }
     else
     {
-        on_tableWidget_measurments_cellClicked(ui->tableWidget_measurments->rowCount()-1, 0);
+        selectMeasurement(rowCount-1);
     }
     if(m_markers)
     {
@@ -3357,11 +3517,9 @@ void MainWindow::on_measurementsClearBtn_clicked(bool)
         return;
     }
 
-    while(ui->tableWidget_measurments->rowCount() != 0)
+    while(ui->tableView_measurments->model()->rowCount() != 0)
     {
-        QTableWidgetItem * item = ui->tableWidget_measurments->item(0, 0);
-        int rowNumber = item->row();
-        m_measurements->deleteRow(rowNumber);
+        m_measurements->deleteRow(0);
     }
 
     //{ Antonov's request: keep user's values
@@ -3372,7 +3530,7 @@ void MainWindow::on_measurementsClearBtn_clicked(bool)
     on_dataChanged(from + range/2, range, m_dotsNumber);
     //}
 
-    if(ui->tableWidget_measurments->rowCount() == 0)
+    if(ui->tableView_measurments->model()->rowCount() == 0)
     {
         ui->measurmentsSaveBtn->setEnabled(false);
         ui->measurmentsDeleteBtn->setEnabled(false);
@@ -3467,9 +3625,22 @@ void MainWindow::on_tableWidget_measurments_cellClicked(int row, int column)
     }
 }
 #endif
-void MainWindow::on_tableWidget_measurments_cellClicked(int row, int column)
+void MainWindow::on_tableView_measurments_clicked(const QModelIndex &index)
+{
+    if(index.isValid())
+    {
+        selectMeasurement(index.row());
+    }
+}
+
+int MainWindow::selectedMeasurementRow() const
+{
+    QModelIndexList rows = ui->tableView_measurments->selectionModel()->selectedRows();
+    return rows.isEmpty() ? -1 : rows.first().row();
+}
+
+void MainWindow::selectMeasurement(int row)
 {
-    Q_UNUSED(column)
     int count = m_swrWidget->graphCount();
     if(count > 0)
     {
@@ -3629,7 +3800,7 @@ void MainWindow::on_printBtn_clicked()
         m_print->setLabel(m_swrWidget->xAxis->label(), m_swrWidget->yAxis->label());
         for(int i = 1; i < m_swrWidget->graphCount(); ++i)
         {
-            QModelIndex myIndex = ui->tableWidget_measurments->model()->
+            QModelIndex myIndex = ui->tableView_measurments->model()->
                     index( m_swrWidget->graphCount()-i-1, 0, QModelIndex());
 
             m_print->setData(m_swrWidget->graph(i)->data(), m_swrWidget->graph(i)->pen(), myIndex.data().toString());
@@ -3642,7 +3813,7 @@ void MainWindow::on_printBtn_clicked()
         m_print->setLabel(m_phaseWidget->xAxis->label(), m_phaseWidget->yAxis->label());
         for(int i = 1; i < m_phaseWidget->graphCount(); ++i)
         {
-            QModelIndex myIndex = ui->tableWidget_measurments->model()->
+            QModelIndex myIndex = ui->tableView_measurments->model()->
                     index( m_swrWidget->graphCount()-i-1, 0, QModelIndex());
 
             m_print->setData(m_phaseWidget->graph(i)->data(), m_phaseWidget->graph(i)->pen(), myIndex.data().toString());
@@ -3675,7 +3846,7 @@ void MainWindow::on_printBtn_clicked()
         m_print->setLabel(m_rlWidget->xAxis->label(), m_rlWidget->yAxis->label());
         for(int i = 1; i < m_rlWidget->graphCount(); ++i)
         {
-            QModelIndex myIndex = ui->tableWidget_measurments->model()->
+            QModelIndex myIndex = ui->tableView_measurments->model()->
                     index( m_swrWidget->graphCount()-i-1, 0, QModelIndex());
 
             m_print->setData(m_rlWidget->graph(i)->data(), m_rlWidget->graph(i)->pen(), myIndex.data().toString());
@@ -3699,7 +3870,7 @@ void MainWindow::on_printBtn_clicked()
 
         for(int i = 0; i < m_measurements->getMeasurementLength(); ++i)
         {
-            QModelIndex myIndex = ui->tableWidget_measurments->model()->
+            QModelIndex myIndex = ui->tableView_measurments->model()->
                                 index( m_smithWidget->graphCount()-i-1, 0, QModelIndex());
             m_print->setSmithData(&m_measurements->getMeasurement(i)->smithGraph,
                                   m_measurements->getMeasurement(i)->smithCurve->pen(),//m_smithWidget->graph(i)->pen(),
@@ -3723,28 +3894,29 @@ void MainWindow::on_printBtn_clicked()
 
 void MainWindow::on_measurmentsSaveBtn_clicked()
 {
-    QList <QTableWidgetItem *> list = ui->tableWidget_measurments->selectedItems();
+    int row = selectedMeasurementRow();
 
-    if(!list.isEmpty())
+    if(row >= 0)
     {
         if(m_lastSavePath.indexOf('.') >= 0)
         {
             m_lastSavePath.remove(m_lastSavePath.indexOf('.'),4);
             m_lastSavePath.append(".asd");
         }
-        QString path = QFileDialog::getSaveFileName(this, "Save file", m_lastSavePath, "AntScope2 (*.asd )");
+        QString path = QFileDialog::getSaveFileName(this, "Save file", m_lastSavePath, "AntScope2 (*.asd );;"
+                                                                                        "AntScope2 binary (*.asb );;"
+                                                                                        "AntScope2 session, all measurements (*.asz )");
         if(!path.isEmpty())
         {
             m_lastSavePath = path;
-            QTableWidgetItem * item = list.at(0);
-            m_measurements->saveData(item->row(), path);
+            m_measurements->saveData(row, path);
         }
     }
 }
 
 void MainWindow::on_measurementsOpenBtn_clicked()
 {
-    QString path = QFileDialog::getOpenFileName(this, "Open file", m_lastOpenPath, "AntScope2 (*.asd )");
+    QString path = QFileDialog::getOpenFileName(this, "Open file", m_lastOpenPath, "AntScope2 (*.asd *.asb *.asz )");
     if(!path.isEmpty())
     {
         m_lastSavePath = path;
@@ -3768,11 +3940,11 @@ void MainWindow::openFile(QString path)
 
 void MainWindow::on_importBtn_clicked()
 {
-    QString path = QFileDialog::getOpenFileName(this, "Open file", m_lastOpenPath,  "S1p (*.s1p);;"
+    QString path = QFileDialog::getOpenFileName(this, "Open file", m_lastOpenPath,  "Touchstone (*.s1p *.s2p);;"
                                                                                     "Csv (*.csv);;"
                                                                                     "Nwl (*.nwl);;"
                                                                                     "AntScope1 (*.antdata);;"
-                                                                                    "AntScope2 (*.asd )");
+                                                                                    "AntScope2 (*.asd *.asb *.asz )");
     m_measurements->loadData(path);
     ui->measurmentsSaveBtn->setEnabled(true);
     ui->exportBtn->setEnabled(true);
@@ -3790,6 +3962,10 @@ void MainWindow::on_Z0Changed(double _Z0)
     m_Z0 = _Z0;
     m_calibration->setZ0(m_Z0);
     m_measurements->setZ0(m_Z0);
+    if(m_waterfall != NULL)
+    {
+        m_waterfall->setZ0(m_Z0);
+    }
 }
 
 void MainWindow::updateGraph ()
@@ -4149,6 +4325,208 @@ void MainWindow::on_antScopeAutoUpdateStateChanged(bool state)
     m_autoUpdateEnabled = state;
 }
 
+void MainWindow::on_sweepJournalChanged(bool state)
+{
+    m_sweepJournalEnabled = state;
+    if(!state)
+    {
+        m_sweepJournal->close();
+    }else if(!m_sweepJournal->isOpen())
+    {
+        if(!m_sweepJournal->open(Settings::localDataPath("sweeps.asj")))
+        {
+            qWarning() << "Sweep journal:" << m_sweepJournal->errorString();
+        }
+    }
+}
+
+// offers the last sweep of a continuous run the journal recorded when
+// AntScope2 did not get to end that run
+void MainWindow::recoverJournal()
+{
+    qint64 run = m_settings->value("sweepJournalRun", 0).toLongLong();
+    if((run == 0) || !m_sweepJournal->isOpen())
+    {
+        return;
+    }
+    m_settings->setValue("sweepJournalRun", 0);
+    int first = m_sweepJournal->find(run);
+    int count = m_sweepJournal->count();
+    if(first >= count)
+    {
+        return;
+    }
+    QString last = QDateTime::fromMSecsSinceEpoch(m_sweepJournal->timestamp(count - 1))
+            .toString("yyyy-MM-dd hh:mm:ss");
+    if(QMessageBox::question(this, tr("Sweep journal"),
+                             tr("AntScope2 was closed during a continuous measurement. The sweep "
+                                "journal holds %1 sweeps of it, the last one from %2.\n"
+                                "Load the last sweep?").arg(count - first).arg(last),
+                             QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes)
+    {
+        return;
+    }
+    SweepRecord record;
+    if(!m_sweepJournal->read(count - 1, record) || record.data.isEmpty())
+    {
+        QMessageBox::information(NULL, tr("Error"), tr("Couldn't read the sweep journal."));
+        return;
+    }
+    SessionMeasurement item;
+    item.name = tr("Recovered %1").arg(last);
+    item.fq = (record.fqFrom + record.fqTo)/2;
+    item.sw = record.fqTo - record.fqFrom;
+    item.dots = record.data.size() - 1;
+    item.data = record.data;
+    m_measurements->addMeasurement(item);
+    on_importFinished(record.fqFrom/1000.0, record.fqTo/1000.0);
+    m_measurements->on_redrawGraphs();
+}
+
+void MainWindow::on_catalogChanged(bool state)
+{
+    m_catalogEnabled = state;
+    if(!state)
+    {
+        m_catalog->close();
+    }else if(!m_catalog->isOpen())
+    {
+        if(!m_catalog->open(Settings::localDataPath("catalog.asc")))
+        {
+            qWarning() << "Catalog:" << m_catalog->errorString();
+        }
+    }
+}
+
+void MainWindow::on_catalogBtn_clicked()
+{
+    if(!m_catalog->isOpen() && !m_catalog->open(Settings::localDataPath("catalog.asc")))
+    {
+        QMessageBox::information(this, tr("Error"), m_catalog->errorString());
+        return;
+    }
+    CatalogDialog dialog(m_catalog, this);
+    dialog.setAntenna(m_catalogAntenna);
+    connect(&dialog, SIGNAL(openSweep(int)), this, SLOT(on_openCatalogSweep(int)));
+    dialog.exec();
+    m_catalogAntenna = dialog.antenna();
+    if(!m_catalogEnabled)
+    {
+        m_catalog->close();
+    }
+}
+
+void MainWindow::analyzerLimits(qint64 &minFreq, qint64 &maxFreq)
+{
+    minFreq = minFq[m_analyzer->getAnalyzerModel()].toULongLong();
+    maxFreq = maxFq[m_analyzer->getAnalyzerModel()].toULongLong();
+    if (CustomAnalyzer::customized()) {
+        CustomAnalyzer* ca = CustomAnalyzer::getCurrent();
+        if (ca != nullptr) {
+            minFreq = ca->minFq().toULongLong();
+            maxFreq = ca->maxFq().toULongLong();
+        }
+    }
+}
+
+void MainWindow::startTuning(double start, double stop)
+{
+    qint64 minFreq;
+    qint64 maxFreq;
+    analyzerLimits(minFreq, maxFreq);
+    m_tuning.setLimits(minFreq, maxFreq);
+    m_tuning.start(start, stop, m_dotsNumber);
+    m_tuningTimer.start();
+}
+
+// a running continuous measurement switches over with its next sweep
+void MainWindow::on_tuningCheckBox_toggled(bool checked)
+{
+    if(checked && m_isContinuos)
+    {
+        startTuning(getFqFrom(), getFqTo());
+    }
+}
+
+// After a keyboard zoom or pan the gaps of the view are measured into the
+// single sweep on screen, at the grid the window would get from a new
+// sweep. A move while the gaps are swept is planned when they are done.
+void MainWindow::sweepZoomWindow()
+{
+    if(!m_zoomSweep || m_isContinuos || m_zoomMeasurement.isEmpty() ||
+       (ui->tabWidget->currentWidget()->objectName() == "tab_6"))
+    {
+        return;
+    }
+    int count = m_measurements->getMeasurementLength();
+    if((count == 0) || (m_measurements->getMeasurementName(count - 1) != m_zoomMeasurement))
+    {
+        return;
+    }
+    if(m_zoomSweeping)
+    {
+        m_zoomPending = true;
+        return;
+    }
+    // nothing to sweep with, or a sweep of the user's own is running
+    if(!ui->singleStart->isEnabled() || isMeasuring())
+    {
+        return;
+    }
+    qint64 minFreq;
+    qint64 maxFreq;
+    analyzerLimits(minFreq, maxFreq);
+    double from = qMax(getFqFrom(), static_cast<double>(minFreq));
+    double to = qMin(getFqTo(), static_cast<double>(maxFreq));
+    if(m_zoomPlanner.plan(m_measurements->getMeasurement(0)->dataRX, from, to, m_dotsNumber) == 0)
+    {
+        return;
+    }
+    m_zoomSweeping = true;
+    m_bInterrupted = false;
+    ui->measurmentsDeleteBtn->setEnabled(false);
+    ui->measurmentsClearBtn->setEnabled(false);
+    nextZoomSegment();
+}
+
+void MainWindow::nextZoomSegment()
+{
+    const ZoomSegment &segment = m_zoomPlanner.takeNext();
+    m_measurements->beginMerge();
+    emit measureSegment(segment.fqFrom*1000, segment.fqTo*1000, segment.dots);
+}
+
+// created on first use and kept hidden when closed, so it gathers the
+// sweeps all the time once it was opened
+void MainWindow::on_waterfallBtn_clicked()
+{
+    if(m_waterfall == NULL)
+    {
+        m_waterfall = new WaterfallDialog(this);
+        connect(m_measurements, SIGNAL(continuousSweep(QVector<rawData>)),
+                m_waterfall, SLOT(on_continuousSweep(QVector<rawData>)));
+    }
+    m_waterfall->setZ0(m_Z0);
+    m_waterfall->show();
+    m_waterfall->raise();
+}
+
+void MainWindow::on_openCatalogSweep(int index)
+{
+    SessionMeasurement item;
+    if(!m_catalog->load(index, item))
+    {
+        QMessageBox::information(this, tr("Error"), m_catalog->errorString());
+        return;
+    }
+    m_measurements->addMeasurement(item);
+    m_measurements->on_redrawGraphs();
+    ui->measurmentsSaveBtn->setEnabled(true);
+    ui->exportBtn->setEnabled(true);
+    ui->measurmentsDeleteBtn->setEnabled(true);
+    ui->measurmentsClearBtn->setEnabled(true);
+}
+
 void MainWindow::on_1secTimerTick()
 {
     QString str = ui->tabWidget->currentWidget()->objectName();
@@ -4253,7 +4631,7 @@ void MainWindow::on_calibrationChanged()
 
 void MainWindow::on_SaveFile(QString path)
 {
-    //int row = ui->tableWidget_measurments->rowCount() - 1;
+    //int row = ui->tableView_measurments->model()->rowCount() - 1;
     saveFile(0, path);
     ui->measurmentsSaveBtn->setEnabled(true);
 }
@@ -4409,6 +4787,42 @@ void MainWindow::on_importFinished(double _fqMin_khz, double _fqMax_khz)
 
 }
 
+void MainWindow::on_sessionSettingsLoaded(const SessionSettings &settings)
+{
+    on_Z0Changed(settings.Z0);
+
+    m_farEndMeasurement = settings.cable.mode;
+    m_cableLength = settings.cable.length;
+    m_cableVelFactor = settings.cable.velocityFactor;
+    m_cableResistance = settings.cable.resistance;
+    m_cableLossConductive = settings.cable.lossConductive;
+    m_cableLossDielectric = settings.cable.lossDielectric;
+    m_cableLossUnits = settings.cable.lossUnits;
+    m_cableLossAtAnyFq = settings.cable.lossAtAnyFq;
+    m_measurements->setCableVelFactor(m_cableVelFactor);
+    m_measurements->setCableResistance(m_cableResistance);
+    m_measurements->setCableLossConductive(m_cableLossConductive);
+    m_measurements->setCableLossDielectric(m_cableLossDielectric);
+    m_measurements->setCableLossUnits(m_cableLossUnits);
+    m_measurements->setCableLossAtAnyFq(m_cableLossAtAnyFq);
+    m_measurements->setCableLength(m_cableLength);
+    m_measurements->setCableFarEndMeasurement(m_farEndMeasurement);
+
+    // the calibration files of the session are not installed over the ones
+    // in use, its calibrated points are loaded but shown only with a
+    // calibration performed here
+    if(m_calibration->getCalibrationPerformed())
+    {
+        ui->checkBoxCalibration->setChecked(settings.calibrationEnabled);
+    }else if(settings.calibrationEnabled)
+    {
+        QMessageBox::information(NULL, tr("Calibration not performed"),
+                                 tr("The session was saved with calibration on. Its calibrated "
+                                    "points are loaded, but they are shown only after a calibration "
+                                    "is performed. The calibration files of the session are not installed."));
+    }
+}
+
 QString appendSpaces(const QString& str) {
     QString tmp;
     int len = str.length();
@@ -6,6 +6,7 @@
 #include <QCheckBox>
 #include <QPushButton>
 #include <QShortcut>
+#include <QElapsedTimer>
 #include <analyzer/analyzer.h>
 #include <qcustomplot.h>
 #include <presets.h>
@@ -26,6 +27,12 @@
 #include <QTranslator>
 #include <updater.h>
 #include <antscopeupdatedialog.h>
+#include <sweepjournal.h>
+#include <sweepcatalog.h>
+#include <catalogdialog.h>
+#include <waterfall.h>
+#include <core/tuningplanner.h>
+#include <core/zoomplanner.h>
 
 namespace Ui {
 class MainWindow;
@@ -141,6 +148,23 @@ private:
     bool m_autoUpdateEnabled;
     bool m_autoFirmwareUpdateEnabled;
 
+    SweepJournal * m_sweepJournal;
+    bool m_sweepJournalEnabled;
+    qint64 m_journalRun;        // time of the first journaled sweep of the running measurement, 0 if none
+    SweepCatalog * m_catalog;
+    bool m_catalogEnabled;
+    QString m_catalogAntenna;
+    WaterfallDialog * m_waterfall;
+    // continuous sweeps follow the SWR dip while tuningCheckBox is checked
+    TuningPlanner m_tuning;
+    QElapsedTimer m_tuningTimer;
+    // keyboard zoom and pan measure only what the last single sweep lacks
+    ZoomPlanner m_zoomPlanner;
+    bool m_zoomSweep;
+    bool m_zoomSweeping;
+    bool m_zoomPending;         // the view moved while the gaps were swept
+    QString m_zoomMeasurement;  // name of the single sweep the gaps go into
+
     int m_swrZoomState;
     int m_phaseZoomState;
     int m_rsZoomState;
@@ -177,8 +201,14 @@ private:
     void setFqTo(double to);
     double getFqFrom(void);
     double getFqTo(void);
+    void startTuning(double start, double stop);
+    void analyzerLimits(qint64 &minFreq, qint64 &maxFreq);
+    void sweepZoomWindow();
+    void nextZoomSegment();
     bool loadLanguage(QString locale); // locale: en, ukr, ru, jp, etc.
     void saveFile(int row, QString path);
+    int selectedMeasurementRow() const;
+    void selectMeasurement(int row);
     QCustomPlot* getCurrentPlot();
     void changeFqFrom(bool _backupValue=false);
     void changeFqTo(bool _backupValue=false);
@@ -186,6 +216,7 @@ private:
 signals:
     void measure(qint64,qint64,int);
     void measureContinuous(qint64,qint64,int);
+    void measureSegment(qint64,qint64,int);
     void currentTab(QString);
     void focus(bool);
     void newCursorFq(double x, int number, int mouseX, int mouseY);
@@ -208,6 +239,7 @@ public slots:
     void on_pressEsc();
     void on_pressF9 ();
     void on_pressF10();
+    void on_pressF11();
     void on_pressDelete();
     void on_pressPlus();
     void on_pressCtrlPlus();
@@ -249,7 +281,7 @@ private slots:
     void on_settingsBtn_clicked();
     void on_dotsNumberChanged(int number);
     void on_measurmentsDeleteBtn_clicked();
-    void on_tableWidget_measurments_cellClicked(int row, int column);
+    void on_tableView_measurments_clicked(const QModelIndex &index);
     void on_screenshot_clicked();
     void on_printBtn_clicked();
     void on_measurmentsSaveBtn_clicked();
@@ -269,6 +301,13 @@ private slots:
     void on_downloadAfterClosing();
     void on_firmwareAutoUpdateStateChanged( bool state);
     void on_antScopeAutoUpdateStateChanged( bool state);
+    void on_sweepJournalChanged(bool state);
+    void recoverJournal();
+    void on_catalogChanged(bool state);
+    void on_catalogBtn_clicked();
+    void on_openCatalogSweep(int index);
+    void on_waterfallBtn_clicked();
+    void on_tuningCheckBox_toggled(bool checked);
     void on_1secTimerTick();
     void on_changedAutoDetectMode(bool state);
     void on_changedSerialPort(QString portName);
@@ -283,6 +322,7 @@ private slots:
     void calibrationToggled(bool checked);
     void on_dataChanged(qint64 _center_khz, qint64 _range_khz, qint32 _dots);
     void on_importFinished(double _fqMin, double _fqMax);
+    void on_sessionSettingsLoaded(const SessionSettings &settings);
     void onFullRange(bool);
 };
 
@@ -241,6 +241,12 @@ void Markers::repaint()
     {
         return;
     }
+    int count = m_measurements->getMeasurementLength();
+    QVector<TraceLookup> lookups;
+    for(int i = 0; i < count; ++i)
+    {
+        lookups.append(m_measurements->traceLookup(count-1 - i));
+    }
     for(int n = 0; n < m_markersList.length(); ++n)
     {
         QVector<double> fq;
@@ -250,231 +256,36 @@ void Markers::repaint()
         QVector<double> phase;
         QVector<int> measurement;
 
-        int count = m_measurements->getMeasurementLength();
+        double frequency = m_markersList.at(n)->frequency;
         for(int i = 0; i < count; ++i)
         {
             measurement.append(i+1);
-            fq.append(m_markersList.at(n)->frequency);
-
-            double dSwr;
-            double dRl;
-            double dR;
-            double dX;
-            double dPhase;
+            fq.append(frequency);
 
-            QCPDataMap *swrMap;
-            if(m_measurements->getCalibrationEnabled())
+            TracePoint point;
+            if(!lookups.at(i).interpolate(frequency, point))
             {
-                swrMap = &m_measurements->getMeasurement(i)->swrGraphCalib;
-            }else
-            {
-                swrMap = &m_measurements->getMeasurement(i)->swrGraph;
+                continue;
             }
-            QList <double> swrKeys = swrMap->keys();
-
-            for(int ii = 0; ii < swrKeys.length()-1; ++ii)
+            swr.append(point.swr);
+            rl.append(point.rl);
+            phase.append(point.phase);
+            QString zString = QString::number(point.r,'f', 2);
+            if(point.x >= 0)
             {
-                if((swrKeys.at(ii) <= m_markersList.at(n)->frequency) && (swrKeys.at(ii+1) >= m_markersList.at(n)->frequency))
-                {
-                    double frequency1 = swrKeys.at(ii);
-                    double frequency2 = swrKeys.at(ii+1);
-
-                    if(m_measurements->getCalibrationEnabled())
-                    {
-                        if(m_measurements->getFarEndMeasurement() == 1)
-                        {
-                            dPhase = interpolate(frequency1,
-                                                 m_markersList.at(n)->frequency,
-                                                 frequency2,
-                                                 m_measurements->getMeasurementSub(i)->phaseGraphCalib.value(frequency1).value,
-                                                 m_measurements->getMeasurementSub(i)->phaseGraphCalib.value(frequency2).value);
-
-                            dR = interpolate(frequency1,
-                                             m_markersList.at(n)->frequency,
-                                             frequency2,
-                                             m_measurements->getMeasurementSub(i)->rsrGraphCalib.value(frequency1).value,
-                                             m_measurements->getMeasurementSub(i)->rsrGraphCalib.value(frequency2).value);
-
-                            dX = interpolate(frequency1,
-                                             m_markersList.at(n)->frequency,
-                                             frequency2,
-                                             m_measurements->getMeasurementSub(i)->rsxGraphCalib.value(frequency1).value,
-                                             m_measurements->getMeasurementSub(i)->rsxGraphCalib.value(frequency2).value);
-
-                        }else if(m_measurements->getFarEndMeasurement() == 2)
-                        {
-                            dPhase = interpolate(frequency1,
-                                                 m_markersList.at(n)->frequency,
-                                                 frequency2,
-                                                 m_measurements->getMeasurementAdd(i)->phaseGraphCalib.value(frequency1).value,
-                                                 m_measurements->getMeasurementAdd(i)->phaseGraphCalib.value(frequency2).value);
-
-                            dR = interpolate(frequency1,
-                                             m_markersList.at(n)->frequency,
-                                             frequency2,
-                                             m_measurements->getMeasurementAdd(i)->rsrGraphCalib.value(frequency1).value,
-                                             m_measurements->getMeasurementAdd(i)->rsrGraphCalib.value(frequency2).value);
-
-                            dX = interpolate(frequency1,
-                                             m_markersList.at(n)->frequency,
-                                             frequency2,
-                                             m_measurements->getMeasurementAdd(i)->rsxGraphCalib.value(frequency1).value,
-                                             m_measurements->getMeasurementAdd(i)->rsxGraphCalib.value(frequency2).value);
-                        }else
-                        {
-                            dPhase = interpolate(frequency1,
-                                                 m_markersList.at(n)->frequency,
-                                                 frequency2,
-                                                 m_measurements->getMeasurement(i)->phaseGraphCalib.value(frequency1).value,
-                                                 m_measurements->getMeasurement(i)->phaseGraphCalib.value(frequency2).value);
-
-                            dR = interpolate(frequency1,
-                                             m_markersList.at(n)->frequency,
-                                             frequency2,
-                                             m_measurements->getMeasurement(i)->dataRXCalib.at(ii).r,
-                                             m_measurements->getMeasurement(i)->dataRXCalib.at(ii+1).r);
-
-                            dX = interpolate(frequency1,
-                                             m_markersList.at(n)->frequency,
-                                             frequency2,
-                                             m_measurements->getMeasurement(i)->dataRXCalib.at(ii).x,
-                                             m_measurements->getMeasurement(i)->dataRXCalib.at(ii+1).x);
-                        }
-                        double m1 = m_measurements->getMeasurement(i)->swrGraphCalib.value(frequency1).value;
-                        double m2 = m_measurements->getMeasurement(i)->swrGraphCalib.value(frequency2).value;
-                        if(m1 > 10)
-                        {
-                            m1 = 10;
-                        }
-                        if(m2 > 10)
-                        {
-                            m2 = 10;
-                        }
-                        dSwr = interpolate(frequency1,
-                                           m_markersList.at(n)->frequency,
-                                           frequency2,
-                                           m1,
-                                           m2);
-
-                        dRl = interpolate(frequency1,
-                                          m_markersList.at(n)->frequency,
-                                          frequency2,
-                                          m_measurements->getMeasurement(i)->rlGraphCalib.value(frequency1).value,
-                                          m_measurements->getMeasurement(i)->rlGraphCalib.value(frequency2).value);
-
-                    }else
-                    {
-                        if(m_measurements->getFarEndMeasurement() == 1)
-                        {
-                            dPhase = interpolate(frequency1,
-                                                 m_markersList.at(n)->frequency,
-                                                 frequency2,
-                                                 m_measurements->getMeasurementSub(i)->phaseGraph.value(frequency1).value,
-                                                 m_measurements->getMeasurementSub(i)->phaseGraph.value(frequency2).value);
-
-                            dR = interpolate(frequency1,
-                                             m_markersList.at(n)->frequency,
-                                             frequency2,
-                                             m_measurements->getMeasurementSub(i)->rsrGraph.value(frequency1).value,
-                                             m_measurements->getMeasurementSub(i)->rsrGraph.value(frequency2).value);
-
-                            dX = interpolate(frequency1,
-                                             m_markersList.at(n)->frequency,
-                                             frequency2,
-                                             m_measurements->getMeasurementSub(i)->rsxGraph.value(frequency1).value,
-                                             m_measurements->getMeasurementSub(i)->rsxGraph.value(frequency2).value);
-
-                        }else if(m_measurements->getFarEndMeasurement() == 2)
-                        {
-                            dPhase = interpolate(frequency1,
-                                                 m_markersList.at(n)->frequency,
-                                                 frequency2,
-                                                 m_measurements->getMeasurementAdd(i)->phaseGraph.value(frequency1).value,
-                                                 m_measurements->getMeasurementAdd(i)->phaseGraph.value(frequency2).value);
-
-                            dR = interpolate(frequency1,
-                                             m_markersList.at(n)->frequency,
-                                             frequency2,
-                                             m_measurements->getMeasurementAdd(i)->rsrGraph.value(frequency1).value,
-                                             m_measurements->getMeasurementAdd(i)->rsrGraph.value(frequency2).value);
-
-                            dX = interpolate(frequency1,
-                                             m_markersList.at(n)->frequency,
-                                             frequency2,
-                                             m_measurements->getMeasurementAdd(i)->rsxGraph.value(frequency1).value,
-                                             m_measurements->getMeasurementAdd(i)->rsxGraph.value(frequency2).value);
-
-                        }else
-                        {
-                            dPhase = interpolate(frequency1,
-                                                 m_markersList.at(n)->frequency,
-                                                 frequency2,
-                                                 m_measurements->getMeasurement(i)->phaseGraph.value(frequency1).value,
-                                                 m_measurements->getMeasurement(i)->phaseGraph.value(frequency2).value);
-
-                            dR = interpolate(frequency1,
-                                             m_markersList.at(n)->frequency,
-                                             frequency2,
-                                             m_measurements->getMeasurement(i)->dataRX.at(ii).r,
-                                             m_measurements->getMeasurement(i)->dataRX.at(ii+1).r);
-
-                            dX = interpolate(frequency1,
-                                             m_markersList.at(n)->frequency,
-                                             frequency2,
-                                             m_measurements->getMeasurement(i)->dataRX.at(ii).x,
-                                             m_measurements->getMeasurement(i)->dataRX.at(ii+1).x);
-
-                        }
-                        double m1 = m_measurements->getMeasurement(i)->swrGraph.value(frequency1).value;
-                        double m2 = m_measurements->getMeasurement(i)->swrGraph.value(frequency2).value;
-                        if(m1 > 10)
-                        {
-                            m1 = 10;
-                        }
-                        if(m2 > 10)
-                        {
-                            m2 = 10;
-                        }
-                        dSwr = interpolate(frequency1,
-                                           m_markersList.at(n)->frequency,
-                                           frequency2,
-                                           m1,
-                                           m2);
-
-                        dRl = interpolate(frequency1,
-                                          m_markersList.at(n)->frequency,
-                                          frequency2,
-                                          m_measurements->getMeasurement(i)->rlGraph.value(frequency1).value,
-                                          m_measurements->getMeasurement(i)->rlGraph.value(frequency2).value);
-
-                    }
-
-                    swr.append(dSwr);
-                    rl.append(dRl);
-                    phase.append(dPhase);
-                    QString zString = QString::number(dR,'f', 2);
-                    if(dX >= 0)
-                    {
-                        zString+= " + j";
-                        zString+= QString::number(dX,'f', 2);
-                    }else
-                    {
-                        zString+= " - j";
-                        zString+= QString::number((dX * (-1)),'f', 2);
-                    }
-                    z.append(zString);
-                }
+                zString+= " + j";
+                zString+= QString::number(point.x,'f', 2);
+            }else
+            {
+                zString+= " - j";
+                zString+= QString::number((point.x * (-1)),'f', 2);
             }
+            z.append(zString);
         }
         m_markersHint->addRowText( n, &measurement, &fq, &swr, &rl, &z, &phase);
     }
 }
 
-double Markers::interpolate(double fq1, double fq2, double fq3, double param1, double param2)
-{
-    return param1 + (fq2-fq1)/(fq3-fq1) *(param2-param1);
-}
-
 void Markers::on_mainWindowPos(int x, int y)
 {
     if(m_markersHint)
@@ -95,8 +95,6 @@ private:
     Measurements *m_measurements;
 
     bool m_focus;
-
-    double interpolate(double fq1, double fq2, double fq3, double param1, double param2);
 signals:
 
 public slots:
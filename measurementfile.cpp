@@ -0,0 +1,208 @@
+#include "measurementfile.h"
+#include <QtEndian>
+#include <stddef.h>
+#include <string.h>
+
+// the layout is part of the file format
+Q_STATIC_ASSERT(sizeof(MeasurementFileHeader) == 64);
+
+static void putDouble(uchar *dest, double value)
+{
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian<quint64>(bits, dest);
+}
+
+static double getDouble(const uchar *src)
+{
+    quint64 bits = qFromLittleEndian<quint64>(src);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+MeasurementFile::MeasurementFile() :
+    m_map(NULL)
+{
+    close();
+}
+
+MeasurementFile::~MeasurementFile()
+{
+    close();
+}
+
+bool MeasurementFile::save(const QString &path, const measurement &data,
+                           double Z0, bool calibrationEnabled)
+{
+    return save(path, data.qint64Fq, data.qint64Sw, data.qint64Dots,
+                data.dataRX, data.dataRXCalib, Z0, calibrationEnabled);
+}
+
+bool MeasurementFile::save(const QString &path, qint64 fq, qint64 sw, qint64 sweepDots,
+                           const QVector<rawData> &raw, const QVector<rawData> &calib,
+                           double Z0, bool calibrationEnabled)
+{
+    bool hasCalibrated = !calib.isEmpty() && (calib.size() == raw.size());
+    int dots = raw.size();
+    int columns = hasCalibrated ? 6 : 3;
+    quint32 flags = (hasCalibrated ? HasCalibrated : 0) |
+                    (calibrationEnabled ? CalibrationEnabled : 0);
+
+    QByteArray buffer(int(sizeof(MeasurementFileHeader)) + columns*dots*int(sizeof(double)), 0);
+    uchar *p = reinterpret_cast<uchar*>(buffer.data());
+    memcpy(p, MEASUREMENT_FILE_MAGIC, 4);
+    qToLittleEndian<quint32>(MEASUREMENT_FILE_VERSION, p + offsetof(MeasurementFileHeader, version));
+    qToLittleEndian<quint32>(sizeof(MeasurementFileHeader), p + offsetof(MeasurementFileHeader, headerSize));
+    qToLittleEndian<quint32>(flags, p + offsetof(MeasurementFileHeader, flags));
+    qToLittleEndian<quint64>(dots, p + offsetof(MeasurementFileHeader, dots));
+    qToLittleEndian<qint64>(fq, p + offsetof(MeasurementFileHeader, fq));
+    qToLittleEndian<qint64>(sw, p + offsetof(MeasurementFileHeader, sw));
+    qToLittleEndian<qint64>(sweepDots, p + offsetof(MeasurementFileHeader, sweepDots));
+    putDouble(p + offsetof(MeasurementFileHeader, Z0), Z0);
+
+    uchar *column = p + sizeof(MeasurementFileHeader);
+    for(int c = 0; c < columns; ++c, column += dots*sizeof(double))
+    {
+        const QVector <rawData> &src = (c < 3) ? raw : calib;
+        for(int i = 0; i < dots; ++i)
+        {
+            const rawData &point = src.at(i);
+            double value = ((c % 3) == 0) ? point.fq : (((c % 3) == 1) ? point.r : point.x);
+            putDouble(column + i*sizeof(double), value);
+        }
+    }
+
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+    return file.write(buffer) == buffer.size();
+}
+
+bool MeasurementFile::open(const QString &path)
+{
+    close();
+    m_file.setFileName(path);
+    if(!m_file.open(QIODevice::ReadOnly))
+    {
+        return fail(m_file.errorString());
+    }
+    qint64 size = m_file.size();
+    if(size < qint64(sizeof(MeasurementFileHeader)))
+    {
+        return fail(tr("File is too short."));
+    }
+    m_map = m_file.map(0, size);
+    if(m_map == NULL)
+    {
+        return fail(m_file.errorString());
+    }
+
+    const uchar *p = m_map;
+    if(memcmp(p, MEASUREMENT_FILE_MAGIC, 4) != 0)
+    {
+        return fail(tr("Not a binary AntScope2 measurement file."));
+    }
+    memcpy(m_header.magic, p, 4);
+    m_header.version = qFromLittleEndian<quint32>(p + offsetof(MeasurementFileHeader, version));
+    m_header.headerSize = qFromLittleEndian<quint32>(p + offsetof(MeasurementFileHeader, headerSize));
+    m_header.flags = qFromLittleEndian<quint32>(p + offsetof(MeasurementFileHeader, flags));
+    m_header.dots = qFromLittleEndian<quint64>(p + offsetof(MeasurementFileHeader, dots));
+    m_header.fq = qFromLittleEndian<qint64>(p + offsetof(MeasurementFileHeader, fq));
+    m_header.sw = qFromLittleEndian<qint64>(p + offsetof(MeasurementFileHeader, sw));
+    m_header.sweepDots = qFromLittleEndian<qint64>(p + offsetof(MeasurementFileHeader, sweepDots));
+    m_header.Z0 = getDouble(p + offsetof(MeasurementFileHeader, Z0));
+
+    if(m_header.version > MEASUREMENT_FILE_VERSION)
+    {
+        return fail(tr("Unsupported file version %1.").arg(m_header.version));
+    }
+    // newer versions may only grow the header, the columns stay 8 byte aligned
+    if((m_header.headerSize < sizeof(MeasurementFileHeader)) || (m_header.headerSize % sizeof(double)))
+    {
+        return fail(tr("Corrupted file header."));
+    }
+    int columns = hasCalibrated() ? 6 : 3;
+    if((m_header.dots > quint64(size)) ||
+       (m_header.headerSize + columns*m_header.dots*sizeof(double) > quint64(size)))
+    {
+        return fail(tr("File is truncated."));
+    }
+
+    int dots = int(m_header.dots);
+    const uchar *first = m_map + m_header.headerSize;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    for(int c = 0; c < columns; ++c)
+    {
+        m_columns[c] = reinterpret_cast<const double*>(first) + c*dots;
+    }
+#else
+    m_swapped.resize(columns*dots);
+    for(int i = 0; i < columns*dots; ++i)
+    {
+        m_swapped[i] = getDouble(first + i*sizeof(double));
+    }
+    for(int c = 0; c < columns; ++c)
+    {
+        m_columns[c] = m_swapped.constData() + c*dots;
+    }
+#endif
+    return true;
+}
+
+void MeasurementFile::close()
+{
+    if(m_map != NULL)
+    {
+        m_file.unmap(m_map);
+        m_map = NULL;
+    }
+    if(m_file.isOpen())
+    {
+        m_file.close();
+    }
+    memset(&m_header, 0, sizeof(m_header));
+    for(int c = 0; c < ColumnCount; ++c)
+    {
+        m_columns[c] = NULL;
+    }
+    m_swapped.clear();
+}
+
+bool MeasurementFile::isOpen() const
+{
+    return m_columns[RawFq] != NULL;
+}
+
+QString MeasurementFile::errorString() const
+{
+    return m_error;
+}
+
+const double *MeasurementFile::column(Column c) const
+{
+    if((c < 0) || (c >= ColumnCount))
+    {
+        return NULL;
+    }
+    return m_columns[c];
+}
+
+rawData MeasurementFile::point(int index, bool calibrated) const
+{
+    int first = calibrated ? CalibFq : RawFq;
+    rawData data;
+    data.fq = m_columns[first][index];
+    data.r = m_columns[first+1][index];
+    data.x = m_columns[first+2][index];
+    return data;
+}
+
+bool MeasurementFile::fail(const QString &error)
+{
+    close();
+    m_error = error;
+    return false;
+}
@@ -0,0 +1,94 @@
+#ifndef MEASUREMENTFILE_H
+#define MEASUREMENTFILE_H
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <analyzer/analyzerparameters.h>
+
+#define MEASUREMENT_FILE_MAGIC      "ASB1"
+#define MEASUREMENT_FILE_VERSION    1
+
+// On-disk header of a binary measurement file (.asb), all fields little-endian.
+// The columns follow the header directly, each one `dots` doubles long:
+//   fq, r, x of the raw data, then fq, r, x of the calibrated data if
+//   MeasurementFile::HasCalibrated is set. fq is in MHz as in rawData.
+struct MeasurementFileHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 headerSize;     // offset of the first column
+    quint32 flags;
+    quint64 dots;           // points per column
+    qint64 fq;              // sweep parameters of the measurement
+    qint64 sw;
+    qint64 sweepDots;
+    double Z0;
+    quint32 reserved[2];
+};
+
+// Versioned binary successor of the .asd JSON measurement file. .asd stays
+// the interchange format, .asb is for fast saving and loading: the file is
+// memory mapped and the columns are handed out as views into the mapping,
+// nothing is parsed or copied on little-endian hosts.
+class MeasurementFile
+{
+    Q_DECLARE_TR_FUNCTIONS(MeasurementFile)
+public:
+    enum Column
+    {
+        RawFq,
+        RawR,
+        RawX,
+        CalibFq,
+        CalibR,
+        CalibX,
+        ColumnCount
+    };
+    enum Flag
+    {
+        HasCalibrated = 0x01,       // calibrated columns are present
+        CalibrationEnabled = 0x02   // calibration was switched on when saving
+    };
+
+    MeasurementFile();
+    ~MeasurementFile();
+
+    static bool save(const QString &path, const measurement &data,
+                     double Z0, bool calibrationEnabled);
+    // fq, sw and sweepDots as in measurement
+    static bool save(const QString &path, qint64 fq, qint64 sw, qint64 sweepDots,
+                     const QVector<rawData> &raw, const QVector<rawData> &calib,
+                     double Z0, bool calibrationEnabled);
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const;
+    QString errorString() const;
+
+    quint32 version() const { return m_header.version; }
+    quint32 flags() const { return m_header.flags; }
+    int dots() const { return int(m_header.dots); }
+    qint64 fq() const { return m_header.fq; }
+    qint64 sw() const { return m_header.sw; }
+    qint64 sweepDots() const { return m_header.sweepDots; }
+    double Z0() const { return m_header.Z0; }
+    bool hasCalibrated() const { return (m_header.flags & HasCalibrated) != 0; }
+
+    // view of a whole column, NULL if the file doesn't contain it
+    const double *column(Column c) const;
+    rawData point(int index, bool calibrated = false) const;
+
+private:
+    QFile m_file;
+    uchar *m_map;
+    MeasurementFileHeader m_header;
+    const double *m_columns[ColumnCount];
+    QVector <double> m_swapped;     // byte swapped columns on big-endian hosts
+    QString m_error;
+
+    bool fail(const QString &error);
+};
+
+#endif // MEASUREMENTFILE_H
@@ -0,0 +1,154 @@
+#include "measurementlistmodel.h"
+#include <core/sweepmath.h>
+
+MeasurementListModel::MeasurementListModel(const QList<measurement> *measurements, QObject *parent) :
+    QAbstractTableModel(parent),
+    m_measurements(measurements),
+    m_Z0(50),
+    m_calibrationEnabled(false)
+{
+}
+
+void MeasurementListModel::append(const QString &name)
+{
+    Summary summary;
+    summary.points = -1;
+    beginInsertRows(QModelIndex(), m_names.size(), m_names.size());
+    m_names.append(name);
+    m_summaries.append(summary);
+    endInsertRows();
+}
+
+void MeasurementListModel::remove(int row)
+{
+    if((row < 0) || (row >= m_names.size()))
+    {
+        return;
+    }
+    beginRemoveRows(QModelIndex(), row, row);
+    m_names.remove(row);
+    m_summaries.remove(row);
+    endRemoveRows();
+}
+
+void MeasurementListModel::clear()
+{
+    beginResetModel();
+    m_names.clear();
+    m_summaries.clear();
+    endResetModel();
+}
+
+void MeasurementListModel::setZ0(double Z0)
+{
+    if(Z0 == m_Z0)
+    {
+        return;
+    }
+    m_Z0 = Z0;
+    invalidateAll();
+}
+
+void MeasurementListModel::setCalibrationEnabled(bool enabled)
+{
+    if(enabled == m_calibrationEnabled)
+    {
+        return;
+    }
+    m_calibrationEnabled = enabled;
+    invalidateAll();
+}
+
+void MeasurementListModel::invalidate(int row)
+{
+    if((row >= 0) && (row < m_summaries.size()))
+    {
+        m_summaries[row].points = -1;
+    }
+}
+
+void MeasurementListModel::invalidateAll()
+{
+    for(int i = 0; i < m_summaries.size(); ++i)
+    {
+        m_summaries[i].points = -1;
+    }
+}
+
+int MeasurementListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_names.size();
+}
+
+int MeasurementListModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 1;
+}
+
+QVariant MeasurementListModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || (index.row() >= m_names.size()))
+    {
+        return QVariant();
+    }
+    if(role == Qt::DisplayRole)
+    {
+        return m_names.at(index.row());
+    }
+    if(role == Qt::ToolTipRole)
+    {
+        return summary(index.row());
+    }
+    return QVariant();
+}
+
+QVariant MeasurementListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if((orientation == Qt::Horizontal) && (role == Qt::DisplayRole) && (section == 0))
+    {
+        return tr("Name");
+    }
+    return QVariant();
+}
+
+QString MeasurementListModel::summary(int row) const
+{
+    // single point measurements have no row, then rows and measurements don't match
+    if(m_measurements->size() != m_names.size())
+    {
+        return m_names.at(row);
+    }
+    const measurement &source = m_measurements->at(row);
+    const QVector <rawData> &data = (m_calibrationEnabled &&
+                                     (source.dataRXCalib.size() == source.dataRX.size())) ?
+                source.dataRXCalib : source.dataRX;
+    Summary &cached = m_summaries[row];
+    if(cached.points == data.size())
+    {
+        return cached.text;
+    }
+
+    cached.points = data.size();
+    cached.text = m_names.at(row);
+    if(data.isEmpty())
+    {
+        return cached.text;
+    }
+    QVector <double> swr(data.size());
+    for(int i = 0; i < data.size(); ++i)
+    {
+        if(!SweepMath::swr(m_Z0, data.at(i).r, data.at(i).x, &swr[i], NULL))
+        {
+            swr[i] = qQNaN();
+        }
+    }
+    cached.text += tr("\n%1 points, %2 - %3 MHz").arg(data.size())
+            .arg(data.first().fq, 0, 'f', 3).arg(data.last().fq, 0, 'f', 3);
+    int best = SweepMath::minimumSwr(swr.constData(), swr.size());
+    if(best >= 0)
+    {
+        cached.text += tr("\nSWR %1 at %2 MHz").arg(swr.at(best), 0, 'f', 2)
+                .arg(data.at(best).fq, 0, 'f', 3);
+    }
+    return cached.text;
+}
@@ -0,0 +1,54 @@
+#ifndef MEASUREMENTLISTMODEL_H
+#define MEASUREMENTLISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include <QVector>
+#include <analyzer/analyzerparameters.h>
+
+// Names of the measurements for the measurements view, row n is
+// Measurements::m_measurements[n]. The summary in the tool tip (points,
+// range, SWR minimum) is computed when the view first asks for it and kept
+// until the sweep gets more points, is measured again, or Z0 or the
+// calibration switch change.
+class MeasurementListModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit MeasurementListModel(const QList<measurement> *measurements, QObject *parent = 0);
+
+    void append(const QString &name);
+    void remove(int row);
+    void clear();
+    const QString &name(int row) const { return m_names.at(row); }
+    const QVector<QString> &names() const { return m_names; }
+    int count() const { return m_names.size(); }
+    void setZ0(double Z0);
+    // the summary is of the calibrated points while calibration is on
+    void setCalibrationEnabled(bool enabled);
+    // the points of the row were replaced
+    void invalidate(int row);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+private:
+    struct Summary
+    {
+        int points;         // points the summary was computed from, -1 if none yet
+        QString text;
+    };
+
+    const QList <measurement> *m_measurements;
+    QVector <QString> m_names;
+    mutable QVector <Summary> m_summaries;
+    double m_Z0;
+    bool m_calibrationEnabled;
+
+    void invalidateAll();
+    QString summary(int row) const;
+};
+
+#endif // MEASUREMENTLISTMODEL_H
@@ -1,5 +1,8 @@
 #include "measurements.h"
-#include "ProgressDlg.h"
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrentMap>
+#include <string.h>
+#include <algorithm>
 
 Measurements::Measurements(QObject *parent) : QObject(parent),
     m_currentIndex(0),
@@ -21,13 +24,30 @@ Measurements::Measurements(QObject *parent) : QObject(parent),
     m_calibrationMode(false),
     m_Z0(50),
     m_dotsNumber(50),
-    m_smithTracer(NULL)
+    m_smithTracer(NULL),
+    m_popupIndex(-1),
+    m_popupKey(0),
+    m_cursorFq(0),
+    m_continuousFq(0),
+    m_continuousSw(0),
+    m_continuousDots(-1),
+    m_statisticsEnabled(true),
+    m_sweepFolded(false),
+    m_merging(false),
+    m_trackerText(NULL),
+    m_trackerEnabled(true)
 {
     QString path = Settings::setIniFile();
     m_settings = new QSettings(path,QSettings::IniFormat);
     m_settings->beginGroup("Measurements");
     m_graphHintEnabled = false; //m_settings->value("GraphHintEnabled",true).toBool();
     m_graphBriefHintEnabled = false; //m_settings->value("GraphBriefHintEnabled",true).toBool();
+    m_statisticsEnabled = m_settings->value("ContinuousStatistics",true).toBool();
+    m_trackerEnabled = m_settings->value("Tracker",true).toBool();
+    for(int i = 0; i < StatCurveCount; ++i)
+    {
+        m_statCurves[i] = NULL;
+    }
     m_settings->endGroup();
 
     m_settings->beginGroup("Cable");
@@ -37,6 +57,8 @@ Measurements::Measurements(QObject *parent) : QObject(parent),
     m_pdTdrImp =  new double[TDR_MAXARRAY];
     m_pdTdrStep =  new double[TDR_MAXARRAY];
 
+    m_listModel = new MeasurementListModel(&m_measurements, this);
+
     if(m_graphHint == NULL)
     {
         m_graphHint = new PopUp();
@@ -72,6 +94,8 @@ Measurements::~Measurements()
     m_settings->beginGroup("Measurements");
     m_settings->setValue("GraphHintEnabled",m_graphHintEnabled);
     m_settings->setValue("GraphBriefHintEnabled",m_graphBriefHintEnabled);
+    m_settings->setValue("ContinuousStatistics",m_statisticsEnabled);
+    m_settings->setValue("Tracker",m_trackerEnabled);
     m_settings->endGroup();
 
     delete []m_pdTdrImp;
@@ -90,7 +114,7 @@ Measurements::~Measurements()
 void Measurements::setWidgets(QCustomPlot * swr,   QCustomPlot * phase,
                               QCustomPlot * rs,    QCustomPlot * rp,
                               QCustomPlot * rl,    QCustomPlot * tdr,
-                              QCustomPlot * smith, QTableWidget * table)
+                              QCustomPlot * smith, QTableView * table)
 {
     m_swrWidget = swr;
     m_phaseWidget = phase;
@@ -105,8 +129,11 @@ void Measurements::setWidgets(QCustomPlot * swr,   QCustomPlot * phase,
     m_tdrWidget->legend->setVisible(true);
     m_tdrWidget->legend->removeAt(0);
     m_smithWidget = smith;
-    m_tableWidget = table;
+    m_tableView = table;
+    m_tableView->setModel(m_listModel);
     drawSmithImage();
+    createStatisticsCurves();
+    createTrackerText();
 
     if(m_graphBriefHint != NULL)
     {
@@ -119,6 +146,7 @@ void Measurements::setWidgets(QCustomPlot * swr,   QCustomPlot * phase,
 void Measurements::setCalibration(Calibration * _calibration)
 {
     m_calibration = _calibration;
+    m_listModel->setCalibrationEnabled(m_calibration->getCalibrationEnabled());
 }
 
 bool Measurements::getCalibrationEnabled(void)
@@ -128,34 +156,8 @@ bool Measurements::getCalibrationEnabled(void)
 
 void Measurements::deleteRow(int row)
 {
-    m_tableNames.remove(row, 1);
-    m_tableWidget->removeRow(row);
+    m_listModel->remove(row);
 
-    for(int j = 0; j < 5; ++j)
-    {
-        if(m_tableNames.length() > j)
-        {
-            QTableWidgetItem *item = m_tableWidget->item(j,0);
-            if(item == NULL)
-            {
-                item = new QTableWidgetItem();
-                QString str = m_tableNames.at(j);
-                item->setText(str);
-                m_tableWidget->setItem(j,0, item);
-            }else
-            {
-                QString str = m_tableNames.at(j);
-                item->setText(str);
-            }
-        }else
-        {
-            QTableWidgetItem *item = m_tableWidget->item(j,0);
-            if(item != NULL)
-            {
-                delete item;
-            }
-        }
-    }
     int count = m_swrWidget->graphCount();
     if(count)
     {
@@ -178,32 +180,13 @@ void Measurements::deleteRow(int row)
         m_tdrWidget->removeGraph(1+row*2);
         m_tdrWidget->removeGraph(1+row*2);
 
-        if(row == m_tableNames.length())
-        {
-            QModelIndex myIndex = m_tableWidget->model()->index( row-1, 0,
-                                                                 QModelIndex());
-            m_tableWidget->selectionModel()->select(myIndex,
-                                                    QItemSelectionModel::Select);
-
-            myIndex = m_tableWidget->model()->index( row-1, 1, QModelIndex());
-            m_tableWidget->selectionModel()->select(myIndex,
-                                                    QItemSelectionModel::Select);
-
-        }else
-        {
-            QModelIndex myIndex = m_tableWidget->model()->index( row, 0,
-                                                                 QModelIndex());
-            m_tableWidget->selectionModel()->select(myIndex,
-                                                    QItemSelectionModel::Select);
-
-            myIndex = m_tableWidget->model()->index( row, 1, QModelIndex());
-            m_tableWidget->selectionModel()->select(myIndex,
-                                                    QItemSelectionModel::Select);
-
-        }
+        int next = (row == m_listModel->count()) ? row-1 : row;
+        QModelIndex myIndex = m_listModel->index(next, 0);
+        m_tableView->selectionModel()->select(myIndex, QItemSelectionModel::Select);
+        // the indices of the later measurements moved
+        markTabsDirty(DirtyTraces);
     }
     replot();
-    m_tableWidget->setRowCount(m_tableNames.length());
 }
 
 void Measurements::on_newMeasurement(QString name, qint64 fq, qint64 sw, qint64 dots)
@@ -218,6 +201,15 @@ void Measurements::on_newMeasurement(QString name, qint64 fq, qint64 sw, qint64
 
 void Measurements::on_newMeasurement(QString name)
 {
+    // a new measurement ends the continuous one
+    m_continuousDots = -1;
+    m_merging = false;
+    m_mergeBuffer.resize(0);
+    m_statistics.clear();
+    updateStatisticsCurves();
+    m_tracker.reset();
+    updateTracker();
+
     // name.isEmpty -> singlePoint measurement
     if (!name.isEmpty())
     {
@@ -230,9 +222,10 @@ void Measurements::on_newMeasurement(QString name)
         if (name.indexOf("##") == 0)
         {
             int next = 0;
-            for (int idx=0; idx<m_tableNames.size(); idx++)
+            const QVector <QString> &names = m_listModel->names();
+            for (int idx=0; idx<names.size(); idx++)
             {
-                QString existed = m_tableNames[idx];
+                QString existed = names[idx];
                 if (existed.indexOf('>') == 2) {
                     QString num = existed.left(2);
                     bool ok = false;
@@ -248,35 +241,15 @@ void Measurements::on_newMeasurement(QString name)
 
             nextName = QString("%1> %2").arg(next, 2, 10, QChar('0')).arg(name.mid(2));
         }
-        m_tableNames.append(nextName);
-        if(m_tableNames.length() == MAX_MEASUREMENTS+1)
+        if(m_listModel->count() == MAX_MEASUREMENTS)
         {
-            m_tableNames.remove(0,1);
-        }
-        if(m_tableNames.length() > m_tableWidget->rowCount())
-        {
-            m_tableWidget->setRowCount(m_tableNames.length());
-        }
-        for(int i = 0; i < m_tableNames.length(); ++i)
-        {
-            QTableWidgetItem *item = m_tableWidget->item(i,0);
-            if(item == NULL)
-            {
-                item = new QTableWidgetItem();
-                QString str = m_tableNames.at(i);
-                item->setText(str);
-                m_tableWidget->setItem(i,0, item);
-            }else
-            {
-                QString str = m_tableNames.at(i);
-                item->setText(str);
-            }
+            m_listModel->remove(0);
         }
+        m_listModel->append(nextName);
 
-        m_tableWidget->reset();
-        QModelIndex myIndex = m_tableWidget->model()->index( m_tableNames.size()-1, 0, QModelIndex());
-        m_tableWidget->selectionModel()->select(myIndex,QItemSelectionModel::Select);
-        m_tableWidget->scrollToBottom();
+        QModelIndex myIndex = m_listModel->index(m_listModel->count()-1, 0);
+        m_tableView->selectionModel()->select(myIndex, QItemSelectionModel::ClearAndSelect);
+        m_tableView->scrollToBottom();
     }
 
     if(m_measurements.length() == MAX_MEASUREMENTS)
@@ -296,6 +269,8 @@ void Measurements::on_newMeasurement(QString name)
         m_rlWidget->removeGraph(1);
         m_tdrWidget->removeGraph(1);
         m_tdrWidget->removeGraph(1);
+        // the indices of the remaining measurements moved
+        markTabsDirty(DirtyTraces);
     }
     m_measurements.append( measurement());
     m_viewMeasurements.append( measurement());
@@ -401,722 +376,939 @@ void Measurements::on_newMeasurement(QString name)
 }
 
 
+// drops every point of the traces, the TDR graphs are rebuilt from dataRX anyway
+static void clearTraces(measurement &meas)
+{
+    QCPDataMap *maps[] = {&meas.swrGraph, &meas.phaseGraph, &meas.rhoGraph,
+                          &meas.rsrGraph, &meas.rsxGraph, &meas.rszGraph,
+                          &meas.rprGraph, &meas.rpxGraph, &meas.rpzGraph, &meas.rlGraph,
+                          &meas.swrGraphCalib, &meas.phaseGraphCalib, &meas.rhoGraphCalib,
+                          &meas.rsrGraphCalib, &meas.rsxGraphCalib, &meas.rszGraphCalib,
+                          &meas.rprGraphCalib, &meas.rpxGraphCalib, &meas.rpzGraphCalib,
+                          &meas.rlGraphCalib};
+    for(unsigned i = 0; i < sizeof(maps)/sizeof(maps[0]); ++i)
+    {
+        maps[i]->clear();
+    }
+    meas.smithGraph.clear();
+    meas.smithGraphView.clear();
+    meas.smithGraphCalib.clear();
+    meas.smithGraphViewCalib.clear();
+}
+
 void Measurements::on_continueMeasurement(qint64 fq, qint64 sw, qint32 dots)
 {
-    Q_UNUSED (fq);
-    Q_UNUSED (sw);
-    Q_UNUSED (dots);
-
-    delete m_measurements.last().smithCurve;
-    delete m_viewMeasurements.last().smithCurve;
-    delete m_farEndMeasurementsAdd.last().smithCurve;
-    delete m_farEndMeasurementsSub.last().smithCurve;
-    m_measurements.last().dataRX.clear();
-    m_measurements.last().dataRXCalib.clear();
-    m_viewMeasurements.last().dataRX.clear();
-    m_viewMeasurements.last().dataRXCalib.clear();
-    m_farEndMeasurementsAdd.last().dataRX.clear();
-    m_farEndMeasurementsAdd.last().dataRXCalib.clear();
-    m_farEndMeasurementsSub.last().dataRX.clear();
-    m_farEndMeasurementsSub.last().dataRXCalib.clear();
-/*
-    m_measurements.removeLast();
-    m_viewMeasurements.removeLast();
-    m_farEndMeasurementsAdd.removeLast();
-    m_farEndMeasurementsSub.removeLast();
+    // The next sweep is written over the last one. On the same grid the maps
+    // keep their nodes and take the new values under the same keys, so the
+    // trace updates in place; resize(0) keeps the memory of the point arrays
+    // and the smith curves stay, setData() replaces their points on redraw.
+    bool sameGrid = (fq == m_continuousFq) && (sw == m_continuousSw) && (dots == m_continuousDots);
+    measurement *lists[] = {&m_measurements.last(), &m_viewMeasurements.last(),
+                            &m_farEndMeasurementsAdd.last(), &m_farEndMeasurementsSub.last()};
+    for(unsigned i = 0; i < sizeof(lists)/sizeof(lists[0]); ++i)
+    {
+        lists[i]->dataRX.resize(0);
+        lists[i]->dataRXCalib.resize(0);
+        if(!sameGrid)
+        {
+            clearTraces(*lists[i]);
+        }
+    }
+    if(!sameGrid)
+    {
+        m_statistics.reset(dots + 1);
+        updateStatisticsCurves();
+        m_continuousFq = fq;
+        m_continuousSw = sw;
+        m_continuousDots = dots;
+    }
+    m_sweepFolded = false;
+    m_tracker.reset();
+    m_listModel->invalidate(m_measurements.size() - 1);
+}
 
-    m_measurements.append( measurement());
-    m_viewMeasurements.append( measurement());
-    m_farEndMeasurementsAdd.append( measurement());
-    m_farEndMeasurementsSub.append( measurement());
-*/
-    m_measurements.last().smithCurve = new QCPCurve(m_smithWidget->xAxis, m_smithWidget->yAxis);
-    m_viewMeasurements.last().smithCurve = new QCPCurve(m_smithWidget->xAxis, m_smithWidget->yAxis);
-    m_farEndMeasurementsAdd.last().smithCurve = new QCPCurve(m_smithWidget->xAxis, m_smithWidget->yAxis);
-    m_farEndMeasurementsSub.last().smithCurve = new QCPCurve(m_smithWidget->xAxis, m_smithWidget->yAxis);
-/*
-    m_swrWidget->graph()->clearData();
-    m_phaseWidget->graph()->clearData();
-    m_rsWidget->graph()->clearData();
-    m_rsWidget->graph()->clearData();
-    m_rsWidget->graph()->clearData();
-    m_rpWidget->graph()->clearData();
-    m_rpWidget->graph()->clearData();
-    m_rpWidget->graph()->clearData();
-    m_rlWidget->graph()->clearData();
-    m_tdrWidget->graph()->clearData();
-    m_tdrWidget->graph()->clearData();
-    */
+static double clampView(double value, double limit)
+{
+    if( value > limit )
+    {
+        return limit;
+    }else if( value < (-limit) )
+    {
+        return -limit;
+    }
+    return value;
 }
 
-void Measurements::on_newDataRedraw(rawData _rawData)
+void Measurements::createStatisticsCurves()
 {
-    on_newData(_rawData, true);
+    QPen swrPen(QColor(80, 80, 80, 200));
+    QPen rPen(QColor(255, 30, 40, 150));
+    QPen xPen(QColor(30, 255, 40, 150));
+    QPen pens[StatCurveCount] = {swrPen, swrPen, swrPen, rPen, rPen, rPen, xPen, xPen, xPen};
+    for(int i = 0; i < StatCurveCount; ++i)
+    {
+        QCustomPlot *widget = (i <= StatSwrMean) ? m_swrWidget : m_rsWidget;
+        m_statCurves[i] = new QCPCurve(widget->xAxis, widget->yAxis);
+        // holds dashed, the mean dotted, both thinner than the traces
+        pens[i].setWidthF(1.5);
+        pens[i].setStyle(((i == StatSwrMean) || (i == StatRMean) || (i == StatXMean)) ?
+                             Qt::DotLine : Qt::DashLine);
+        m_statCurves[i]->setPen(pens[i]);
+    }
 }
 
-void Measurements::on_newData(rawData _rawData, bool _redraw)
+void Measurements::setContinuousStatisticsEnabled(bool enabled)
 {
-    if(m_calibrationMode)
+    m_statisticsEnabled = enabled;
+    updateStatisticsCurves();
+    replot();
+}
+
+// folds the sweep in once, when its last point was appended
+void Measurements::updateStatistics()
+{
+    if((m_continuousDots < 0) || m_measurements.isEmpty() || m_sweepFolded)
     {
         return;
     }
+    const measurement &meas = m_measurements.last();
+    if(meas.dataRX.size() != m_statistics.points())
+    {
+        return;
+    }
+    m_sweepFolded = true;
+    const QVector <rawData> &data = (meas.dataRXCalib.size() == meas.dataRX.size()) ?
+                meas.dataRXCalib : meas.dataRX;
+    m_statistics.add(data.constData(), data.size(), m_Z0);
+    updateStatisticsCurves();
+    emit continuousSweep(data);
+}
 
-    m_measurements.last().dataRX.append(_rawData);
-
-    double VSWR;
-    double RL;
-    if(!computeSWR(_rawData.fq, m_Z0,_rawData.r,_rawData.x,&VSWR,&RL))
+void Measurements::updateStatisticsCurves()
+{
+    if(m_statCurves[0] == NULL)
     {
-        if(m_measurements.last().swrGraph.size() > 0)
-        {
-            VSWR = m_measurements.last().swrGraph.last().value;
-            RL = m_measurements.last().rlGraph.last().value;
-        }else
+        return;
+    }
+    // one sweep has nothing to hold yet
+    if(!m_statisticsEnabled || (m_statistics.sweeps() < 2))
+    {
+        for(int i = 0; i < StatCurveCount; ++i)
         {
-            return;
+            m_statCurves[i]->clearData();
         }
+        return;
     }
+    const double *columns[StatCurveCount] = {
+        m_statistics.maximum(SweepStatistics::Swr), m_statistics.minimum(SweepStatistics::Swr),
+        m_statistics.mean(SweepStatistics::Swr),
+        m_statistics.maximum(SweepStatistics::R), m_statistics.minimum(SweepStatistics::R),
+        m_statistics.mean(SweepStatistics::R),
+        m_statistics.maximum(SweepStatistics::X), m_statistics.minimum(SweepStatistics::X),
+        m_statistics.mean(SweepStatistics::X)};
     double maxSwr = m_swrWidget->yAxis->range().upper;
     double maxRs = m_rsWidget->yAxis->range().upper;
-    double maxRp = m_rpWidget->yAxis->range().upper;
-
-    QVector <double> x,y;
-    double fq = _rawData.fq*1000;
-    x.append(fq);
-    x.append(fq);
-    y.append(MIN_SWR);
-    y.append(MAX_SWR);
-
-    QCPData data;
-    data.key = fq;
-    data.value = VSWR;
-    m_measurements.last().swrGraph.insert(data.key,data);
-
-    m_swrWidget->graph(0)->setData(x,y);
-
-    y.clear();
-    y.append(m_phaseWidget->yAxis->getRangeLower());
-    y.append(m_phaseWidget->yAxis->getRangeUpper());
-    m_phaseWidget->graph(0)->setData(x,y);
-
-    y.clear();
-    y.append(m_rsWidget->yAxis->getRangeLower());
-    y.append(m_rsWidget->yAxis->getRangeUpper());
-    m_rsWidget->graph(0)->setData(x,y);
+    const double *fq = m_statistics.fq();
+    int size = m_statistics.size();
+    QVector <double> t, keys, values;
+    t.reserve(size);
+    keys.reserve(size);
+    values.reserve(size);
+    for(int i = 0; i < StatCurveCount; ++i)
+    {
+        t.resize(0);
+        keys.resize(0);
+        values.resize(0);
+        const double *column = columns[i];
+        for(int n = 0; n < size; ++n)
+        {
+            if(qIsNaN(column[n]))
+            {
+                continue;
+            }
+            t.append(n);
+            keys.append(fq[n]*1000);
+            values.append((i <= StatSwrMean) ? qMin(column[n], maxSwr) : clampView(column[n], maxRs));
+        }
+        m_statCurves[i]->setData(t, keys, values);
+    }
+}
 
-    y.clear();
-    y.append(m_rpWidget->yAxis->getRangeLower());
-    y.append(m_rpWidget->yAxis->getRangeUpper());
-    m_rpWidget->graph(0)->setData(x,y);
+void Measurements::createTrackerText()
+{
+    m_trackerText = new QCPItemText(m_swrWidget);
+    m_swrWidget->addItem(m_trackerText);
+    m_trackerText->setClipToAxisRect(true);
+    m_trackerText->position->setType(QCPItemPosition::ptAxisRectRatio);
+    m_trackerText->position->setCoords(0.99, 0.02);
+    m_trackerText->setPositionAlignment(Qt::AlignRight | Qt::AlignTop);
+    m_trackerText->setTextAlignment(Qt::AlignLeft);
+    m_trackerText->setBrush(QBrush(QColor(255, 255, 255, 200)));
+    m_trackerText->setPadding(QMargins(4, 2, 4, 2));
+    m_trackerText->setVisible(false);
+}
 
-    y.clear();
-    y.append(m_rlWidget->yAxis->getRangeLower());
-    y.append(m_rlWidget->yAxis->getRangeUpper());
-    m_rlWidget->graph(0)->setData(x,y);
-//------------------------------------------------------------------------------
-//------------------RXZ---------------------------------------------------------
-//------------------------------------------------------------------------------
-    double R = _rawData.r;
-    double X = _rawData.x;
-    double Z = computeZ(R, X);
+void Measurements::setTrackerEnabled(bool enabled)
+{
+    m_trackerEnabled = enabled;
+    updateTracker();
+    replot();
+}
 
-    data.value = R;
-    m_measurements.last().rsrGraph.insert(data.key,data);
-    if( R > maxRs )
-    {
-        data.value = maxRs;
-    }else if( R < (-maxRs) )
+static QString bandText(const TrackerBand &band, double limit)
+{
+    if(!band.isValid())
     {
-        data.value = -maxRs;
+        return QString();
     }
-    m_viewMeasurements.last().rsrGraph.insert(data.key,data);
+    return Measurements::tr("\nSWR %1: %2%3 - %4%5 MHz").arg(limit, 0, 'f', 1)
+            .arg(band.lowerOpen ? "<" : "").arg(band.lower, 0, 'f', 3)
+            .arg(band.upperOpen ? ">" : "").arg(band.upper, 0, 'f', 3);
+}
 
-    data.value = X;
-    m_measurements.last().rsxGraph.insert(data.key,data);
-    if( X > maxRs )
-    {
-        data.value = maxRs;
-    }else if( X < (-maxRs) )
+// publishes the tracker after new points, the work does not grow with the sweep
+void Measurements::updateTracker()
+{
+    const TrackerResult &result = m_tracker.result();
+    emit trackerChanged(result);
+    if(m_trackerText == NULL)
     {
-        data.value = -maxRs;
+        return;
     }
-    m_viewMeasurements.last().rsxGraph.insert(data.key,data);
-
-    data.value = Z;
-    m_measurements.last().rszGraph.insert(data.key,data);
-    if( Z > maxRs )
+    if(!m_trackerEnabled || qIsNaN(result.minSwr))
     {
-        data.value = maxRs;
-    }else if( Z < (-maxRs) )
-    {
-        data.value = -maxRs;
+        m_trackerText->setVisible(false);
+        return;
     }
-    m_viewMeasurements.last().rszGraph.insert(data.key,data);
-//------------------------------------------------------------------------------
-//------------------RXZ par-----------------------------------------------------
-//------------------------------------------------------------------------------
-    if (qIsNaN(R) || (R<0.001) )
+    QString text = tr("SWR %1 at %2 MHz").arg(result.minSwr, 0, 'f', 2).arg(result.minSwrFq, 0, 'f', 3);
+    if(!qIsNaN(result.resonance))
     {
-        R = 0.01;
+        text += tr("\nResonance %1 MHz").arg(result.resonance, 0, 'f', 3);
     }
-    if (qIsNaN(X))
+    text += bandText(result.band15, SweepTracker::limit(SweepTracker::Limit15));
+    text += bandText(result.band2, SweepTracker::limit(SweepTracker::Limit2));
+    if(!qIsNaN(result.q))
     {
-        X = 0;
+        text += tr("\nQ %1").arg(result.q, 0, 'f', 1);
     }
-    double Rpar = R*(1+X*X/R/R);
-    double Xpar = X*(1+R*R/X/X);
-    double Zpar = computeZ(R, X);
+    m_trackerText->setText(text);
+    m_trackerText->setVisible(true);
+}
 
-    data.value = Rpar;
-    m_measurements.last().rprGraph.insert(data.key,data);
-    if( Rpar > maxRp )
-    {
-        data.value = maxRp;
-    }else if( Rpar < (-maxRp) )
-    {
-        data.value = -maxRp;
-    }
-    m_viewMeasurements.last().rprGraph.insert(data.key,data);
+void Measurements::on_newDataRedraw(rawData _rawData)
+{
+    on_newData(_rawData, true);
+}
 
-    data.value = Xpar;
-    m_measurements.last().rpxGraph.insert(data.key,data);
-    if( Xpar > maxRp )
+void Measurements::on_newData(rawData _rawData, bool _redraw)
+{
+    if(m_calibrationMode)
     {
-        data.value = maxRp;
-    }else if( Xpar < (-maxRp) )
+        return;
+    }
+    if(m_merging)
     {
-        data.value = -maxRp;
+        m_mergeBuffer.append(_rawData);
+        return;
     }
-    m_viewMeasurements.last().rpxGraph.insert(data.key,data);
 
-    data.value = Zpar;
-    m_measurements.last().rpzGraph.insert(data.key,data);
-    if( Zpar > maxRp )
-    {
-        data.value = maxRp;
-    }else if( Zpar < (-maxRp) )
+    PointValues values;
+    computePoint(_rawData, calibrationPerformed() ? &m_calibration->standards() : NULL, values);
+    bool appended = appendPoint(values,
+                                m_swrWidget->yAxis->range().upper,
+                                m_rsWidget->yAxis->range().upper,
+                                m_rpWidget->yAxis->range().upper);
+    updateTracker();
+    if(!appended)
     {
-        data.value = -maxRp;
+        return;
     }
-    m_viewMeasurements.last().rpzGraph.insert(data.key,data);
+    updateStatistics();
 
-    data.value = RL;
-    m_measurements.last().rlGraph.insert(data.key,data);
+    // only the visible tab moves its cursor line, hidden tabs catch up when shown
+    m_cursorFq = _rawData.fq*1000;
+    updateCursorLine();
+    markTabsDirty(DirtyCursor);
+    markTraceDirty(m_measurements.length() - 1);
 
-//------------------------------------------------------------------------------
-//----------------------calc phase----------------------------------------------
-//------------------------------------------------------------------------------
+    if (_redraw)
+    {
+        // only the measurement being swept has changed
+        QSet <int> changed;
+        changed.insert(m_measurements.length() - 1);
+        redrawCurrentTab(&changed);
+    }
+}
 
-    if (qIsNaN(_rawData.r) || (_rawData.r<0.001) )
+void Measurements::appendData(const QVector<rawData> &_data, const QVector<rawData> *_calibrated)
+{
+    if(m_calibrationMode || m_measurements.isEmpty() || _data.isEmpty())
     {
-        _rawData.r = 0.01;
+        return;
     }
-    if (qIsNaN(_rawData.x))
+    int count = _data.size();
+    // the band set covering this data, whatever the last sweep was
+    const OslStandards *standards = NULL;
+    if((_calibrated == NULL) && calibrationPerformed())
     {
-        _rawData.x = 0;
+        double fqFrom = _data.first().fq;
+        double fqTo = fqFrom;
+        for(int i = 1; i < count; ++i)
+        {
+            fqFrom = qMin(fqFrom, _data.at(i).fq);
+            fqTo = qMax(fqTo, _data.at(i).fq);
+        }
+        standards = &m_calibration->standards(fqFrom, fqTo);
     }
-    double Rnorm = _rawData.r/m_Z0;
-    double Xnorm = _rawData.x/m_Z0;
-    double Denom = (Rnorm+1)*(Rnorm+1)+Xnorm*Xnorm;
-    double RhoReal = ((Rnorm-1)*(Rnorm+1)+Xnorm*Xnorm)/Denom;
-    double RhoImag = 2*Xnorm/Denom;
-    double RhoPhase = atan2(RhoImag, RhoReal) / M_PI * 180.0;
-    double RhoMod = sqrt(RhoReal*RhoReal+RhoImag*RhoImag);
-    data.value = RhoPhase;
-    m_measurements.last().phaseGraph.insert(data.key,data);
-    data.value = RhoMod;
-    m_measurements.last().rhoGraph.insert(data.key,data);
-//------------------------------------------------------------------------------
-//----------------------calc smith----------------------------------------------
-//------------------------------------------------------------------------------
-    double pointX,pointY;
-    NormRXtoSmithPoint(R/m_Z0, X/m_Z0, pointX, pointY);
-    double len = m_measurements.last().dataRX.length();
-    m_measurements.last().smithGraph.insert(len, QCPCurveData(len, pointX, pointY));
-    len = m_measurements.last().dataRX.length()*2 - 1;
-    m_measurements.last().smithGraphView.insert(len, QCPCurveData(len, pointX, pointY));
+    // calibrated points archived with the raw ones are taken as they are
+    bool archived = (_calibrated != NULL) && (_calibrated->size() == count);
+    bool calibrate = archived || (standards != NULL);
 
-//------------------------------------------------------------------------------
-//----------------------Calc calibration if performed---------------------------
-//------------------------------------------------------------------------------
-    if(m_calibration != NULL)
+    QVector <PointValues> values(count);
+    for(int i = 0; i < count; ++i)
     {
-        if(m_calibration->getCalibrationPerformed())
+        values[i].raw = _data.at(i);
+        if(archived)
         {
-            R = _rawData.r;
-            X = _rawData.x;
-            double Gre = (R*R-m_Z0*m_Z0+X*X)/((R+m_Z0)*(R+m_Z0)+X*X);
-            double Gim = (2*m_Z0*X)/((R+m_Z0)*(R+m_Z0)+X*X);
-
-            double GreOut;
-            double GimOut;
-
-            double SOR =  1; double SOI = 0; // Ideal model
-            double SSR = -1; double SSI = 0;
-            double SLR =  0; double SLI = 0;
-
-            double COR, COI; // CalibrationReOpen, CalibrationImOpen
-            double CSR, CSI; // CalibrationReShort, CalibrationImShort
-            double CLR, CLI; // CalibrationReLoad, CalibrationImLoad
-            bool res = m_calibration->interpolateS(_rawData.fq, COR, COI, CSR, CSI, CLR, CLI);
-//            COR = 1;
-//            COI = 0;
-//            CSR = -1;
-//            CSI = 0;
-//            CLR = 0;
-//            CLI = 0;
-
-            if (!res)
-            {
-                SOR =  1; SOI = 0; // Ideal model
-                SSR = -1; SSI = 0;
-                SLR =  0; SLI = 0;
-            }
-            m_calibration->applyCalibration(Gre,Gim,  // Measured
-                                            COR,COI,CSR,CSI,CLR,CLI, // Measured parameters of cal standards
-                                            SOR,SOI,SSR,SSI,SLR,SLI, // Actual (Ideal) parameters of cal standards
-                                            GreOut,GimOut); // Actual
-
-            double calR = (1-GreOut*GreOut-GimOut*GimOut)/((1-GreOut)*(1-GreOut)+GimOut*GimOut);
-            calR *= m_Z0;
-            double calX = (2*GimOut)/((1-GreOut)*(1-GreOut)+GimOut*GimOut);
-            calX *= m_Z0;
-            double calZ = computeZ(calR,calX);
-
-            rawData rawDataCalib = _rawData;
-            rawDataCalib.r = calR;
-            rawDataCalib.x = calX;
-            m_measurements.last().dataRXCalib.append(rawDataCalib);
-            computeSWR(_rawData.fq, m_Z0, calR, calX,&VSWR,&RL);
-
-            data.value = VSWR;
-            m_measurements.last().swrGraphCalib.insert(data.key,data);
-            if( VSWR > maxSwr )
-            {
-                data.value = maxSwr;
-            }
-            m_viewMeasurements.last().swrGraphCalib.insert(data.key,data);
-
-            data.value = calR;
-            m_measurements.last().rsrGraphCalib.insert(data.key,data);
-            if( calR > maxRs )
-            {
-                data.value = maxRs;
-            }else if( calR < (-maxRs) )
-            {
-                data.value = -maxRs;
-            }
-            m_viewMeasurements.last().rsrGraphCalib.insert(data.key,data);
-
-            data.value = calX;
-            m_measurements.last().rsxGraphCalib.insert(data.key,data);
-            if( calX > maxRs )
-            {
-                data.value = maxRs;
-            }else if( calX < (-maxRs) )
-            {
-                data.value = -maxRs;
-            }
-            m_viewMeasurements.last().rsxGraphCalib.insert(data.key,data);
-
-            data.value = calZ;
-            m_measurements.last().rszGraphCalib.insert(data.key,data);
-            if( calZ > maxRs )
-            {
-                data.value = maxRs;
-            }else if( calZ < (-maxRs) )
-            {
-                data.value = -maxRs;
-            }
-            m_viewMeasurements.last().rszGraphCalib.insert(data.key,data);
-
-
-            double calRpar = calR*(1+calX*calX/calR/calR);
-            double calZpar = computeZ(calRpar, calX);
-            data.value = calRpar;
-            m_measurements.last().rprGraphCalib.insert(data.key,data);
-            if( calRpar > maxRp )
-            {
-                data.value = maxRp;
-            }else if( calRpar < (-maxRp) )
-            {
-                data.value = -maxRp;
-            }
-            m_viewMeasurements.last().rprGraphCalib.insert(data.key,data);
-
-            data.value = calX;
-            m_measurements.last().rpxGraphCalib.insert(data.key,data);
-            if( calX > maxRp )
-            {
-                data.value = maxRp;
-            }else if( calX < (-maxRp) )
-            {
-                data.value = -maxRp;
-            }
-            m_viewMeasurements.last().rpxGraphCalib.insert(data.key,data);
-
-            data.value = calZpar;
-            m_measurements.last().rpzGraphCalib.insert(data.key,data);
-            if( calZpar > maxRp )
-            {
-                data.value = maxRp;
-            }else if( calZpar < (-maxRp) )
-            {
-                data.value = -maxRp;
-            }
-            m_viewMeasurements.last().rpzGraphCalib.insert(data.key,data);
-
-            data.value = RL;
-            m_measurements.last().rlGraphCalib.insert(data.key,data);
-
-            //----------------------calc phase---------------------------
-            if (qIsNaN(calR) || (calR<0.001) )
+            values[i].rawCalib = _calibrated->at(i);
+        }
+    }
+    // every point is independent of the others, only the append below is ordered
+    if(count >= BULK_PARALLEL_DOTS)
+    {
+        QtConcurrent::blockingMap(values, [this, standards, archived](PointValues &point)
+        {
+            computePoint(point.raw, standards, point);
+            if(archived)
             {
-                calR = 0.01;
+                computeCalibrated(point);
             }
-            if (qIsNaN(calX))
+        });
+    }else
+    {
+        for(int i = 0; i < count; ++i)
+        {
+            computePoint(values.at(i).raw, standards, values[i]);
+            if(archived)
             {
-                calX = 0;
+                computeCalibrated(values[i]);
             }
-            Rnorm = calR/m_Z0;
-            Xnorm = calX/m_Z0;
-
-            Denom = (Rnorm+1)*(Rnorm+1)+Xnorm*Xnorm;
-            RhoReal = ((Rnorm-1)*(Rnorm+1)+Xnorm*Xnorm)/Denom;
-            RhoImag = 2*Xnorm/Denom;
-
-            RhoPhase = atan2(RhoImag, RhoReal) / M_PI * 180.0;
-            RhoMod = sqrt(RhoReal*RhoReal+RhoImag*RhoImag);
-
-            QString msg = QString("f=%1, r=%2, x=%3, RhoPhase=%4")
-                    .arg(_rawData.fq, 0, 'f', 4, QLatin1Char(' '))
-                    .arg(calR, 0, 'f', 4, QLatin1Char(' '))
-                    .arg(calX, 0, 'f', 4, QLatin1Char(' '))
-                    .arg(RhoPhase, 0, 'f', 4, QLatin1Char(' '));
-            //qDebug() << "RhoPhase: " << msg;
-
-            data.value = RhoPhase;
-            m_measurements.last().phaseGraphCalib.insert(data.key,data);
-            data.value = RhoMod;
-            m_measurements.last().rhoGraphCalib.insert(data.key,data);
-            //----------------------calc phase end---------------------------
-            //----------------------calc smith-------------------------------
-
-            double ptX,ptY;
-            //NormRXtoSmithPoint(R/m_Z0, X/m_Z0, ptX, ptY);
-            NormRXtoSmithPoint(Rnorm, Xnorm, ptX, ptY);
-            int len = m_measurements.last().dataRX.length();
-            m_measurements.last().smithGraphCalib.insert(len, QCPCurveData(len, ptX, ptY));
-            len = m_measurements.last().dataRX.length()*2 - 1;
-            m_measurements.last().smithGraphViewCalib.insert(len, QCPCurveData(len, ptX, ptY));
-            //----------------------calc smith end---------------------------
         }
     }
-    if (_redraw)
-        on_redrawGraphs();
-}
-
-quint32 Measurements::computeSWR(double freq, double Z0, double R, double X, double *VSWR, double *RL)
-{
-    Q_UNUSED(freq);
-
-    if (R <= 0)
-    {
-        R = 0.001;
-    }
-    double SWR, Gamma;
-    double XX = X * X;								// always >= 0
-    double denominator = (R + Z0) * (R + Z0) + XX;
 
-    if (denominator == 0)
-    {
-        return 0;
-    }
-    Gamma = sqrt(((R - Z0) * (R - Z0) + XX) / denominator);
-    if (Gamma == 1.0)
-    {
-        return 0;
+    measurement &meas = m_measurements.last();
+    measurement &view = m_viewMeasurements.last();
+    int total = meas.dataRX.size() + count;
+    meas.dataRX.reserve(total);
+    QCPDataMap *maps[] = {&meas.swrGraph, &meas.phaseGraph, &meas.rhoGraph,
+                          &meas.rsrGraph, &meas.rsxGraph, &meas.rszGraph,
+                          &meas.rprGraph, &meas.rpxGraph, &meas.rpzGraph, &meas.rlGraph,
+                          &view.rsrGraph, &view.rsxGraph, &view.rszGraph,
+                          &view.rprGraph, &view.rpxGraph, &view.rpzGraph};
+    for(unsigned i = 0; i < sizeof(maps)/sizeof(maps[0]); ++i)
+    {
+        maps[i]->reserve(total);
+    }
+    meas.smithGraph.reserve(total);
+    meas.smithGraphView.reserve(total);
+    if(calibrate)
+    {
+        meas.dataRXCalib.reserve(total);
+        QCPDataMap *calibMaps[] = {&meas.swrGraphCalib, &meas.phaseGraphCalib, &meas.rhoGraphCalib,
+                                   &meas.rsrGraphCalib, &meas.rsxGraphCalib, &meas.rszGraphCalib,
+                                   &meas.rprGraphCalib, &meas.rpxGraphCalib, &meas.rpzGraphCalib,
+                                   &meas.rlGraphCalib,
+                                   &view.swrGraphCalib, &view.rsrGraphCalib, &view.rsxGraphCalib,
+                                   &view.rszGraphCalib, &view.rprGraphCalib, &view.rpxGraphCalib,
+                                   &view.rpzGraphCalib};
+        for(unsigned i = 0; i < sizeof(calibMaps)/sizeof(calibMaps[0]); ++i)
+        {
+            calibMaps[i]->reserve(total);
+        }
+        meas.smithGraphCalib.reserve(total);
+        meas.smithGraphViewCalib.reserve(total);
     }
-    SWR = (1 + Gamma) / (1 - Gamma);
 
-    if ((SWR > 200) || (Gamma > 0.99))
-    {
-        SWR = 200;
-    } else if (SWR < 1)
+    double maxSwr = m_swrWidget->yAxis->range().upper;
+    double maxRs = m_rsWidget->yAxis->range().upper;
+    double maxRp = m_rpWidget->yAxis->range().upper;
+    bool appended = false;
+    bool lastAppended = false;
+    for(int i = 0; i < count; ++i)
     {
-        SWR = 1;
+        lastAppended = appendPoint(values.at(i), maxSwr, maxRs, maxRp);
+        if(lastAppended)
+        {
+            m_cursorFq = values.at(i).raw.fq*1000;
+            appended = true;
+        }
     }
-    if (VSWR)
+    if(lastAppended)
     {
-        *VSWR = SWR;
+        updateStatistics();
     }
-    if (RL)
+    updateTracker();
+    if(appended)
     {
-        if (Gamma == 0)
-        {
-            return 0;
-        }
-        *RL = -20 * log10(Gamma);
+        updateCursorLine();
+        markTabsDirty(DirtyCursor);
+        markTraceDirty(m_measurements.length() - 1);
     }
-    return 1;
-}
-
-double Measurements::computeZ (double R, double X)
-{
-    return sqrt((R*R) + (X*X));
-}
-
-void Measurements::on_currentTab(QString name)
-{
-    m_currentTab = name;
-    on_redrawGraphs();
-}
-
-void Measurements::setGraphHintEnabled(bool enabled)
-{
-    m_graphHintEnabled = enabled;
-    showHideHints();
 }
 
-void Measurements::setGraphBriefHintEnabled(bool enabled)
+static bool lessFq(const rawData &a, const rawData &b)
 {
-    m_graphBriefHintEnabled = enabled;
-    showHideHints();
+    return a.fq < b.fq;
 }
 
-void Measurements::on_focus(bool focus)
+void Measurements::beginMerge()
 {
-    m_focus = focus;
-    showHideHints();
+    m_merging = true;
+    m_mergeBuffer.resize(0);
 }
 
-void Measurements::hideGraphBriefHint()
+// The new points are sorted in with the cached ones and the measurement is
+// rebuilt from the merged list, so dataRX, the smith curves and the tracker
+// stay in frequency order as after a single sweep. A point measured again
+// replaces the old one.
+void Measurements::endMerge()
 {
-    if(m_graphBriefHint)
+    m_merging = false;
+    if(m_measurements.isEmpty() || m_mergeBuffer.isEmpty())
     {
-        m_graphBriefHint->focusHide();
+        m_mergeBuffer.resize(0);
+        return;
     }
-}
+    std::stable_sort(m_mergeBuffer.begin(), m_mergeBuffer.end(), lessFq);
 
-void Measurements::showHideHints()
-{
-    if(m_graphHint)
+    const QVector <rawData> &cached = m_measurements.last().dataRX;
+    QVector <rawData> merged;
+    merged.reserve(cached.size() + m_mergeBuffer.size());
+    int i = 0;
+    int j = 0;
+    while((i < cached.size()) || (j < m_mergeBuffer.size()))
     {
-        if(m_graphHintEnabled && m_focus)
+        if(j == m_mergeBuffer.size())
         {
-            m_graphHint->focusShow();
-        }else
+            merged.append(cached.at(i++));
+        }else if((i == cached.size()) || (m_mergeBuffer.at(j).fq < cached.at(i).fq))
         {
-            m_graphHint->focusHide();
-        }
-    }
-    if(m_graphBriefHint)
-    {
-        if(m_graphBriefHintEnabled && m_focus)
+            merged.append(m_mergeBuffer.at(j++));
+        }else if(m_mergeBuffer.at(j).fq == cached.at(i).fq)
         {
-            m_graphBriefHint->focusShow();
+            ++i;
+            merged.append(m_mergeBuffer.at(j++));
         }else
         {
-            m_graphBriefHint->focusHide();
+            merged.append(cached.at(i++));
         }
     }
+    m_mergeBuffer.resize(0);
+
+    // save, export and the archives record the merged range and points,
+    // center and span in Hz as sent to the analyzer
+    qint64 fqFrom = qint64(merged.first().fq*1000000);
+    qint64 fqTo = qint64(merged.last().fq*1000000);
+    measurement *lists[] = {&m_measurements.last(), &m_viewMeasurements.last(),
+                            &m_farEndMeasurementsAdd.last(), &m_farEndMeasurementsSub.last()};
+    for(unsigned n = 0; n < sizeof(lists)/sizeof(lists[0]); ++n)
+    {
+        lists[n]->dataRX.resize(0);
+        lists[n]->dataRXCalib.resize(0);
+        clearTraces(*lists[n]);
+        lists[n]->set((fqFrom + fqTo)/2, fqTo - fqFrom, merged.size() - 1);
+    }
+    m_tracker.reset();
+    m_listModel->invalidate(m_measurements.size() - 1);
+    // the band set is chosen for the merged range, the strips outside the
+    // first sweep are not clamped to its edge terms
+    appendData(merged);
+    on_redrawGraphs();
 }
 
-void Measurements::on_newCursorFq(double x, int number, int mouseX, int mouseY)
+bool Measurements::calibrationPerformed()
 {
-    updatePopUp(x, number, mouseX, mouseY);
+    return (m_calibration != NULL) && m_calibration->getCalibrationPerformed();
 }
 
-void Measurements::on_newCursorSmithPos (double x, double y, int index)
+// _standards NULL for no calibration
+void Measurements::computePoint(const rawData &_rawData, const OslStandards *_standards, PointValues &values)
 {
-    QCPCurveDataMap map;
-    if((m_calibration != NULL) && (m_calibration->getCalibrationEnabled()))
+    values.raw = _rawData;
+    values.swrValid = computeSWR(_rawData.fq, m_Z0, _rawData.r, _rawData.x, &values.swr, &values.rl) != 0;
+//------------------------------------------------------------------------------
+//------------------RXZ---------------------------------------------------------
+//------------------------------------------------------------------------------
+    double R = _rawData.r;
+    double X = _rawData.x;
+    values.r = R;
+    values.x = X;
+    values.z = computeZ(R, X);
+//------------------------------------------------------------------------------
+//------------------RXZ par-----------------------------------------------------
+//------------------------------------------------------------------------------
+    if (qIsNaN(R) || (R<0.001) )
     {
-        map = m_measurements.at(index).smithGraphCalib;
-    }else
+        R = 0.01;
+    }
+    if (qIsNaN(X))
     {
-        map = m_measurements.at(index).smithGraph;
+        X = 0;
     }
-    QList <QCPCurveData> dataList = map.values();
-    if(dataList.isEmpty())
+    values.rpar = R*(1+X*X/R/R);
+    values.xpar = X*(1+R*R/X/X);
+    values.zpar = computeZ(R, X);
+//------------------------------------------------------------------------------
+//----------------------calc phase and smith------------------------------------
+//------------------------------------------------------------------------------
+    computeReflection(R, X, values.phase, values.rho, values.smithX, values.smithY);
+
+//------------------------------------------------------------------------------
+//----------------------Calc calibration if performed---------------------------
+//------------------------------------------------------------------------------
+    values.calibrated = (_standards != NULL);
+    if(!values.calibrated)
     {
         return;
     }
-    int findedNum = 0;
-    bool finded = false;
-    for(double n = 0; n < 6; n+=0.1)
+    SweepMath::calibrate(*_standards, m_Z0, &_rawData, &values.rawCalib, 1);
+    computeCalibrated(values);
+}
+
+// the calibrated values from values.rawCalib
+void Measurements::computeCalibrated(PointValues &values)
+{
+    values.calibrated = true;
+    double calR = values.rawCalib.r;
+    double calX = values.rawCalib.x;
+    values.calSwrValid = computeSWR(values.raw.fq, m_Z0, calR, calX, &values.calSwr, &values.calRl) != 0;
+    values.calR = calR;
+    values.calX = calX;
+    values.calZ = computeZ(calR, calX);
+    values.calRpar = calR*(1+calX*calX/calR/calR);
+    values.calZpar = computeZ(values.calRpar, calX);
+
+    //----------------------calc phase and smith----------------
+    if (qIsNaN(calR) || (calR<0.001) )
+    {
+        calR = 0.01;
+    }
+    if (qIsNaN(calX))
+    {
+        calX = 0;
+    }
+    computeReflection(calR, calX, values.calPhase, values.calRho, values.calSmithX, values.calSmithY);
+}
+
+// phase and magnitude of the reflection at Z0 and its point on the smith chart
+void Measurements::computeReflection(double R, double X, double &phase, double &rho,
+                                     double &smithX, double &smithY)
+{
+    double Rnorm = R/m_Z0;
+    double Xnorm = X/m_Z0;
+    double Denom = (Rnorm+1)*(Rnorm+1)+Xnorm*Xnorm;
+    double RhoReal = ((Rnorm-1)*(Rnorm+1)+Xnorm*Xnorm)/Denom;
+    double RhoImag = 2*Xnorm/Denom;
+    phase = atan2(RhoImag, RhoReal) / M_PI * 180.0;
+    rho = sqrt(RhoReal*RhoReal+RhoImag*RhoImag);
+    NormRXtoSmithPoint(Rnorm, Xnorm, smithX, smithY);
+}
+
+bool Measurements::appendPoint(const PointValues &values, double maxSwr, double maxRs, double maxRp)
+{
+    measurement &meas = m_measurements.last();
+    measurement &view = m_viewMeasurements.last();
+
+    meas.dataRX.append(values.raw);
+    m_tracker.add(values.calibrated ? values.rawCalib : values.raw);
+
+    double VSWR = values.swr;
+    double RL = values.rl;
+    if(!values.swrValid)
     {
-        for(int i = 0; i < dataList.length(); ++i)
+        if(meas.swrGraph.size() > 0)
         {
-            if( ((x >= dataList.at(i).key - n) && (x <= dataList.at(i).key + n)) &&
-                 (y >= dataList.at(i).value - n) && (y <= dataList.at(i).value + n))
-            {
-                findedNum = i;
-                finded = true;
-                break;
-            }
-        }
-        if(finded)
+            VSWR = meas.swrGraph.last().value;
+            RL = meas.rlGraph.last().value;
+        }else
         {
-            break;
+            return false;
         }
     }
-    if(m_smithTracer == NULL)
+
+    QCPData data;
+    data.key = values.raw.fq*1000;
+    data.value = VSWR;
+    meas.swrGraph.insert(data.key,data);
+
+    data.value = values.r;
+    meas.rsrGraph.insert(data.key,data);
+    data.value = clampView(values.r, maxRs);
+    view.rsrGraph.insert(data.key,data);
+
+    data.value = values.x;
+    meas.rsxGraph.insert(data.key,data);
+    data.value = clampView(values.x, maxRs);
+    view.rsxGraph.insert(data.key,data);
+
+    data.value = values.z;
+    meas.rszGraph.insert(data.key,data);
+    data.value = clampView(values.z, maxRs);
+    view.rszGraph.insert(data.key,data);
+
+    data.value = values.rpar;
+    meas.rprGraph.insert(data.key,data);
+    data.value = clampView(values.rpar, maxRp);
+    view.rprGraph.insert(data.key,data);
+
+    data.value = values.xpar;
+    meas.rpxGraph.insert(data.key,data);
+    data.value = clampView(values.xpar, maxRp);
+    view.rpxGraph.insert(data.key,data);
+
+    data.value = values.zpar;
+    meas.rpzGraph.insert(data.key,data);
+    data.value = clampView(values.zpar, maxRp);
+    view.rpzGraph.insert(data.key,data);
+
+    data.value = RL;
+    meas.rlGraph.insert(data.key,data);
+
+    data.value = values.phase;
+    meas.phaseGraph.insert(data.key,data);
+    data.value = values.rho;
+    meas.rhoGraph.insert(data.key,data);
+
+    double len = meas.dataRX.length();
+    meas.smithGraph.insert(len, QCPCurveData(len, values.smithX, values.smithY));
+    len = meas.dataRX.length()*2 - 1;
+    meas.smithGraphView.insert(len, QCPCurveData(len, values.smithX, values.smithY));
+
+    if(!values.calibrated)
     {
-        m_smithTracer = new QCPItemEllipse(m_smithWidget);
+        return true;
     }
-    m_smithTracer->setAntialiased(true);
-    QPen pen;
-    pen.setColor(QColor(250,30,20,180));
-    pen.setWidth(4);
-    m_smithTracer->setPen(pen);
-    m_smithTracer->topLeft->setCoords(dataList.at(findedNum).key-0.1, dataList.at(findedNum).value+0.1);
-    m_smithTracer->bottomRight->setCoords(dataList.at(findedNum).key+0.1, dataList.at(findedNum).value-0.1);
-    m_smithWidget->replot();
+    meas.dataRXCalib.append(values.rawCalib);
+    // keep the near end values if the calibrated point has no SWR
+    if(values.calSwrValid)
+    {
+        VSWR = values.calSwr;
+        RL = values.calRl;
+    }
+
+    data.value = VSWR;
+    meas.swrGraphCalib.insert(data.key,data);
+    data.value = (VSWR > maxSwr) ? maxSwr : VSWR;
+    view.swrGraphCalib.insert(data.key,data);
+
+    data.value = values.calR;
+    meas.rsrGraphCalib.insert(data.key,data);
+    data.value = clampView(values.calR, maxRs);
+    view.rsrGraphCalib.insert(data.key,data);
+
+    data.value = values.calX;
+    meas.rsxGraphCalib.insert(data.key,data);
+    data.value = clampView(values.calX, maxRs);
+    view.rsxGraphCalib.insert(data.key,data);
+
+    data.value = values.calZ;
+    meas.rszGraphCalib.insert(data.key,data);
+    data.value = clampView(values.calZ, maxRs);
+    view.rszGraphCalib.insert(data.key,data);
+
+    data.value = values.calRpar;
+    meas.rprGraphCalib.insert(data.key,data);
+    data.value = clampView(values.calRpar, maxRp);
+    view.rprGraphCalib.insert(data.key,data);
+
+    data.value = values.calX;
+    meas.rpxGraphCalib.insert(data.key,data);
+    data.value = clampView(values.calX, maxRp);
+    view.rpxGraphCalib.insert(data.key,data);
+
+    data.value = values.calZpar;
+    meas.rpzGraphCalib.insert(data.key,data);
+    data.value = clampView(values.calZpar, maxRp);
+    view.rpzGraphCalib.insert(data.key,data);
 
+    data.value = RL;
+    meas.rlGraphCalib.insert(data.key,data);
+
+    data.value = values.calPhase;
+    meas.phaseGraphCalib.insert(data.key,data);
+    data.value = values.calRho;
+    meas.rhoGraphCalib.insert(data.key,data);
+
+    int calLen = meas.dataRX.length();
+    meas.smithGraphCalib.insert(calLen, QCPCurveData(calLen, values.calSmithX, values.calSmithY));
+    calLen = meas.dataRX.length()*2 - 1;
+    meas.smithGraphViewCalib.insert(calLen, QCPCurveData(calLen, values.calSmithX, values.calSmithY));
+    return true;
+}
 
+quint32 Measurements::computeSWR(double freq, double Z0, double R, double X, double *VSWR, double *RL)
+{
+    Q_UNUSED(freq);
+    return SweepMath::swr(Z0, R, X, VSWR, RL);
+}
 
-    QCPDataMap *swrmap;
-    if((m_calibration != NULL) && (m_calibration->getCalibrationEnabled()))
+double Measurements::computeZ (double R, double X)
+{
+    return SweepMath::z(R, X);
+}
+
+void Measurements::on_currentTab(QString name)
+{
+    m_currentTab = name;
+    int dirty = m_dirtyTabs.take(name);
+    QSet <int> traces = m_dirtyTraces.take(name);
+    if(dirty & DirtyCursor)
+    {
+        updateCursorLine();
+    }
+    // only the measurements that changed while the tab was hidden are rebuilt,
+    // a clean tab is just replotted
+    if((dirty & DirtyTraces) && (m_calibration != NULL))
+    {
+        redrawCurrentTab();
+    }else if(!traces.isEmpty() && (m_calibration != NULL))
     {
-        swrmap = &(m_measurements[index].swrGraphCalib);
+        redrawCurrentTab(&traces);
     }else
     {
-        swrmap = &(m_measurements[index].swrGraph);
+        replot();
     }
-    QList <double> swrkeys = swrmap->keys();
-
-    double frequency = 0;
-    double swr = 0;
-    double phase = 0;
-    double rho = 0;
-    double rl = 0;
-    double l = 0;
-    double c = 0;
-    double lpar = 0;
-    double cpar = 0;
-    double r = 0;
-    double x1 = 0;
-    double z = 0;
-    double rpar = 0;
-    double xpar = 0;
-    QString zString;
-    QString zparString;
-
-    frequency = findedNum < swrkeys.size() ? swrkeys.at(findedNum) : swrkeys.last();
+}
 
-    if(m_calibration->getCalibrationEnabled())
+void Measurements::markTabsDirty(int flags)
+{
+    static const char *tabs[] = {"tab_1", "tab_2", "tab_3", "tab_4", "tab_5", "tab_6", "tab_7"};
+    for(int i = 0; i < 7; ++i)
     {
-        if(m_farEndMeasurement == 1)
-        {
-            rho = m_farEndMeasurementsSub.at(index).rhoGraph.value(frequency).value;
-            phase = m_farEndMeasurementsSub.at(index).phaseGraph.value(frequency).value;
-            r = m_farEndMeasurementsSub.at(index).rsrGraph.value(frequency).value;//dataRX.at(previousI).r;
-            x1 = m_farEndMeasurementsSub.at(index).rsxGraph.value(frequency).value;//dataRX.at(previousI).x;
-        }else if(m_farEndMeasurement == 2)
+        QString tab = tabs[i];
+        if(tab != m_currentTab)
         {
-            rho = m_farEndMeasurementsAdd.at(index).rhoGraph.value(frequency).value;
-            phase = m_farEndMeasurementsAdd.at(index).phaseGraph.value(frequency).value;
-            r = m_farEndMeasurementsAdd.at(index).rsrGraph.value(frequency).value;//dataRX.at(previousI).r;
-            x1 = m_farEndMeasurementsAdd.at(index).rsxGraph.value(frequency).value;//dataRX.at(previousI).x;
-        }else
-        {
-            rho = m_measurements.at(index).rhoGraph.value(frequency).value;
-            phase = m_measurements.at(index).phaseGraphCalib.value(frequency).value;
-            r = m_measurements.at(index).dataRXCalib.at(findedNum).r;
-            x1 = m_measurements.at(index).dataRXCalib.at(findedNum).x;
+            m_dirtyTabs[tab] |= flags;
+            if(flags & DirtyTraces)
+            {
+                m_dirtyTraces.remove(tab);
+            }
         }
-        swr = m_measurements.at(index).swrGraphCalib.value(frequency).value;
-        rl = m_measurements.at(index).rlGraphCalib.value(frequency).value;
-        z = m_viewMeasurements.at(index).rszGraphCalib.value(frequency).value;
-        rpar = m_viewMeasurements.at(index).rprGraphCalib.value(frequency).value;
-        xpar = m_viewMeasurements.at(index).rpxGraphCalib.value(frequency).value;
-    }else
+    }
+}
+
+void Measurements::markTraceDirty(int index)
+{
+    static const char *tabs[] = {"tab_1", "tab_2", "tab_3", "tab_4", "tab_5", "tab_6", "tab_7"};
+    for(int i = 0; i < 7; ++i)
     {
-        if(m_farEndMeasurement == 1)
-        {
-            rho = m_farEndMeasurementsSub.at(index).rhoGraph.value(frequency).value;
-            phase = m_farEndMeasurementsSub.at(index).phaseGraph.value(frequency).value;
-            r = m_farEndMeasurementsSub.at(index).rsrGraph.value(frequency).value;//dataRX.at(previousI).r;
-            x1 = m_farEndMeasurementsSub.at(index).rsxGraph.value(frequency).value;//dataRX.at(previousI).x;
-        }else if(m_farEndMeasurement == 2)
-        {
-            rho = m_farEndMeasurementsAdd.at(index).rhoGraph.value(frequency).value;
-            phase = m_farEndMeasurementsAdd.at(index).phaseGraph.value(frequency).value;
-            r = m_farEndMeasurementsAdd.at(index).rsrGraph.value(frequency).value;//dataRX.at(previousI).r;
-            x1 = m_farEndMeasurementsAdd.at(index).rsxGraph.value(frequency).value;//dataRX.at(previousI).x;
-        }else
+        QString tab = tabs[i];
+        if((tab != m_currentTab) && !(m_dirtyTabs.value(tab) & DirtyTraces))
         {
-            rho = m_measurements.at(index).rhoGraph.value(frequency).value;
-            phase = m_measurements.at(index).phaseGraph.value(frequency).value;
-            r = m_measurements.at(index).dataRX.at(findedNum).r;
-            x1 = m_measurements.at(index).dataRX.at(findedNum).x;
+            m_dirtyTraces[tab].insert(index);
         }
-        swr = m_measurements.at(index).swrGraph.value(frequency).value;
-        rl = m_measurements.at(index).rlGraph.value(frequency).value;
-        z = m_viewMeasurements.at(index).rszGraph.value(frequency).value;
-        rpar = m_viewMeasurements.at(index).rprGraph.value(frequency).value;
-        xpar = m_viewMeasurements.at(index).rpxGraph.value(frequency).value;
     }
+}
 
-    zString+= QString::number(r,'f', 2);
-    if(x1 >= 0)
+void Measurements::updateCursorLine()
+{
+    QCustomPlot *widget = NULL;
+    if(m_currentTab == "tab_1")
     {
-        if (x1 > 2000)
-            x1 = 2000; // HUCK
-        zString+= " + j";
-        zString+= QString::number(x1,'f', 2);
-    }else
+        widget = m_swrWidget;
+    }else if(m_currentTab == "tab_2")
     {
-        if (x1 < -2000)
-            x1 = -2000; // HUCK
-        zString+= " - j";
-        zString+= QString::number((x1 * (-1)),'f', 2);
+        widget = m_phaseWidget;
+    }else if(m_currentTab == "tab_3")
+    {
+        widget = m_rsWidget;
+    }else if(m_currentTab == "tab_4")
+    {
+        widget = m_rpWidget;
+    }else if(m_currentTab == "tab_5")
+    {
+        widget = m_rlWidget;
     }
-    zparString+= QString::number(rpar,'f', 2);
-    if(x1 >= 0)
+    if(widget == NULL)
     {
-        zparString+= " + j";
-        zparString+= QString::number(xpar,'f', 2);
+        return;
+    }
+    QVector <double> x,y;
+    x.append(m_cursorFq);
+    x.append(m_cursorFq);
+    if(widget == m_swrWidget)
+    {
+        y.append(MIN_SWR);
+        y.append(MAX_SWR);
     }else
     {
-        zparString+= " - j";
-        zparString+= QString::number((xpar * (-1)),'f', 2);
+        y.append(widget->yAxis->getRangeLower());
+        y.append(widget->yAxis->getRangeUpper());
     }
-    l = 1E9 * x1 / (2*M_PI * frequency * 1E3);//nH
-    c = 1E12 / (2*M_PI * frequency * (x1 * (-1)) * 1E3);//pF
+    widget->graph(0)->setData(x,y);
+}
 
-    lpar = 1E9 * xpar / (2*M_PI * frequency * 1E3);//nH
-    cpar = 1E12 / (2*M_PI * frequency * (xpar * (-1)) * 1E3);//pF
+void Measurements::setGraphHintEnabled(bool enabled)
+{
+    m_graphHintEnabled = enabled;
+    showHideHints();
+}
 
-    QString str = QString::number(frequency);
-    int pos = str.indexOf(".");
-    if(pos < 0)
+void Measurements::setGraphBriefHintEnabled(bool enabled)
+{
+    m_graphBriefHintEnabled = enabled;
+    showHideHints();
+}
+
+void Measurements::on_focus(bool focus)
+{
+    m_focus = focus;
+    showHideHints();
+}
+
+void Measurements::hideGraphBriefHint()
+{
+    if(m_graphBriefHint)
     {
-        if(str.length() > 6)
+        m_graphBriefHint->focusHide();
+    }
+}
+
+void Measurements::showHideHints()
+{
+    if(m_graphHint)
+    {
+        if(m_graphHintEnabled && m_focus)
         {
-            str.insert(str.length()-6," ");
-        }
-        if(str.length() > 3)
+            m_graphHint->focusShow();
+        }else
         {
-            str.insert(str.length()-3," ");
+            m_graphHint->focusHide();
         }
-    }else
+    }
+    if(m_graphBriefHint)
     {
-        int len = str.length() - pos;
-        if((str.length()-len) > 6)
+        if(m_graphBriefHintEnabled && m_focus)
         {
-            str.insert(str.length()-len-6," ");
+            m_graphBriefHint->focusShow();
+        }else
+        {
+            m_graphBriefHint->focusHide();
         }
-        if((str.length()-len) > 3)
+    }
+}
+
+void Measurements::on_newCursorFq(double x, int number, int mouseX, int mouseY)
+{
+    updatePopUp(x, number, mouseX, mouseY);
+}
+
+void Measurements::on_newCursorSmithPos (double x, double y, int index)
+{
+    QCPCurveDataMap *map;
+    if((m_calibration != NULL) && (m_calibration->getCalibrationEnabled()))
+    {
+        map = &(m_measurements[index].smithGraphCalib);
+    }else
+    {
+        map = &(m_measurements[index].smithGraph);
+    }
+    if(map->isEmpty())
+    {
+        return;
+    }
+    int findedNum = 0;
+    double findedDist = 6;
+    int i = 0;
+    for(QCPCurveDataMap::const_iterator it = map->constBegin(); it != map->constEnd(); ++it, ++i)
+    {
+        double dist = qMax(qAbs(x - it.value().key), qAbs(y - it.value().value));
+        if(dist < findedDist)
         {
-            str.insert(str.length()-len-3," ");
+            findedDist = dist;
+            findedNum = i;
         }
     }
+    QCPCurveData point = (map->constBegin() + findedNum).value();
+    if(m_smithTracer == NULL)
+    {
+        m_smithTracer = new QCPItemEllipse(m_smithWidget);
+    }
+    m_smithTracer->setAntialiased(true);
+    QPen pen;
+    pen.setColor(QColor(250,30,20,180));
+    pen.setWidth(4);
+    m_smithTracer->setPen(pen);
+    m_smithTracer->topLeft->setCoords(point.key-0.1, point.value+0.1);
+    m_smithTracer->bottomRight->setCoords(point.key+0.1, point.value-0.1);
+    m_smithWidget->replot();
+
+    TraceLookup lookup = traceLookup(index);
+    TracePoint tracePoint;
+    if(!lookup.at(qMin(findedNum, lookup.size()-1), tracePoint))
+    {
+        return;
+    }
+    m_graphHint->setPopupText(hintText(tracePoint));
+}
+
+TraceLookup Measurements::traceLookup(int index)
+{
+    if((index < 0) || (index >= m_measurements.length()))
+    {
+        return TraceLookup();
+    }
+    bool calib = (m_calibration != NULL) && (m_calibration->getCalibrationEnabled());
+    const QVector<rawData> *data = calib ? &m_measurements.at(index).dataRXCalib
+                                         : &m_measurements.at(index).dataRX;
+    const QVector<rawData> *impedance = data;
+    if(m_farEndMeasurement == 1)
+    {
+        impedance = &m_farEndMeasurementsSub.at(index).dataRX;
+    }else if(m_farEndMeasurement == 2)
+    {
+        impedance = &m_farEndMeasurementsAdd.at(index).dataRX;
+    }
+    return TraceLookup(data, m_Z0, impedance);
+}
+
+QString Measurements::hintText(const TracePoint &point)
+{
+    double x = point.x;
+    QString zString = QString::number(point.r,'f', 2);
+    if(x >= 0)
+    {
+        if (x > 2000)
+            x = 2000; // HUCK
+        zString+= " + j";
+        zString+= QString::number(x,'f', 2);
+    }else
+    {
+        if (x < -2000)
+            x = -2000; // HUCK
+        zString+= " - j";
+        zString+= QString::number((x * (-1)),'f', 2);
+    }
+    QString zparString = QString::number(point.rpar,'f', 2);
+    if(x >= 0)
+    {
+        zparString+= " + j";
+        zparString+= QString::number(point.xpar,'f', 2);
+    }else
+    {
+        zparString+= " - j";
+        zparString+= QString::number((point.xpar * (-1)),'f', 2);
+    }
+    double frequency = point.fq;
+    double l = 1E9 * x / (2*M_PI * frequency * 1E3);//nH
+    double c = 1E12 / (2*M_PI * frequency * (x * (-1)) * 1E3);//pF
+    double lpar = 1E9 * point.xpar / (2*M_PI * frequency * 1E3);//nH
+    double cpar = 1E12 / (2*M_PI * frequency * (point.xpar * (-1)) * 1E3);//pF
 
+    QString str = frequencyText(frequency);
 
     QString text;
-    if(x1 > 0)
+    if(x > 0)
     {
         text = QString(tr("Frequency = %1 kHz\n"
                           "SWR = %2\n"
@@ -1127,16 +1319,16 @@ void Measurements::on_newCursorSmithPos (double x, double y, int index)
                           "L = %8 nH\n"
                           "Zpar = %9 Ohm\n"
                           "Lpar = %10 nH\n"))
-        .arg(str)
-        .arg(QString::number(swr,'f', 2))
-        .arg(QString::number(rl,'f', 2))
-        .arg(zString)
-        .arg(QString::number(z,'f', 2))
-        .arg(QString::number(rho,'f', 2))
-        .arg(QString::number(phase,'f', 2))
-        .arg(QString::number(l,'f', 2))
-        .arg(zparString)
-        .arg(QString::number(lpar,'f', 2));
+            .arg(str)
+            .arg(QString::number(point.swr,'f', 2))
+            .arg(QString::number(point.rl,'f', 2))
+            .arg(zString)
+            .arg(QString::number(point.z,'f', 2))
+            .arg(QString::number(point.rho,'f', 2))
+            .arg(QString::number(point.phase,'f', 2))
+            .arg(QString::number(l,'f', 2))
+            .arg(zparString)
+            .arg(QString::number(lpar,'f', 2));
     }else
     {
         text = QString(tr("Frequency = %1 kHz\n"
@@ -1148,16 +1340,16 @@ void Measurements::on_newCursorSmithPos (double x, double y, int index)
                           "C = %8 pF\n"
                           "Zpar = %9 Ohm\n"
                           "Cpar = %10 pF\n"))
-        .arg(str)
-        .arg(QString::number(swr,'f', 2))
-        .arg(QString::number(rl,'f', 2))
-        .arg(zString)
-        .arg(QString::number(z,'f', 2))
-        .arg(QString::number(rho,'f', 2))
-        .arg(QString::number(phase,'f', 2))
-        .arg(QString::number(c,'f', 2))
-        .arg(zparString)
-        .arg(QString::number(cpar,'f', 2));
+            .arg(str)
+            .arg(QString::number(point.swr,'f', 2))
+            .arg(QString::number(point.rl,'f', 2))
+            .arg(zString)
+            .arg(QString::number(point.z,'f', 2))
+            .arg(QString::number(point.rho,'f', 2))
+            .arg(QString::number(point.phase,'f', 2))
+            .arg(QString::number(c,'f', 2))
+            .arg(zparString)
+            .arg(QString::number(cpar,'f', 2));
     }
 
     if(!m_farEndMeasurement)
@@ -1188,172 +1380,129 @@ void Measurements::on_newCursorSmithPos (double x, double y, int index)
                 .arg(lenUnits);
         text += cableString;
     }
+    return text;
+}
 
-    m_graphHint->setPopupText(text);
+QString Measurements::frequencyText(double frequency)
+{
+    QString str = QString::number(frequency);
+    int pos = str.indexOf(".");
+    if(pos < 0)
+    {
+        if(str.length() > 6)
+        {
+            str.insert(str.length()-6," ");
+        }
+        if(str.length() > 3)
+        {
+            str.insert(str.length()-3," ");
+        }
+    }else
+    {
+        int len = str.length() - pos;
+        if((str.length()-len) > 6)
+        {
+            str.insert(str.length()-len-6," ");
+        }
+        if((str.length()-len) > 3)
+        {
+            str.insert(str.length()-len-3," ");
+        }
+    }
+    return str;
 }
 
 void Measurements::updatePopUp(double xPos, int index, int mouseX, int mouseY)
 {
-#define DELTA 5
-    static int previousI = 0;
     if(m_graphHint)
     {
         if(m_currentTab == "tab_6")
         {
-            QCPDataMap *tdrmap;
-            double pdTdrImp;
-            double pdTdrStep;
+            const measurement *tdrMeasurement;
             if(m_farEndMeasurement == 1)
             {
-                if(m_measureSystemMetric)
-                {
-                    tdrmap = &(m_farEndMeasurementsSub[index].tdrImpGraph);
-                }else
-                {
-                    tdrmap = &(m_farEndMeasurementsSub[index].tdrImpGraphFeet);
-                }
+                tdrMeasurement = &m_farEndMeasurementsSub.at(index);
             }else if(m_farEndMeasurement == 2)
             {
-                if(m_measureSystemMetric)
-                {
-                    tdrmap = &(m_farEndMeasurementsAdd[index].tdrImpGraph);
-                }else
-                {
-                    tdrmap = &(m_farEndMeasurementsAdd[index].tdrImpGraphFeet);
-                }
+                tdrMeasurement = &m_farEndMeasurementsAdd.at(index);
             }else
             {
-                if(m_measureSystemMetric)
-                {
-                    tdrmap = &(m_measurements[index].tdrImpGraph);
-                }else
-                {
-                    tdrmap = &(m_measurements[index].tdrImpGraphFeet);
-                }
+                tdrMeasurement = &m_measurements.at(index);
+            }
+            const QCPDataMap &tdrmap = m_measureSystemMetric ? tdrMeasurement->tdrImpGraph
+                                                              : tdrMeasurement->tdrImpGraphFeet;
+            const QCPDataMap &stepmap = m_measureSystemMetric ? tdrMeasurement->tdrStepGraph
+                                                               : tdrMeasurement->tdrStepGraphFeet;
+            if((tdrmap.size() < 2) || (xPos < tdrmap.firstKey()) || (xPos > tdrmap.lastKey()))
+            {
+                replot();
+                return;
+            }
+            QCPDataMap::const_iterator it = TraceLookup::nearestKey(tdrmap, xPos);
+            double place = it.key();
+            if(m_popupIndex == index && m_popupKey == place)
+            {
+                return;
             }
+            m_popupIndex = index;
+            m_popupKey = place;
 
-            QList <double> tdrkeys = tdrmap->keys();
+            double pdTdrImp = it.value().value;
+            double pdTdrStep = stepmap.value(place).value;
 
-            bool res = false;
-            int start = previousI-DELTA;
-            if(start < 0)
+            if(!m_tdrLine)
             {
-                start = 0;
+                m_tdrLine = new QCPItemStraightLine(m_tdrWidget);
+                m_tdrLine->setAntialiased(false);
+                m_tdrWidget->addItem(m_tdrLine);
             }
-            int stop = previousI+DELTA;
-            if (stop > tdrkeys.length()-1)
+            m_tdrLine->point1->setCoords(place, -1);
+            m_tdrLine->point2->setCoords(place, 1);
+
+            double Z = m_Z0*(1+pdTdrStep)/(1-pdTdrStep);
+            if (Z<0)
             {
-                stop = tdrkeys.length()-1;
+                Z = 0;
             }
-            for(int t = 0; t < 2; ++t)
+
+            QString text;
+            QString distance;
+
+            QString lenUnits;
+            QString timeNs;
+            distance = QString::number(place,'f',3);
+            double airLen = place/m_cableVelFactor;
+            QString distanceInAir = QString::number(airLen,'f',3);//FEETINMETER
+            if(m_measureSystemMetric)
             {
-                if(t == 1)
-                {
-                    if(res)
-                    {
-                        break;
-                    }
-                    start = 0;
-                    stop = tdrkeys.length()-1;
-                }
-                double place;
-                for(int i = start; i < stop; ++i)
-                {
-                    if((tdrkeys.at(i) <= xPos) && (tdrkeys.at(i+1) >= xPos))
-                    {
-                        double center = (tdrkeys.at(i) + tdrkeys.at(i+1))/2;
-                        if( xPos > center )
-                        {
-                            if(previousI == i+1)
-                            {
-                                return;
-                            }
-                            place = tdrkeys.at(i+1);
-                            previousI = i+1;
-                        }else
-                        {
-                            if(previousI == i)
-                            {
-                                return;
-                            }
-                            place = tdrkeys.at(i);
-                            previousI = i;
-                        }
-
-                        if(m_farEndMeasurement == 1)
-                        {
-                            pdTdrImp = m_farEndMeasurementsSub[index].tdrImpGraph.value(place).value;
-                            pdTdrStep = m_farEndMeasurementsSub[index].tdrStepGraph.value(place).value;
-                        }else if(m_farEndMeasurement == 2)
-                        {
-                            pdTdrImp = m_farEndMeasurementsAdd[index].tdrImpGraph.value(place).value;
-                            pdTdrStep = m_farEndMeasurementsAdd[index].tdrStepGraph.value(place).value;
-                        }else
-                        {
-                            pdTdrImp = m_measurements[index].tdrImpGraph.value(place).value;
-                            pdTdrStep = m_measurements[index].tdrStepGraph.value(place).value;
-                        }
-
-                        if(!m_tdrLine)
-                        {
-                            m_tdrLine = new QCPItemStraightLine(m_tdrWidget);
-                            m_tdrLine->setAntialiased(false);
-                            m_tdrWidget->addItem(m_tdrLine);
-                        }
-                        m_tdrLine->point1->setCoords(place, -1);
-                        m_tdrLine->point2->setCoords(place, 1);
-
-                        double Z = m_Z0*(1+pdTdrStep)/(1-pdTdrStep);
-                        if (Z<0)
-                        {
-                            Z = 0;
-                        }
-
-                        QString text;
-                        QString distance;
-
-                        QString lenUnits;
-                        QString timeNs;
-                        distance = QString::number(place,'f',3);
-                        double airLen = place/m_cableVelFactor;
-                        QString distanceInAir = QString::number(airLen,'f',3);//FEETINMETER
-                        if(m_measureSystemMetric)
-                        {
-                            lenUnits = "m";
-                            timeNs = QString::number(airLen/0.299792458,'f',2);
-                        }else
-                        {
-                            lenUnits = "ft";
-                            timeNs = QString::number(airLen*FEETINMETER/0.299792458,'f',2);
-                        }
-
-
-                        QString ir = QString::number(pdTdrImp,'f',3);
-                        QString sr = QString::number(pdTdrStep,'f',3);
-
-                        QString zStr = QString::number(Z,'f',1);
-                        text = QString(tr("Distance = %1 %2\n"
-                                          "(distance in the air = %3 %4)\n"
-                                          "Time = %5 ns\n"
-                                          "Impulse response = %6\n"
-                                          "Step response = %7\n"
-                                          "|Z| = %8 Ohm"))
-                                .arg(distance)//1
-                                .arg(lenUnits)//2
-                                .arg(distanceInAir)//3
-                                .arg(lenUnits)//4
-                                .arg(timeNs)//5
-                                .arg(ir)//6
-                                .arg(sr)//7
-                                .arg(zStr);//8
-
-                        m_graphHint->setPopupText(text);
-
-                        res = true;
-                        break;
-                    }
-                }
-            }
+                lenUnits = "m";
+                timeNs = QString::number(airLen/0.299792458,'f',2);
+            }else
+            {
+                lenUnits = "ft";
+                timeNs = QString::number(airLen*FEETINMETER/0.299792458,'f',2);
+            }
+
+            QString ir = QString::number(pdTdrImp,'f',3);
+            QString sr = QString::number(pdTdrStep,'f',3);
+
+            QString zStr = QString::number(Z,'f',1);
+            text = QString(tr("Distance = %1 %2\n"
+                              "(distance in the air = %3 %4)\n"
+                              "Time = %5 ns\n"
+                              "Impulse response = %6\n"
+                              "Step response = %7\n"
+                              "|Z| = %8 Ohm"))
+                    .arg(distance)//1
+                    .arg(lenUnits)//2
+                    .arg(distanceInAir)//3
+                    .arg(lenUnits)//4
+                    .arg(timeNs)//5
+                    .arg(ir)//6
+                    .arg(sr)//7
+                    .arg(zStr);//8
+
+            m_graphHint->setPopupText(text);
         }else
         {
             if(m_graphBriefHint != NULL)
@@ -1361,213 +1510,35 @@ void Measurements::updatePopUp(double xPos, int index, int mouseX, int mouseY)
                 m_graphBriefHint->setPosition(mouseX+1,mouseY+1);
             }
 
-            QCPDataMap *swrmap;
-            if((m_calibration != NULL) && (m_calibration->getCalibrationEnabled()))
-            {
-                swrmap = &(m_measurements[index].swrGraphCalib);
-            }else
-            {
-                swrmap = &(m_measurements[index].swrGraph);
-            }
-            QList <double> swrkeys = swrmap->keys();
-
-            double frequency = 0;
-            double swr = 0;
-            double phase = 0;
-            double rho = 0;
-            double rl = 0;
-            double l = 0;
-            double c = 0;
-            double lpar = 0;
-            double cpar = 0;
-            double r = 0;
-            double z = 0;
-            double x = 0;
-            double rpar = 0;
-            double xpar = 0;
-            QString zString;
-            QString zparString;
-            bool res = false;
-            int start = previousI-DELTA;
-            if(start < 0)
-            {
-                start = 0;
-            }
-            int stop = previousI+DELTA;
-            if (stop > swrkeys.length()-1)
-            {
-                stop = swrkeys.length()-1;
-            }
-            for(int t = 0; t < 2; ++t)
+            TracePoint point = TracePoint();
+            int pointIndex = -1;
+            if(traceLookup(index).nearest(xPos, point, &pointIndex))
             {
-                if(t == 1)
+                if(m_popupIndex == index && m_popupKey == point.fq)
                 {
-                    if(res)
-                    {
-                        break;
-                    }
-                    start = 0;
-                    stop = swrkeys.length()-1;
+                    return;
                 }
-                for(int i = start; i < stop; ++i)
+                m_popupIndex = index;
+                m_popupKey = point.fq;
+
+                if(m_graphBriefHint != NULL)
                 {
-                    if((swrkeys.at(i) <= xPos) && (swrkeys.at(i+1) >= xPos))
+                    QString str = frequencyText(point.fq);
+                    str += " kHz\n";
+                    if(m_currentTab == "tab_1")
+                    {
+                        str += QString::number(point.swr,'f',2);
+                    }else if(m_currentTab == "tab_2")
                     {
-                        double center = (swrkeys.at(i) + swrkeys.at(i+1))/2;
-                        if( xPos > center )
-                        {
-                            if(previousI == i+1)
-                            {
-                                return;
-                            }
-                            frequency = swrkeys.at(i+1);
-                            previousI = i+1;
-                        }else
-                        {
-                            if(previousI == i)
-                            {
-                                return;
-                            }
-                            frequency = swrkeys.at(i);
-                            previousI = i;
-                        }
-
-                        if(m_calibration->getCalibrationEnabled())
-                        {
-                            if(m_farEndMeasurement == 1)
-                            {
-                                rho = m_farEndMeasurementsSub.at(index).rhoGraph.value(frequency).value;
-                                phase = m_farEndMeasurementsSub.at(index).phaseGraph.value(frequency).value;
-                                r = m_farEndMeasurementsSub.at(index).rsrGraph.value(frequency).value;
-                                x = m_farEndMeasurementsSub.at(index).rsxGraph.value(frequency).value;
-                            }else if(m_farEndMeasurement == 2)
-                            {
-                                rho = m_farEndMeasurementsAdd.at(index).rhoGraph.value(frequency).value;
-                                phase = m_farEndMeasurementsAdd.at(index).phaseGraph.value(frequency).value;
-                                r = m_farEndMeasurementsAdd.at(index).rsrGraph.value(frequency).value;
-                                x = m_farEndMeasurementsAdd.at(index).rsxGraph.value(frequency).value;
-                            }else
-                            {
-                                rho = m_measurements.at(index).rhoGraph.value(frequency).value;
-                                phase = m_measurements.at(index).phaseGraphCalib.value(frequency).value;
-                                r = m_measurements.at(index).dataRXCalib.at(previousI).r;
-                                x = m_measurements.at(index).dataRXCalib.at(previousI).x;
-                            }
-                            swr = m_measurements.at(index).swrGraphCalib.value(frequency).value;
-                            rl = m_measurements.at(index).rlGraphCalib.value(frequency).value;
-                            z = m_viewMeasurements.at(index).rszGraph.value(frequency).value;
-                            rpar = m_viewMeasurements.at(index).rprGraph.value(frequency).value;
-                            xpar = m_viewMeasurements.at(index).rpxGraph.value(frequency).value;
-                        }else
-                        {
-                            if(m_farEndMeasurement == 1)
-                            {
-                                rho = m_farEndMeasurementsSub.at(index).rhoGraph.value(frequency).value;
-                                phase = m_farEndMeasurementsSub.at(index).phaseGraph.value(frequency).value;
-                                r = m_farEndMeasurementsSub.at(index).rsrGraph.value(frequency).value;
-                                x = m_farEndMeasurementsSub.at(index).rsxGraph.value(frequency).value;
-                            }else if(m_farEndMeasurement == 2)
-                            {
-                                rho = m_farEndMeasurementsAdd.at(index).rhoGraph.value(frequency).value;
-                                phase = m_farEndMeasurementsAdd.at(index).phaseGraph.value(frequency).value;
-                                r = m_farEndMeasurementsAdd.at(index).rsrGraph.value(frequency).value;
-                                x = m_farEndMeasurementsAdd.at(index).rsxGraph.value(frequency).value;
-                            }else
-                            {
-                                rho = m_measurements.at(index).rhoGraph.value(frequency).value;
-                                phase = m_measurements.at(index).phaseGraph.value(frequency).value;
-                                r = m_measurements.at(index).dataRX.at(previousI).r;
-                                x = m_measurements.at(index).dataRX.at(previousI).x;
-                            }
-                            swr = m_measurements.at(index).swrGraph.value(frequency).value;
-                            rl = m_measurements.at(index).rlGraph.value(frequency).value;
-                            z = m_viewMeasurements.at(index).rszGraph.value(frequency).value;
-                            rpar = m_viewMeasurements.at(index).rprGraph.value(frequency).value;
-                            xpar = m_viewMeasurements.at(index).rpxGraph.value(frequency).value;
-                        }
-
-                        zString+= QString::number(r,'f', 2);
-                        if(x >= 0)
-                        {
-                            if (x > 2000)
-                                x = 2000; // HUCK
-                            zString+= " + j";
-                            zString+= QString::number(x,'f', 2);
-                        }else
-                        {
-                            if (x < -2000)
-                                x = -2000; // HUCK
-                            zString+= " - j";
-                            zString+= QString::number((x * (-1)),'f', 2);
-                        }
-                        zparString+= QString::number(rpar,'f', 2);
-                        if(x >= 0)
-                        {
-                            zparString+= " + j";
-                            zparString+= QString::number(xpar,'f', 2);
-                        }else
-                        {
-                            zparString+= " - j";
-                            zparString+= QString::number((xpar * (-1)),'f', 2);
-                        }
-
-                        l = 1E9 * x / (2*M_PI * frequency * 1E3);//nH
-                        c = 1E12 / (2*M_PI * frequency * (x * (-1)) * 1E3);//pF
-
-                        lpar = 1E9 * xpar / (2*M_PI * frequency * 1E3);
-                        cpar = 1E12 / (2*M_PI * frequency * (xpar * (-1)) * 1E3);
-
-                        res = true;
-                        if(m_graphBriefHint != NULL)
-                        {
-                            QString str;
-                            str = QString::number(frequency);
-                            int index = str.indexOf(".");
-                            if(index < 0)
-                            {
-                                if(str.length() > 6)
-                                {
-                                    str.insert(str.length()-6," ");
-                                }
-                                if(str.length() > 3)
-                                {
-                                    str.insert(str.length()-3," ");
-                                }
-                            }else
-                            {
-                                int len = str.length() - index;
-                                if((str.length()-len) > 6)
-                                {
-                                    str.insert(str.length()-len-6," ");
-                                }
-                                if((str.length()-len) > 3)
-                                {
-                                    str.insert(str.length()-len-3," ");
-                                }
-                            }
-                            str += " kHz\n";
-                            if(m_currentTab == "tab_1")
-                            {
-                                str += QString::number(swr,'f',2);
-                            }else if(m_currentTab == "tab_2")
-                            {
-                                str += QString::number(phase,'f',2) + "°";
-                            }else if(m_currentTab == "tab_3")
-                            {
-                                //str += QString::number(computeZ(r,x),'f',2);
-                            }else if(m_currentTab == "tab_4")
-                            {
-                                //str += QString::number(computeZ(r,x),'f',2);
-                            }else if(m_currentTab == "tab_5")
-                            {
-                                str += QString::number(rl,'f',2) + " dB";
-                            }
-                            m_graphBriefHint->setPopupText(str);
-                        }
-                        break;
+                        str += QString::number(point.phase,'f',2) + "°";
+                    }else if(m_currentTab == "tab_5")
+                    {
+                        str += QString::number(point.rl,'f',2) + " dB";
                     }
+                    m_graphBriefHint->setPopupText(str);
                 }
             }
+            double frequency = point.fq;
             if(m_currentTab == "tab_1")
             {
                 if(!m_swrLine)
@@ -1585,8 +1556,8 @@ void Measurements::updatePopUp(double xPos, int index, int mouseX, int mouseY)
                 m_swrLine->point1->setCoords(frequency, MIN_SWR);
                 m_swrLine->point2->setCoords(frequency, MAX_SWR);
 
-                m_swrLine2->point1->setCoords(m_swrWidget->yAxis->getRangeLower(), swr);
-                m_swrLine2->point2->setCoords(m_swrWidget->yAxis->getRangeUpper(), swr);
+                m_swrLine2->point1->setCoords(m_swrWidget->yAxis->getRangeLower(), point.swr);
+                m_swrLine2->point2->setCoords(m_swrWidget->yAxis->getRangeUpper(), point.swr);
             }else if(m_currentTab == "tab_2")
             {
                 if(!m_phaseLine)
@@ -1603,8 +1574,8 @@ void Measurements::updatePopUp(double xPos, int index, int mouseX, int mouseY)
                 }
                 m_phaseLine->point1->setCoords(frequency, -2000);
                 m_phaseLine->point2->setCoords(frequency, 2000);
-                m_phaseLine2->point1->setCoords(m_phaseWidget->yAxis->getRangeLower(), phase);
-                m_phaseLine2->point2->setCoords(m_phaseWidget->yAxis->getRangeUpper(), phase);
+                m_phaseLine2->point1->setCoords(m_phaseWidget->yAxis->getRangeLower(), point.phase);
+                m_phaseLine2->point2->setCoords(m_phaseWidget->yAxis->getRangeUpper(), point.phase);
             }else if(m_currentTab == "tab_3")
             {
                 if(!m_rsLine)
@@ -1641,109 +1612,10 @@ void Measurements::updatePopUp(double xPos, int index, int mouseX, int mouseY)
                 }
                 m_rlLine->point1->setCoords(frequency, -2000);
                 m_rlLine->point2->setCoords(frequency, 2000);
-                m_rlLine2->point1->setCoords(m_rlWidget->yAxis->getRangeLower(), rl);
-                m_rlLine2->point2->setCoords(m_rlWidget->yAxis->getRangeUpper(), rl);
-            }
-
-            QString str = QString::number(frequency);
-            int index = str.indexOf(".");
-            if(index < 0)
-            {
-                if(str.length() > 6)
-                {
-                    str.insert(str.length()-6," ");
-                }
-                if(str.length() > 3)
-                {
-                    str.insert(str.length()-3," ");
-                }
-            }else
-            {
-                int len = str.length() - index;
-                if((str.length()-len) > 6)
-                {
-                    str.insert(str.length()-len-6," ");
-                }
-                if((str.length()-len) > 3)
-                {
-                    str.insert(str.length()-len-3," ");
-                }
-            }
-
-            QString text;
-            if(x > 0)
-            {
-                text = QString(tr("Frequency = %1 kHz\n"
-                                  "SWR = %2\n"
-                                  "RL = %3 dB\n"
-                                  "Z = %4 Ohm\n"
-                                  "|Z| = %5 Ohm\n"
-                                  "|rho| = %6, phase = %7 °\n"
-                                  "L = %8 nH\n"
-                                  "Zpar = %9 Ohm\n"
-                                  "Lpar = %10 nH\n"))
-                    .arg(str)
-                    .arg(QString::number(swr,'f', 2))
-                    .arg(QString::number(rl,'f', 2))
-                    .arg(zString)
-                    .arg(QString::number(z,'f', 2))
-                    .arg(QString::number(rho,'f', 2))
-                    .arg(QString::number(phase,'f', 2))
-                    .arg(QString::number(l,'f', 2))
-                    .arg(zparString)
-                    .arg(QString::number(lpar,'f', 2));
-            }else
-            {
-                text = QString(tr("Frequency = %1 kHz\n"
-                                  "SWR = %2\n"
-                                  "RL = %3 dB\n"
-                                  "Z = %4 Ohm\n"
-                                  "|Z| = %5 Ohm\n"
-                                  "|rho| = %6, phase = %7 °\n"
-                                  "C = %8 pF\n"
-                                  "Zpar = %9 Ohm\n"
-                                  "Cpar = %10 pF\n"))
-                        .arg(str)
-                        .arg(QString::number(swr,'f', 2))
-                        .arg(QString::number(rl,'f', 2))
-                        .arg(zString)
-                        .arg(QString::number(z,'f', 2))
-                        .arg(QString::number(rho,'f', 2))
-                        .arg(QString::number(phase,'f', 2))
-                        .arg(QString::number(c,'f', 2))
-                        .arg(zparString)
-                        .arg(QString::number(cpar,'f', 2));
-            }
-
-            if(!m_farEndMeasurement)
-            {
-                QString cableString;
-                QString lenUnits;
-                if(m_measureSystemMetric)
-                {
-                    lenUnits = tr("m");
-                }else
-                {
-                    lenUnits = tr("ft");
-                }
-
-                double len14 = SPEEDOFLIGHT/4/frequency/1000*m_cableVelFactor;
-                double len12 = SPEEDOFLIGHT/2/frequency/1000*m_cableVelFactor;
-
-                if(!m_measureSystemMetric)
-                {
-                    len14 *= FEETINMETER;
-                    len12 *= FEETINMETER;
-                }
-
-                cableString = tr("Cable: length(1/4) = %1 %2, length(1/2) = %3 %4")
-                        .arg(QString::number(len14,'f',2))
-                        .arg(lenUnits)
-                        .arg(QString::number(len12,'f',2))
-                        .arg(lenUnits);
-                text += cableString;
+                m_rlLine2->point1->setCoords(m_rlWidget->yAxis->getRangeLower(), point.rl);
+                m_rlLine2->point2->setCoords(m_rlWidget->yAxis->getRangeUpper(), point.rl);
             }
-            m_graphHint->setPopupText(text);
+            m_graphHint->setPopupText(hintText(point));
         }
     }
     replot();
@@ -1769,6 +1641,7 @@ bool Measurements::getGraphHintEnabled(void)
 
 void Measurements::on_calibrationEnabled(bool enabled)
 {
+    m_listModel->setCalibrationEnabled(enabled);
     if(m_swrWidget->graphCount() == 1)
     {
         return;
@@ -1835,6 +1708,7 @@ void Measurements::on_calibrationEnabled(bool enabled)
         //m_smithWidget->graph(i)->setData(&smithmap, true);
         m_measurements.at(j).smithCurve->setData(&smithmap, true);
     }
+    markTabsDirty(DirtyTraces);
     replot();
     emit calibrationChanged();
 }
@@ -1843,520 +1717,250 @@ void Measurements::saveData(quint32 number, QString path)
 {
     if(path.indexOf(".asd") >= 0 )
     {
-        QFile saveFile(path);
-
-        if (!saveFile.open(QIODevice::WriteOnly))
-        {
-            qWarning("Couldn't open save file.");
-            return;
-        }
-
-        QVector <rawData> data;
-        if(m_calibration != NULL)
-        {
-            if(m_calibration->getCalibrationEnabled())
-            {
-                data = m_measurements.at(number).dataRXCalib;
-            }else
-            {
-                data = m_measurements.at(number).dataRX;
-            }
-        }else
+        QString error;
+        if(!ExportEngine::write(exportItem(number, path, 0), &error))
         {
-            data = m_measurements.at(number).dataRX;
+            qWarning() << "Couldn't write save file:" << error;
         }
-
-        //Dots
-        QJsonObject mainObj;
-        mainObj["DotsNumber"] = data.length();
-
-        //Measurements
-        QJsonArray measurementsArray;
-        for(int i = 0; i < data.length(); ++i)
+    }else if(path.indexOf(".asb") >= 0)
+    {
+        bool calibrationEnabled = (m_calibration != NULL) && m_calibration->getCalibrationEnabled();
+        if(!MeasurementFile::save(path, m_measurements.at(number), m_Z0, calibrationEnabled))
         {
-            QJsonObject obj;
-            obj["fq"] = data.at(i).fq;
-            obj["r"] = data.at(i).r;
-            obj["x"] = data.at(i).x;
-            measurementsArray.append(obj);
+            qWarning("Couldn't open save file.");
         }
-        mainObj["Measurements"] = measurementsArray;
-
-        QJsonDocument saveDoc(mainObj);
-
-        saveFile.write(saveDoc.toJson());
+    }else if(path.indexOf(".asz") >= 0)
+    {
+        saveSession(path);
     }
 }
 
-void Measurements::loadData(QString path)
+bool Measurements::saveSession(QString path)
 {
-    if(path.indexOf(".asd") >= 0 )
-    {
-        QStringList list;
-        list = path.split("/");
-        if(list.length() == 1)
-        {
-            list.clear();
-            list = path.split("\\");
-        }
-
-        QFile loadFile(path);
-
-        if (!loadFile.open(QIODevice::ReadOnly)) {
-            QMessageBox::information(NULL, tr("Error"), tr("Couldn't open saved file."));
-            qWarning("Couldn't open saved file.");
-            return;
-        }
-        on_newMeasurement(list.last());
-
-        QByteArray saveData = loadFile.readAll();
+    SessionSettings settings;
+    settings.Z0 = m_Z0;
+    settings.calibrationEnabled = (m_calibration != NULL) && m_calibration->getCalibrationEnabled();
+    settings.cable = cableModel();
 
-        QJsonDocument loadDoc(QJsonDocument::fromJson(saveData));
-        QJsonObject mainObj = loadDoc.object();
-
-        QJsonArray measureArray = mainObj["Measurements"].toArray();
-
-        double fqMin = DBL_MAX;
-        double fqMax = 0;
-        int size = measureArray.size();
-
-        ProgressDlg* progressDlg = new ProgressDlg();
-        progressDlg->setValue(0);
-        progressDlg->setProgressData(0, size, 1);
-        progressDlg->updateActionInfo(tr("Load measurement"));
-        progressDlg->updateStatusInfo(tr("please wait ...."));
-        progressDlg->show();
-        progressDlg->setWindowModality(Qt::WindowModal);
-        QApplication::processEvents();
-
-        for(int i = 0; i < size; ++i)
+    SessionWriter writer;
+    bool ok = writer.open(path) && writer.writeSettings(settings);
+    if(ok && (m_calibration != NULL))
+    {
+        foreach (const QString &file, m_calibration->filePaths())
         {
-            QJsonObject dataObject = measureArray[i].toObject();
-            rawData data;
-            data.read(dataObject);
-            on_newData(data);
-            fqMin = qMin(fqMin, data.fq);
-            fqMax = qMax(fqMax, data.fq);
-            if ((i%10) == 0) {
-                progressDlg->setValue(i);
-                progressDlg->updateStatusInfo(QString(tr("loaded %1 dots, from %2")).arg(i).arg(size));
+            if(QFileInfo(file).isFile() && !writer.addCalibrationFile(file))
+            {
+                ok = false;
+                break;
             }
         }
-        progressDlg->hide();
-        delete progressDlg;
-
-        emit import_finished(fqMin*1000, fqMax*1000);
-    }else
+    }
+    for(int i = 0; ok && (i < m_measurements.length()); ++i)
     {
-        importData(path);
+        const measurement &source = m_measurements.at(i);
+        SessionMeasurement item;
+        item.name = getMeasurementName(i);
+        item.fq = source.qint64Fq;
+        item.sw = source.qint64Sw;
+        item.dots = source.qint64Dots;
+        item.data = source.dataRX;
+        item.calibrated = source.dataRXCalib;
+        ok = writer.addMeasurement(item);
     }
-    on_redrawGraphs();
+    if(!ok || !writer.close())
+    {
+        qWarning() << "Couldn't write session file:" << writer.errorString();
+        return false;
+    }
+    return true;
 }
 
-void Measurements::exportData(QString _name, int _type, int _number)
+void Measurements::loadSession(QString path)
 {
-    if(_name.indexOf(".s1p") >= 0 )
+    SessionReader reader;
+    if(!reader.open(path))
     {
-        QFile file(_name);
-
-        if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate | QIODevice::Text))//if (!file.open(QFile::ReadWrite))
-        {
-            return;
-        }
-
-        QTextStream out(&file);
-
-        out << "! Touchstone file generated by AntScope2";
-        out << "\n";
-
-        double Rswr = m_calibration->getZ0();
-
-        if (_type == 0) // Z, RI
-        {
-            out << "# MHz Z RI R " << Rswr << "\n";
-            out << "! Format: Frequency Z-real Z-imaginary (normalized to " << Rswr << " Ohm)\n";
-        }else if (_type == 1) // S, RI
-        {
-            out << "# MHz S RI R " << Rswr << "\n";
-            out << "! Format: Frequency S-real S-imaginary (normalized to " << Rswr << " Ohm)\n";
-        }
-        else if (_type == 2) // S, MA
-        {
-            out << "# MHz S MA R " << Rswr << "\n";
-            out << "! Format: Frequency S-magnitude S-angle (normalized to " << Rswr << " Ohm, angle in degrees)\n";
-        }
+        QMessageBox::information(NULL, tr("Error"), tr("Couldn't open saved file."));
+        qWarning() << "Couldn't open session file:" << reader.errorString();
+        return;
+    }
+    // the points are computed with the Z0 and cable they were saved with
+    emit sessionSettingsLoaded(reader.settings());
 
-        // Data
-        int len = 0;
-        QVector<rawData> vector;
-        if((m_calibration != NULL) && (m_calibration->getCalibrationEnabled()))
-        {
-            vector = m_measurements.at(_number).dataRXCalib;
-        }else
+    // the raw sweeps are replayed oldest first
+    double fqMin = DBL_MAX;
+    double fqMax = 0;
+    for(int i = 0; i < reader.count(); ++i)
+    {
+        SessionMeasurement item;
+        if(!reader.read(i, item))
         {
-            vector = m_measurements.at(_number).dataRX;
+            qWarning() << "Couldn't read session file:" << reader.errorString();
+            break;
         }
-        len = vector.length();
-
-        for (int i = 0; i < len; ++i)
+        if(item.name.isEmpty())
         {
-            QString s;
-
-            s = QString("%1").arg(vector.at(i).fq, 0, 'f', 6);		// Fq
-            out << s << " ";
-
-            double R = vector.at(i).r;
-            double X = vector.at(i).x;
-
-            if (_type == 0) // Z, RI
-            {
-                if (!qIsNaN(R))
-                    s = QString::number(R/Rswr,'g',4);           // R
-                else
-                    s = "0";
-                out << s << " ";
-                if (!qIsNaN(X))
-                    s = QString::number(X/Rswr,'g',4);           // X
-                else
-                    s = "0";
-                out << s << "\n";
-            }
-            else
-            if (_type == 1) // S, RI
-            {
-                double Gre = (R*R-Rswr*Rswr+X*X)/((R+Rswr)*(R+Rswr)+X*X);
-                double Gim = (2*Rswr*X)/((R+Rswr)*(R+Rswr)+X*X);
-
-                if (!qIsNaN(Gre))
-                    s = QString::number(Gre,'g',4);              // Real
-                else
-                    s = "0";
-                out << s << " ";
-
-                if (!qIsNaN(Gim))
-                    s = QString::number(Gim,'g',4);              // Imaginary
-                else
-                    s = "0";
-                out << s << "\n";
-
-            }
-            else
-            if (_type == 2) // S, MA
-            {
-                double Gre = (R*R-Rswr*Rswr+X*X)/((R+Rswr)*(R+Rswr)+X*X);
-                double Gim = (2*Rswr*X)/((R+Rswr)*(R+Rswr)+X*X);
-
-                if (!qIsNaN(Gre))
-                    s = QString::number(sqrt(Gre*Gre+Gim*Gim),'g',4);		// Magnitude
-                else
-                    s = "0";
-                out << s << " ";
-
-                if (!qIsNaN(Gim))
-                    s = QString::number(atan2(Gim,Gre)/3.1415926*180.0,'g',4);		// Angle
-                else
-                    s = "0";
-                out << s << "\n";
-            }
+            item.name = QFileInfo(path).fileName();
         }
-        out.flush();
-    }else if(_name.indexOf(".csv") >= 0 )
-    {
-        QString str;
-        QFile file(_name);
-        bool result = file.open(QFile::ReadWrite);
-        if(result)
+        addMeasurement(item);
+        foreach (const rawData &point, item.data)
         {
-            str = "#Frequency(MHz);R;X";
-            file.write( str.toLocal8Bit(), str.length());
-            file.write("\r\n", 2);
-
-            int len = 0;
-            QVector<rawData> vector;
-            if((m_calibration != NULL) && (m_calibration->getCalibrationEnabled()))
-            {
-                vector = m_measurements.at(_number).dataRXCalib;
-            }else
-            {
-                vector = m_measurements.at(_number).dataRX;
-            }
-            len = vector.length();
-
-            for (int i = 0; i < len; ++i)
-            {
-                str = QString::number(vector.at(i).fq, 'f', 6) +
-                "," +//";" +
-                QString::number(vector.at(i).r,'f',2) +
-                "," +//";" +
-                QString::number(vector.at(i).x,'f',2);
-
-                file.write( str.toLocal8Bit(), str.length());
-                file.write("\r\n", 2);
-            }
-            file.close();
+            fqMin = qMin(fqMin, point.fq);
+            fqMax = qMax(fqMax, point.fq);
         }
-    }else if(_name.indexOf(".nwl") >= 0 )
+    }
+    if(fqMax > 0)
     {
-        QString str;
-        QFile file(_name);
-        bool result = file.open(QFile::ReadWrite);
-        if(result)
-        {
-            str = "/\"Freq(MHz)\" \"Rs\" \"Xs\"/";
-            file.write( str.toLocal8Bit(), str.length());
-            file.write("\r\n", 2);
-
-            int len = 0;
-            QVector<rawData> vector;
-            if((m_calibration != NULL) && (m_calibration->getCalibrationEnabled()))
-            {
-                vector = m_measurements.at(_number).dataRXCalib;
-            }else
-            {
-                vector = m_measurements.at(_number).dataRX;
-            }
-            len = vector.length();
-
-            for (int i = 0; i < len; ++i)
-            {
-                str = QString::number(vector.at(i).fq, 'f', 6) +
-                " " +//";" +
-                QString::number(vector.at(i).r,'f',2) +
-                " " +//";" +
-                QString::number(vector.at(i).x,'f',2);
-
-                file.write( str.toLocal8Bit(), str.length());
-                file.write("\r\n", 2);
-            }
-            file.close();
-        }
+        emit import_finished(fqMin*1000, fqMax*1000);
     }
 }
 
-void Measurements::importData(QString _name)
+void Measurements::addMeasurement(const SessionMeasurement &item)
+{
+    on_newMeasurement(item.name, item.fq, item.sw, item.dots);
+    appendData(item.data, item.calibrated.isEmpty() ? NULL : &item.calibrated);
+}
+
+void Measurements::loadData(QString path)
 {
-    if(_name.indexOf(".s1p") >= 0 )
+    if(path.indexOf(".asd") >= 0 )
     {
         QStringList list;
-        list = _name.split("/");
+        list = path.split("/");
         if(list.length() == 1)
         {
             list.clear();
-            list = _name.split("\\");
-        }
-        on_newMeasurement(list.last());
-
-        QString sPathName = _name;
-
-        if (sPathName.isEmpty())
-        {
-            return;
+            list = path.split("\\");
         }
 
-        QFile ifs(sPathName);
+        QFile loadFile(path);
 
-        if (!ifs.open(QFile::ReadWrite))
-        {
+        if (!loadFile.open(QIODevice::ReadOnly)) {
+            QMessageBox::information(NULL, tr("Error"), tr("Couldn't open saved file."));
+            qWarning("Couldn't open saved file.");
             return;
         }
-        QTextStream in(&ifs);
-        bool bGood = true;
-
-        int iLines=0, iPoints=0;
-
-        double  fqmul = 1000.0; // Default is GHz
-        int iUnit = 1; // Default is S
-        int iFormat = 1; // Default is MA
-
-        QString line;//char str[1000]; // Whole string
-        char strn[5][100]; // Substrings
-
-        double f, param1, param2; // for reading S11 data lines
-
-        double Z0 = 50;
-
-        double fqMin = DBL_MAX;
-        double fqMax = 0;
-        do//while (ifs.isOpen() && (!ifs.eof()))
-        {
-            line = in.readLine();
-            iLines++;
-
-            if ( (line.length() > 2) && (line[0] == '#')) // Option line
-            {
-                line.remove(0,1);
-                bool bErr = false;
-
-                int ns = sscanf(line.toLocal8Bit(), "%s %s %s %s %s", strn[0], strn[1], strn[2], strn[3], strn[4]);
-
-                for (int i=0; i<ns; i++)
-                {
-                    // Frequency unit
-
-                    if (!strcmp(strn[i], "GHz"))
-                        fqmul = 1000.0;
-                    else
-                    if (!strcmp(strn[i], "MHz"))
-                        fqmul = 1.0;
-                    else
-                    if (!strcmp(strn[i], "KHz"))
-                        fqmul = 0.001;
-                    else
-                    if (!strcmp(strn[i], "Hz"))
-                        fqmul = 0.000001;
-                    else
-
-                    // Parameter
-
-                    if (!strcmp(strn[i], "S"))
-                        iUnit = 1;
-                    else
-                    if (!strcmp(strn[i], "Z"))
-                        iUnit = 2;
-                    else
-
-                    // Format
-
-                    if (!strcmp(strn[i], "MA"))
-                        iFormat = 1;
-                    else
-                    if (!strcmp(strn[i], "RI"))
-                        iFormat = 2;
-                    else
-
-                    // R n
-
-                    if (!strcmp(strn[i], "R"))
-                    {
-                        if ( i < (ns-1) )
-                        {
-                            i++;
-
-//                            setlocale(LC_NUMERIC,"C");
-                            Z0 = atof(strn[i]);
-//                            setlocale(LC_NUMERIC,"");
-
-                            if ( (Z0<=0) || (Z0>10000) )
-                            {
-                                //bErr = true;
-                                //break;
-                                return;
-                            }
-                        }
-                        else
-                        {
-                            //bErr = true;
-                            //break;
-                            return;
-                        }
-                    }
-                    else
-                    {
-                        //bErr = true;
-                        //break;
-                        return;
-                    }
-                }
-
-                // Check possible combinations
-/*
-                if ( (iUnit == 1) && (iFormat == 1) ) // S, MA
-                {
-                }
-                else
-                if ( (iUnit == 1) && (iFormat == 2) ) // S, RI
-                {
-                }
-                else
-                if ( (iUnit == 2) && (iFormat == 2) ) // Z, RI
-                {
-                }
-                else
-                {
-                    bErr = true;
-                }
-
-                if (bErr == true)
-                {
-                    return;
-                }
-*/
-                if(! ((iUnit == 1) && (iFormat == 1) // S, MA
-                        || (iUnit == 1) && (iFormat == 2)  // S, RI
-                        || (iUnit == 2) && (iFormat == 2)  // Z, RI
-                    ))
-                {
-                    return;
-                }
+        on_newMeasurement(list.last());
 
-                continue;
-            }
+        QByteArray saveData = loadFile.readAll();
 
-            if ( (strstr(line.toLocal8Bit(), "!") != NULL) || (strstr(line.toLocal8Bit(), ".") == NULL) ) // Comment or void line
-                continue;
+        QJsonDocument loadDoc(QJsonDocument::fromJson(saveData));
+        QJsonObject mainObj = loadDoc.object();
 
-            // Scan data lines
+        QJsonArray measureArray = mainObj["Measurements"].toArray();
 
-            if ( sscanf(line.toLocal8Bit(), "%lf %lf %lf", &f, &param1, &param2) != 3)
-            {
-                return;
-            }
+        double fqMin = DBL_MAX;
+        double fqMax = 0;
+        int size = measureArray.size();
+        QVector <rawData> points(size);
+        for(int i = 0; i < size; ++i)
+        {
+            rawData &data = points[i];
+            data.read(measureArray[i].toObject());
+            fqMin = qMin(fqMin, data.fq);
+            fqMax = qMax(fqMax, data.fq);
+        }
+        appendData(points);
 
-            double r = 0,x = 0;
+        emit import_finished(fqMin*1000, fqMax*1000);
+    }else if(path.indexOf(".asb") >= 0)
+    {
+        MeasurementFile file;
+        if(!file.open(path))
+        {
+            QMessageBox::information(NULL, tr("Error"), tr("Couldn't open saved file."));
+            qWarning() << "Couldn't open saved file:" << file.errorString();
+            return;
+        }
+        on_newMeasurement(QFileInfo(path).fileName(), file.fq(), file.sw(), file.sweepDots());
 
-            if ( (iUnit == 1) && (iFormat == 1) ) // S, MA
-            {
-                    double Gr = param1 * cos(param2/180.0*M_PI);
-                    double Gi = param1 * sin(param2/180.0*M_PI);
+        // the raw columns are replayed, calibration is applied by appendData as usual
+        int size = file.dots();
+        const double *fq = file.column(MeasurementFile::RawFq);
+        double fqMin = DBL_MAX;
+        double fqMax = 0;
+        QVector <rawData> points(size);
+        for(int i = 0; i < size; ++i)
+        {
+            points[i] = file.point(i);
+            fqMin = qMin(fqMin, fq[i]);
+            fqMax = qMax(fqMax, fq[i]);
+        }
+        appendData(points);
+        if(size > 0)
+        {
+            emit import_finished(fqMin*1000, fqMax*1000);
+        }
+    }else if(path.indexOf(".asz") >= 0)
+    {
+        loadSession(path);
+    }else
+    {
+        importData(path);
+    }
+    on_redrawGraphs();
+}
 
-                    r = (1-Gr*Gr-Gi*Gi)/((1-Gr)*(1-Gr)+Gi*Gi);
-                    x = (2*Gi)/((1-Gr)*(1-Gr)+Gi*Gi);
-            }
-            else
-            if ( (iUnit == 1) && (iFormat == 2) ) // S, RI
-            {
-                    r = (1-param1*param1-param2*param2)/((1-param1)*(1-param1)+param2*param2);
-                    x = (2*param2)/((1-param1)*(1-param1)+param2*param2);
-            }
-            else
-            if ( (iUnit == 2) && (iFormat == 2) ) // Z, RI
-            {
-                    r = param1;
-                    x = param2;
-            }
-            else
-            {
-                // Bug
-            }
+void Measurements::exportData(QString _name, int _type, int _number)
+{
+    QString error;
+    if(!ExportEngine::write(exportItem(_number, _name, _type), &error))
+    {
+        qWarning() << "Export failed:" << error;
+    }
+}
 
-            if ( qIsNaN(r) || (r<0) )
-            {
-                r = 0;
-            }
-            if ( qIsNaN(x) )
-            {
-                x = 0;
-            }
+ExportItem Measurements::exportItem(int number, QString target, int type)
+{
+    const measurement &source = m_measurements.at(number);
+    ExportItem item;
+    item.target = target;
+    item.type = type;
+    item.Z0 = m_Z0;
+    item.calibrationEnabled = (m_calibration != NULL) && m_calibration->getCalibrationEnabled();
+    item.data.fq = source.qint64Fq;
+    item.data.sw = source.qint64Sw;
+    item.data.dots = source.qint64Dots;
+    item.data.dataRX = source.dataRX;
+    item.data.dataRXCalib = source.dataRXCalib;
+    return item;
+}
 
-            rawData data;
-            data.fq = f*fqmul;
-            data.r =r*(Z0);
-            data.x =x*(Z0);
-            on_newData(data);
-            iPoints++;
-            fqMin = qMin(fqMin, data.fq);
-            fqMax = qMax(fqMax, data.fq);
-        }while (!line.isNull());
-        emit import_finished(fqMin*1000, fqMax*1000);
+QString Measurements::getMeasurementName(int number)
+{
+    // single point measurements have no row in the table
+    if(m_listModel->count() == m_measurements.length())
+    {
+        return m_listModel->name(number);
+    }
+    return QString("measurement_%1").arg(number+1);
+}
+
+void Measurements::importData(QString _name)
+{
+    if(TouchstoneReader::portsFromFileName(_name) > 0)
+    {
+        on_newMeasurement(QFileInfo(_name).fileName());
 
-        if (bGood && (iPoints>1) )
+        QVector <rawData> points;
+        TouchstoneReader reader;
+        bool result = reader.read(_name, points);
+        // whatever was read before an error is kept, as the old line reader did
+        appendData(points);
+        if(!result)
         {
+            qWarning() << "Touchstone import failed:" << reader.errorString();
             return;
         }
-        else
+
+        double fqMin = DBL_MAX;
+        double fqMax = 0;
+        for(int i = 0; i < points.size(); ++i)
         {
-            return;
+            fqMin = qMin(fqMin, points.at(i).fq);
+            fqMax = qMax(fqMax, points.at(i).fq);
         }
+        emit import_finished(fqMin*1000, fqMax*1000);
     }
     else if(_name.indexOf(".csv") >= 0 )
     {
@@ -2376,6 +1980,7 @@ void Measurements::importData(QString _name)
             QString str = file.readAll();
             double fqMin = DBL_MAX;
             double fqMax = 0;
+            QVector <rawData> points;
             QStringList nList = str.split('\n');
 
             double mul=1.0;
@@ -2396,7 +2001,7 @@ void Measurements::importData(QString _name)
                     data.fq = dList.at(0).toDouble()*mul;
                     data.r = dList.at(1).toDouble();
                     data.x = dList.at(2).toDouble();
-                    on_newData(data);
+                    points.append(data);
                     fqMin = qMin(fqMin, data.fq);
                     fqMax = qMax(fqMax, data.fq);
                 }
@@ -2411,11 +2016,12 @@ void Measurements::importData(QString _name)
                     data.fq = dList.at(0).toDouble()*mul;
                     data.r = dList.at(1).toDouble();
                     data.x = dList.at(2).toDouble();
-                    on_newData(data);
+                    points.append(data);
                     fqMin = qMin(fqMin, data.fq);
                     fqMax = qMax(fqMax, data.fq);
                 }
             }
+            appendData(points);
             emit import_finished(fqMin*1000, fqMax*1000);
         }
     }else if(_name.indexOf(".nwl") >= 0 )
@@ -2437,6 +2043,7 @@ void Measurements::importData(QString _name)
 
             double fqMin = DBL_MAX;
             double fqMax = 0;
+            QVector <rawData> points;
             QStringList nList = str.split('\n');
 
             double mul=1.0;
@@ -2459,11 +2066,12 @@ void Measurements::importData(QString _name)
                     data.fq = dList.at(0).toDouble()*mul;
                     data.r = dList.at(1).toDouble();
                     data.x = dList.at(2).toDouble();
-                    on_newData(data);
+                    points.append(data);
                     fqMin = qMin(fqMin, data.fq);
                     fqMax = qMax(fqMax, data.fq);
                 }
             }
+            appendData(points);
             emit import_finished(fqMin*1000, fqMax*1000);
         }
     } else if (_name.indexOf(".antdata") >= 0) {
@@ -2496,6 +2104,8 @@ void Measurements::importData(QString _name)
             double maxFq = 0;
             qint16 points = *(qint16*)pData;
             points--;
+            QVector <rawData> dots;
+            dots.reserve(points);
             qint32* p = (qint32*)(pData+6);
             for (int idx=0; idx<points; idx++) {
                 rawData data_;
@@ -2505,10 +2115,11 @@ void Measurements::importData(QString _name)
                 double* pd = (double*)(p+1);
                 data_.r  = pd[0];
                 data_.x  = pd[1];
-                on_newData(data_);
+                dots.append(data_);
 
                 p += 14;
             }
+            appendData(dots);
             emit import_finished(minFq*1000, maxFq*1000);
         }
     }
@@ -2516,205 +2127,18 @@ void Measurements::importData(QString _name)
 
 int Measurements::CalcTdr(QVector <rawData> *data)
 {
-    int asize = data->length();
-
-    if (asize < 200)
+    QVector <double> impulse;
+    QVector <double> step;
+    int length = SweepMath::tdr(data->constData(), data->length(), m_cableVelFactor,
+                                impulse, step, &m_tdrRange);
+    if ((length == 0) || (length > TDR_MAXARRAY))
     {
         return 0;
     }
-
-    double minfq = data->at(0).fq;
-    if ( minfq > 0.1 )
-    {
-        return 0; // Wrong fq
-    }
-
-    double maxfq = data->at(asize-1).fq;
-
-    int m_iTdrFftSize = 0;
-
-    int i;
-    for (i=0; ; i++)
-    {
-        m_iTdrFftSize = (1<<i);
-        if ( (m_iTdrFftSize/2) >= (asize-1) )
-            break;
-
-        if (i==14)
-            return 0; // bug
-    }
-
-    m_iTdrFftSize *= 8;
-
-    if (m_iTdrFftSize > TDR_MAXARRAY)
-            return 0; // bug
-
-    m_tdrResolution = 1.0/(maxfq-minfq)/4*299792458*m_cableVelFactor / (m_iTdrFftSize/2) * (asize-1);
-
-    m_tdrRange = m_tdrResolution*m_iTdrFftSize/1000000;
-
-    float *TdrReal = new float[TDR_MAXARRAY];
-    float *TdrImag = new float[TDR_MAXARRAY];
-
-#define Rdevice 50.0
-
-    for (i=0; i<=m_iTdrFftSize/2; i++)
-    {
-        if (i < asize)
-        {
-            double R = data->at(i).r;
-            double X = data->at(i).x;
-
-            double Gre = (R*R-Rdevice*Rdevice+X*X)/((R+Rdevice)*(R+Rdevice)+X*X);
-            double Gim = (2*Rdevice*X)/((R+Rdevice)*(R+Rdevice)+X*X);
-
-            if ( i==0)
-            {
-                double m_dFarEndImpedance = 50;
-                Gre = (m_dFarEndImpedance-Rdevice)/(m_dFarEndImpedance+Rdevice);
-                Gim = 0;
-            }
-
-#define KP (1.0/0.53836)
-                double k = 0.53836-0.46146*cos(M_PI+M_PI*i/(asize-1));
-
-                TdrReal[i] = Gre*m_iTdrFftSize/asize/2.0*k*KP;
-                TdrImag[i] = Gim*m_iTdrFftSize/asize/2.0*k*KP;
-        }
-        else
-        {
-            TdrReal[i] = 0;
-            TdrImag[i] = 0;
-        }
-    }
-
-// Interpolate zero frequency
-
-#define BDR 1
-    for (i=0; i<BDR; i++)
-    {
-        double newreal = sqrt(TdrReal[BDR]*TdrReal[BDR]+TdrImag[BDR]*TdrImag[BDR]);
-
-        if (TdrReal[BDR] < 0)
-            TdrReal[i] = -newreal;
-        else
-            TdrReal[i] = newreal;
-
-        TdrImag[i] = 0;
-
-    }
-
-// Mirror
-    for (i=1; i<m_iTdrFftSize/2; i++)
-    {
-        TdrReal[m_iTdrFftSize-i] = TdrReal[i];
-        TdrImag[m_iTdrFftSize-i] = -TdrImag[i];
-    }
-    TdrReal[m_iTdrFftSize/2] = 0;
-    TdrImag[m_iTdrFftSize/2] = 0;
-
-    FFT(TdrReal, TdrImag, m_iTdrFftSize, 1/*Inverse*/);	// Inverse FFT
-
-    double ig = 0;
-    for (i=0; i<m_iTdrFftSize; i++)
-    {
-        double Amp = TdrReal[i];
-        if((Amp > 0.015) || (Amp < -0.015))
-        {
-            m_pdTdrImp[i] = Amp;
-            ig += Amp/2/(((double)m_iTdrFftSize)/asize/2);
-        }else
-        {
-            m_pdTdrImp[i] = 0;
-        }
-
-        m_pdTdrStep[i] = ig;
-    }
-
-    delete TdrReal;
-    delete TdrImag;
-    return m_iTdrFftSize;
-}
-
-void Measurements::FFT(float real[], float imag[], int length, int Inverse)
-{
-    double wreal, wpreal, wimag, wpimag, theta;
-    double tempreal, tempimag, tempwreal, direction;
-
-    int Addr, Position, Mask, BitRevAddr, PairAddr;
-    int m, k;
-
-    direction = -1.0;		// direction of rotating phasor for FFT
-
-    if(Inverse)
-        direction = 1.0;	// direction of rotating phasor for IFFT
-
-    //  bit-reverse the addresses of both the real and imaginary arrays
-    //  real[0..length-1] and imag[0..length-1] are the paired complex numbers
-
-    for (Addr=0; Addr<length; Addr++)
-    {
-        // Derive Bit-Reversed Address
-        BitRevAddr = 0;
-        Position = length >> 1;
-        Mask = Addr;
-        while (Mask)
-        {
-            if(Mask & 1)
-                BitRevAddr += Position;
-            Mask >>= 1;
-            Position >>= 1;
-        }
-
-        if (BitRevAddr > Addr)				// Swap
-        {
-            double s;
-            s = real[BitRevAddr];			// real part
-            real[BitRevAddr] = real[Addr];
-            real[Addr] = s;
-            s = imag[BitRevAddr];			// imaginary part
-            imag[BitRevAddr] = imag[Addr];
-            imag[Addr] = s;
-        }
-    }
-
-    // FFT, IFFT Kernel
-
-    for (k=1; k < length; k <<= 1)
-    {
-        theta = direction * M_PI / (double)k;
-        wpimag = sin(theta);
-        wpreal = cos(theta);
-        wreal = 1.0;
-        wimag = 0.0;
-
-        for (m=0; m < k; m++)
-        {
-            for (Addr = m; Addr < length; Addr += (k*2))
-            {
-                PairAddr = Addr + k;
-
-                tempreal = wreal * (double)real[PairAddr] - wimag * (double)imag[PairAddr];
-                tempimag = wreal * (double)imag[PairAddr] + wimag * (double)real[PairAddr];
-
-
-                real[PairAddr] = (double)real[Addr] - tempreal;
-                imag[PairAddr] = (double)imag[Addr] - tempimag;
-                real[Addr] += tempreal;
-                imag[Addr] += tempimag;
-            }
-            tempwreal = wreal;
-            wreal = wreal * wpreal - wimag * wpimag;
-            wimag = wimag * wpreal + tempwreal * wpimag;
-        }
-    }
-
-    if(Inverse)							// Normalize the IFFT coefficients
-        for(int i=0; i<length; i++)
-        {
-            real[i] /= (double)length;
-            imag[i] /= (double)length;
-        }
+    m_tdrResolution = m_tdrRange*1000000/length;
+    memcpy(m_pdTdrImp, impulse.constData(), length*sizeof(double));
+    memcpy(m_pdTdrStep, step.constData(), length*sizeof(double));
+    return length;
 }
 
 void Measurements::on_dotsNumberChanged(int number)
@@ -2748,7 +2172,28 @@ void Measurements::on_changeMeasureSystemMetric (bool state)
     }
 }
 
+// the measurements redrawCurrentTab() rebuilds, all of them for NULL
+static QList<int> traceIndices(int count, const QSet<int> *changed)
+{
+    QList <int> traces;
+    for(int i = 0; i < count; ++i)
+    {
+        if((changed == NULL) || changed->contains(i))
+        {
+            traces.append(i);
+        }
+    }
+    return traces;
+}
+
 void Measurements::on_redrawGraphs()
+{
+    redrawCurrentTab();
+    // the hidden tabs are rebuilt once when they are shown again
+    markTabsDirty(DirtyTraces);
+}
+
+void Measurements::redrawCurrentTab(const QSet<int> *changed)
 {
     if(m_calibration == NULL)
     {
@@ -2759,6 +2204,7 @@ void Measurements::on_redrawGraphs()
         replot();
         return;
     }
+    QList <int> traces = traceIndices(m_measurements.length(), changed);
 
     if(m_calibration->getCalibrationEnabled())
     {
@@ -2768,7 +2214,7 @@ void Measurements::on_redrawGraphs()
             {
                 calcFarEnd();
             }
-            for(int i = 0; i < m_measurements.length(); ++i)
+            foreach (int i, traces)
             {
                 m_viewMeasurements[i].swrGraphCalib.clear();
 
@@ -2797,20 +2243,20 @@ void Measurements::on_redrawGraphs()
             if(m_farEndMeasurement == 1)
             {
                 calcFarEnd();
-                for(int i = 0; i < m_measurements.length(); ++i)
+                foreach (int i, traces)
                 {
                     m_phaseWidget->graph(i+1)->setData(&m_farEndMeasurementsSub[i].phaseGraph, true);
                 }
             }else if(m_farEndMeasurement == 1)
             {
                 calcFarEnd();
-                for(int i = 0; i < m_measurements.length(); ++i)
+                foreach (int i, traces)
                 {
                     m_phaseWidget->graph(i+1)->setData(&m_farEndMeasurementsAdd[i].phaseGraph, true);
                 }
             }else
             {
-                for(int i = 0; i < m_measurements.length(); ++i)
+                foreach (int i, traces)
                 {
                     m_phaseWidget->graph(i+1)->setData(&m_measurements[i].phaseGraphCalib, true);
                 }
@@ -2818,7 +2264,7 @@ void Measurements::on_redrawGraphs()
         }else if(m_currentTab == "tab_3")//RX
         {
             calcFarEnd();
-            for(int i = 0; i < m_measurements.length(); ++i)
+            foreach (int i, traces)
             {
                 QCPDataMap mapr;
                 QCPDataMap mapx;
@@ -2910,7 +2356,7 @@ void Measurements::on_redrawGraphs()
             {
                 calcFarEnd();
             }
-            for(int i = 0; i < m_measurements.length(); ++i)
+            foreach (int i, traces)
             {
                 QCPDataMap mapr;
                 QCPDataMap mapx;
@@ -3002,7 +2448,7 @@ void Measurements::on_redrawGraphs()
             {
                 calcFarEnd();
             }
-            for(int i = 0; i < m_measurements.length(); ++i)
+            foreach (int i, traces)
             {
                 m_rlWidget->graph(i+1)->setData(&m_measurements[i].rlGraphCalib, true);
             }
@@ -3135,20 +2581,20 @@ void Measurements::on_redrawGraphs()
                 calcFarEnd();
                 if(m_farEndMeasurement == 1)
                 {
-                    for(int i = 0; i < m_measurements.length(); ++i)
+                    foreach (int i, traces)
                     {
                         m_measurements[i].smithCurve->setData(&m_farEndMeasurementsSub[i].smithGraphCalib,true);
                     }
                 }else if(m_farEndMeasurement == 2)
                 {
-                    for(int i = 0; i < m_measurements.length(); ++i)
+                    foreach (int i, traces)
                     {
                         m_measurements[i].smithCurve->setData(&m_farEndMeasurementsAdd[i].smithGraphCalib,true);
                     }
                 }
             }else
             {
-                for(int i = 0; i < m_measurements.length(); ++i)
+                foreach (int i, traces)
                 {
                     m_measurements[i].smithCurve->setData(&m_measurements[i].smithGraphViewCalib,true);
                 }
@@ -3162,7 +2608,7 @@ void Measurements::on_redrawGraphs()
             {
                 calcFarEnd();
             }
-            for(int i = 0; i < m_measurements.length(); ++i)
+            foreach (int i, traces)
             {
                 m_viewMeasurements[i].swrGraph.clear();
 
@@ -3191,20 +2637,20 @@ void Measurements::on_redrawGraphs()
             if(m_farEndMeasurement == 1)
             {
                 calcFarEnd();
-                for(int i = 0; i < m_measurements.length(); ++i)
+                foreach (int i, traces)
                 {
                     m_phaseWidget->graph(i+1)->setData(&m_farEndMeasurementsSub[i].phaseGraph, true);
                 }
             }else if(m_farEndMeasurement == 1)
             {
                 calcFarEnd();
-                for(int i = 0; i < m_measurements.length(); ++i)
+                foreach (int i, traces)
                 {
                     m_phaseWidget->graph(i+1)->setData(&m_farEndMeasurementsAdd[i].phaseGraph, true);
                 }
             }else
             {
-                for(int i = 0; i < m_measurements.length(); ++i)
+                foreach (int i, traces)
                 {
                     m_phaseWidget->graph(i+1)->setData(&m_measurements[i].phaseGraph, true);
                 }
@@ -3212,7 +2658,7 @@ void Measurements::on_redrawGraphs()
         }else if(m_currentTab == "tab_3")//RX
         {
             calcFarEnd();
-            for(int i = 0; i < m_measurements.length(); ++i)
+            foreach (int i, traces)
             {
                 QCPDataMap mapr;
                 QCPDataMap mapx;
@@ -3312,7 +2758,7 @@ void Measurements::on_redrawGraphs()
             {
                 calcFarEnd();
             }
-            for(int i = 0; i < m_measurements.length(); ++i)
+            foreach (int i, traces)
             {
                 QCPDataMap rMap;
                 QCPDataMap xMap;
@@ -3404,7 +2850,7 @@ void Measurements::on_redrawGraphs()
             {
                 calcFarEnd();
             }
-            for(int i = 0; i < m_measurements.length(); ++i)
+            foreach (int i, traces)
             {
                 m_rlWidget->graph(i+1)->setData(&m_measurements[i].rlGraph, true);
             }
@@ -3537,20 +2983,20 @@ void Measurements::on_redrawGraphs()
                 calcFarEnd();
                 if(m_farEndMeasurement == 1)
                 {
-                    for(int i = 0; i < m_measurements.length(); ++i)
+                    foreach (int i, traces)
                     {
                         m_measurements[i].smithCurve->setData(&m_farEndMeasurementsSub[i].smithGraph,true);
                     }
                 }else if(m_farEndMeasurement == 2)
                 {
-                    for(int i = 0; i < m_measurements.length(); ++i)
+                    foreach (int i, traces)
                     {
                         m_measurements[i].smithCurve->setData(&m_farEndMeasurementsAdd[i].smithGraph,true);
                     }
                 }
             }else
             {
-                for(int i = 0; i < m_measurements.length(); ++i)
+                foreach (int i, traces)
                 {
                     m_measurements[i].smithCurve->setData(&m_measurements[i].smithGraphView,true);
                 }
@@ -3598,6 +3044,7 @@ void Measurements::NormRXtoSmithPoint(double Rnorm, double Xnorm, double &x, dou
 
 void Measurements::drawSmithImage (void)
 {
+    m_smithWidget->setCurrentLayer("static");
     QPen pen;
     pen.setColor(Qt::black);
 #define ROUND_DOTS_NUM 360
@@ -3825,6 +3272,7 @@ void Measurements::drawSmithImage (void)
     down02->setFont(serifFont);
     down02->setColor(QColor(0, 0, 0, 150));
 
+    m_smithWidget->setCurrentLayer("main");
 }
 //Cable-------------------------------------------------------------------------
 void Measurements::setCableVelFactor(double value)
@@ -3872,498 +3320,104 @@ void Measurements::setCableFarEndMeasurement(int value)
     m_farEndMeasurement = value;
 }
 
-void Measurements::calcFarEnd(void)
+CableModel Measurements::cableModel() const
 {
-    if(m_calibration != NULL)
-    {
-        int count = m_measurements.length();
-        int dataCount;
-        QVector <rawData> data;
-
-        for(int i = 0; i < count; ++i)
-        {
-            if(m_calibration->getCalibrationEnabled())
-            {
-                dataCount = m_measurements.at(i).dataRXCalib.length();
-                data = m_measurements.at(i).dataRXCalib;
-            }else
-            {
-                dataCount = m_measurements.at(i).dataRX.length();
-                data = m_measurements.at(i).dataRX;
-            }
-
-            if(m_farEndMeasurement==1) // subtract cable
-            {
-                m_farEndMeasurementsSub[i].dataRX.clear();
-                m_farEndMeasurementsSub[i].rsrGraph.clear();
-                m_farEndMeasurementsSub[i].rsxGraph.clear();
-                m_farEndMeasurementsSub[i].rszGraph.clear();
-                m_farEndMeasurementsSub[i].rprGraph.clear();
-                m_farEndMeasurementsSub[i].rpxGraph.clear();
-                m_farEndMeasurementsSub[i].rpzGraph.clear();
-                m_farEndMeasurementsSub[i].phaseGraph.clear();
-                m_farEndMeasurementsSub[i].rhoGraph.clear();
-                m_farEndMeasurementsSub[i].smithGraph.clear();
-            }else if(m_farEndMeasurement==2) // add cable
-            {
-                m_farEndMeasurementsAdd[i].dataRX.clear();
-                m_farEndMeasurementsAdd[i].rsrGraph.clear();
-                m_farEndMeasurementsAdd[i].rsxGraph.clear();
-                m_farEndMeasurementsAdd[i].rszGraph.clear();
-                m_farEndMeasurementsAdd[i].rprGraph.clear();
-                m_farEndMeasurementsAdd[i].rpxGraph.clear();
-                m_farEndMeasurementsAdd[i].rpzGraph.clear();
-                m_farEndMeasurementsAdd[i].phaseGraph.clear();
-                m_farEndMeasurementsAdd[i].rhoGraph.clear();
-                m_farEndMeasurementsAdd[i].smithGraph.clear();
-            }
-
-            double fq;
-            double R;
-            double X;
-            double Rpar;
-            double Xpar;
-            QCPData qdata;
-            for(int n = 0; n < dataCount; ++n)
-            {
-                fq = data.at(n).fq;
-                qdata.key = fq*1000;
-                R = data.at(n).r;
-                X = data.at(n).x;
-                //if (m_farEndMeasurement != 0)
-                {
-                    double Klen = 1;
-                    switch (m_cableLossUnits)
-                    {
-                        case 0: Klen = 1; break;
-                        case 1: Klen = 1*100.0; break;
-                        case 2: Klen = 1/FEETINMETER; break;
-                        case 3: Klen = 1/FEETINMETER*100.0; break;
-                    }
-
-                    Complex Zload = Complex( R, X);
-
-                    double dMatchedLossDb;  // Note that K1/K2 are in dB/100 ft
-                    if(!m_cableLossAtAnyFq)
-                        dMatchedLossDb = m_cableLossConductive*Klen*sqrt(fq/1000.0) + m_cableLossDielectric*Klen*fq/1000.0;
-                    else
-                        dMatchedLossDb = m_cableLossConductive*Klen + m_cableLossDielectric*Klen;
-
-
-            #define NEPER 8.68588963806504        // = 20 / Ln(10)
-
-                    double Alpha = dMatchedLossDb / 100.0 / NEPER; // Nepers (attenuation) per foot
-                    double Beta = (2*M_PI * fq/1000.0) / (SPEEDOFLIGHT*FEETINMETER/1000000.0 * m_cableVelFactor); // Radians (phase constant) per foot
-
-                    double Alphal = Alpha * m_cableLength;
-                    double Betal = Beta * m_cableLength;
-
-                    if(m_farEndMeasurement==1) // subtract cable
-                    {
-                        Alphal = -Alphal;
-                        Betal = -Betal;
-
-                        if (m_cableLossUnits==0)
-                        {
-                            Alphal *= FEETINMETER;
-                            Betal *= FEETINMETER;
-                        }
-
-                        Complex Sinh_gl = Complex( cos(Betal) * sinh(Alphal), sin(Betal) * cosh(Alphal) );
-                        Complex Cosh_gl = Complex( cos(Betal) * cosh(Alphal), sin(Betal) * sinh(Alphal) );
-
-                        Complex Zo = Complex(m_cableResistance, -m_cableResistance * (Alpha / Beta));
-
-                        Complex ZIZL = Zo * ( (Zload*Cosh_gl + Zo*Sinh_gl) /  (Zo*Cosh_gl + Zload*Sinh_gl) );
-
-                        R = ZIZL.real();
-                        if(R<0.0001)
-                            R = 0.0001;
-                        X = ZIZL.imag();
-
-                        Rpar = R*(1+X*X/R/R);
-                        Xpar = X*(1+R*R/X/X);
-
-                        if (qIsNaN(R) || (R<0.001) ) {R = 0.01;}
-                        if (qIsNaN(X)) {X = 0;}
-
-                        double Rnorm = R/m_Z0;
-                        double Xnorm = X/m_Z0;
-
-                        double Denom = (Rnorm+1)*(Rnorm+1)+Xnorm*Xnorm;
-                        double RhoReal = ((Rnorm-1)*(Rnorm+1)+Xnorm*Xnorm)/Denom;
-                        double RhoImag = 2*Xnorm/Denom;
-
-                        double RhoPhase = atan2(RhoImag, RhoReal) / M_PI * 180.0;
-                        double RhoMod = sqrt(RhoReal*RhoReal+RhoImag*RhoImag);
-
-                        rawData da = data.at(n);
-                        da.r = R;
-                        da.x = X;
-                        m_farEndMeasurementsSub[i].dataRX.append(da);
-
-                        qdata.value = R;
-                        m_farEndMeasurementsSub[i].rsrGraph.insert(qdata.key,qdata);
-                        qdata.value = X;
-                        m_farEndMeasurementsSub[i].rsxGraph.insert(qdata.key,qdata);
-                        qdata.value = computeZ(R, X);
-                        m_farEndMeasurementsSub[i].rszGraph.insert(qdata.key,qdata);
-
-                        qdata.value = Rpar;
-                        m_farEndMeasurementsSub[i].rprGraph.insert(qdata.key,qdata);
-                        qdata.value = Xpar;
-                        m_farEndMeasurementsSub[i].rpxGraph.insert(qdata.key,qdata);
-                        qdata.value = computeZ(R, X);
-                        m_farEndMeasurementsSub[i].rpzGraph.insert(qdata.key,qdata);
-
-                        qdata.value = RhoPhase;
-                        m_farEndMeasurementsSub[i].phaseGraph.insert(qdata.key,qdata);
-                        qdata.value = RhoMod;
-                        m_farEndMeasurementsSub[i].rhoGraph.insert(qdata.key,qdata);
-
-                        double pointX,pointY;
-                        NormRXtoSmithPoint(R/m_Z0, X/m_Z0, pointX, pointY);
-                        int len = m_farEndMeasurementsSub[i].dataRX.length();
-                        m_farEndMeasurementsSub[i].smithGraph.insert(len, QCPCurveData(len, pointX, pointY));
-                    }else if (m_farEndMeasurement==2) // add cable
-                    {
-                        if (m_cableLossUnits==0)
-                        {
-                            Alphal *= FEETINMETER;
-                            Betal *= FEETINMETER;
-                        }
-
-                        Complex Sinh_gl = Complex( cos(Betal) * sinh(Alphal), sin(Betal) * cosh(Alphal) );
-                        Complex Cosh_gl = Complex( cos(Betal) * cosh(Alphal), sin(Betal) * sinh(Alphal) );
-
-                        Complex Zo = Complex(m_cableResistance, -m_cableResistance * (Alpha / Beta));
-
-                        Complex ZIZL = Zo * ( (Zload*Cosh_gl + Zo*Sinh_gl) /  (Zo*Cosh_gl + Zload*Sinh_gl) );
-
-                        R = ZIZL.real();
-                        if(R<0.0001)
-                            R = 0.0001;
-                        X = ZIZL.imag();
-
-                        Rpar = R*(1+X*X/R/R);
-                        Xpar = X*(1+R*R/X/X);
-
-                        if (qIsNaN(R) || (R<0.001) ) {R = 0.01;}
-                        if (qIsNaN(X)) {X = 0;}
-
-                        double Rnorm = R/m_Z0;
-                        double Xnorm = X/m_Z0;
-
-                        double Denom = (Rnorm+1)*(Rnorm+1)+Xnorm*Xnorm;
-                        double RhoReal = ((Rnorm-1)*(Rnorm+1)+Xnorm*Xnorm)/Denom;
-                        double RhoImag = 2*Xnorm/Denom;
-
-                        double RhoPhase = atan2(RhoImag, RhoReal) / M_PI * 180.0;
-                        double RhoMod = sqrt(RhoReal*RhoReal+RhoImag*RhoImag);
-
-                        rawData da = data.at(n);
-                        da.r = R;
-                        da.x = X;
-                        m_farEndMeasurementsAdd[i].dataRX.append(da);
-
-                        qdata.value = R;
-                        m_farEndMeasurementsAdd[i].rsrGraph.insert(qdata.key,qdata);
-                        qdata.value = X;
-                        m_farEndMeasurementsAdd[i].rsxGraph.insert(qdata.key,qdata);
-                        qdata.value = computeZ(R, X);
-                        m_farEndMeasurementsAdd[i].rszGraph.insert(qdata.key,qdata);
-
-                        qdata.value = Rpar;
-                        m_farEndMeasurementsAdd[i].rprGraph.insert(qdata.key,qdata);
-                        qdata.value = Xpar;
-                        m_farEndMeasurementsAdd[i].rpxGraph.insert(qdata.key,qdata);
-                        qdata.value = computeZ(R, X);
-                        m_farEndMeasurementsAdd[i].rpzGraph.insert(qdata.key,qdata);
-
-                        qdata.value = RhoPhase;
-                        m_farEndMeasurementsAdd[i].phaseGraph.insert(qdata.key,qdata);
-                        qdata.value = RhoMod;
-                        m_farEndMeasurementsAdd[i].rhoGraph.insert(qdata.key,qdata);
-
-                        double pointX,pointY;
-                        NormRXtoSmithPoint(R/m_Z0, X/m_Z0, pointX, pointY);
-                        int len = m_farEndMeasurementsAdd[i].dataRX.length();
-                        m_farEndMeasurementsAdd[i].smithGraph.insert(len, QCPCurveData(len, pointX, pointY));
-                    }
-                }
-            }
-        }
-    }
+    CableModel cable;
+    cable.mode = m_farEndMeasurement;
+    cable.length = m_cableLength;
+    cable.velocityFactor = m_cableVelFactor;
+    cable.resistance = m_cableResistance;
+    cable.lossConductive = m_cableLossConductive;
+    cable.lossDielectric = m_cableLossDielectric;
+    cable.lossUnits = m_cableLossUnits;
+    cable.lossAtAnyFq = m_cableLossAtAnyFq != 0;
+    return cable;
 }
 
-int Measurements::CalcTdr2(QVector <rawData> *data)
+void Measurements::calcFarEnd(void)
 {
-    #define   MIN_VECTOR_SIZE    500
-    #define   MAX_VECTOR_SIZE    16384    						// value must be by Radix2 !!!
-    #define   PI                 (double)3.14159265358979323846
-    #define   LIGHT_SPEED        (double)299792458.0
-
-    //------  ZERO_STYLEs
-    #define   ARTIFICAL_12        0  // phase of zero is calculated from 1 & 2 bin
-    #define   FROM_LOWEST         1  // phase of zero is calculated from lowest frequency posible, this point must be located at zero index of R,X vector
-
-    #define  FT_DIRECT        			-1    // Direct transform.
-    #define  FT_INVERSE       			 1    // Inverse transform.
-
-    //---------STEP flags
-    #define STEPUNITY   		0
-    #define STEPIMPEDANCE		1
-    //-------------------
-
-    double GK_Re[MAX_VECTOR_SIZE*2];           // vector size, doubling for mirroring
-    double GK_Im[MAX_VECTOR_SIZE*2];           // vector size, doubling for mirroring
-
-    int vector_length;
-    int radix2length;
-    int  log2N;
-
-    int cnt;
-    double R;
-    double X;
-    double t_Re;
-    double t_Im;
-    double hamm;
-    if(data->length() < MIN_VECTOR_SIZE+1)
-    {
-        return 0;
-    }
-    if(data->length() > MAX_VECTOR_SIZE)
-    {
-        return 0;
-    }
-    //-----------cache vars, try to find radix2 length
-    vector_length = data->length();
-
-    radix2length = DTF_FindRadix2Length(vector_length, &log2N);
-
-    if(radix2length == 0)
-    {
-        return 0;
-    }
-    //--------------
-
-    //-------generating GK, calculation, windowing, padding and mirroring
-    cnt=1;  //starting from first bin, zero will be inserted later
-    do{
-        if(cnt < vector_length)
-        {
-            //----GE calc
-            X = data->at(cnt).x;
-            R = data->at(cnt).r;
-            t_Re = (R*R - m_Z0 * m_Z0 +X*X)/((R+ m_Z0)*(R+m_Z0)+X*X);
-            t_Im = (2*m_Z0*X)/((R+m_Z0)*(R+m_Z0)+X*X);
-            //----window calc,hamming, one half, positive frequency part
-            hamm = 0.53836 - 0.46146 * cos(PI * (1.0 + ((double)cnt / (double)vector_length)));
-            // zero case is drop out and it equals 1.0 and applies to zero bin
-
-            t_Re *= hamm;
-            t_Im *= hamm;
-            //----positive frequencies
-            GK_Re[cnt] = t_Re;
-            GK_Im[cnt] = t_Im;
-            //---negative frequencies, mirror
-            GK_Re[radix2length*2-cnt]=t_Re;
-            GK_Im[radix2length*2-cnt]=-t_Im;
-        }else
-        {
-            //---padding to radix2length by zeroes
-            GK_Re[cnt] = 0.0;
-            GK_Im[cnt] = 0.0;
-            GK_Re[radix2length*2-cnt]=0.0;
-            GK_Im[radix2length*2-cnt]=0.0;
-        }
-    }while(++cnt<radix2length);
-
-    //-----put N/2 value
-    GK_Re[radix2length] = 0.0;
-    GK_Im[radix2length] = 0.0;
-
-
-    //-----deliver zero bin
-    double p1;
-    double p2;
-    double mod;
-
-    p1 = sqrt(GK_Re[1]*GK_Re[1]+GK_Im[1]*GK_Im[1]);
-    p2 = sqrt(GK_Re[2]*GK_Re[2]+GK_Im[2]*GK_Im[2]);
-    mod = 2*p1-p2;    // module is linear extrapolated from p1,p2
-
-    p1 = atan2(GK_Re[1], GK_Im[1]);
-    p2 = atan2(GK_Re[2], GK_Im[2]);
-
-    double phase = p2-p1;
-
-    while(phase > PI) {phase=phase-2*PI;}
-    while(phase <-PI) {phase=phase+2*PI;}
-
-    p2 = phase;
-
-    phase = p1-p2;
-
-    while(phase > PI) {phase=phase-2*PI;}
-    while(phase <-PI) {phase=phase+2*PI;}
-
-    p2 = phase;
-
-    if((p2 < -PI/2)||(p2 > PI/2))
-    {
-        GK_Re[0] = mod * (-1.0);
-    }else
+    if((m_calibration == NULL) ||
+       ((m_farEndMeasurement != CableModel::Subtract) && (m_farEndMeasurement != CableModel::Add)))
     {
-        GK_Re[0] = mod * (1.0);
-    }
-
-    GK_Im[0]=0.0;
-    //------------------------------------------
-
-    FFT2(GK_Im, GK_Re, radix2length*2, (log2N+1), FT_DIRECT);
-
-    for(int i = 0; i < radix2length*2; ++i)
-    {
-        m_pdTdrImp[i] = GK_Re[i];
+        return;
     }
-
-    //dtf_do_step
-    qint16 end,cnt1;
-    double acc;
-    //-------
-    acc = 0.0;
-    end = radix2length*2;
-    cnt1 = 0;
-    do{
-        acc = acc + GK_Re[cnt1];
-        m_pdTdrStep[cnt1] = acc;
-    }while(++cnt1<end);
-
-    //DTF_CalcResolution
-    double tmp;
-//    vector_length = UTIL_limit_u16(MIN_VECTOR_SIZE, MAX_VECTOR_SIZE, vector_length);
-    tmp = (data->last().fq/1000 - data->first().fq/1000)/(vector_length-1);   // resolution by original set
-    tmp = tmp * radix2length;                // new Fmax by radix2length
-    tmp = (LIGHT_SPEED * m_cableVelFactor)/(( tmp - data->first().fq/1000)*2*1000000.0);
-
-    m_tdrResolution = tmp*1000;
-
-    m_tdrRange = m_tdrResolution * radix2length/1000000;
-
-
-    return end;
-}
-
-qint16 Measurements::DTF_FindRadix2Length(qint16 length, int *log2N)
-{
-    qint8 log;
-    qint16 result =0x0010;   //start from 16
-    log = 4;
-    while(result <= MAX_VECTOR_SIZE)
-    {
-        if (result >= length)
-        {
-            (*log2N)=log;
-            return result;
+    CableModel cable = cableModel();
+    int count = m_measurements.length();
+    for(int i = 0; i < count; ++i)
+    {
+        const QVector <rawData> &data = m_calibration->getCalibrationEnabled() ?
+                    m_measurements.at(i).dataRXCalib : m_measurements.at(i).dataRX;
+        int dataCount = data.length();
+
+        measurement &farEnd = (m_farEndMeasurement == CableModel::Subtract) ?
+                    m_farEndMeasurementsSub[i] : m_farEndMeasurementsAdd[i];
+        farEnd.dataRX.clear();
+        farEnd.rsrGraph.clear();
+        farEnd.rsxGraph.clear();
+        farEnd.rszGraph.clear();
+        farEnd.rprGraph.clear();
+        farEnd.rpxGraph.clear();
+        farEnd.rpzGraph.clear();
+        farEnd.phaseGraph.clear();
+        farEnd.rhoGraph.clear();
+        farEnd.smithGraph.clear();
+        farEnd.dataRX.reserve(dataCount);
+
+        QCPData qdata;
+        for(int n = 0; n < dataCount; ++n)
+        {
+            rawData da = SweepMath::transformCable(cable, data.at(n));
+            double R = da.r;
+            double X = da.x;
+            qdata.key = da.fq*1000;
+
+            double Rpar = R*(1+X*X/R/R);
+            double Xpar = X*(1+R*R/X/X);
+
+            if (qIsNaN(R) || (R<0.001) ) {R = 0.01;}
+            if (qIsNaN(X)) {X = 0;}
+
+            double Rnorm = R/m_Z0;
+            double Xnorm = X/m_Z0;
+
+            double Denom = (Rnorm+1)*(Rnorm+1)+Xnorm*Xnorm;
+            double RhoReal = ((Rnorm-1)*(Rnorm+1)+Xnorm*Xnorm)/Denom;
+            double RhoImag = 2*Xnorm/Denom;
+
+            double RhoPhase = atan2(RhoImag, RhoReal) / M_PI * 180.0;
+            double RhoMod = sqrt(RhoReal*RhoReal+RhoImag*RhoImag);
+
+            da.r = R;
+            da.x = X;
+            farEnd.dataRX.append(da);
+
+            qdata.value = R;
+            farEnd.rsrGraph.insert(qdata.key,qdata);
+            qdata.value = X;
+            farEnd.rsxGraph.insert(qdata.key,qdata);
+            qdata.value = computeZ(R, X);
+            farEnd.rszGraph.insert(qdata.key,qdata);
+
+            qdata.value = Rpar;
+            farEnd.rprGraph.insert(qdata.key,qdata);
+            qdata.value = Xpar;
+            farEnd.rpxGraph.insert(qdata.key,qdata);
+            qdata.value = computeZ(R, X);
+            farEnd.rpzGraph.insert(qdata.key,qdata);
+
+            qdata.value = RhoPhase;
+            farEnd.phaseGraph.insert(qdata.key,qdata);
+            qdata.value = RhoMod;
+            farEnd.rhoGraph.insert(qdata.key,qdata);
+
+            double pointX,pointY;
+            NormRXtoSmithPoint(R/m_Z0, X/m_Z0, pointX, pointY);
+            int len = farEnd.dataRX.length();
+            farEnd.smithGraph.insert(len, QCPCurveData(len, pointX, pointY));
         }
-        result<<=1;
-        log++;
-    }
-    return 0;
-}
-
-void  Measurements::FFT2(double *Rdat, double *Idat, int N, int LogN, int Ft_Flag)
-{
-  register int  i, j, n, k, io, ie, in, nn;
-  double        ru, iu, rtp, itp, rtq, itq, rw, iw, sr;
-
-  static const double Rcoef[14] =
-  {  -1.0000000000000000,  0.0000000000000000,  0.7071067811865475,
-      0.9238795325112867,  0.9807852804032304,  0.9951847266721969,
-      0.9987954562051724,  0.9996988186962042,  0.9999247018391445,
-      0.9999811752826011,  0.9999952938095761,  0.9999988234517018,
-      0.9999997058628822,  0.9999999264657178
-  };
-  static const double Icoef[14] =
-  {   0.0000000000000000, -1.0000000000000000, -0.7071067811865474,
-     -0.3826834323650897, -0.1950903220161282, -0.0980171403295606,
-     -0.0490676743274180, -0.0245412285229122, -0.0122715382857199,
-     -0.0061358846491544, -0.0030679567629659, -0.0015339801862847,
-     -0.0007669903187427, -0.0003834951875714
-  };
-
-  nn = N >> 1;
-  ie = N;
-  for(n=1; n<=LogN; n++)
-  {
-    rw = Rcoef[LogN - n];
-    iw = Icoef[LogN - n];
-    in = ie >> 1;
-    ru = 1.0;
-    iu = 0.0;
-    for(j=0; j<in; j++)
-    {
-      for(i=j; i<N; i+=ie)
-      {
-        io       = i + in;
-        rtp      = Rdat[i]  + Rdat[io];
-        itp      = Idat[i]  + Idat[io];
-        rtq      = Rdat[i]  - Rdat[io];
-        itq      = Idat[i]  - Idat[io];
-        Rdat[io] = rtq * ru - itq * iu;
-        Idat[io] = itq * ru + rtq * iu;
-        Rdat[i]  = rtp;
-        Idat[i]  = itp;
-      }
-
-      if(Ft_Flag == FT_INVERSE) iw = -iw;
-      sr = ru;
-      ru = ru * rw - iu * iw;
-      iu = iu * rw + sr * iw;
-    }
-    ie >>= 1;
-  }
-
-  for(j=i=1; i<N; i++)
-  {
-    if(i < j)
-    {
-      io       = i - 1;
-      in       = j - 1;
-      rtp      = Rdat[in];
-      itp      = Idat[in];
-      Rdat[in] = Rdat[io];
-      Idat[in] = Idat[io];
-      Rdat[io] = rtp;
-      Idat[io] = itp;
-    }
-
-    k = nn;
-
-    while(k < j)
-    {
-      j   = j - k;
-      k >>= 1;
     }
-
-    j = j + k;
-  }
-
-  if(Ft_Flag == FT_INVERSE) return;
-
-  rw = 1.0 / N;
-
-  for(i=0; i<N; i++)
-  {
-    Rdat[i] *= rw;
-    Idat[i] *= rw;
-  }
-
-  return;
 }
 
-
 void Measurements::on_translate()
 {
     if (m_graphHint != nullptr)
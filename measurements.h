@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QVector>
+#include <QSet>
 #include <math.h>
 #include <qdebug.h>
 #include <qcustomplot.h>
@@ -11,11 +12,20 @@
 #include <QSettings>
 #include <calibration.h>
 #include <ctime>
-#include <complex>
 #include <settings.h>
+#include <tracelookup.h>
+#include <measurementfile.h>
+#include <touchstone.h>
+#include <exportengine.h>
+#include <sessionarchive.h>
+#include <measurementlistmodel.h>
+#include <core/sweepmath.h>
+#include <core/sweepstats.h>
+#include <core/sweeptracker.h>
 
 #define MAX_MEASUREMENTS 5
 #define TDR_MAXARRAY 20000
+#define BULK_PARALLEL_DOTS 2000 // appendData() computes larger arrays on all cores
 
 #define SPEEDOFLIGHT 299792458.0
 #define FEETINMETER 3.2808399
@@ -27,8 +37,6 @@
 #define INACTIVE_GRAPH_PEN_WIDTH 2
 
 
-typedef std::complex <double> Complex;
-
 class Measurements : public QObject
 {
     Q_OBJECT
@@ -37,7 +45,7 @@ public:
     ~Measurements();
 
     void setWidgets(QCustomPlot * swr, QCustomPlot * phase, QCustomPlot * rs, QCustomPlot * rp,
-                    QCustomPlot * rl, QCustomPlot * tdr, QCustomPlot * smith, QTableWidget *table);
+                    QCustomPlot * rl, QCustomPlot * tdr, QCustomPlot * smith, QTableView *table);
     void setCalibration(Calibration * _calibration);
     bool getCalibrationEnabled(void);
     void deleteRow(int row);
@@ -46,23 +54,45 @@ public:
     measurement* getMeasurementSub(int number) {return &m_farEndMeasurementsSub[m_farEndMeasurementsSub.length()-1 - number];}
     measurement* getMeasurementAdd(int number) {return &m_farEndMeasurementsAdd[m_farEndMeasurementsAdd.length()-1 - number];}
     qint32 getMeasurementLength(void) {return m_measurements.length();}
+    TraceLookup traceLookup(int index);
     bool isEmpty() { return getMeasurementLength() == 0; }
     bool getGraphHintEnabled(void);
     void saveData(quint32 number, QString path);
     void loadData(QString path);
+    // all measurements with Z0, cable and calibration files in one .asz
+    bool saveSession(QString path);
+    void loadSession(QString path);
+    // replays the raw points together with the calibrated ones of the archive
+    void addMeasurement(const SessionMeasurement &item);
 
     void exportData(QString _name, int _type, int _number);
+    ExportItem exportItem(int number, QString target, int type);
+    QString getMeasurementName(int number);
     void importData(QString _name);
+    // _calibrated, if given, holds the calibrated points of _data
+    void appendData(const QVector<rawData> &_data, const QVector<rawData> *_calibrated = NULL);
+    // min, max and mean of every point over the complete continuous sweeps,
+    // drawn on the SWR and R/X tabs from the second sweep on
+    const SweepStatistics &continuousStatistics() const { return m_statistics; }
+    bool continuousStatisticsEnabled() const { return m_statisticsEnabled; }
+    void setContinuousStatisticsEnabled(bool enabled);
+    // SWR minimum, resonance, bandwidth and Q of the sweep being measured,
+    // current after every point; shown in the corner of the SWR graph
+    const TrackerResult &trackerResult() const { return m_tracker.result(); }
+    bool trackerEnabled() const { return m_trackerEnabled; }
+    void setTrackerEnabled(bool enabled);
+    // the points of the sweeps between beginMerge() and endMerge() go into the
+    // last measurement, sorted in by frequency; used to fill the gaps of a
+    // zoomed or panned view
+    void beginMerge();
+    void endMerge();
+    bool isMerging() const { return m_merging; }
 
     double getZ0(void) const{ return m_Z0;}
-    void setZ0(double _Z0) { m_Z0 = _Z0;}
+    void setZ0(double _Z0) { m_Z0 = _Z0; m_listModel->setZ0(_Z0); m_tracker.setZ0(_Z0);}
 
     int CalcTdr(QVector<rawData> *data);
-    void FFT(float real[], float imag[], int length, int Inverse = 0);
 
-    int CalcTdr2(QVector <rawData> *data);
-    qint16 DTF_FindRadix2Length(qint16 length, int *log2N);
-    void FFT2(double *Rdat, double *Idat, int N, int LogN, int Ft_Flag);
 
     void setCableVelFactor(double value);
     void setCableResistance(double value);
@@ -78,7 +108,7 @@ public:
 private:
 //    QVector <rawData> m_rawDataVector;
 //    QVector < QVector<rawData> > m_rawDataLists;
-    QVector <QString> m_tableNames;
+    MeasurementListModel *m_listModel;
 
     QString m_currentTab;
 
@@ -95,7 +125,7 @@ private:
     QCustomPlot *m_rlWidget;
     QCustomPlot *m_tdrWidget;
     QCustomPlot *m_smithWidget;
-    QTableWidget *m_tableWidget;
+    QTableView *m_tableView;
 
     qint32 m_currentIndex;
 
@@ -143,18 +173,113 @@ private:
     double m_cableLength;
     qint32 m_farEndMeasurement;
     QCPItemEllipse * m_smithTracer;
+    int m_popupIndex;
+    double m_popupKey;
+
+    // what went stale on a tab while it was hidden, applied by on_currentTab()
+    enum DirtyFlag
+    {
+        DirtyCursor = 0x01, // sweep cursor line, graph(0)
+        DirtyTraces = 0x02  // measurement graphs have to be rebuilt
+    };
+    QMap <QString, int> m_dirtyTabs;
+    QMap <QString, QSet<int> > m_dirtyTraces; // measurements changed on a tab without DirtyTraces
+    double m_cursorFq;
+
+    // grid of the running continuous measurement
+    qint64 m_continuousFq;
+    qint64 m_continuousSw;
+    qint32 m_continuousDots;    // -1 if no continuous measurement runs
+    SweepStatistics m_statistics;
+
+    enum StatisticsCurve
+    {
+        StatSwrMax = 0, StatSwrMin, StatSwrMean,
+        StatRMax, StatRMin, StatRMean,
+        StatXMax, StatXMin, StatXMean,
+        StatCurveCount
+    };
+    QCPCurve *m_statCurves[StatCurveCount];
+    bool m_statisticsEnabled;
+    bool m_sweepFolded;         // the sweep being measured is in m_statistics
+    bool m_merging;
+    QVector <rawData> m_mergeBuffer;
+
+    SweepTracker m_tracker;     // fed by appendPoint()
+    QCPItemText *m_trackerText;
+    bool m_trackerEnabled;
 
     bool m_focus;
 
+    // everything on_newData() derives from one sample, filled by computePoint()
+    struct PointValues
+    {
+        rawData raw;
+        bool swrValid;
+        double swr;
+        double rl;
+        double r;
+        double x;
+        double z;
+        double rpar;
+        double xpar;
+        double zpar;
+        double phase;
+        double rho;
+        double smithX;
+        double smithY;
+
+        bool calibrated;
+        rawData rawCalib;
+        bool calSwrValid;
+        double calSwr;
+        double calRl;
+        double calR;
+        double calX;
+        double calZ;
+        double calRpar;
+        double calZpar;
+        double calPhase;
+        double calRho;
+        double calSmithX;
+        double calSmithY;
+    };
+
     quint32 computeSWR(double freq, double Z0, double R, double X, double *VSWR, double *RL);
     double computeZ (double R, double X);
 
     void NormRXtoSmithPoint(double Rnorm, double Xnorm, double &x, double &y);    
+    QString hintText(const TracePoint &point);
+    QString frequencyText(double frequency);
     void drawSmithImage(void);
+    CableModel cableModel() const;
     void calcFarEnd(void);
+    void markTabsDirty(int flags);
+    void markTraceDirty(int index);
+    void updateCursorLine(void);
+    // changed limits the rebuild to these measurements, NULL rebuilds all
+    void redrawCurrentTab(const QSet<int> *changed = NULL);
+    bool calibrationPerformed(void);
+    // pure per-point math, safe to run on worker threads
+    void computePoint(const rawData &_rawData, const OslStandards *_standards, PointValues &values);
+    void computeCalibrated(PointValues &values);
+    void computeReflection(double R, double X, double &phase, double &rho,
+                           double &smithX, double &smithY);
+    bool appendPoint(const PointValues &values, double maxSwr, double maxRs, double maxRp);
+    void createStatisticsCurves(void);
+    void updateStatistics(void);
+    void updateStatisticsCurves(void);
+    void createTrackerText(void);
+    void updateTracker(void);
 signals:
     void calibrationChanged();
+    // every complete sweep of a continuous measurement, calibrated if it is
+    void continuousSweep(const QVector<rawData> &data);
+    // after the points of a sweep, see trackerResult()
+    void trackerChanged(const TrackerResult &result);
     void import_finished(double _fqMin_khz, double _fqMax_khz);
+    // Z0, cable and calibration flag of an .asz, before its points are replayed
+    void sessionSettingsLoaded(const SessionSettings &settings);
 
 public slots:
     void on_newDataRedraw(rawData _rawData);
@@ -25,6 +25,8 @@
 
 #include "qcustomplot.h"
 
+#include <QtConcurrent/QtConcurrentRun>
+
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -792,6 +794,8 @@ void QCPLayer::addChild(QCPLayerable *layerable, bool prepend)
       mChildren.prepend(layerable);
     else
       mChildren.append(layerable);
+    if (mParentPlot->mCachedLayer && mIndex <= mParentPlot->mCachedLayer->index())
+      mParentPlot->invalidateLayerCache();
   } else
     qDebug() << Q_FUNC_INFO << "layerable is already child of this layer" << reinterpret_cast<quintptr>(layerable);
 }
@@ -809,6 +813,8 @@ void QCPLayer::removeChild(QCPLayerable *layerable)
 {
   if (!mChildren.removeOne(layerable))
     qDebug() << Q_FUNC_INFO << "layerable is not child of this layer" << reinterpret_cast<quintptr>(layerable);
+  else if (mParentPlot->mCachedLayer && mIndex <= mParentPlot->mCachedLayer->index())
+    mParentPlot->invalidateLayerCache();
 }
 
 
@@ -9140,7 +9146,13 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mCurrentLayer(0),
   mPlottingHints(QCP::phCacheLabels|QCP::phForceRepaint),
   mMultiSelectModifier(Qt::ControlModifier),
+  mCachedLayer(0),
+  mRenderMode(rmDirect),
   mPaintBuffer(size()),
+  mLayerCacheValid(false),
+  mRenderWatcher(new QFutureWatcher<QImage>(this)),
+  mRenderPending(false),
+  mRenderDiscard(false),
   mMouseEventElement(0),
   mReplotting(false)
 {
@@ -9150,6 +9162,7 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   QLocale currentLocale = locale();
   currentLocale.setNumberOptions(QLocale::OmitGroupSeparator);
   setLocale(currentLocale);
+  connect(mRenderWatcher, SIGNAL(finished()), this, SLOT(renderJobFinished()));
   
   // create initial layers:
   mLayers.append(new QCPLayer(this, QLatin1String("background")));
@@ -9194,6 +9207,8 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
 
 QCustomPlot::~QCustomPlot()
 {
+  mRenderWatcher->disconnect(this);
+  mRenderWatcher->waitForFinished();
   clearPlottables();
   clearItems();
 
@@ -9204,6 +9219,7 @@ QCustomPlot::~QCustomPlot()
   }
   
   mCurrentLayer = 0;
+  mCachedLayer = 0;
   qDeleteAll(mLayers); // don't use removeLayer, because it would prevent the last layer to be removed
   mLayers.clear();
 }
@@ -9458,6 +9474,60 @@ void QCustomPlot::setMultiSelectModifier(Qt::KeyboardModifier modifier)
   mMultiSelectModifier = modifier;
 }
 
+/*!
+  Sets \a layer as the top of the cached layer stack. The background and all layers up to and
+  including \a layer are rendered once into an internal pixmap, which \ref replot then reuses
+  and only draws the layers above it. This is meant for static content like band shading or
+  chart grids that is expensive to rasterize but rarely changes.
+  
+  The cache is rebuilt automatically when the viewport, an axis rect or an axis range changes,
+  or when layerables are added to or removed from a cached layer. Changes to the appearance of
+  objects on cached layers (pens, brushes, visibility, positions) are not tracked, call \ref
+  invalidateLayerCache after such changes.
+  
+  Pass 0 to disable the cache.
+  
+  \see invalidateLayerCache
+*/
+void QCustomPlot::setCachedLayer(QCPLayer *layer)
+{
+  if (layer && !mLayers.contains(layer))
+  {
+    qDebug() << Q_FUNC_INFO << "layer not a layer of this QCustomPlot:" << reinterpret_cast<quintptr>(layer);
+    return;
+  }
+  mCachedLayer = layer;
+  invalidateLayerCache();
+}
+
+/*!
+  Sets on which thread \ref replot rasterizes the plottables.
+  
+  With \ref rmThreaded, replot takes a snapshot of all visible graphs and curves above the cached
+  layer (\ref setCachedLayer) that are drawn as plain lines, and rasterizes them into an image on
+  a worker thread. When the worker is done, the image is composed with the remaining layers,
+  which are still drawn on the GUI thread, and the widget is updated. Replots requested while the
+  worker is busy are coalesced into one follow-up frame. Plottables with scatters, fills or error
+  bars as well as all other plottable types are drawn on the GUI thread as usual.
+  
+  The snapshot shares the plottable data containers, so it costs no copy of the points; changing
+  the data afterwards detaches the plottable's container from the snapshot.
+  
+  Replots with \ref rpImmediate and all exports (\ref toPixmap, \ref savePng, \ref toPainter,
+  ...) always draw synchronously.
+*/
+void QCustomPlot::setRenderMode(QCustomPlot::RenderMode mode)
+{
+  if (mRenderMode == mode)
+    return;
+  mRenderMode = mode;
+  mRenderWatcher->waitForFinished();
+  mRenderFrame = QImage();
+  mRenderFramePlottables.clear();
+  mRenderPending = false;
+  mRenderDiscard = false;
+}
+
 /*!
   Sets the viewport of this QCustomPlot. The Viewport is the area that the top level layout
   (QCustomPlot::plotLayout()) uses as its rect. Normally, the viewport is the entire widget rect.
@@ -9643,6 +9713,17 @@ bool QCustomPlot::removePlottable(QCPAbstractPlottable *plottable)
   // special handling for QCPGraphs to maintain the simple graph interface:
   if (QCPGraph *graph = qobject_cast<QCPGraph*>(plottable))
     mGraphs.removeOne(graph);
+  // the frame and the running render job show it, fall back to live drawing until a fresh job is done:
+  if (mRenderFramePlottables.remove(plottable))
+  {
+    mRenderFrame = QImage();
+    mRenderFramePlottables.clear();
+  }
+  if (mRenderJobPlottables.remove(plottable))
+  {
+    mRenderDiscard = true;
+    mRenderPending = true;
+  }
   // remove plottable:
   delete plottable;
   mPlottables.removeOne(plottable);
@@ -10204,6 +10285,7 @@ bool QCustomPlot::addLayer(const QString &name, QCPLayer *otherLayer, QCustomPlo
   QCPLayer *newLayer = new QCPLayer(this, name);
   mLayers.insert(otherLayer->index() + (insertMode==limAbove ? 1:0), newLayer);
   updateLayerIndices();
+  invalidateLayerCache();
   return true;
 }
 
@@ -10251,10 +10333,14 @@ bool QCustomPlot::removeLayer(QCPLayer *layer)
   // if removed layer is current layer, change current layer to layer below/above:
   if (layer == mCurrentLayer)
     setCurrentLayer(targetLayer);
+  // if removed layer is the top cached layer, the cache ends at the layer below:
+  if (layer == mCachedLayer)
+    mCachedLayer = isFirstLayer ? 0 : targetLayer;
   // remove layer:
   delete layer;
   mLayers.removeOne(layer);
   updateLayerIndices();
+  invalidateLayerCache();
   return true;
 }
 
@@ -10282,6 +10368,7 @@ bool QCustomPlot::moveLayer(QCPLayer *layer, QCPLayer *otherLayer, QCustomPlot::
   
   mLayers.move(layer->index(), otherLayer->index() + (insertMode==limAbove ? 1:0));
   updateLayerIndices();
+  invalidateLayerCache();
   return true;
 }
 
@@ -10472,6 +10559,38 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
   mReplotting = true;
   emit beforeReplot();
   
+  if (mRenderMode == rmThreaded && refreshPriority != rpImmediate)
+  {
+    // the buffer is painted by renderJobFinished once the worker has rasterized the plottables:
+    if (mRenderWatcher->isRunning())
+      mRenderPending = true;
+    else
+      startRenderJob();
+  } else
+  {
+    if (mRenderWatcher->isRunning())
+    {
+      // the running job started from older data, replace it by a fresh one:
+      mRenderDiscard = true;
+      mRenderPending = true;
+    }
+    mRenderFrame = QImage();
+    mRenderFramePlottables.clear();
+    paintBuffer(refreshPriority);
+  }
+  
+  emit afterReplot();
+  mReplotting = false;
+}
+
+/*! \internal
+  
+  Draws the plot into the paint buffer and refreshes the widget surface according to \a
+  refreshPriority. Plottables contained in the last frame of the render worker are taken from that
+  frame, see \ref setRenderMode.
+*/
+void QCustomPlot::paintBuffer(QCustomPlot::RefreshPriority refreshPriority)
+{
   mPaintBuffer.fill(mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : Qt::transparent);
   QCPPainter painter;
   painter.begin(&mPaintBuffer);
@@ -10480,7 +10599,10 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
 //    painter.setRenderHint(QPainter::HighQualityAntialiasing); // to make Antialiasing look good if using the OpenGL graphicssystem
     if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush)
       painter.fillRect(mViewport, mBackgroundBrush);
-    draw(&painter);
+    if (mCachedLayer || !mRenderFrame.isNull())
+      drawLive(&painter);
+    else
+      draw(&painter);
     painter.end();
     if ((refreshPriority == rpHint && mPlottingHints.testFlag(QCP::phForceRepaint)) || refreshPriority==rpImmediate)
       repaint();
@@ -10488,9 +10610,288 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
       update();
   } else // might happen if QCustomPlot has width or height zero
     qDebug() << Q_FUNC_INFO << "Couldn't activate painter on buffer. This usually happens because QCustomPlot has width or height zero.";
+}
+
+/*!
+  Marks the pixmap holding the cached layers as outdated, so the next \ref replot renders them
+  again. Only needed after changing the appearance of objects on cached layers.
   
-  emit afterReplot();
-  mReplotting = false;
+  \see setCachedLayer
+*/
+void QCustomPlot::invalidateLayerCache()
+{
+  mLayerCacheValid = false;
+}
+
+/*! \internal
+  
+  Axis state needed to map coordinates to pixels, copied from a QCPAxis so the render worker never
+  touches the axis itself. \ref coordToPixel matches \ref QCPAxis::coordToPixel.
+*/
+struct QCPAxisSnapshot
+{
+  Qt::Orientation orientation;
+  QRect rect;
+  QCPRange range;
+  bool reversed;
+  bool logarithmic;
+  double logBase;
+  
+  void assign(const QCPAxis *axis)
+  {
+    orientation = axis->orientation();
+    rect = axis->axisRect()->rect();
+    range = axis->range();
+    reversed = axis->rangeReversed();
+    logarithmic = axis->scaleType() == QCPAxis::stLogarithmic;
+    logBase = axis->scaleLogBase();
+  }
+  
+  double coordToPixel(double value) const
+  {
+    double fraction;
+    if (!logarithmic)
+      fraction = !reversed ? (value-range.lower)/range.size() : (range.upper-value)/range.size();
+    else if (value >= 0 && range.upper < 0) // invalid value for logarithmic scale, draw it outside visible range
+      fraction = !reversed ? 2 : -1;
+    else if (value <= 0 && range.upper > 0)
+      fraction = !reversed ? -1 : 2;
+    else
+      fraction = !reversed ? qLn(value/range.lower)/qLn(range.upper/range.lower) : qLn(range.upper/value)/qLn(range.upper/range.lower);
+    if (orientation == Qt::Horizontal)
+      return rect.left()+fraction*rect.width();
+    else
+      return rect.bottom()-fraction*rect.height();
+  }
+};
+
+/*! \internal
+  
+  Everything the render worker needs to draw one graph or curve, taken on the GUI thread by \ref
+  QCustomPlot::startRenderJob. Only one of \a graphData and \a curveData is used, depending on \a
+  isCurve.
+*/
+struct QCPPlottableSnapshot
+{
+  QCPAxisSnapshot keyAxis, valueAxis;
+  QRect clipRect;
+  QPen pen;
+  bool antialiased;
+  bool isCurve;
+  QCPDataMap graphData;
+  QCPCurveDataMap curveData;
+  
+  QPointF coordsToPixels(double key, double value) const
+  {
+    if (keyAxis.orientation == Qt::Horizontal)
+      return QPointF(keyAxis.coordToPixel(key), valueAxis.coordToPixel(value));
+    else
+      return QPointF(valueAxis.coordToPixel(value), keyAxis.coordToPixel(key));
+  }
+};
+
+/*! \internal
+  
+  Draws \a line as polyline with \a painter and empties it.
+*/
+static void flushPolyline(QCPPainter *painter, QVector<QPointF> &line)
+{
+  if (line.size() > 1)
+    painter->drawPolyline(line.constData(), line.size());
+  line.resize(0);
+}
+
+/*! \internal
+  
+  Draws the visible part of a graph snapshot as line. Like \ref QCPGraph::getPreparedData, dense
+  data is reduced to the minimum and maximum value per pixel column; without that, lines are
+  broken at NaN values.
+*/
+static void rasterizeGraph(QCPPainter *painter, const QCPPlottableSnapshot &snapshot)
+{
+  const QCPDataMap &data = snapshot.graphData;
+  int begin = qMax(0, data.lowerBoundIndex(snapshot.keyAxis.range.lower)-1);
+  int end = qMin(data.size(), data.upperBoundIndex(snapshot.keyAxis.range.upper)+1);
+  if (end-begin < 2)
+    return;
+  
+  const QCPData *points = data.valueVector().constData();
+  int pixelSpan = qMax(1, snapshot.keyAxis.orientation == Qt::Horizontal ? snapshot.keyAxis.rect.width() : snapshot.keyAxis.rect.height());
+  QVector<QPointF> line;
+  if (end-begin <= 2*pixelSpan)
+  {
+    line.reserve(end-begin);
+    for (int i=begin; i<end; ++i)
+    {
+      if (qIsNaN(points[i].value))
+        flushPolyline(painter, line);
+      else
+        line.append(snapshot.coordsToPixels(points[i].key, points[i].value));
+    }
+  } else
+  {
+    line.reserve(2*pixelSpan+4);
+    int column = int(snapshot.keyAxis.coordToPixel(points[begin].key));
+    double columnKey = points[begin].key;
+    double minValue = std::numeric_limits<double>::max();
+    double maxValue = -std::numeric_limits<double>::max();
+    for (int i=begin; i<=end; ++i)
+    {
+      int pixel = i < end ? int(snapshot.keyAxis.coordToPixel(points[i].key)) : column+1;
+      if (pixel != column)
+      {
+        if (minValue <= maxValue)
+        {
+          line.append(snapshot.coordsToPixels(columnKey, minValue));
+          if (maxValue > minValue)
+            line.append(snapshot.coordsToPixels(columnKey, maxValue));
+        }
+        if (i == end)
+          break;
+        column = pixel;
+        columnKey = points[i].key;
+        minValue = std::numeric_limits<double>::max();
+        maxValue = -std::numeric_limits<double>::max();
+      }
+      if (!qIsNaN(points[i].value))
+      {
+        minValue = qMin(minValue, points[i].value);
+        maxValue = qMax(maxValue, points[i].value);
+      }
+    }
+  }
+  flushPolyline(painter, line);
+}
+
+/*! \internal
+  
+  Draws a curve snapshot as line, broken at NaN coordinates.
+*/
+static void rasterizeCurve(QCPPainter *painter, const QCPPlottableSnapshot &snapshot)
+{
+  QVector<QPointF> line;
+  line.reserve(snapshot.curveData.size());
+  for (QCPCurveDataMap::const_iterator it = snapshot.curveData.constBegin(); it != snapshot.curveData.constEnd(); ++it)
+  {
+    if (qIsNaN(it->key) || qIsNaN(it->value))
+      flushPolyline(painter, line);
+    else
+      line.append(snapshot.coordsToPixels(it->key, it->value));
+  }
+  flushPolyline(painter, line);
+}
+
+/*! \internal
+  
+  Render worker entry point: rasterizes \a snapshots into a transparent image of \a size. Runs on
+  a thread of the global thread pool and only reads the snapshots.
+*/
+static QImage rasterizePlottables(const QVector<QCPPlottableSnapshot> &snapshots, const QSize &size)
+{
+  QImage frame(size, QImage::Format_ARGB32_Premultiplied);
+  frame.fill(Qt::transparent);
+  QCPPainter painter;
+  painter.begin(&frame);
+  if (!painter.isActive())
+    return frame;
+  for (int i=0; i<snapshots.size(); ++i)
+  {
+    const QCPPlottableSnapshot &snapshot = snapshots.at(i);
+    painter.save();
+    painter.setClipRect(snapshot.clipRect.translated(0, -1));
+    painter.setAntialiasing(snapshot.antialiased);
+    painter.setPen(snapshot.pen);
+    painter.setBrush(Qt::NoBrush);
+    if (snapshot.isCurve)
+      rasterizeCurve(&painter, snapshot);
+    else
+      rasterizeGraph(&painter, snapshot);
+    painter.restore();
+  }
+  painter.end();
+  return frame;
+}
+
+/*! \internal
+  
+  Takes snapshots of all plottables the render worker can draw and starts rasterizing them on the
+  global thread pool. \ref renderJobFinished presents the result.
+  
+  \see setRenderMode
+*/
+void QCustomPlot::startRenderJob()
+{
+  // the snapshots take the axis rect geometry, so the layout must be up to date:
+  mPlotLayout->update(QCPLayoutElement::upPreparation);
+  mPlotLayout->update(QCPLayoutElement::upMargins);
+  mPlotLayout->update(QCPLayoutElement::upLayout);
+  
+  int firstLiveLayer = mCachedLayer ? mCachedLayer->index()+1 : 0;
+  QVector<QCPPlottableSnapshot> snapshots;
+  mRenderJobPlottables.clear();
+  foreach (QCPAbstractPlottable *plottable, mPlottables)
+  {
+    if (!plottable->realVisibility() || !plottable->layer() || plottable->layer()->index() < firstLiveLayer)
+      continue;
+    if (!plottable->keyAxis() || !plottable->valueAxis() || plottable->brush().style() != Qt::NoBrush)
+      continue;
+    
+    QCPPlottableSnapshot snapshot;
+    if (QCPGraph *graph = qobject_cast<QCPGraph*>(plottable))
+    {
+      if (graph->lineStyle() != QCPGraph::lsLine || !graph->scatterStyle().isNone() || graph->errorType() != QCPGraph::etNone || graph->channelFillGraph())
+        continue;
+      snapshot.isCurve = false;
+      snapshot.graphData = *graph->data();
+    } else if (QCPCurve *curve = qobject_cast<QCPCurve*>(plottable))
+    {
+      if (curve->lineStyle() != QCPCurve::lsLine || !curve->scatterStyle().isNone())
+        continue;
+      snapshot.isCurve = true;
+      snapshot.curveData = *curve->data();
+    } else
+      continue;
+    
+    snapshot.keyAxis.assign(plottable->keyAxis());
+    snapshot.valueAxis.assign(plottable->valueAxis());
+    snapshot.clipRect = plottable->clipRect();
+    snapshot.pen = plottable->selected() ? plottable->selectedPen() : plottable->pen();
+    if (mNotAntialiasedElements.testFlag(QCP::aePlottables))
+      snapshot.antialiased = false;
+    else if (mAntialiasedElements.testFlag(QCP::aePlottables))
+      snapshot.antialiased = true;
+    else
+      snapshot.antialiased = plottable->antialiased();
+    snapshots.append(snapshot);
+    mRenderJobPlottables.insert(plottable);
+  }
+  
+  mRenderWatcher->setFuture(QtConcurrent::run(rasterizePlottables, snapshots, mPaintBuffer.size()));
+}
+
+/*! \internal
+  
+  Called on the GUI thread when the render worker is done. Starts the next job if replots came in
+  meanwhile, then paints the buffer with the new frame.
+*/
+void QCustomPlot::renderJobFinished()
+{
+  if (mRenderMode != rmThreaded)
+    return;
+  bool discard = mRenderDiscard;
+  mRenderDiscard = false;
+  if (!discard)
+  {
+    mRenderFrame = mRenderWatcher->result();
+    mRenderFramePlottables = mRenderJobPlottables;
+  }
+  if (mRenderPending)
+  {
+    mRenderPending = false;
+    startRenderJob();
+  }
+  if (!discard)
+    paintBuffer(rpQueued);
 }
 
 /*!
@@ -10984,19 +11385,7 @@ void QCustomPlot::draw(QCPPainter *painter)
 
   // draw all layered objects (grid, axes, plottables, items, legend,...):
   foreach (QCPLayer *layer, mLayers)
-  {
-    foreach (QCPLayerable *child, layer->children())
-    {
-      if (child->realVisibility())
-      {
-        painter->save();
-        painter->setClipRect(child->clipRect().translated(0, -1));
-        child->applyDefaultAntialiasingHint(painter);
-        child->draw(painter);
-        painter->restore();
-      }
-    }
-  }
+    drawLayer(painter, layer);
   
   /* Debug code to draw all layout element rects
   foreach (QCPLayoutElement* el, findChildren<QCPLayoutElement*>())
@@ -11010,6 +11399,120 @@ void QCustomPlot::draw(QCPPainter *painter)
   */
 }
 
+/*! \internal
+  
+  Same as \ref draw, but used by \ref replot only, exports always go through \ref draw. The
+  background and the layers up to the cached layer (\ref setCachedLayer) are taken from the layer
+  cache pixmap, and the plottables rasterized by the render worker (\ref setRenderMode) are taken
+  from its last frame, which is drawn in place of the first layer holding one of them.
+*/
+void QCustomPlot::drawLive(QCPPainter *painter)
+{
+  // run through layout phases:
+  mPlotLayout->update(QCPLayoutElement::upPreparation);
+  mPlotLayout->update(QCPLayoutElement::upMargins);
+  mPlotLayout->update(QCPLayoutElement::upLayout);
+  
+  int firstLiveLayer = 0;
+  if (mCachedLayer)
+  {
+    updateLayerCache();
+    painter->drawPixmap(0, 0, mLayerCache);
+    firstLiveLayer = mCachedLayer->index()+1;
+  } else
+    drawBackground(painter);
+  
+  // draw the remaining layers live:
+  bool frameDrawn = mRenderFrame.isNull();
+  for (int i=firstLiveLayer; i<mLayers.size(); ++i)
+  {
+    QCPLayer *layer = mLayers.at(i);
+    if (!frameDrawn)
+    {
+      foreach (QCPLayerable *child, layer->children())
+      {
+        if (mRenderFramePlottables.contains(child))
+        {
+          painter->drawImage(0, 0, mRenderFrame);
+          frameDrawn = true;
+          break;
+        }
+      }
+    }
+    drawLayer(painter, layer, &mRenderFramePlottables);
+  }
+}
+
+/*! \internal
+  
+  Renders the background and the layers up to the cached layer into the layer cache pixmap, if it
+  was invalidated or the key returned by \ref layerCacheKey has changed.
+*/
+void QCustomPlot::updateLayerCache()
+{
+  QVector<double> key = layerCacheKey();
+  if (mLayerCacheValid && mLayerCache.size() == mPaintBuffer.size() && key == mLayerCacheKey)
+    return;
+  
+  mLayerCache = QPixmap(mPaintBuffer.size());
+  mLayerCache.fill(mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : Qt::transparent);
+  QCPPainter cachePainter;
+  cachePainter.begin(&mLayerCache);
+  if (cachePainter.isActive())
+  {
+    if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush)
+      cachePainter.fillRect(mViewport, mBackgroundBrush);
+    drawBackground(&cachePainter);
+    int cachedIndex = mCachedLayer->index();
+    for (int i=0; i<=cachedIndex; ++i)
+      drawLayer(&cachePainter, mLayers.at(i));
+    cachePainter.end();
+  }
+  mLayerCacheKey = key;
+  mLayerCacheValid = true;
+}
+
+/*! \internal
+  
+  Draws all visible layerables of \a layer with the provided \a painter. Layerables contained in
+  \a skip are left out.
+*/
+void QCustomPlot::drawLayer(QCPPainter *painter, QCPLayer *layer, const QSet<QCPLayerable*> *skip)
+{
+  foreach (QCPLayerable *child, layer->children())
+  {
+    if (skip && skip->contains(child))
+      continue;
+    if (child->realVisibility())
+    {
+      painter->save();
+      painter->setClipRect(child->clipRect().translated(0, -1));
+      child->applyDefaultAntialiasingHint(painter);
+      child->draw(painter);
+      painter->restore();
+    }
+  }
+}
+
+/*! \internal
+  
+  Returns the state the cached layers depend on: the viewport, the rects of all axis rects and the
+  ranges and scale types of their axes. The layer cache is rebuilt whenever this key changes.
+*/
+QVector<double> QCustomPlot::layerCacheKey() const
+{
+  QVector<double> key;
+  key << mViewport.x() << mViewport.y() << mViewport.width() << mViewport.height();
+  foreach (QCPAxisRect *rect, axisRects())
+  {
+    QRect r = rect->rect();
+    key << r.x() << r.y() << r.width() << r.height();
+    foreach (QCPAxis *axis, rect->axes())
+      key << axis->range().lower << axis->range().upper << axis->scaleType();
+  }
+  return key;
+}
+
 /*! \internal
   
   Draws the viewport background pixmap of the plot.
@@ -14694,6 +15197,7 @@ void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
+  mData->reserve(n);
   QCPData newData;
   for (int i=0; i<n; ++i)
   {
@@ -15106,9 +15610,7 @@ void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &value
 */
 void QCPGraph::removeDataBefore(double key)
 {
-  QCPDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < key)
-    it = mData->erase(it);
+  mData->erase(mData->begin(), mData->lowerBound(key));
 }
 
 /*!
@@ -15118,9 +15620,7 @@ void QCPGraph::removeDataBefore(double key)
 void QCPGraph::removeDataAfter(double key)
 {
   if (mData->isEmpty()) return;
-  QCPDataMap::iterator it = mData->upperBound(key);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(key), mData->end());
 }
 
 /*!
@@ -15133,10 +15633,7 @@ void QCPGraph::removeDataAfter(double key)
 void QCPGraph::removeData(double fromKey, double toKey)
 {
   if (fromKey >= toKey || mData->isEmpty()) return;
-  QCPDataMap::iterator it = mData->upperBound(fromKey);
-  QCPDataMap::iterator itEnd = mData->upperBound(toKey);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(fromKey), mData->upperBound(toKey));
 }
 
 /*! \overload
@@ -17178,9 +17675,7 @@ void QCPCurve::addData(const QVector<double> &ts, const QVector<double> &keys, c
 */
 void QCPCurve::removeDataBefore(double t)
 {
-  QCPCurveDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < t)
-    it = mData->erase(it);
+  mData->erase(mData->begin(), mData->lowerBound(t));
 }
 
 /*!
@@ -17190,9 +17685,7 @@ void QCPCurve::removeDataBefore(double t)
 void QCPCurve::removeDataAfter(double t)
 {
   if (mData->isEmpty()) return;
-  QCPCurveDataMap::iterator it = mData->upperBound(t);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(t), mData->end());
 }
 
 /*!
@@ -17205,10 +17698,7 @@ void QCPCurve::removeDataAfter(double t)
 void QCPCurve::removeData(double fromt, double tot)
 {
   if (fromt >= tot || mData->isEmpty()) return;
-  QCPCurveDataMap::iterator it = mData->upperBound(fromt);
-  QCPCurveDataMap::iterator itEnd = mData->upperBound(tot);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(fromt), mData->upperBound(tot));
 }
 
 /*! \overload
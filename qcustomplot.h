@@ -33,6 +33,9 @@
 #include <QPaintEvent>
 #include <QMouseEvent>
 #include <QPixmap>
+#include <QImage>
+#include <QSet>
+#include <QFutureWatcher>
 #include <QVector>
 #include <QString>
 #include <QDateTime>
@@ -45,6 +48,7 @@
 #include <QMargins>
 #include <qmath.h>
 #include <limits>
+#include <algorithm>
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #  include <qnumeric.h>
 #  include <QPrinter>
@@ -1719,6 +1723,16 @@ public:
                          ,rpHint     ///< Whether to use immediate repaint or queued update depends on whether the plotting hint \ref QCP::phForceRepaint is set, see \ref setPlottingHints.
                        };
   
+  /*!
+    Defines on which thread \ref replot rasterizes the plottables.
+
+    \see setRenderMode
+  */
+  enum RenderMode { rmDirect    ///< Everything is drawn on the GUI thread inside \ref replot
+                    ,rmThreaded ///< Graphs and curves are rasterized on a worker thread from a snapshot of their data, the frame is presented when it's finished
+                  };
+  Q_ENUMS(RenderMode)
+  
   explicit QCustomPlot(QWidget *parent = 0);
   virtual ~QCustomPlot();
   
@@ -1736,6 +1750,8 @@ public:
   bool noAntialiasingOnDrag() const { return mNoAntialiasingOnDrag; }
   QCP::PlottingHints plottingHints() const { return mPlottingHints; }
   Qt::KeyboardModifier multiSelectModifier() const { return mMultiSelectModifier; }
+  QCPLayer *cachedLayer() const { return mCachedLayer; }
+  RenderMode renderMode() const { return mRenderMode; }
 
   // setters:
   void setViewport(const QRect &rect);
@@ -1756,6 +1772,8 @@ public:
   void setPlottingHints(const QCP::PlottingHints &hints);
   void setPlottingHint(QCP::PlottingHint hint, bool enabled=true);
   void setMultiSelectModifier(Qt::KeyboardModifier modifier);
+  void setCachedLayer(QCPLayer *layer);
+  void setRenderMode(RenderMode mode);
   
   // non-property methods:
   // plottable interface:
@@ -1822,6 +1840,7 @@ public:
   QPixmap toPixmap(int width=0, int height=0, double scale=1.0);
   void toPainter(QCPPainter *painter, int width=0, int height=0);
   Q_SLOT void replot(QCustomPlot::RefreshPriority refreshPriority=QCustomPlot::rpHint);
+  Q_SLOT void invalidateLayerCache();
   
   QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2;
   QCPLegend *legend;
@@ -1869,9 +1888,18 @@ protected:
   QCPLayer *mCurrentLayer;
   QCP::PlottingHints mPlottingHints;
   Qt::KeyboardModifier mMultiSelectModifier;
+  QCPLayer *mCachedLayer;
+  RenderMode mRenderMode;
   
   // non-property members:
   QPixmap mPaintBuffer;
+  QPixmap mLayerCache;
+  QVector<double> mLayerCacheKey;
+  bool mLayerCacheValid;
+  QFutureWatcher<QImage> *mRenderWatcher;
+  QImage mRenderFrame;
+  QSet<QCPLayerable*> mRenderFramePlottables, mRenderJobPlottables;
+  bool mRenderPending, mRenderDiscard;
   QPoint mMousePressPos;
   QPointer<QCPLayoutElement> mMouseEventElement;
   bool mReplotting;
@@ -1889,6 +1917,7 @@ protected:
   
   // introduced virtual methods:
   virtual void draw(QCPPainter *painter);
+  virtual void drawLive(QCPPainter *painter);
   virtual void axisRemoved(QCPAxis *axis);
   virtual void legendRemoved(QCPLegend *legend);
   
@@ -1896,6 +1925,12 @@ protected:
   void updateLayerIndices() const;
   QCPLayerable *layerableAt(const QPointF &pos, bool onlySelectable, QVariant *selectionDetails=0) const;
   void drawBackground(QCPPainter *painter);
+  void drawLayer(QCPPainter *painter, QCPLayer *layer, const QSet<QCPLayerable*> *skip=0);
+  void updateLayerCache();
+  QVector<double> layerCacheKey() const;
+  void paintBuffer(RefreshPriority refreshPriority);
+  void startRenderJob();
+  Q_SLOT void renderJobFinished();
   
   friend class QCPLegend;
   friend class QCPAxis;
@@ -2471,6 +2506,287 @@ private:
 
 
 
+/*! \class QCPDataContainer
+  \brief Sorted container of plottable data points, stored in contiguous arrays
+
+  Keeps the sort keys and the data points in two parallel QVectors ordered by key. It offers the
+  subset of the QMap interface that QCustomPlot and its users rely on (insert, insertMulti,
+  value, lowerBound, upperBound, erase, iterators with key() and value(), ...), so it is a drop-in
+  replacement for the QMap based data maps.
+
+  Appending points with monotonically increasing keys, which is how measured data usually
+  arrives, is amortized O(1). Lookups and range queries are binary searches over the contiguous
+  key array, and iterating the data walks linear memory. Inserting in the middle moves the
+  following points, so data that arrives in random key order should rather be collected and
+  passed in one go. Like QMap, the container is implicitly shared, so copies are cheap until
+  one of them is modified.
+*/
+template <class T>
+class QCPDataContainer
+{
+public:
+  class const_iterator;
+  
+  class iterator
+  {
+  public:
+    iterator() : c(0), i(0) {}
+    iterator(QCPDataContainer *container, int index) : c(container), i(index) {}
+    double key() const { return c->mKeys.at(i); }
+    T &value() const { return c->mValues[i]; }
+    T &operator*() const { return c->mValues[i]; }
+    T *operator->() const { return &c->mValues[i]; }
+    iterator &operator++() { ++i; return *this; }
+    iterator operator++(int) { iterator r = *this; ++i; return r; }
+    iterator &operator--() { --i; return *this; }
+    iterator operator--(int) { iterator r = *this; --i; return r; }
+    iterator &operator+=(int j) { i += j; return *this; }
+    iterator &operator-=(int j) { i -= j; return *this; }
+    iterator operator+(int j) const { return iterator(c, i+j); }
+    iterator operator-(int j) const { return iterator(c, i-j); }
+    int operator-(const iterator &other) const { return i-other.i; }
+    bool operator==(const iterator &other) const { return i == other.i; }
+    bool operator!=(const iterator &other) const { return i != other.i; }
+    bool operator<(const iterator &other) const { return i < other.i; }
+    int index() const { return i; }
+  private:
+    QCPDataContainer *c;
+    int i;
+    friend class const_iterator;
+  };
+  
+  class const_iterator
+  {
+  public:
+    const_iterator() : c(0), i(0) {}
+    const_iterator(const QCPDataContainer *container, int index) : c(container), i(index) {}
+    const_iterator(const iterator &it) : c(it.c), i(it.i) {}
+    double key() const { return c->mKeys.at(i); }
+    const T &value() const { return c->mValues.at(i); }
+    const T &operator*() const { return c->mValues.at(i); }
+    const T *operator->() const { return &c->mValues.at(i); }
+    const_iterator &operator++() { ++i; return *this; }
+    const_iterator operator++(int) { const_iterator r = *this; ++i; return r; }
+    const_iterator &operator--() { --i; return *this; }
+    const_iterator operator--(int) { const_iterator r = *this; --i; return r; }
+    const_iterator &operator+=(int j) { i += j; return *this; }
+    const_iterator &operator-=(int j) { i -= j; return *this; }
+    const_iterator operator+(int j) const { return const_iterator(c, i+j); }
+    const_iterator operator-(int j) const { return const_iterator(c, i-j); }
+    int operator-(const const_iterator &other) const { return i-other.i; }
+    bool operator==(const const_iterator &other) const { return i == other.i; }
+    bool operator!=(const const_iterator &other) const { return i != other.i; }
+    bool operator<(const const_iterator &other) const { return i < other.i; }
+    int index() const { return i; }
+  private:
+    const QCPDataContainer *c;
+    int i;
+  };
+  
+  typedef double key_type;
+  typedef T mapped_type;
+  typedef T value_type;
+  typedef int size_type;
+  
+  // getters:
+  int size() const { return mKeys.size(); }
+  int count() const { return mKeys.size(); }
+  bool isEmpty() const { return mKeys.isEmpty(); }
+  bool empty() const { return mKeys.isEmpty(); }
+  const QVector<double> &keyVector() const { return mKeys; }
+  const QVector<T> &valueVector() const { return mValues; }
+  
+  // iterators:
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, mKeys.size()); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, mKeys.size()); }
+  const_iterator constBegin() const { return const_iterator(this, 0); }
+  const_iterator constEnd() const { return const_iterator(this, mKeys.size()); }
+  const_iterator cbegin() const { return const_iterator(this, 0); }
+  const_iterator cend() const { return const_iterator(this, mKeys.size()); }
+  
+  // element access:
+  T &first() { return mValues.first(); }
+  const T &first() const { return mValues.first(); }
+  T &last() { return mValues.last(); }
+  const T &last() const { return mValues.last(); }
+  double firstKey() const { return mKeys.first(); }
+  double lastKey() const { return mKeys.last(); }
+  const T &at(int index) const { return mValues.at(index); }
+  double keyAt(int index) const { return mKeys.at(index); }
+  
+  // binary search:
+  int lowerBoundIndex(double key) const { return int(std::lower_bound(mKeys.constBegin(), mKeys.constEnd(), key) - mKeys.constBegin()); }
+  int upperBoundIndex(double key) const { return int(std::upper_bound(mKeys.constBegin(), mKeys.constEnd(), key) - mKeys.constBegin()); }
+  iterator lowerBound(double key) { return iterator(this, lowerBoundIndex(key)); }
+  const_iterator lowerBound(double key) const { return const_iterator(this, lowerBoundIndex(key)); }
+  iterator upperBound(double key) { return iterator(this, upperBoundIndex(key)); }
+  const_iterator upperBound(double key) const { return const_iterator(this, upperBoundIndex(key)); }
+  
+  // QMap compatible lookup:
+  bool contains(double key) const { return findIndex(key) >= 0; }
+  iterator find(double key) { int i = findIndex(key); return i < 0 ? end() : iterator(this, i); }
+  const_iterator find(double key) const { int i = findIndex(key); return i < 0 ? constEnd() : const_iterator(this, i); }
+  const_iterator constFind(double key) const { return find(key); }
+  T value(double key, const T &defaultValue = T()) const { int i = findIndex(key); return i < 0 ? defaultValue : mValues.at(i); }
+  QList<double> keys() const { return mKeys.toList(); }
+  QList<T> values() const { return mValues.toList(); }
+  
+  // modification:
+  void reserve(int size) { mKeys.reserve(size); mValues.reserve(size); }
+  void clear() { mKeys.clear(); mValues.clear(); }
+  iterator insert(double key, const T &value);
+  iterator insertMulti(double key, const T &value);
+  void unite(const QCPDataContainer &other);
+  int remove(double key);
+  iterator erase(iterator it);
+  iterator erase(iterator first, iterator last);
+  T &operator[](double key);
+  
+private:
+  QVector<double> mKeys;
+  QVector<T> mValues;
+  
+  int findIndex(double key) const;
+};
+
+/*!
+  Inserts \a value with \a key. If points with \a key already exist, the last of them is replaced
+  (same as QMap::insert). Appending beyond the current last key doesn't search.
+*/
+template <class T>
+typename QCPDataContainer<T>::iterator QCPDataContainer<T>::insert(double key, const T &value)
+{
+  if (mKeys.isEmpty() || key > mKeys.last())
+  {
+    mKeys.append(key);
+    mValues.append(value);
+    return iterator(this, mKeys.size()-1);
+  }
+  int i = upperBoundIndex(key);
+  if (i > 0 && mKeys.at(i-1) == key)
+  {
+    mValues[i-1] = value;
+    return iterator(this, i-1);
+  }
+  mKeys.insert(i, key);
+  mValues.insert(i, value);
+  return iterator(this, i);
+}
+
+/*!
+  Inserts \a value with \a key behind any points with an equal key (same as QMap::insertMulti).
+*/
+template <class T>
+typename QCPDataContainer<T>::iterator QCPDataContainer<T>::insertMulti(double key, const T &value)
+{
+  if (mKeys.isEmpty() || key >= mKeys.last())
+  {
+    mKeys.append(key);
+    mValues.append(value);
+    return iterator(this, mKeys.size()-1);
+  }
+  int i = upperBoundIndex(key);
+  mKeys.insert(i, key);
+  mValues.insert(i, value);
+  return iterator(this, i);
+}
+
+/*!
+  Adds all points of \a other, keeping points with equal keys (same as QMap::unite). If \a other
+  starts behind the last point of this container, its arrays are appended as a block.
+*/
+template <class T>
+void QCPDataContainer<T>::unite(const QCPDataContainer &other)
+{
+  if (other.isEmpty())
+    return;
+  if (isEmpty())
+  {
+    *this = other;
+    return;
+  }
+  if (other.mKeys.first() >= mKeys.last())
+  {
+    mKeys += other.mKeys;
+    mValues += other.mValues;
+    return;
+  }
+  for (int i=0; i<other.size(); ++i)
+    insertMulti(other.mKeys.at(i), other.mValues.at(i));
+}
+
+/*!
+  Removes all points with \a key and returns how many were removed.
+*/
+template <class T>
+int QCPDataContainer<T>::remove(double key)
+{
+  int first = lowerBoundIndex(key);
+  int last = upperBoundIndex(key);
+  if (last > first)
+  {
+    mKeys.remove(first, last-first);
+    mValues.remove(first, last-first);
+  }
+  return last-first;
+}
+
+/*!
+  Removes the point at \a it and returns an iterator to the following point.
+*/
+template <class T>
+typename QCPDataContainer<T>::iterator QCPDataContainer<T>::erase(iterator it)
+{
+  mKeys.remove(it.index());
+  mValues.remove(it.index());
+  return iterator(this, it.index());
+}
+
+/*!
+  Removes the points in the range [\a first, \a last) and returns an iterator to the point
+  following the removed range.
+*/
+template <class T>
+typename QCPDataContainer<T>::iterator QCPDataContainer<T>::erase(iterator first, iterator last)
+{
+  int count = last.index()-first.index();
+  if (count > 0)
+  {
+    mKeys.remove(first.index(), count);
+    mValues.remove(first.index(), count);
+  }
+  return iterator(this, first.index());
+}
+
+/*!
+  Returns a modifiable reference to the point with \a key, inserting a default constructed point
+  if there is none.
+*/
+template <class T>
+T &QCPDataContainer<T>::operator[](double key)
+{
+  int i = findIndex(key);
+  if (i < 0)
+    i = insert(key, T()).index();
+  return mValues[i];
+}
+
+/*! \internal
+  
+  Returns the index of the last point with \a key, or -1 if there is none.
+*/
+template <class T>
+int QCPDataContainer<T>::findIndex(double key) const
+{
+  int i = upperBoundIndex(key);
+  if (i > 0 && mKeys.at(i-1) == key)
+    return i-1;
+  return -1;
+}
+
+
 class QCP_LIB_DECL QCPData
 {
 public:
@@ -2489,9 +2805,7 @@ Q_DECLARE_TYPEINFO(QCPData, Q_MOVABLE_TYPE);
   This is the container in which QCPGraph holds its data.
   \see QCPData, QCPGraph::setData
 */
-typedef QMap<double, QCPData> QCPDataMap;
-typedef QMapIterator<double, QCPData> QCPDataMapIterator;
-typedef QMutableMapIterator<double, QCPData> QCPDataMutableMapIterator;
+typedef QCPDataContainer<QCPData> QCPDataMap;
 
 
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable
@@ -2661,9 +2975,7 @@ Q_DECLARE_TYPEINFO(QCPCurveData, Q_MOVABLE_TYPE);
   \see QCPCurveData, QCPCurve::setData
 */
 
-typedef QMap<double, QCPCurveData> QCPCurveDataMap;
-typedef QMapIterator<double, QCPCurveData> QCPCurveDataMapIterator;
-typedef QMutableMapIterator<double, QCPCurveData> QCPCurveDataMutableMapIterator;
+typedef QCPDataContainer<QCPCurveData> QCPCurveDataMap;
 
 
 class QCP_LIB_DECL QCPCurve : public QCPAbstractPlottable
@@ -0,0 +1,716 @@
+#include "sessionarchive.h"
+#include "crc32.h"
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtEndian>
+#include <stddef.h>
+#include <string.h>
+
+// the layout is part of the file format
+Q_STATIC_ASSERT(sizeof(SessionBlockHeader) == 24);
+
+#define SESSION_FILE_HEADER_SIZE    16
+#define SESSION_TRAILER_SIZE        16
+
+enum MeasurementFlag
+{
+    HasCalibrated = 0x01,
+    FqInHz = 0x02
+};
+
+static void putDouble(uchar *dest, double value)
+{
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian<quint64>(bits, dest);
+}
+
+static double getDouble(const uchar *src)
+{
+    quint64 bits = qFromLittleEndian<quint64>(src);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void putUInt32(QByteArray &out, quint32 value)
+{
+    uchar buf[4];
+    qToLittleEndian<quint32>(value, buf);
+    out.append(reinterpret_cast<const char*>(buf), 4);
+}
+
+static void putInt64(QByteArray &out, qint64 value)
+{
+    uchar buf[8];
+    qToLittleEndian<qint64>(value, buf);
+    out.append(reinterpret_cast<const char*>(buf), 8);
+}
+
+static void putVarint(QByteArray &out, qint64 value)
+{
+    // zigzag, so small negative steps stay short
+    quint64 v = (quint64(value) << 1) ^ quint64(value >> 63);
+    while(v >= 0x80)
+    {
+        out.append(char((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.append(char(v));
+}
+
+static void putString(QByteArray &out, const QString &str)
+{
+    QByteArray utf8 = str.toUtf8();
+    putUInt32(out, utf8.size());
+    out.append(utf8);
+}
+
+// the n-th byte of every value goes to plane n: the sign/exponent bytes of
+// neighbouring points are nearly equal and compress far better than interleaved
+static void putShuffled(QByteArray &out, const QVector<rawData> &data, double rawData::*field)
+{
+    int count = data.size();
+    int start = out.size();
+    out.resize(start + count*int(sizeof(double)));
+    uchar *dest = reinterpret_cast<uchar*>(out.data()) + start;
+    uchar value[8];
+    for(int i = 0; i < count; ++i)
+    {
+        putDouble(value, data.at(i).*field);
+        for(int b = 0; b < 8; ++b)
+        {
+            dest[b*count + i] = value[b];
+        }
+    }
+}
+
+// bounds checked reading of an encoded measurement
+class SessionCursor
+{
+public:
+    SessionCursor(const QByteArray &data) :
+        m_p(reinterpret_cast<const uchar*>(data.constData())),
+        m_end(m_p + data.size()),
+        m_ok(true)
+    {
+    }
+
+    bool ok() const { return m_ok; }
+
+    const uchar *take(qint64 size)
+    {
+        if(!m_ok || (size < 0) || (size > (m_end - m_p)))
+        {
+            m_ok = false;
+            return NULL;
+        }
+        const uchar *p = m_p;
+        m_p += size;
+        return p;
+    }
+
+    quint32 uint32()
+    {
+        const uchar *p = take(4);
+        return (p == NULL) ? 0 : qFromLittleEndian<quint32>(p);
+    }
+
+    qint64 int64()
+    {
+        const uchar *p = take(8);
+        return (p == NULL) ? 0 : qFromLittleEndian<qint64>(p);
+    }
+
+    qint64 varint()
+    {
+        quint64 v = 0;
+        for(int shift = 0; shift < 64; shift += 7)
+        {
+            const uchar *p = take(1);
+            if(p == NULL)
+            {
+                return 0;
+            }
+            v |= quint64(*p & 0x7f) << shift;
+            if((*p & 0x80) == 0)
+            {
+                return qint64(v >> 1) ^ -qint64(v & 1);
+            }
+        }
+        m_ok = false;
+        return 0;
+    }
+
+    QString string()
+    {
+        quint32 size = uint32();
+        const uchar *p = take(size);
+        return (p == NULL) ? QString() : QString::fromUtf8(reinterpret_cast<const char*>(p), size);
+    }
+
+    void shuffled(QVector<rawData> &data, double rawData::*field)
+    {
+        int count = data.size();
+        const uchar *src = take(qint64(count)*int(sizeof(double)));
+        if(src == NULL)
+        {
+            return;
+        }
+        uchar value[8];
+        for(int i = 0; i < count; ++i)
+        {
+            for(int b = 0; b < 8; ++b)
+            {
+                value[b] = src[b*count + i];
+            }
+            data[i].*field = getDouble(value);
+        }
+    }
+
+private:
+    const uchar *m_p;
+    const uchar *m_end;
+    bool m_ok;
+};
+
+static bool fqInHz(const QVector<rawData> &data)
+{
+    foreach (const rawData &point, data)
+    {
+        qint64 hz = qRound64(point.fq*1000000);
+        if((double(hz)/1000000) != point.fq)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+QByteArray SessionArchive::encode(const SessionMeasurement &measurement)
+{
+    const QVector <rawData> &data = measurement.data;
+    bool hasCalibrated = !measurement.calibrated.isEmpty() &&
+                         (measurement.calibrated.size() == data.size());
+    bool hz = fqInHz(data);
+
+    QByteArray out;
+    out.reserve(64 + data.size()*int(sizeof(double))*(hasCalibrated ? 5 : 3));
+    putString(out, measurement.name);
+    putInt64(out, measurement.fq);
+    putInt64(out, measurement.sw);
+    putInt64(out, measurement.dots);
+    putUInt32(out, data.size());
+    putUInt32(out, (hasCalibrated ? HasCalibrated : 0) | (hz ? FqInHz : 0));
+
+    if(hz)
+    {
+        // a linear sweep has a constant step, its second difference is 0 or
+        // a rounding jitter of +-1 Hz and takes a single byte per point
+        qint64 previous = 0;
+        qint64 step = 0;
+        for(int i = 0; i < data.size(); ++i)
+        {
+            qint64 value = qRound64(data.at(i).fq*1000000);
+            qint64 delta = value - previous;
+            putVarint(out, delta - step);
+            step = (i == 0) ? 0 : delta;
+            previous = value;
+        }
+    }else
+    {
+        putShuffled(out, data, &rawData::fq);
+    }
+    putShuffled(out, data, &rawData::r);
+    putShuffled(out, data, &rawData::x);
+    if(hasCalibrated)
+    {
+        putShuffled(out, measurement.calibrated, &rawData::r);
+        putShuffled(out, measurement.calibrated, &rawData::x);
+    }
+    return out;
+}
+
+bool SessionArchive::decode(const QByteArray &data, SessionMeasurement &measurement)
+{
+    SessionCursor cursor(data);
+    measurement.name = cursor.string();
+    measurement.fq = cursor.int64();
+    measurement.sw = cursor.int64();
+    measurement.dots = cursor.int64();
+    quint32 count = cursor.uint32();
+    quint32 flags = cursor.uint32();
+    // every point takes at least 17 bytes, reject a count the payload can't hold
+    if(!cursor.ok() || (qint64(count)*17 > data.size()))
+    {
+        return false;
+    }
+
+    measurement.data.resize(count);
+    measurement.calibrated.clear();
+    if(flags & FqInHz)
+    {
+        qint64 previous = 0;
+        qint64 step = 0;
+        for(quint32 i = 0; i < count; ++i)
+        {
+            qint64 delta = step + cursor.varint();
+            qint64 value = previous + delta;
+            measurement.data[i].fq = double(value)/1000000;
+            step = (i == 0) ? 0 : delta;
+            previous = value;
+        }
+    }else
+    {
+        cursor.shuffled(measurement.data, &rawData::fq);
+    }
+    cursor.shuffled(measurement.data, &rawData::r);
+    cursor.shuffled(measurement.data, &rawData::x);
+    if(flags & HasCalibrated)
+    {
+        measurement.calibrated.resize(count);
+        for(quint32 i = 0; i < count; ++i)
+        {
+            measurement.calibrated[i].fq = measurement.data.at(i).fq;
+        }
+        cursor.shuffled(measurement.calibrated, &rawData::r);
+        cursor.shuffled(measurement.calibrated, &rawData::x);
+    }
+    return cursor.ok();
+}
+
+static QJsonObject settingsToJson(const SessionSettings &settings)
+{
+    QJsonObject cable;
+    cable["mode"] = settings.cable.mode;
+    cable["length"] = settings.cable.length;
+    cable["velocityFactor"] = settings.cable.velocityFactor;
+    cable["resistance"] = settings.cable.resistance;
+    cable["lossConductive"] = settings.cable.lossConductive;
+    cable["lossDielectric"] = settings.cable.lossDielectric;
+    cable["lossUnits"] = settings.cable.lossUnits;
+    cable["lossAtAnyFq"] = settings.cable.lossAtAnyFq;
+
+    QJsonObject obj;
+    obj["Z0"] = settings.Z0;
+    obj["calibrationEnabled"] = settings.calibrationEnabled;
+    obj["cable"] = cable;
+    return obj;
+}
+
+static SessionSettings settingsFromJson(const QJsonObject &obj)
+{
+    SessionSettings settings;
+    settings.Z0 = obj["Z0"].toDouble(settings.Z0);
+    settings.calibrationEnabled = obj["calibrationEnabled"].toBool();
+
+    QJsonObject cable = obj["cable"].toObject();
+    CableModel &model = settings.cable;
+    model.mode = cable["mode"].toInt(model.mode);
+    model.length = cable["length"].toDouble(model.length);
+    model.velocityFactor = cable["velocityFactor"].toDouble(model.velocityFactor);
+    model.resistance = cable["resistance"].toDouble(model.resistance);
+    model.lossConductive = cable["lossConductive"].toDouble(model.lossConductive);
+    model.lossDielectric = cable["lossDielectric"].toDouble(model.lossDielectric);
+    model.lossUnits = cable["lossUnits"].toInt(model.lossUnits);
+    model.lossAtAnyFq = cable["lossAtAnyFq"].toBool(model.lossAtAnyFq);
+    return settings;
+}
+
+SessionWriter::SessionWriter()
+{
+}
+
+SessionWriter::~SessionWriter()
+{
+    if(m_file.isOpen())
+    {
+        close();
+    }
+}
+
+bool SessionWriter::fail(const QString &error)
+{
+    m_error = error;
+    m_file.close();
+    return false;
+}
+
+bool SessionWriter::open(const QString &path)
+{
+    m_index.clear();
+    m_error.clear();
+    m_file.close();
+    m_file.setFileName(path);
+    if(!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        m_error = m_file.errorString();
+        return false;
+    }
+    uchar header[SESSION_FILE_HEADER_SIZE];
+    memcpy(header, SESSION_ARCHIVE_MAGIC, 4);
+    qToLittleEndian<quint32>(SESSION_ARCHIVE_VERSION, header + 4);
+    qToLittleEndian<quint32>(SESSION_FILE_HEADER_SIZE, header + 8);
+    qToLittleEndian<quint32>(0, header + 12);
+    if(m_file.write(reinterpret_cast<const char*>(header), sizeof(header)) != sizeof(header))
+    {
+        return fail(m_file.errorString());
+    }
+    return true;
+}
+
+bool SessionWriter::writeRecord(int type, const QString &name, const QByteArray &data, qint64 *offset)
+{
+    if(!m_file.isOpen())
+    {
+        m_error = tr("The archive is not open.");
+        return false;
+    }
+    qint64 start = m_file.pos();
+    int pos = 0;
+    do
+    {
+        int size = qMin(SESSION_BLOCK_SIZE, data.size() - pos);
+        QByteArray packed = qCompress(reinterpret_cast<const uchar*>(data.constData()) + pos, size, 1);
+        pos += size;
+
+        uchar header[sizeof(SessionBlockHeader)];
+        qToLittleEndian<quint32>(SESSION_BLOCK_MARKER, header + offsetof(SessionBlockHeader, marker));
+        qToLittleEndian<quint32>(type, header + offsetof(SessionBlockHeader, type));
+        qToLittleEndian<quint32>((pos == data.size()) ? SessionArchive::LastBlock : 0,
+                                 header + offsetof(SessionBlockHeader, flags));
+        qToLittleEndian<quint32>(size, header + offsetof(SessionBlockHeader, rawSize));
+        qToLittleEndian<quint32>(packed.size(), header + offsetof(SessionBlockHeader, packedSize));
+        qToLittleEndian<quint32>(CRC32::crc(0xffffffff, packed), header + offsetof(SessionBlockHeader, crc));
+        if((m_file.write(reinterpret_cast<const char*>(header), sizeof(header)) != sizeof(header)) ||
+           (m_file.write(packed) != packed.size()))
+        {
+            return fail(m_file.errorString());
+        }
+    }while(pos < data.size());
+
+    if(type != SessionArchive::RecordIndex)
+    {
+        Entry entry;
+        entry.type = type;
+        entry.offset = start;
+        entry.name = name;
+        m_index.append(entry);
+    }
+    if(offset != NULL)
+    {
+        *offset = start;
+    }
+    return true;
+}
+
+bool SessionWriter::writeSettings(const SessionSettings &settings)
+{
+    return writeRecord(SessionArchive::RecordSettings, QString(),
+                       QJsonDocument(settingsToJson(settings)).toJson(QJsonDocument::Compact));
+}
+
+bool SessionWriter::addCalibrationFile(const QString &path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        m_error = QString("%1: %2").arg(path, file.errorString());
+        return false;
+    }
+    QString name = QFileInfo(path).fileName();
+    QByteArray data;
+    putString(data, name);
+    data.append(file.readAll());
+    return writeRecord(SessionArchive::RecordCalibrationFile, name, data);
+}
+
+bool SessionWriter::addMeasurement(const SessionMeasurement &measurement)
+{
+    return writeRecord(SessionArchive::RecordMeasurement, measurement.name,
+                       SessionArchive::encode(measurement));
+}
+
+bool SessionWriter::close()
+{
+    if(!m_file.isOpen())
+    {
+        return m_error.isEmpty();
+    }
+    QJsonArray records;
+    foreach (const Entry &entry, m_index)
+    {
+        QJsonObject obj;
+        obj["type"] = entry.type;
+        obj["offset"] = double(entry.offset);
+        obj["name"] = entry.name;
+        records.append(obj);
+    }
+    QJsonObject index;
+    index["Records"] = records;
+
+    qint64 offset;
+    if(!writeRecord(SessionArchive::RecordIndex, QString(),
+                    QJsonDocument(index).toJson(QJsonDocument::Compact), &offset))
+    {
+        return false;
+    }
+    uchar trailer[SESSION_TRAILER_SIZE];
+    qToLittleEndian<quint64>(offset, trailer);
+    qToLittleEndian<quint32>(0, trailer + 8);
+    memcpy(trailer + 12, SESSION_ARCHIVE_END_MAGIC, 4);
+    if(m_file.write(reinterpret_cast<const char*>(trailer), sizeof(trailer)) != sizeof(trailer))
+    {
+        return fail(m_file.errorString());
+    }
+    m_file.close();
+    return true;
+}
+
+SessionReader::SessionReader()
+{
+}
+
+bool SessionReader::fail(const QString &error)
+{
+    m_error = error;
+    return false;
+}
+
+void SessionReader::close()
+{
+    m_file.close();
+    m_settings = SessionSettings();
+    m_measurements.clear();
+    m_calibrationFiles.clear();
+}
+
+bool SessionReader::open(const QString &path)
+{
+    close();
+    m_error.clear();
+    m_file.setFileName(path);
+    if(!m_file.open(QIODevice::ReadOnly))
+    {
+        return fail(m_file.errorString());
+    }
+    QByteArray header = m_file.read(SESSION_FILE_HEADER_SIZE);
+    if((header.size() != SESSION_FILE_HEADER_SIZE) || !header.startsWith(SESSION_ARCHIVE_MAGIC))
+    {
+        m_file.close();
+        return fail(tr("Not an AntScope2 session archive."));
+    }
+    if(qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(header.constData()) + 4) > SESSION_ARCHIVE_VERSION)
+    {
+        m_file.close();
+        return fail(tr("The session archive was written by a newer version."));
+    }
+    // an archive that was not closed has no index, its complete records are still readable
+    if(!readIndex() && !scan())
+    {
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+bool SessionReader::readRecord(qint64 offset, int &type, QByteArray &data, qint64 *end)
+{
+    data.clear();
+    type = 0;
+    if(!m_file.seek(offset))
+    {
+        return fail(m_file.errorString());
+    }
+    forever
+    {
+        uchar header[sizeof(SessionBlockHeader)];
+        if(m_file.read(reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header) ||
+           (qFromLittleEndian<quint32>(header + offsetof(SessionBlockHeader, marker)) != SESSION_BLOCK_MARKER))
+        {
+            return fail(tr("The session archive is damaged."));
+        }
+        int blockType = qFromLittleEndian<quint32>(header + offsetof(SessionBlockHeader, type));
+        quint32 flags = qFromLittleEndian<quint32>(header + offsetof(SessionBlockHeader, flags));
+        quint32 rawSize = qFromLittleEndian<quint32>(header + offsetof(SessionBlockHeader, rawSize));
+        quint32 packedSize = qFromLittleEndian<quint32>(header + offsetof(SessionBlockHeader, packedSize));
+        quint32 crc = qFromLittleEndian<quint32>(header + offsetof(SessionBlockHeader, crc));
+        if(((type != 0) && (blockType != type)) || (rawSize > SESSION_BLOCK_SIZE) ||
+           (packedSize > (m_file.size() - m_file.pos())))
+        {
+            return fail(tr("The session archive is damaged."));
+        }
+        type = blockType;
+
+        QByteArray packed = m_file.read(packedSize);
+        if((packed.size() != int(packedSize)) || (CRC32::crc(0xffffffff, packed) != crc))
+        {
+            return fail(tr("The session archive is damaged."));
+        }
+        QByteArray raw = qUncompress(packed);
+        if(raw.size() != int(rawSize))
+        {
+            return fail(tr("The session archive is damaged."));
+        }
+        data.append(raw);
+        if(flags & SessionArchive::LastBlock)
+        {
+            break;
+        }
+    }
+    if(end != NULL)
+    {
+        *end = m_file.pos();
+    }
+    return true;
+}
+
+bool SessionReader::readIndex()
+{
+    qint64 size = m_file.size();
+    if((size < (SESSION_FILE_HEADER_SIZE + SESSION_TRAILER_SIZE)) ||
+       !m_file.seek(size - SESSION_TRAILER_SIZE))
+    {
+        return false;
+    }
+    QByteArray trailer = m_file.read(SESSION_TRAILER_SIZE);
+    if((trailer.size() != SESSION_TRAILER_SIZE) || !trailer.endsWith(SESSION_ARCHIVE_END_MAGIC))
+    {
+        return false;
+    }
+    qint64 offset = qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(trailer.constData()));
+    int type;
+    QByteArray data;
+    if((offset < SESSION_FILE_HEADER_SIZE) || !readRecord(offset, type, data) ||
+       (type != SessionArchive::RecordIndex))
+    {
+        return false;
+    }
+
+    QJsonArray records = QJsonDocument::fromJson(data).object()["Records"].toArray();
+    foreach (const QJsonValue &value, records)
+    {
+        QJsonObject obj = value.toObject();
+        Entry entry;
+        entry.offset = qint64(obj["offset"].toDouble());
+        entry.name = obj["name"].toString();
+        switch(obj["type"].toInt())
+        {
+        case SessionArchive::RecordSettings:
+            if(readRecord(entry.offset, type, data))
+            {
+                m_settings = settingsFromJson(QJsonDocument::fromJson(data).object());
+            }
+            break;
+        case SessionArchive::RecordCalibrationFile:
+            m_calibrationFiles.append(entry);
+            break;
+        case SessionArchive::RecordMeasurement:
+            m_measurements.append(entry);
+            break;
+        }
+    }
+    return true;
+}
+
+bool SessionReader::scan()
+{
+    qint64 pos = SESSION_FILE_HEADER_SIZE;
+    qint64 size = m_file.size();
+    while(pos < size)
+    {
+        int type;
+        QByteArray data;
+        qint64 end;
+        // a torn tail ends the scan, the records before it are kept
+        if(!readRecord(pos, type, data, &end) || (type == SessionArchive::RecordIndex))
+        {
+            break;
+        }
+        Entry entry;
+        entry.offset = pos;
+        switch(type)
+        {
+        case SessionArchive::RecordSettings:
+            m_settings = settingsFromJson(QJsonDocument::fromJson(data).object());
+            break;
+        case SessionArchive::RecordCalibrationFile:
+        case SessionArchive::RecordMeasurement:
+            // both payloads start with the name
+            entry.name = SessionCursor(data).string();
+            ((type == SessionArchive::RecordMeasurement) ? m_measurements : m_calibrationFiles).append(entry);
+            break;
+        }
+        pos = end;
+    }
+    if(m_measurements.isEmpty() && m_calibrationFiles.isEmpty())
+    {
+        return fail(tr("The session archive is empty or damaged."));
+    }
+    m_error.clear();
+    return true;
+}
+
+QString SessionReader::name(int index) const
+{
+    if((index < 0) || (index >= m_measurements.size()))
+    {
+        return QString();
+    }
+    return m_measurements.at(index).name;
+}
+
+bool SessionReader::read(int index, SessionMeasurement &measurement)
+{
+    if((index < 0) || (index >= m_measurements.size()))
+    {
+        return fail(tr("No measurement %1 in the archive.").arg(index));
+    }
+    int type;
+    QByteArray data;
+    if(!readRecord(m_measurements.at(index).offset, type, data))
+    {
+        return false;
+    }
+    if((type != SessionArchive::RecordMeasurement) || !SessionArchive::decode(data, measurement))
+    {
+        return fail(tr("The session archive is damaged."));
+    }
+    return true;
+}
+
+QStringList SessionReader::calibrationFiles() const
+{
+    QStringList names;
+    foreach (const Entry &entry, m_calibrationFiles)
+    {
+        names.append(entry.name);
+    }
+    return names;
+}
+
+bool SessionReader::readCalibrationFile(int index, QByteArray &data)
+{
+    data.clear();
+    if((index < 0) || (index >= m_calibrationFiles.size()))
+    {
+        return fail(tr("No calibration file %1 in the archive.").arg(index));
+    }
+    int type;
+    QByteArray record;
+    if(!readRecord(m_calibrationFiles.at(index).offset, type, record))
+    {
+        return false;
+    }
+    SessionCursor cursor(record);
+    quint32 size = cursor.uint32();
+    if((type != SessionArchive::RecordCalibrationFile) || !cursor.ok() ||
+       (size > quint32(record.size() - 4)))
+    {
+        return fail(tr("The session archive is damaged."));
+    }
+    data = record.mid(4 + size);
+    return true;
+}
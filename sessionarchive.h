@@ -0,0 +1,150 @@
+#ifndef SESSIONARCHIVE_H
+#define SESSIONARCHIVE_H
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <core/rawdata.h>
+#include <core/sweepmath.h>
+
+#define SESSION_ARCHIVE_MAGIC       "ASZ1"
+#define SESSION_ARCHIVE_END_MAGIC   "ASZE"
+#define SESSION_ARCHIVE_VERSION     1
+#define SESSION_BLOCK_MARKER        0x4b4c4253  // "SBLK" little-endian
+#define SESSION_BLOCK_SIZE          (1024*1024) // uncompressed bytes per block
+
+// Layout of a session archive (.asz), all fields little-endian:
+//   16 byte file header: magic, version, header size, flags
+//   blocks, each a SessionBlockHeader and `packedSize` bytes of qCompress()
+//   output. A record (settings, one calibration file, one measurement) is
+//   split into blocks of at most SESSION_BLOCK_SIZE bytes, the last one has
+//   SessionArchive::LastBlock set.
+//   an index record (JSON) with the offset of every record, and a 16 byte
+//   trailer: index offset, reserved, end magic.
+// Readers use the index for random access and fall back to scanning the
+// blocks if the archive was not closed, so it can also be read as a stream.
+struct SessionBlockHeader
+{
+    quint32 marker;
+    quint32 type;
+    quint32 flags;
+    quint32 rawSize;
+    quint32 packedSize;
+    quint32 crc;            // CRC32 of the packed bytes
+};
+
+struct SessionSettings
+{
+    double Z0;
+    bool calibrationEnabled;
+    CableModel cable;
+
+    SessionSettings() : Z0(50), calibrationEnabled(false) {}
+};
+
+struct SessionMeasurement
+{
+    QString name;
+    qint64 fq;              // sweep parameters as in measurement
+    qint64 sw;
+    qint64 dots;
+    QVector <rawData> data;
+    QVector <rawData> calibrated;   // empty or as long as data, on the same frequencies
+
+    SessionMeasurement() : fq(0), sw(0), dots(0) {}
+};
+
+class SessionArchive
+{
+public:
+    enum RecordType
+    {
+        RecordSettings = 1,
+        RecordCalibrationFile = 2,
+        RecordMeasurement = 3,
+        RecordIndex = 4
+    };
+    enum BlockFlag
+    {
+        LastBlock = 0x01
+    };
+
+    // measurement columns: the frequency grid as second differences of
+    // integer Hz when that is exact, r and x as byte planes of the doubles
+    static QByteArray encode(const SessionMeasurement &measurement);
+    static bool decode(const QByteArray &data, SessionMeasurement &measurement);
+};
+
+// Writes an archive front to back, nothing is kept in memory but the index.
+class SessionWriter
+{
+    Q_DECLARE_TR_FUNCTIONS(SessionWriter)
+public:
+    SessionWriter();
+    ~SessionWriter();
+
+    bool open(const QString &path);
+    bool writeSettings(const SessionSettings &settings);
+    bool addCalibrationFile(const QString &path);
+    bool addMeasurement(const SessionMeasurement &measurement);
+    bool close();
+    QString errorString() const { return m_error; }
+
+private:
+    struct Entry
+    {
+        int type;
+        qint64 offset;
+        QString name;
+    };
+
+    QFile m_file;
+    QList <Entry> m_index;
+    QString m_error;
+
+    bool writeRecord(int type, const QString &name, const QByteArray &data, qint64 *offset = NULL);
+    bool fail(const QString &error);
+};
+
+class SessionReader
+{
+    Q_DECLARE_TR_FUNCTIONS(SessionReader)
+public:
+    SessionReader();
+
+    bool open(const QString &path);
+    void close();
+    QString errorString() const { return m_error; }
+
+    SessionSettings settings() const { return m_settings; }
+
+    int count() const { return m_measurements.size(); }
+    QString name(int index) const;
+    bool read(int index, SessionMeasurement &measurement);
+
+    QStringList calibrationFiles() const;
+    bool readCalibrationFile(int index, QByteArray &data);
+
+private:
+    struct Entry
+    {
+        qint64 offset;
+        QString name;
+    };
+
+    QFile m_file;
+    SessionSettings m_settings;
+    QList <Entry> m_measurements;
+    QList <Entry> m_calibrationFiles;
+    QString m_error;
+
+    bool readIndex();
+    bool scan();
+    bool readRecord(qint64 offset, int &type, QByteArray &data, qint64 *end = NULL);
+    bool fail(const QString &error);
+};
+
+#endif // SESSIONARCHIVE_H
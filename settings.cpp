@@ -247,6 +247,8 @@ void Settings::setCalibration(Calibration * calibration)
         ui->labelShortState->setText(m_calibration->getShortFileName());
         ui->labelLoadState->setText(m_calibration->getLoadFileName());
         ui->lineEditPoints->setText(QString::number(m_calibration->dotsNumber()));
+        ui->averagesSpinBox->setValue(m_calibration->averages());
+        ui->bandCalibCheckBox->setChecked(m_calibration->bandCapture());
 
         if(m_calibration->getCalibrationPerformed())
         {
@@ -386,6 +388,7 @@ void Settings::on_percentCalibrationChanged(qint32 state, qint32 percent)
             {
                 ui->openProgressBar->hide();
                 ui->labelOpenState->setText("cal_open.s1p");
+                showDeviation(ui->labelOpenState, state);
                 m_onlyOneCalib = false;
                 enableButtons(true);
             }
@@ -403,6 +406,7 @@ void Settings::on_percentCalibrationChanged(qint32 state, qint32 percent)
             {
                 ui->shortProgressBar->hide();
                 ui->labelShortState->setText("cal_short.s1p");
+                showDeviation(ui->labelShortState, state);
                 m_onlyOneCalib = false;
                 enableButtons(true);
             }
@@ -417,6 +421,7 @@ void Settings::on_percentCalibrationChanged(qint32 state, qint32 percent)
             {
                 ui->loadProgressBar->hide();
                 ui->labelLoadState->setText("cal_load.s1p");
+                showDeviation(ui->labelLoadState, state);
                 m_onlyOneCalib = false;
             }else
             {
@@ -426,6 +431,9 @@ void Settings::on_percentCalibrationChanged(qint32 state, qint32 percent)
                 ui->labelOpenState->setText("cal_open.s1p");
                 ui->labelShortState->setText("cal_short.s1p");
                 ui->labelLoadState->setText("cal_load.s1p");
+                showDeviation(ui->labelOpenState, CALIB_OPEN);
+                showDeviation(ui->labelShortState, CALIB_SHORT);
+                showDeviation(ui->labelLoadState, CALIB_LOAD);
             }
             enableButtons(true);
         }
@@ -901,6 +909,16 @@ void Settings::on_checkBox_AntScopeAutoUpdate_clicked(bool checked)
     emit antScopeAutoUpdateStateChanged(checked);
 }
 
+void Settings::on_sweepJournalCheckBox_clicked(bool checked)
+{
+    emit sweepJournalChanged(checked);
+}
+
+void Settings::on_catalogCheckBox_clicked(bool checked)
+{
+    emit catalogChanged(checked);
+}
+
 void Settings::setFirmwareAutoUpdate(bool checked)
 {
     ui->autoUpdatesCheckBox->setChecked(checked);
@@ -911,6 +929,16 @@ void Settings::setAntScopeAutoUpdate(bool checked)
     ui->checkBox_AntScopeAutoUpdate->setChecked(checked);
 }
 
+void Settings::setSweepJournal(bool checked)
+{
+    ui->sweepJournalCheckBox->setChecked(checked);
+}
+
+void Settings::setCatalog(bool checked)
+{
+    ui->catalogCheckBox->setChecked(checked);
+}
+
 void Settings::setAntScopeVersion(QString version)
 {
     ui->antScopeVersion->setText(version);
@@ -1181,3 +1209,28 @@ void Settings::on_PointsFinished()
     m_calibration->setDotsNumber(str.toInt());
 }
 
+void Settings::on_bandCalibCheckBox_clicked(bool checked)
+{
+    if(m_calibration != NULL)
+    {
+        m_calibration->setBandCapture(checked);
+    }
+}
+
+void Settings::on_averagesSpinBox_valueChanged(int value)
+{
+    if(m_calibration != NULL)
+    {
+        m_calibration->setAverages(value);
+    }
+}
+
+void Settings::showDeviation(QLabel *label, int standard)
+{
+    double deviation = m_calibration->maxDeviation(standard);
+    label->setToolTip((deviation > 0) ?
+                          tr("%1 sweeps, reflection deviates up to %2")
+                          .arg(m_calibration->averages()).arg(deviation, 0, 'g', 3) :
+                          QString());
+}
+
@@ -3,6 +3,7 @@
 
 #include <QDialog>
 #include <QFileDialog>
+#include <QLabel>
 #include <QTimer>
 #include <analyzer/analyzer.h>
 #include <analyzer/analyzerparameters.h>
@@ -60,6 +61,8 @@ public:
 
     void setFirmwareAutoUpdate(bool checked);
     void setAntScopeAutoUpdate(bool checked);
+    void setSweepJournal(bool checked);
+    void setCatalog(bool checked);
     void setAntScopeVersion(QString version);
     void setAutoDetectMode(bool state, QString portName);
 
@@ -100,6 +103,7 @@ private:
     void cableActionEnableButtons(bool enabled);
     void openCablesFile(QString path);
     void initCustomizeTab();
+    void showDeviation(QLabel *label, int standard);
 
 signals:
     void paramsChanged();
@@ -128,6 +132,8 @@ signals:
     void cableActionChanged(int);
     void firmwareAutoUpdateStateChanged(bool);
     void antScopeAutoUpdateStateChanged(bool);
+    void sweepJournalChanged(bool);
+    void catalogChanged(bool);
 
     void changedAutoDetectMode(bool);
     void changedSerialPort(QString);
@@ -166,6 +172,8 @@ private slots:
 
     void on_autoUpdatesCheckBox(bool checked);
     void on_checkBox_AntScopeAutoUpdate_clicked(bool checked);
+    void on_sweepJournalCheckBox_clicked(bool checked);
+    void on_catalogCheckBox_clicked(bool checked);
     void on_autoDetect_clicked(bool checked);
     void on_manualDetect_clicked(bool checked);
     void on_serialPortComboBox_activated(const QString &arg1);
@@ -181,6 +189,8 @@ private slots:
     void on_fqMinFinished();
     void on_fqMaxFinished();
     void on_PointsFinished();
+    void on_averagesSpinBox_valueChanged(int value);
+    void on_bandCalibCheckBox_clicked(bool checked);
 
 };
 
@@ -0,0 +1,425 @@
+#include "sweepcatalog.h"
+#include <QtEndian>
+#include <crc32.h>
+#include <algorithm>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+// the layout is part of the file format
+Q_STATIC_ASSERT(sizeof(CatalogEntryHeader) == 104);
+
+#define CATALOG_HEADER_SIZE     16
+#define DATA_HEADER_SIZE        12
+#define MAX_NAME_SIZE           4096
+
+static void putDouble(uchar *dest, double value)
+{
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian<quint64>(bits, dest);
+}
+
+static double getDouble(const uchar *src)
+{
+    quint64 bits = qFromLittleEndian<quint64>(src);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// over the whole entry with the crc and flags fields zeroed
+static quint32 entryCrc(QByteArray record)
+{
+    memset(record.data() + offsetof(CatalogEntryHeader, flags), 0, sizeof(quint32));
+    memset(record.data() + offsetof(CatalogEntryHeader, crc), 0, sizeof(quint32));
+    return CRC32::crc(0xffffffff, record);
+}
+
+static bool older(const CatalogEntry &a, const CatalogEntry &b)
+{
+    return a.timestamp < b.timestamp;
+}
+
+static bool earlier(const CatalogEntry &entry, qint64 timestamp)
+{
+    return entry.timestamp < timestamp;
+}
+
+static bool later(qint64 timestamp, const CatalogEntry &entry)
+{
+    return timestamp < entry.timestamp;
+}
+
+SweepCatalog::SweepCatalog()
+{
+}
+
+SweepCatalog::~SweepCatalog()
+{
+    close();
+}
+
+QString SweepCatalog::dataPath(const QString &path)
+{
+    return path + ".dat";
+}
+
+bool SweepCatalog::fail(const QString &error)
+{
+    m_error = error;
+    close();
+    return false;
+}
+
+void SweepCatalog::close()
+{
+    m_index.close();
+    m_data.close();
+    m_entries.clear();
+}
+
+bool SweepCatalog::open(const QString &path)
+{
+    close();
+    m_error.clear();
+    m_index.setFileName(path);
+    m_data.setFileName(dataPath(path));
+    if(!m_index.open(QIODevice::ReadWrite))
+    {
+        return fail(m_index.errorString());
+    }
+    if(!m_data.open(QIODevice::ReadWrite))
+    {
+        return fail(m_data.errorString());
+    }
+
+    uchar header[CATALOG_HEADER_SIZE];
+    if(m_index.size() == 0)
+    {
+        memset(header, 0, sizeof(header));
+        memcpy(header, SWEEP_CATALOG_MAGIC, 4);
+        qToLittleEndian<quint32>(SWEEP_CATALOG_VERSION, header + 4);
+        qToLittleEndian<quint32>(CATALOG_HEADER_SIZE, header + 8);
+        if((m_index.write(reinterpret_cast<const char*>(header), sizeof(header)) != sizeof(header)) ||
+           !m_index.flush())
+        {
+            return fail(m_index.errorString());
+        }
+        return true;
+    }
+    if((m_index.read(reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header)) ||
+       (memcmp(header, SWEEP_CATALOG_MAGIC, 4) != 0))
+    {
+        return fail(tr("Not an AntScope2 sweep catalog."));
+    }
+    quint32 version = qFromLittleEndian<quint32>(header + 4);
+    if(version > SWEEP_CATALOG_VERSION)
+    {
+        return fail(tr("Unsupported catalog version %1.").arg(version));
+    }
+    if(qFromLittleEndian<quint32>(header + 8) != CATALOG_HEADER_SIZE)
+    {
+        return fail(tr("Corrupted catalog header."));
+    }
+    return readEntries();
+}
+
+// position of the next entry marker from pos on, the end of the index if none
+qint64 SweepCatalog::nextMarker(qint64 pos)
+{
+    uchar marker[sizeof(quint32)];
+    qToLittleEndian<quint32>(CATALOG_ENTRY_MARKER, marker);
+    m_index.seek(pos);
+    int found = m_index.readAll().indexOf(QByteArray(reinterpret_cast<const char*>(marker),
+                                                     sizeof(marker)));
+    return (found < 0) ? m_index.size() : pos + found;
+}
+
+bool SweepCatalog::readEntries()
+{
+    qint64 dataSize = m_data.size();
+    qint64 indexSize = m_index.size();
+    qint64 pos = CATALOG_HEADER_SIZE;
+    bool torn = false;
+    while(pos < indexSize)
+    {
+        m_index.seek(pos);
+        QByteArray record = m_index.read(sizeof(CatalogEntryHeader));
+        if(record.size() != int(sizeof(CatalogEntryHeader)))
+        {
+            torn = true;
+            break;
+        }
+        const uchar *p = reinterpret_cast<const uchar*>(record.constData());
+        quint32 antennaSize = qFromLittleEndian<quint32>(p + offsetof(CatalogEntryHeader, antennaSize));
+        quint32 nameSize = qFromLittleEndian<quint32>(p + offsetof(CatalogEntryHeader, nameSize));
+        if((qFromLittleEndian<quint32>(p + offsetof(CatalogEntryHeader, marker)) != CATALOG_ENTRY_MARKER) ||
+           (antennaSize > MAX_NAME_SIZE) || (nameSize > MAX_NAME_SIZE))
+        {
+            // the sizes of a damaged header can't be trusted, go on at the next entry
+            pos = nextMarker(pos + 1);
+            continue;
+        }
+        QByteArray names = m_index.read(antennaSize + nameSize);
+        if(names.size() != int(antennaSize + nameSize))
+        {
+            torn = true;
+            break;
+        }
+        record.append(names);
+        p = reinterpret_cast<const uchar*>(record.constData());
+        qint64 next = pos + record.size();
+        if(qFromLittleEndian<quint32>(p + offsetof(CatalogEntryHeader, crc)) != entryCrc(record))
+        {
+            // a damaged entry is skipped, the ones behind it stay
+            pos = next;
+            continue;
+        }
+
+        CatalogEntry entry;
+        entry.entryOffset = pos;
+        entry.dataOffset = qFromLittleEndian<qint64>(p + offsetof(CatalogEntryHeader, dataOffset));
+        pos = next;
+        if((qFromLittleEndian<quint32>(p + offsetof(CatalogEntryHeader, flags)) & Removed) ||
+           (entry.dataOffset >= dataSize))
+        {
+            continue;
+        }
+        entry.timestamp = qFromLittleEndian<qint64>(p + offsetof(CatalogEntryHeader, timestamp));
+        entry.fqFrom = getDouble(p + offsetof(CatalogEntryHeader, fqFrom));
+        entry.fqTo = getDouble(p + offsetof(CatalogEntryHeader, fqTo));
+        entry.Z0 = getDouble(p + offsetof(CatalogEntryHeader, Z0));
+        entry.minSwr = getDouble(p + offsetof(CatalogEntryHeader, minSwr));
+        entry.minSwrFq = getDouble(p + offsetof(CatalogEntryHeader, minSwrFq));
+        entry.resonance = getDouble(p + offsetof(CatalogEntryHeader, resonance));
+        entry.bandLower = getDouble(p + offsetof(CatalogEntryHeader, bandLower));
+        entry.bandUpper = getDouble(p + offsetof(CatalogEntryHeader, bandUpper));
+        entry.points = qFromLittleEndian<quint32>(p + offsetof(CatalogEntryHeader, points));
+        entry.antenna = QString::fromUtf8(names.constData(), antennaSize);
+        entry.name = QString::fromUtf8(names.constData() + antennaSize, nameSize);
+        m_entries.append(entry);
+    }
+    // only an entry torn by a crash at the end is cut off, its points are
+    // dead space in the data file
+    if(torn && !m_index.resize(pos))
+    {
+        return fail(m_index.errorString());
+    }
+    // sweeps are mostly added in time order, only imported ones need sorting
+    std::stable_sort(m_entries.begin(), m_entries.end(), older);
+    return true;
+}
+
+void SweepCatalog::summarize(const QVector<rawData> &data, double Z0, CatalogEntry &entry) const
+{
+    int count = data.size();
+    entry.points = count;
+    entry.fqFrom = (count > 0) ? data.first().fq : 0;
+    entry.fqTo = (count > 0) ? data.last().fq : 0;
+    entry.minSwr = qQNaN();
+    entry.minSwrFq = qQNaN();
+    entry.resonance = qQNaN();
+    entry.bandLower = qQNaN();
+    entry.bandUpper = qQNaN();
+
+    QVector <double> fq(count);
+    QVector <double> swr(count);
+    for(int i = 0; i < count; ++i)
+    {
+        fq[i] = data.at(i).fq;
+        if(!SweepMath::swr(Z0, data.at(i).r, data.at(i).x, &swr[i], NULL))
+        {
+            swr[i] = qQNaN();
+        }
+    }
+    int best = SweepMath::minimumSwr(swr.constData(), count);
+    if(best < 0)
+    {
+        return;
+    }
+    entry.minSwr = swr.at(best);
+    entry.minSwrFq = fq.at(best);
+    double lower;
+    double upper;
+    if(SweepMath::bandwidth(fq.constData(), swr.constData(), count, best,
+                            CATALOG_SWR_LIMIT, lower, upper))
+    {
+        entry.bandLower = lower;
+        entry.bandUpper = upper;
+    }
+    foreach (double resonance, SweepMath::resonances(data.constData(), count))
+    {
+        if(qIsNaN(entry.resonance) ||
+           (fabs(resonance - entry.minSwrFq) < fabs(entry.resonance - entry.minSwrFq)))
+        {
+            entry.resonance = resonance;
+        }
+    }
+}
+
+int SweepCatalog::insert(const CatalogEntry &entry)
+{
+    QVector<CatalogEntry>::iterator it = std::upper_bound(m_entries.begin(), m_entries.end(),
+                                                          entry.timestamp, later);
+    int index = int(it - m_entries.begin());
+    m_entries.insert(index, entry);
+    return index;
+}
+
+int SweepCatalog::add(const SessionMeasurement &measurement, const QString &antenna,
+                      double Z0, qint64 timestamp)
+{
+    if(!isOpen())
+    {
+        m_error = tr("The catalog is not open.");
+        return -1;
+    }
+    CatalogEntry entry;
+    entry.timestamp = timestamp;
+    entry.antenna = antenna.left(MAX_NAME_SIZE/4);
+    entry.name = measurement.name.left(MAX_NAME_SIZE/4);
+    entry.Z0 = Z0;
+    summarize(measurement.data, Z0, entry);
+
+    // the points first, an entry never refers to data that is not on disk
+    QByteArray packed = qCompress(SessionArchive::encode(measurement), 1);
+    uchar dataHeader[DATA_HEADER_SIZE];
+    qToLittleEndian<quint32>(CATALOG_DATA_MARKER, dataHeader);
+    qToLittleEndian<quint32>(packed.size(), dataHeader + 4);
+    qToLittleEndian<quint32>(CRC32::crc(0xffffffff, packed), dataHeader + 8);
+    entry.dataOffset = m_data.size();
+    if(!m_data.seek(entry.dataOffset) ||
+       (m_data.write(reinterpret_cast<const char*>(dataHeader), sizeof(dataHeader)) != sizeof(dataHeader)) ||
+       (m_data.write(packed) != packed.size()) || !m_data.flush())
+    {
+        m_error = m_data.errorString();
+        return -1;
+    }
+
+    QByteArray antennaUtf8 = entry.antenna.toUtf8();
+    QByteArray nameUtf8 = entry.name.toUtf8();
+    QByteArray record(sizeof(CatalogEntryHeader), 0);
+    uchar *p = reinterpret_cast<uchar*>(record.data());
+    qToLittleEndian<quint32>(CATALOG_ENTRY_MARKER, p + offsetof(CatalogEntryHeader, marker));
+    qToLittleEndian<qint64>(entry.timestamp, p + offsetof(CatalogEntryHeader, timestamp));
+    qToLittleEndian<qint64>(entry.dataOffset, p + offsetof(CatalogEntryHeader, dataOffset));
+    putDouble(p + offsetof(CatalogEntryHeader, fqFrom), entry.fqFrom);
+    putDouble(p + offsetof(CatalogEntryHeader, fqTo), entry.fqTo);
+    putDouble(p + offsetof(CatalogEntryHeader, Z0), entry.Z0);
+    putDouble(p + offsetof(CatalogEntryHeader, minSwr), entry.minSwr);
+    putDouble(p + offsetof(CatalogEntryHeader, minSwrFq), entry.minSwrFq);
+    putDouble(p + offsetof(CatalogEntryHeader, resonance), entry.resonance);
+    putDouble(p + offsetof(CatalogEntryHeader, bandLower), entry.bandLower);
+    putDouble(p + offsetof(CatalogEntryHeader, bandUpper), entry.bandUpper);
+    qToLittleEndian<quint32>(entry.points, p + offsetof(CatalogEntryHeader, points));
+    qToLittleEndian<quint32>(antennaUtf8.size(), p + offsetof(CatalogEntryHeader, antennaSize));
+    qToLittleEndian<quint32>(nameUtf8.size(), p + offsetof(CatalogEntryHeader, nameSize));
+    record.append(antennaUtf8);
+    record.append(nameUtf8);
+    qToLittleEndian<quint32>(entryCrc(record), reinterpret_cast<uchar*>(record.data()) + offsetof(CatalogEntryHeader, crc));
+
+    entry.entryOffset = m_index.size();
+    if(!m_index.seek(entry.entryOffset) || (m_index.write(record) != record.size()) || !m_index.flush())
+    {
+        m_error = m_index.errorString();
+        return -1;
+    }
+    return insert(entry);
+}
+
+bool SweepCatalog::remove(int index)
+{
+    if((index < 0) || (index >= m_entries.size()))
+    {
+        m_error = tr("No catalog entry %1.").arg(index);
+        return false;
+    }
+    uchar flags[4];
+    qToLittleEndian<quint32>(Removed, flags);
+    if(!m_index.seek(m_entries.at(index).entryOffset + offsetof(CatalogEntryHeader, flags)) ||
+       (m_index.write(reinterpret_cast<const char*>(flags), sizeof(flags)) != sizeof(flags)) ||
+       !m_index.flush())
+    {
+        m_error = m_index.errorString();
+        return false;
+    }
+    m_entries.remove(index);
+    return true;
+}
+
+QVector<int> SweepCatalog::query(const CatalogQuery &query) const
+{
+    QVector<CatalogEntry>::const_iterator first = m_entries.constBegin();
+    QVector<CatalogEntry>::const_iterator last = m_entries.constEnd();
+    if(query.from > 0)
+    {
+        first = std::lower_bound(first, last, query.from, earlier);
+    }
+    if(query.to > 0)
+    {
+        last = std::upper_bound(first, last, query.to, later);
+    }
+
+    QVector <int> result;
+    for(QVector<CatalogEntry>::const_iterator it = first; it != last; ++it)
+    {
+        if(((query.fqFrom > 0) && (it->fqTo < query.fqFrom)) ||
+           ((query.fqTo > 0) && (it->fqFrom > query.fqTo)))
+        {
+            continue;
+        }
+        if(!query.antenna.isEmpty() && (it->antenna.compare(query.antenna, Qt::CaseInsensitive) != 0))
+        {
+            continue;
+        }
+        result.append(int(it - m_entries.constBegin()));
+    }
+    return result;
+}
+
+QStringList SweepCatalog::antennas() const
+{
+    QStringList list;
+    foreach (const CatalogEntry &entry, m_entries)
+    {
+        if(!entry.antenna.isEmpty() && !list.contains(entry.antenna, Qt::CaseInsensitive))
+        {
+            list.append(entry.antenna);
+        }
+    }
+    list.sort(Qt::CaseInsensitive);
+    return list;
+}
+
+bool SweepCatalog::load(int index, SessionMeasurement &measurement)
+{
+    if((index < 0) || (index >= m_entries.size()))
+    {
+        m_error = tr("No catalog entry %1.").arg(index);
+        return false;
+    }
+    uchar header[DATA_HEADER_SIZE];
+    if(!m_data.seek(m_entries.at(index).dataOffset) ||
+       (m_data.read(reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header)) ||
+       (qFromLittleEndian<quint32>(header) != CATALOG_DATA_MARKER))
+    {
+        m_error = tr("The catalog data is damaged.");
+        return false;
+    }
+    quint32 size = qFromLittleEndian<quint32>(header + 4);
+    if(size > (m_data.size() - m_data.pos()))
+    {
+        m_error = tr("The catalog data is damaged.");
+        return false;
+    }
+    QByteArray packed = m_data.read(size);
+    if((packed.size() != int(size)) ||
+       (CRC32::crc(0xffffffff, packed) != qFromLittleEndian<quint32>(header + 8)) ||
+       !SessionArchive::decode(qUncompress(packed), measurement))
+    {
+        m_error = tr("The catalog data is damaged.");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,122 @@
+#ifndef SWEEPCATALOG_H
+#define SWEEPCATALOG_H
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <sessionarchive.h>
+
+#define SWEEP_CATALOG_MAGIC         "ASC1"
+#define SWEEP_CATALOG_VERSION       1
+#define CATALOG_ENTRY_MARKER        0x54414331  // "1CAT" little-endian
+#define CATALOG_DATA_MARKER         0x54414431  // "1DAT" little-endian
+#define CATALOG_SWR_LIMIT           2.0         // SWR that defines the band of a sweep
+
+// Layout of a catalog (.asc), all fields little-endian:
+//   16 byte file header: magic, version, header size, reserved
+//   entries, each a CatalogEntryHeader followed by the UTF-8 antenna and
+//   sweep names. The CRC32 covers header and names with crc and flags zeroed,
+//   so removing an entry only rewrites its flags.
+// The points live in the companion data file (.asc.dat): one record per sweep,
+// a marker, the packed size, a CRC32 and SessionArchive::encode() packed by
+// qCompress(). It is only read when a sweep is opened.
+struct CatalogEntryHeader
+{
+    quint32 marker;
+    quint32 flags;
+    qint64 timestamp;       // ms since epoch, UTC
+    qint64 dataOffset;
+    double fqFrom;          // MHz
+    double fqTo;
+    double Z0;
+    double minSwr;
+    double minSwrFq;
+    double resonance;
+    double bandLower;
+    double bandUpper;
+    quint32 points;
+    quint32 antennaSize;
+    quint32 nameSize;
+    quint32 crc;
+};
+
+struct CatalogEntry
+{
+    qint64 timestamp;
+    QString antenna;
+    QString name;
+    double fqFrom;          // MHz
+    double fqTo;
+    double Z0;
+    int points;
+    double minSwr;
+    double minSwrFq;
+    double resonance;       // resonance nearest to the SWR minimum, NaN if none
+    double bandLower;       // edges where SWR crosses CATALOG_SWR_LIMIT, NaN if none
+    double bandUpper;
+    qint64 entryOffset;
+    qint64 dataOffset;
+};
+
+struct CatalogQuery
+{
+    qint64 from;            // ms since epoch, 0 for no limit
+    qint64 to;
+    double fqFrom;          // MHz, sweeps overlapping the range; 0 for no limit
+    double fqTo;
+    QString antenna;        // empty for any antenna
+
+    CatalogQuery() : from(0), to(0), fqFrom(0), fqTo(0) {}
+};
+
+// Catalog of archived sweeps. The entries with their summary are kept in
+// memory sorted by time, so a date range is a binary search and band and
+// antenna are filtered on the entries inside it. The points are loaded
+// only by load().
+class SweepCatalog
+{
+    Q_DECLARE_TR_FUNCTIONS(SweepCatalog)
+public:
+    enum EntryFlag
+    {
+        Removed = 0x01
+    };
+
+    SweepCatalog();
+    ~SweepCatalog();
+
+    static QString dataPath(const QString &path);
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return m_index.isOpen(); }
+    QString errorString() const { return m_error; }
+
+    // returns the position of the new entry, -1 on error
+    int add(const SessionMeasurement &measurement, const QString &antenna,
+            double Z0, qint64 timestamp);
+    bool remove(int index);
+
+    int count() const { return m_entries.size(); }
+    const CatalogEntry &entry(int index) const { return m_entries.at(index); }
+    QVector<int> query(const CatalogQuery &query) const;
+    QStringList antennas() const;
+
+    bool load(int index, SessionMeasurement &measurement);
+
+private:
+    QFile m_index;
+    QFile m_data;
+    QVector <CatalogEntry> m_entries;
+    QString m_error;
+
+    bool readEntries();
+    qint64 nextMarker(qint64 pos);
+    void summarize(const QVector<rawData> &data, double Z0, CatalogEntry &entry) const;
+    int insert(const CatalogEntry &entry);
+    bool fail(const QString &error);
+};
+
+#endif // SWEEPCATALOG_H
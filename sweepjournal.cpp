@@ -0,0 +1,532 @@
+#include "sweepjournal.h"
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtEndian>
+#include <crc32.h>
+#include <stddef.h>
+#include <string.h>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// the layout is part of the file format
+Q_STATIC_ASSERT(sizeof(SweepRecordHeader) == 48);
+
+#define JOURNAL_HEADER_SIZE     16
+#define INDEX_HEADER_SIZE       8
+#define INDEX_ENTRY_SIZE        16
+#define POINT_SIZE              (3*sizeof(double))
+
+class SweepJournal::Writer : public QThread
+{
+public:
+    explicit Writer(SweepJournal *journal) : m_journal(journal) {}
+
+protected:
+    void run() { m_journal->writeLoop(); }
+
+private:
+    SweepJournal *m_journal;
+};
+
+static void putDouble(uchar *dest, double value)
+{
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian<quint64>(bits, dest);
+}
+
+static double getDouble(const uchar *src)
+{
+    quint64 bits = qFromLittleEndian<quint64>(src);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static qint64 recordSize(quint32 dots)
+{
+    return sizeof(SweepRecordHeader) + qint64(dots)*POINT_SIZE + sizeof(quint32);
+}
+
+static quint32 recordCrc(const char *record, qint64 size)
+{
+    return CRC32::crc(0xffffffff, QByteArray::fromRawData(record, int(size)));
+}
+
+// pushes the written data to the disk, not only to the OS cache
+static bool syncFile(QFile &file)
+{
+    if(!file.flush())
+    {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return fsync(file.handle()) == 0;
+#endif
+}
+
+SweepJournal::SweepJournal(QObject *parent) :
+    QObject(parent),
+    m_writer(NULL),
+    m_end(0),
+    m_stop(false)
+{
+}
+
+SweepJournal::~SweepJournal()
+{
+    close();
+}
+
+QString SweepJournal::indexPath(const QString &path)
+{
+    return path + ".idx";
+}
+
+bool SweepJournal::open(const QString &path)
+{
+    close();
+    m_log.setFileName(path);
+    if(!m_log.open(QIODevice::ReadWrite))
+    {
+        return fail(m_log.errorString());
+    }
+
+    uchar header[JOURNAL_HEADER_SIZE];
+    if(m_log.size() == 0)
+    {
+        memset(header, 0, sizeof(header));
+        memcpy(header, SWEEP_JOURNAL_MAGIC, 4);
+        qToLittleEndian<quint32>(SWEEP_JOURNAL_VERSION, header + 4);
+        qToLittleEndian<quint32>(JOURNAL_HEADER_SIZE, header + 8);
+        if((m_log.write(reinterpret_cast<const char*>(header), sizeof(header)) != sizeof(header)) ||
+           !syncFile(m_log))
+        {
+            return fail(m_log.errorString());
+        }
+    }else
+    {
+        if((m_log.read(reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header)) ||
+           (memcmp(header, SWEEP_JOURNAL_MAGIC, 4) != 0))
+        {
+            return fail(tr("Not an AntScope2 sweep journal."));
+        }
+        quint32 version = qFromLittleEndian<quint32>(header + 4);
+        if(version > SWEEP_JOURNAL_VERSION)
+        {
+            return fail(tr("Unsupported journal version %1.").arg(version));
+        }
+        if(qFromLittleEndian<quint32>(header + 8) != JOURNAL_HEADER_SIZE)
+        {
+            return fail(tr("Corrupted journal header."));
+        }
+    }
+
+    m_indexFile.setFileName(indexPath(path));
+    if(!m_indexFile.open(QIODevice::ReadWrite))
+    {
+        return fail(m_indexFile.errorString());
+    }
+    if(!recover())
+    {
+        return false;
+    }
+    // unbuffered, so it always sees what the writer thread appended
+    m_reader.setFileName(path);
+    if(!m_reader.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+    {
+        return fail(m_reader.errorString());
+    }
+
+    m_stop = false;
+    m_writer = new Writer(this);
+    m_writer->start(QThread::LowPriority);
+    return true;
+}
+
+void SweepJournal::close()
+{
+    if(m_writer != NULL)
+    {
+        // the queued sweeps are written before the thread ends
+        m_mutex.lock();
+        m_stop = true;
+        m_wake.wakeAll();
+        m_mutex.unlock();
+        m_writer->wait();
+        delete m_writer;
+        m_writer = NULL;
+    }
+    m_log.close();
+    m_indexFile.close();
+    m_reader.close();
+    m_pending.clear();
+    m_index.clear();
+    m_end = 0;
+}
+
+bool SweepJournal::isOpen() const
+{
+    return m_writer != NULL;
+}
+
+QString SweepJournal::fileName() const
+{
+    return m_log.fileName();
+}
+
+QString SweepJournal::errorString() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_error;
+}
+
+void SweepJournal::append(qint64 fqFrom, qint64 fqTo, double Z0, const QVector<rawData> &data)
+{
+    if(!isOpen() || data.isEmpty() || (data.size() > SWEEP_JOURNAL_MAX_DOTS))
+    {
+        return;
+    }
+    SweepRecord record;
+    record.timestamp = QDateTime::currentMSecsSinceEpoch();
+    record.fqFrom = fqFrom;
+    record.fqTo = fqTo;
+    record.Z0 = Z0;
+    record.data = data;     // shared, the copy happens only if the caller changes it
+
+    QMutexLocker locker(&m_mutex);
+    m_pending.append(record);
+    m_wake.wakeOne();
+}
+
+int SweepJournal::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_index.size();
+}
+
+qint64 SweepJournal::timestamp(int index) const
+{
+    QMutexLocker locker(&m_mutex);
+    if((index < 0) || (index >= m_index.size()))
+    {
+        return 0;
+    }
+    return m_index.at(index).timestamp;
+}
+
+int SweepJournal::find(qint64 timestamp) const
+{
+    QMutexLocker locker(&m_mutex);
+    int first = 0;
+    int last = m_index.size();
+    while(first < last)
+    {
+        int middle = first + (last - first)/2;
+        if(m_index.at(middle).timestamp < timestamp)
+        {
+            first = middle + 1;
+        }else
+        {
+            last = middle;
+        }
+    }
+    return first;
+}
+
+bool SweepJournal::read(int index, SweepRecord &record)
+{
+    qint64 offset;
+    {
+        QMutexLocker locker(&m_mutex);
+        if(!m_reader.isOpen() || (index < 0) || (index >= m_index.size()))
+        {
+            return false;
+        }
+        offset = m_index.at(index).offset;
+    }
+
+    QByteArray header(sizeof(SweepRecordHeader), 0);
+    if(!m_reader.seek(offset) || (m_reader.read(header.data(), header.size()) != header.size()))
+    {
+        return false;
+    }
+    const uchar *h = reinterpret_cast<const uchar*>(header.constData());
+    quint32 dots = qFromLittleEndian<quint32>(h + offsetof(SweepRecordHeader, dots));
+    if(dots > SWEEP_JOURNAL_MAX_DOTS)
+    {
+        return false;
+    }
+    qint64 size = recordSize(dots);
+    QByteArray buffer = header;
+    buffer.resize(int(size));
+    qint64 rest = size - header.size();
+    if(m_reader.read(buffer.data() + header.size(), rest) != rest)
+    {
+        return false;
+    }
+    const uchar *p = reinterpret_cast<const uchar*>(buffer.constData());
+    if(recordCrc(buffer.constData(), size - sizeof(quint32)) !=
+       qFromLittleEndian<quint32>(p + size - sizeof(quint32)))
+    {
+        return false;
+    }
+
+    record.timestamp = qFromLittleEndian<qint64>(p + offsetof(SweepRecordHeader, timestamp));
+    record.fqFrom = qFromLittleEndian<qint64>(p + offsetof(SweepRecordHeader, fqFrom));
+    record.fqTo = qFromLittleEndian<qint64>(p + offsetof(SweepRecordHeader, fqTo));
+    record.Z0 = getDouble(p + offsetof(SweepRecordHeader, Z0));
+    record.data.resize(dots);
+    const uchar *point = p + sizeof(SweepRecordHeader);
+    for(quint32 i = 0; i < dots; ++i, point += POINT_SIZE)
+    {
+        rawData &data = record.data[i];
+        data.fq = getDouble(point);
+        data.r = getDouble(point + sizeof(double));
+        data.x = getDouble(point + 2*sizeof(double));
+    }
+    return true;
+}
+
+bool SweepJournal::recover()
+{
+    qint64 size = m_log.size();
+    QVector <IndexEntry> entries = loadIndex(size);
+    bool rewrite = false;
+
+    // the index is written after the log, so only its last entries can be
+    // ahead of the data on disk
+    qint64 end = JOURNAL_HEADER_SIZE;
+    qint64 timestamp;
+    while(!entries.isEmpty())
+    {
+        if(checkRecord(entries.last().offset, size, end, timestamp))
+        {
+            break;
+        }
+        entries.removeLast();
+        end = JOURNAL_HEADER_SIZE;
+        rewrite = true;
+    }
+
+    // records that made it to the log but not to the index
+    qint64 offset = end;
+    while(checkRecord(offset, size, end, timestamp))
+    {
+        IndexEntry entry;
+        entry.offset = offset;
+        entry.timestamp = timestamp;
+        entries.append(entry);
+        offset = end;
+        rewrite = true;
+    }
+
+    if(offset < size)
+    {
+        // torn write of the last sweep before a crash or power loss
+        if(!m_log.resize(offset) || !syncFile(m_log))
+        {
+            return fail(m_log.errorString());
+        }
+    }
+    m_end = offset;
+    if(rewrite || (m_indexFile.size() != INDEX_HEADER_SIZE + entries.size()*INDEX_ENTRY_SIZE))
+    {
+        if(!writeIndex(entries, true))
+        {
+            return fail(m_indexFile.errorString());
+        }
+    }
+    m_index = entries;
+    return true;
+}
+
+bool SweepJournal::checkRecord(qint64 offset, qint64 size, qint64 &end, qint64 &timestamp)
+{
+    if(offset + qint64(sizeof(SweepRecordHeader)) > size)
+    {
+        return false;
+    }
+    uchar header[sizeof(SweepRecordHeader)];
+    if(!m_log.seek(offset) ||
+       (m_log.read(reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header)))
+    {
+        return false;
+    }
+    quint32 dots = qFromLittleEndian<quint32>(header + offsetof(SweepRecordHeader, dots));
+    if((qFromLittleEndian<quint32>(header + offsetof(SweepRecordHeader, marker)) != SWEEP_RECORD_MARKER) ||
+       (dots > SWEEP_JOURNAL_MAX_DOTS) || (offset + recordSize(dots) > size))
+    {
+        return false;
+    }
+    if(!m_log.seek(offset))
+    {
+        return false;
+    }
+    QByteArray record = m_log.read(recordSize(dots));
+    if(record.size() != recordSize(dots))
+    {
+        return false;
+    }
+    qint64 crcOffset = record.size() - sizeof(quint32);
+    if(recordCrc(record.constData(), crcOffset) !=
+       qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(record.constData()) + crcOffset))
+    {
+        return false;
+    }
+    end = offset + record.size();
+    timestamp = qFromLittleEndian<qint64>(header + offsetof(SweepRecordHeader, timestamp));
+    return true;
+}
+
+QVector<SweepJournal::IndexEntry> SweepJournal::loadIndex(qint64 logSize)
+{
+    QVector <IndexEntry> entries;
+    m_indexFile.seek(0);
+    QByteArray data = m_indexFile.readAll();
+    if((data.size() < INDEX_HEADER_SIZE) ||
+       (memcmp(data.constData(), SWEEP_JOURNAL_INDEX_MAGIC, 4) != 0) ||
+       (qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data.constData()) + 4) != SWEEP_JOURNAL_VERSION))
+    {
+        return entries;
+    }
+
+    int count = (data.size() - INDEX_HEADER_SIZE)/INDEX_ENTRY_SIZE;
+    entries.reserve(count);
+    const uchar *p = reinterpret_cast<const uchar*>(data.constData()) + INDEX_HEADER_SIZE;
+    qint64 previous = JOURNAL_HEADER_SIZE - 1;
+    for(int i = 0; i < count; ++i, p += INDEX_ENTRY_SIZE)
+    {
+        IndexEntry entry;
+        entry.offset = qFromLittleEndian<qint64>(p);
+        entry.timestamp = qFromLittleEndian<qint64>(p + 8);
+        // anything out of order is a damaged index, the log scan fills in the rest
+        if((entry.offset <= previous) || (entry.offset >= logSize))
+        {
+            break;
+        }
+        entries.append(entry);
+        previous = entry.offset;
+    }
+    return entries;
+}
+
+bool SweepJournal::writeIndex(const QVector<IndexEntry> &entries, bool truncate)
+{
+    QByteArray data;
+    data.reserve(INDEX_HEADER_SIZE + entries.size()*INDEX_ENTRY_SIZE);
+    if(truncate)
+    {
+        if(!m_indexFile.resize(0))
+        {
+            return false;
+        }
+        data.resize(INDEX_HEADER_SIZE);
+        memcpy(data.data(), SWEEP_JOURNAL_INDEX_MAGIC, 4);
+        qToLittleEndian<quint32>(SWEEP_JOURNAL_VERSION, reinterpret_cast<uchar*>(data.data()) + 4);
+    }
+    int start = data.size();
+    data.resize(start + entries.size()*INDEX_ENTRY_SIZE);
+    uchar *p = reinterpret_cast<uchar*>(data.data()) + start;
+    for(int i = 0; i < entries.size(); ++i, p += INDEX_ENTRY_SIZE)
+    {
+        qToLittleEndian<qint64>(entries.at(i).offset, p);
+        qToLittleEndian<qint64>(entries.at(i).timestamp, p + 8);
+    }
+    if(!m_indexFile.seek(m_indexFile.size()) || (m_indexFile.write(data) != data.size()))
+    {
+        return false;
+    }
+    return m_indexFile.flush();
+}
+
+void SweepJournal::writeLoop()
+{
+    forever
+    {
+        QList <SweepRecord> batch;
+        m_mutex.lock();
+        while(m_pending.isEmpty() && !m_stop)
+        {
+            m_wake.wait(&m_mutex);
+        }
+        if(m_pending.isEmpty())
+        {
+            m_mutex.unlock();
+            return;
+        }
+        batch.swap(m_pending);
+        m_mutex.unlock();
+
+        // every sweep of the batch goes to the disk in a single write and sync
+        qint64 total = 0;
+        for(int i = 0; i < batch.size(); ++i)
+        {
+            total += recordSize(batch.at(i).data.size());
+        }
+        QByteArray buffer(int(total), 0);
+        QVector <IndexEntry> entries(batch.size());
+        uchar *p = reinterpret_cast<uchar*>(buffer.data());
+        for(int i = 0; i < batch.size(); ++i)
+        {
+            const SweepRecord &record = batch.at(i);
+            uchar *start = p;
+            quint32 dots = record.data.size();
+            qToLittleEndian<quint32>(SWEEP_RECORD_MARKER, p + offsetof(SweepRecordHeader, marker));
+            qToLittleEndian<quint32>(dots, p + offsetof(SweepRecordHeader, dots));
+            qToLittleEndian<qint64>(record.timestamp, p + offsetof(SweepRecordHeader, timestamp));
+            qToLittleEndian<qint64>(record.fqFrom, p + offsetof(SweepRecordHeader, fqFrom));
+            qToLittleEndian<qint64>(record.fqTo, p + offsetof(SweepRecordHeader, fqTo));
+            putDouble(p + offsetof(SweepRecordHeader, Z0), record.Z0);
+            p += sizeof(SweepRecordHeader);
+            for(quint32 j = 0; j < dots; ++j, p += POINT_SIZE)
+            {
+                const rawData &point = record.data.at(j);
+                putDouble(p, point.fq);
+                putDouble(p + sizeof(double), point.r);
+                putDouble(p + 2*sizeof(double), point.x);
+            }
+            quint32 crc = recordCrc(reinterpret_cast<const char*>(start), p - start);
+            qToLittleEndian<quint32>(crc, p);
+            p += sizeof(quint32);
+
+            entries[i].offset = m_end + (start - reinterpret_cast<uchar*>(buffer.data()));
+            entries[i].timestamp = record.timestamp;
+        }
+
+        if(!m_log.seek(m_end) || (m_log.write(buffer) != buffer.size()) || !syncFile(m_log))
+        {
+            QString error = m_log.errorString();
+            // leave no partial record behind, the next batch starts at m_end again
+            m_log.resize(m_end);
+            m_mutex.lock();
+            m_error = error;
+            m_mutex.unlock();
+            emit writeFailed(error);
+            continue;
+        }
+        m_end += buffer.size();
+        // a lost index update is repaired by the scan in recover()
+        writeIndex(entries, false);
+
+        m_mutex.lock();
+        m_index += entries;
+        int count = m_index.size();
+        m_mutex.unlock();
+        emit written(count);
+    }
+}
+
+bool SweepJournal::fail(const QString &error)
+{
+    close();
+    QMutexLocker locker(&m_mutex);
+    m_error = error;
+    return false;
+}
@@ -0,0 +1,106 @@
+#ifndef SWEEPJOURNAL_H
+#define SWEEPJOURNAL_H
+
+#include <QObject>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QVector>
+#include <QWaitCondition>
+#include <analyzer/analyzerparameters.h>
+
+#define SWEEP_JOURNAL_MAGIC         "ASJ1"
+#define SWEEP_JOURNAL_INDEX_MAGIC   "ASJI"
+#define SWEEP_JOURNAL_VERSION       1
+#define SWEEP_RECORD_MARKER         0x50575331  // "1SWP" little-endian
+#define SWEEP_JOURNAL_MAX_DOTS      (1024*1024)
+
+// Layout of a journal (.asj), all fields little-endian:
+//   16 byte file header: magic, version, header size, reserved
+//   records, each one SweepRecordHeader, `dots` points of fq (MHz), r, x as
+//   doubles and a CRC32 over header and points.
+// The companion index (.asj.idx) holds the offset and timestamp of every
+// complete record. It is only a cache, a damaged index is rebuilt from the log.
+struct SweepRecordHeader
+{
+    quint32 marker;
+    quint32 dots;
+    qint64 timestamp;       // ms since epoch, UTC
+    qint64 fqFrom;          // Hz
+    qint64 fqTo;
+    double Z0;
+    quint32 flags;
+    quint32 reserved;
+};
+
+struct SweepRecord
+{
+    qint64 timestamp;
+    qint64 fqFrom;
+    qint64 fqTo;
+    double Z0;
+    QVector <rawData> data;
+};
+
+// Append-only log of completed sweeps for unattended continuous runs.
+// append() only queues the sweep, a writer thread encodes it, appends it to
+// the log and syncs the file, so the GUI thread never waits for the disk.
+// open() recovers the journal after a crash: records behind the last indexed
+// one are verified by their CRC and a torn record at the end is cut off.
+class SweepJournal : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SweepJournal(QObject *parent = 0);
+    ~SweepJournal();
+
+    static QString indexPath(const QString &path);
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const;
+    QString fileName() const;
+    QString errorString() const;
+
+    void append(qint64 fqFrom, qint64 fqTo, double Z0, const QVector<rawData> &data);
+
+    // random access to the records already on disk
+    int count() const;
+    qint64 timestamp(int index) const;
+    int find(qint64 timestamp) const;  // first record not older than timestamp
+    bool read(int index, SweepRecord &record);
+
+signals:
+    void written(int count);
+    void writeFailed(QString error);
+
+private:
+    class Writer;
+    struct IndexEntry
+    {
+        qint64 offset;
+        qint64 timestamp;
+    };
+
+    QFile m_log;
+    QFile m_indexFile;
+    QFile m_reader;
+    Writer *m_writer;
+    qint64 m_end;                       // end of the last complete record, writer only
+
+    mutable QMutex m_mutex;             // guards everything below
+    QWaitCondition m_wake;
+    QList <SweepRecord> m_pending;
+    QVector <IndexEntry> m_index;
+    bool m_stop;
+    QString m_error;
+
+    bool recover();
+    bool checkRecord(qint64 offset, qint64 size, qint64 &end, qint64 &timestamp);
+    QVector <IndexEntry> loadIndex(qint64 logSize);
+    bool writeIndex(const QVector<IndexEntry> &entries, bool truncate);
+    void writeLoop();
+    bool fail(const QString &error);
+};
+
+#endif // SWEEPJOURNAL_H
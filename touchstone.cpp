@@ -0,0 +1,462 @@
+#include "touchstone.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QByteArray>
+#include <math.h>
+
+static const double s_pow10[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool isBlank(char c)
+{
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == ',');
+}
+
+static inline bool isDelimiter(char c)
+{
+    return isBlank(c) || (c == '\n') || (c == '!');
+}
+
+static inline bool isDigit(char c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+static bool tokenIs(const char *token, int length, const char *word)
+{
+    return (int(qstrlen(word)) == length) && (qstrnicmp(token, word, length) == 0);
+}
+
+// Locale independent conversion of the number at p, p is moved past it.
+// Up to 15 significant digits and exponents within +-22 are converted with a
+// single exactly rounded multiplication or division, everything else (long
+// mantissas, nan, inf) takes the slow path through QByteArray::toDouble().
+static bool parseNumber(const char *&p, const char *end, double &value)
+{
+    const char *s = p;
+    bool negative = false;
+    if((s < end) && ((*s == '+') || (*s == '-')))
+    {
+        negative = (*s == '-');
+        ++s;
+    }
+    quint64 mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool exact = true;
+    bool any = false;
+    while((s < end) && isDigit(*s))
+    {
+        any = true;
+        if(digits < 19)
+        {
+            mantissa = mantissa*10 + (*s - '0');
+            if(mantissa != 0)
+            {
+                digits++;
+            }
+        }else
+        {
+            exponent++;
+            exact = exact && (*s == '0');
+        }
+        ++s;
+    }
+    if((s < end) && (*s == '.'))
+    {
+        ++s;
+        while((s < end) && isDigit(*s))
+        {
+            any = true;
+            if(digits < 19)
+            {
+                mantissa = mantissa*10 + (*s - '0');
+                if(mantissa != 0)
+                {
+                    digits++;
+                }
+                exponent--;
+            }else
+            {
+                exact = exact && (*s == '0');
+            }
+            ++s;
+        }
+    }
+    if(any && (s < end) && ((*s == 'e') || (*s == 'E')))
+    {
+        const char *e = s + 1;
+        bool negativeExponent = false;
+        if((e < end) && ((*e == '+') || (*e == '-')))
+        {
+            negativeExponent = (*e == '-');
+            ++e;
+        }
+        if((e < end) && isDigit(*e))
+        {
+            int power = 0;
+            while((e < end) && isDigit(*e))
+            {
+                if(power < 10000)
+                {
+                    power = power*10 + (*e - '0');
+                }
+                ++e;
+            }
+            exponent += negativeExponent ? -power : power;
+            s = e;
+        }
+    }
+
+    const char *tokenEnd = s;
+    while((tokenEnd < end) && !isDelimiter(*tokenEnd))
+    {
+        ++tokenEnd;
+    }
+    if(any && exact && (tokenEnd == s) && (mantissa <= (Q_UINT64_C(1) << 53)) &&
+       (exponent >= -22) && (exponent <= 22))
+    {
+        double result = double(mantissa);
+        result = (exponent < 0) ? result/s_pow10[-exponent] : result*s_pow10[exponent];
+        value = negative ? -result : result;
+        p = s;
+        return true;
+    }
+    bool ok = false;
+    value = QByteArray::fromRawData(p, int(tokenEnd - p)).toDouble(&ok);
+    p = tokenEnd;
+    return ok;
+}
+
+TouchstoneReader::TouchstoneReader() :
+    m_version(1),
+    m_ports(1),
+    m_parameter(ParameterS),
+    m_format(FormatMA),
+    m_fqMul(1000.0),
+    m_Z0(50),
+    m_fullMatrix(true),
+    m_line(0)
+{
+}
+
+int TouchstoneReader::portsFromFileName(const QString &path)
+{
+    QString suffix = QFileInfo(path).suffix().toLower();
+    if((suffix.length() < 3) || !suffix.startsWith('s') || !suffix.endsWith('p'))
+    {
+        return 0;
+    }
+    bool ok = false;
+    int ports = suffix.mid(1, suffix.length()-2).toInt(&ok);
+    return (ok && (ports > 0)) ? ports : 0;
+}
+
+bool TouchstoneReader::read(const QString &path, QVector <rawData> &data)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return fail(file.errorString());
+    }
+    int ports = qMax(1, portsFromFileName(path));
+    qint64 size = file.size();
+    uchar *map = (size > 0) ? file.map(0, size) : NULL;
+    if(map != NULL)
+    {
+        // the pages are read in by the system as the scan goes along
+        const char *begin = reinterpret_cast<const char*>(map);
+        bool result = parse(begin, begin + size, data, ports);
+        file.unmap(map);
+        return result;
+    }
+    // not mappable (pipes, some network file systems), read it at once
+    QByteArray buffer = file.readAll();
+    return parse(buffer.constData(), buffer.constData() + buffer.size(), data, ports);
+}
+
+bool TouchstoneReader::parse(const char *begin, const char *end, QVector <rawData> &data, int ports)
+{
+    m_version = 1;
+    m_ports = qMax(1, ports);
+    m_parameter = ParameterS;
+    m_format = FormatMA;
+    m_fqMul = 1000.0; // GHz
+    m_Z0 = 50;
+    m_fullMatrix = true;
+    m_line = 1;
+    m_error.clear();
+
+    int referenceLeft = 0;      // [Reference] values still to come
+    bool inInformation = false;
+    bool finished = false;
+    int recordValues = 0;       // numbers per record, known when the data starts
+    int valueIndex = 0;
+    double record[3] = {0, 0, 0};
+    double lastFq = -1;
+
+    const char *p = begin;
+    while((p < end) && !finished)
+    {
+        char c = *p;
+        if(isBlank(c))
+        {
+            ++p;
+            continue;
+        }
+        if(c == '\n')
+        {
+            ++m_line;
+            ++p;
+            continue;
+        }
+        if((c == '!') || (inInformation && (c != '[')))
+        {
+            while((p < end) && (*p != '\n'))
+            {
+                ++p;
+            }
+            continue;
+        }
+        if(c == '#')
+        {
+            ++p;
+            if(!parseOptions(p, end))
+            {
+                return false;
+            }
+            continue;
+        }
+        if(c == '[')
+        {
+            if(!parseKeyword(p, end, data, referenceLeft, inInformation, finished))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        double value;
+        if(!parseNumber(p, end, value))
+        {
+            return fail(tr("Invalid number in line %1.").arg(m_line));
+        }
+        if(referenceLeft > 0)
+        {
+            if(referenceLeft == m_ports)
+            {
+                if(value <= 0)
+                {
+                    return fail(tr("Invalid reference impedance in line %1.").arg(m_line));
+                }
+                m_Z0 = value;
+            }
+            referenceLeft--;
+            continue;
+        }
+        if(recordValues == 0)
+        {
+            int matrix = m_fullMatrix ? m_ports*m_ports : m_ports*(m_ports+1)/2;
+            recordValues = 1 + 2*matrix;
+        }
+        if(valueIndex == 0)
+        {
+            // 1.x two-port files append the noise parameters, they restart the frequency
+            if((m_version == 1) && (m_ports == 2) && (value <= lastFq))
+            {
+                break;
+            }
+            lastFq = value;
+        }
+        if(valueIndex < 3)
+        {
+            record[valueIndex] = value;
+        }
+        if(++valueIndex == recordValues)
+        {
+            appendPoint(record[0], record[1], record[2], data);
+            valueIndex = 0;
+        }
+    }
+    if(valueIndex != 0)
+    {
+        return fail(tr("Incomplete data record in line %1.").arg(m_line));
+    }
+    return true;
+}
+
+bool TouchstoneReader::parseOptions(const char *&p, const char *end)
+{
+    while(p < end)
+    {
+        while((p < end) && isBlank(*p))
+        {
+            ++p;
+        }
+        if((p >= end) || (*p == '\n') || (*p == '!'))
+        {
+            break;
+        }
+        const char *token = p;
+        while((p < end) && !isDelimiter(*p))
+        {
+            ++p;
+        }
+        int length = int(p - token);
+
+        if(tokenIs(token, length, "GHz"))
+            m_fqMul = 1000.0;
+        else if(tokenIs(token, length, "MHz"))
+            m_fqMul = 1.0;
+        else if(tokenIs(token, length, "kHz"))
+            m_fqMul = 0.001;
+        else if(tokenIs(token, length, "Hz"))
+            m_fqMul = 0.000001;
+        else if(tokenIs(token, length, "S"))
+            m_parameter = ParameterS;
+        else if(tokenIs(token, length, "Y"))
+            m_parameter = ParameterY;
+        else if(tokenIs(token, length, "Z"))
+            m_parameter = ParameterZ;
+        else if(tokenIs(token, length, "MA"))
+            m_format = FormatMA;
+        else if(tokenIs(token, length, "RI"))
+            m_format = FormatRI;
+        else if(tokenIs(token, length, "DB"))
+            m_format = FormatDB;
+        else if(tokenIs(token, length, "R"))
+        {
+            while((p < end) && isBlank(*p))
+            {
+                ++p;
+            }
+            double Z0 = 0;
+            if((p >= end) || (*p == '\n') || !parseNumber(p, end, Z0) ||
+               (Z0 <= 0) || (Z0 > 10000))
+            {
+                return fail(tr("Invalid reference impedance in line %1.").arg(m_line));
+            }
+            m_Z0 = Z0;
+        }
+        else
+        {
+            // H and G parameters don't describe the port 1 reflection
+            return fail(tr("Unsupported option '%1' in line %2.")
+                        .arg(QString::fromLatin1(token, length)).arg(m_line));
+        }
+    }
+    return true;
+}
+
+bool TouchstoneReader::parseKeyword(const char *&p, const char *end, QVector <rawData> &data,
+                                    int &referenceLeft, bool &inInformation, bool &finished)
+{
+    const char *name = ++p;
+    while((p < end) && (*p != ']') && (*p != '\n'))
+    {
+        ++p;
+    }
+    if((p >= end) || (*p != ']'))
+    {
+        return fail(tr("Unterminated keyword in line %1.").arg(m_line));
+    }
+    QByteArray keyword = QByteArray(name, int(p - name)).trimmed().toLower();
+    ++p;
+    if(keyword == "reference")
+    {
+        // one value per port, they may continue on the following lines
+        referenceLeft = m_ports;
+        return true;
+    }
+    const char *first = p;
+    while((p < end) && (*p != '\n') && (*p != '!'))
+    {
+        ++p;
+    }
+    QByteArray argument = QByteArray(first, int(p - first)).trimmed().toLower();
+
+    if(keyword == "version")
+    {
+        m_version = argument.startsWith('1') ? 1 : 2;
+    }else if(keyword == "number of ports")
+    {
+        bool ok = false;
+        int ports = argument.toInt(&ok);
+        if(!ok || (ports < 1))
+        {
+            return fail(tr("Invalid number of ports in line %1.").arg(m_line));
+        }
+        m_ports = ports;
+    }else if(keyword == "number of frequencies")
+    {
+        int count = argument.toInt();
+        if(count > 0)
+        {
+            data.reserve(data.size() + count);
+        }
+    }else if(keyword == "matrix format")
+    {
+        m_fullMatrix = (argument == "full");
+    }else if(keyword == "begin information")
+    {
+        inInformation = true;
+    }else if(keyword == "end information")
+    {
+        inInformation = false;
+    }else if((keyword == "noise data") || (keyword == "end"))
+    {
+        finished = true;
+    }
+    return true;
+}
+
+void TouchstoneReader::appendPoint(double fq, double a, double b, QVector <rawData> &data) const
+{
+    double re = a;
+    double im = b;
+    if(m_format != FormatRI)
+    {
+        double magnitude = (m_format == FormatDB) ? pow(10.0, a/20.0) : a;
+        re = magnitude * cos(b/180.0*M_PI);
+        im = magnitude * sin(b/180.0*M_PI);
+    }
+
+    double r = re;
+    double x = im;
+    if(m_parameter == ParameterS)
+    {
+        double denominator = (1-re)*(1-re) + im*im;
+        r = (1-re*re-im*im)/denominator;
+        x = (2*im)/denominator;
+    }else if(m_parameter == ParameterY)
+    {
+        double denominator = re*re + im*im;
+        r = re/denominator;
+        x = -im/denominator;
+    }
+    if(qIsNaN(r) || (r < 0))
+    {
+        r = 0;
+    }
+    if(qIsNaN(x))
+    {
+        x = 0;
+    }
+
+    // 1.x normalizes Z and Y to the reference, 2.0 stores them in Ohm and Siemens
+    double scale = ((m_parameter == ParameterS) || (m_version == 1)) ? m_Z0 : 1;
+    rawData point;
+    point.fq = fq*m_fqMul;
+    point.r = r*scale;
+    point.x = x*scale;
+    data.append(point);
+}
+
+bool TouchstoneReader::fail(const QString &error)
+{
+    m_error = error;
+    return false;
+}
@@ -0,0 +1,64 @@
+#ifndef TOUCHSTONE_H
+#define TOUCHSTONE_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QVector>
+#include <core/rawdata.h>
+
+// Single pass reader for Touchstone 1.x and 2.0 network data (.s1p, .s2p, ...).
+// The file is memory mapped and scanned in place, numbers are converted with
+// a locale independent parser. Only the port 1 reflection is kept: every
+// record becomes one rawData with fq in MHz and r, x in Ohm, whatever the
+// units, parameter (S, Y, Z) and format (MA, RI, DB) of the file are.
+class TouchstoneReader
+{
+    Q_DECLARE_TR_FUNCTIONS(TouchstoneReader)
+public:
+    enum Parameter
+    {
+        ParameterS,
+        ParameterY,
+        ParameterZ
+    };
+    enum Format
+    {
+        FormatMA,
+        FormatRI,
+        FormatDB
+    };
+
+    TouchstoneReader();
+
+    // number of ports encoded in a .sNp file name, 0 if it is no Touchstone name
+    static int portsFromFileName(const QString &path);
+
+    bool read(const QString &path, QVector <rawData> &data);
+    bool parse(const char *begin, const char *end, QVector <rawData> &data, int ports = 1);
+    QString errorString() const { return m_error; }
+
+    int version() const { return m_version; }
+    int ports() const { return m_ports; }
+    Parameter parameter() const { return m_parameter; }
+    Format format() const { return m_format; }
+    double Z0() const { return m_Z0; }      // reference impedance of port 1
+
+private:
+    int m_version;
+    int m_ports;
+    Parameter m_parameter;
+    Format m_format;
+    double m_fqMul;
+    double m_Z0;
+    bool m_fullMatrix;      // n*n values per record, else n*(n+1)/2
+    int m_line;
+    QString m_error;
+
+    bool parseOptions(const char *&p, const char *end);
+    bool parseKeyword(const char *&p, const char *end, QVector <rawData> &data,
+                      int &referenceLeft, bool &inInformation, bool &finished);
+    void appendPoint(double fq, double a, double b, QVector <rawData> &data) const;
+    bool fail(const QString &error);
+};
+
+#endif // TOUCHSTONE_H
@@ -0,0 +1,197 @@
+#include "tracelookup.h"
+#include <algorithm>
+#include <math.h>
+
+static bool fqLess(double _fq, const rawData &data)
+{
+    return _fq < data.fq*1000;
+}
+
+static double lerp(double t, double v1, double v2)
+{
+    return v1 + t*(v2-v1);
+}
+
+TraceLookup::TraceLookup() :
+    m_data(NULL),
+    m_impedanceData(NULL),
+    m_Z0(50)
+{
+}
+
+TraceLookup::TraceLookup(const QVector<rawData> *data, double Z0,
+                         const QVector<rawData> *impedanceData) :
+    m_data(data),
+    m_impedanceData(impedanceData),
+    m_Z0(Z0)
+{
+    if((m_impedanceData == NULL) || (m_data == NULL) ||
+       (m_impedanceData->size() != m_data->size()))
+    {
+        m_impedanceData = m_data;
+    }
+}
+
+bool TraceLookup::isEmpty() const
+{
+    return (m_data == NULL) || m_data->isEmpty();
+}
+
+int TraceLookup::size() const
+{
+    return (m_data == NULL) ? 0 : m_data->size();
+}
+
+int TraceLookup::lowerIndex(double _fq) const
+{
+    int count = size();
+    if(count < 2)
+    {
+        return -1;
+    }
+    const rawData *begin = m_data->constData();
+    const rawData *end = begin + count;
+    if((_fq < begin->fq*1000) || (_fq > (end-1)->fq*1000))
+    {
+        return -1;
+    }
+    const rawData *it = std::upper_bound(begin, end, _fq, fqLess);
+    int i = int(it - begin) - 1;
+    if(i >= count-1)
+    {
+        i = count-2;
+    }
+    return i;
+}
+
+int TraceLookup::nearestIndex(double _fq) const
+{
+    int i = lowerIndex(_fq);
+    if(i < 0)
+    {
+        return -1;
+    }
+    double fq1 = m_data->at(i).fq*1000;
+    double fq2 = m_data->at(i+1).fq*1000;
+    return (_fq > (fq1 + fq2)/2) ? i+1 : i;
+}
+
+bool TraceLookup::at(int index, TracePoint &point) const
+{
+    if((index < 0) || (index >= size()))
+    {
+        return false;
+    }
+    computePoint(m_data->at(index), m_impedanceData->at(index), m_Z0, point);
+    return true;
+}
+
+bool TraceLookup::nearest(double _fq, TracePoint &point, int *index) const
+{
+    int i = nearestIndex(_fq);
+    if(index)
+    {
+        *index = i;
+    }
+    return at(i, point);
+}
+
+bool TraceLookup::interpolate(double _fq, TracePoint &point, double _maxSwr) const
+{
+    int i = lowerIndex(_fq);
+    if(i < 0)
+    {
+        return false;
+    }
+    TracePoint p1;
+    TracePoint p2;
+    at(i, p1);
+    at(i+1, p2);
+    p1.swr = qMin(p1.swr, _maxSwr);
+    p2.swr = qMin(p2.swr, _maxSwr);
+
+    double t = (p2.fq == p1.fq) ? 0 : (_fq - p1.fq)/(p2.fq - p1.fq);
+    point.fq = _fq;
+    point.swr = lerp(t, p1.swr, p2.swr);
+    point.rl = lerp(t, p1.rl, p2.rl);
+    point.r = lerp(t, p1.r, p2.r);
+    point.x = lerp(t, p1.x, p2.x);
+    point.z = lerp(t, p1.z, p2.z);
+    point.rpar = lerp(t, p1.rpar, p2.rpar);
+    point.xpar = lerp(t, p1.xpar, p2.xpar);
+    point.zpar = lerp(t, p1.zpar, p2.zpar);
+    point.phase = lerp(t, p1.phase, p2.phase);
+    point.rho = lerp(t, p1.rho, p2.rho);
+    return true;
+}
+
+void TraceLookup::computePoint(const rawData &swrData, const rawData &impData,
+                               double Z0, TracePoint &point)
+{
+    point.fq = swrData.fq*1000;
+//------------------SWR, RL-----------------------------------------------------
+    double R = swrData.r;
+    double X = swrData.x;
+    if (R <= 0)
+    {
+        R = 0.001;
+    }
+    double XX = X * X;
+    double denominator = (R + Z0) * (R + Z0) + XX;
+    double gamma = (denominator == 0) ? 1 : sqrt(((R - Z0) * (R - Z0) + XX) / denominator);
+    double swr = (gamma >= 0.99) ? 200 : (1 + gamma) / (1 - gamma);
+    if (swr > 200)
+    {
+        swr = 200;
+    } else if (swr < 1)
+    {
+        swr = 1;
+    }
+    point.swr = swr;
+    point.rl = (gamma > 0) ? -20 * log10(gamma) : 200;
+//------------------RXZ---------------------------------------------------------
+    R = impData.r;
+    X = impData.x;
+    point.r = R;
+    point.x = X;
+    point.z = sqrt(R*R + X*X);
+
+    if (qIsNaN(R) || (R<0.001) )
+    {
+        R = 0.01;
+    }
+    if (qIsNaN(X))
+    {
+        X = 0;
+    }
+    point.rpar = R*(1+X*X/R/R);
+    point.xpar = X*(1+R*R/X/X);
+    point.zpar = sqrt(R*R + X*X);
+//------------------phase, rho--------------------------------------------------
+    double Rnorm = R/Z0;
+    double Xnorm = X/Z0;
+    double Denom = (Rnorm+1)*(Rnorm+1)+Xnorm*Xnorm;
+    double RhoReal = ((Rnorm-1)*(Rnorm+1)+Xnorm*Xnorm)/Denom;
+    double RhoImag = 2*Xnorm/Denom;
+    point.phase = atan2(RhoImag, RhoReal) / M_PI * 180.0;
+    point.rho = sqrt(RhoReal*RhoReal+RhoImag*RhoImag);
+}
+
+QCPDataMap::const_iterator TraceLookup::nearestKey(const QCPDataMap &map, double key)
+{
+    if(map.isEmpty())
+    {
+        return map.constEnd();
+    }
+    QCPDataMap::const_iterator upper = map.lowerBound(key);
+    if(upper == map.constBegin())
+    {
+        return upper;
+    }
+    QCPDataMap::const_iterator lower = upper - 1;
+    if(upper == map.constEnd())
+    {
+        return lower;
+    }
+    return ((key - lower.key()) > (upper.key() - key)) ? upper : lower;
+}
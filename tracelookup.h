@@ -0,0 +1,60 @@
+#ifndef TRACELOOKUP_H
+#define TRACELOOKUP_H
+
+#include <QVector>
+#include <qcustomplot.h>
+#include <analyzer/analyzerparameters.h>
+
+// All quantities shown for one point of a trace.
+// Frequency is in kHz (graph key units), impedances in Ohm, phase in degrees.
+struct TracePoint
+{
+    double fq;
+    double swr;
+    double rl;
+    double r;
+    double x;
+    double z;
+    double rpar;
+    double xpar;
+    double zpar;
+    double phase;
+    double rho;
+};
+
+// Read-only view over the contiguous rawData columns of a measurement.
+// SWR and RL are taken from the near-end column, impedance, phase and rho
+// from the impedance column (the far-end transformed data when enabled).
+// Both columns share the same frequency grid, sorted by frequency, so every
+// lookup is a binary search over the near-end column.
+class TraceLookup
+{
+public:
+    TraceLookup();
+    TraceLookup(const QVector<rawData> *data, double Z0,
+                const QVector<rawData> *impedanceData = NULL);
+
+    bool isEmpty() const;
+    int size() const;
+
+    // index of the sample closest to _fq (kHz), -1 if _fq is outside the trace
+    int nearestIndex(double _fq) const;
+    // index i with fq[i] <= _fq <= fq[i+1], -1 if _fq is outside the trace
+    int lowerIndex(double _fq) const;
+
+    bool at(int index, TracePoint &point) const;
+    bool nearest(double _fq, TracePoint &point, int *index = NULL) const;
+    // linear interpolation of every quantity, SWR limited to _maxSwr first
+    bool interpolate(double _fq, TracePoint &point, double _maxSwr = MAX_SWR) const;
+
+    static void computePoint(const rawData &swrData, const rawData &impData,
+                             double Z0, TracePoint &point);
+    static QCPDataMap::const_iterator nearestKey(const QCPDataMap &map, double key);
+
+private:
+    const QVector<rawData> *m_data;
+    const QVector<rawData> *m_impedanceData;
+    double m_Z0;
+};
+
+#endif // TRACELOOKUP_H
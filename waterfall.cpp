@@ -0,0 +1,220 @@
+#include "waterfall.h"
+#include "ui_waterfall.h"
+#include <settings.h>
+#include <core/sweepmath.h>
+
+enum WaterfallQuantity {QuantitySwr = 0, QuantityRho};
+
+WaterfallPlot::WaterfallPlot(QCPAxis *keyAxis, QCPAxis *valueAxis, int rows) :
+    QCPAbstractPlottable(keyAxis, valueAxis),
+    m_rows(qMax(rows, 1)),
+    m_points(0),
+    m_head(0),
+    m_count(0),
+    m_keyFrom(0),
+    m_keyTo(0),
+    m_gradient(QCPColorGradient::gpJet),
+    m_dataRange(0, 1)
+{
+    setSelectable(false);
+}
+
+void WaterfallPlot::add(const double *values, int count, double keyFrom, double keyTo)
+{
+    if(count <= 0)
+    {
+        return;
+    }
+    if((count != m_points) || (keyFrom != m_keyFrom) || (keyTo != m_keyTo))
+    {
+        m_image = QImage(count, m_rows, QImage::Format_RGB32);
+        m_row.resize(count);
+        m_points = count;
+        m_keyFrom = keyFrom;
+        m_keyTo = keyTo;
+        m_head = 0;
+        m_count = 0;
+    }
+    // the ring runs upwards, the rows below the newest one are the older sweeps
+    m_head = (m_head + m_rows - 1) % m_rows;
+    m_count = qMin(m_count + 1, m_rows);
+    for(int i = 0; i < count; ++i)
+    {
+        m_row[i] = qIsNaN(values[i]) ? m_dataRange.upper : values[i];
+    }
+    m_gradient.colorize(m_row.constData(), m_dataRange,
+                        reinterpret_cast<QRgb *>(m_image.scanLine(m_head)), count);
+}
+
+void WaterfallPlot::clearData()
+{
+    m_head = 0;
+    m_count = 0;
+}
+
+double WaterfallPlot::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+{
+    Q_UNUSED(pos)
+    Q_UNUSED(onlySelectable)
+    Q_UNUSED(details)
+    return -1;
+}
+
+double WaterfallPlot::halfCell() const
+{
+    return (m_points > 1) ? (m_keyTo - m_keyFrom)/(m_points - 1)/2 : 0.5;
+}
+
+// rows of the image from row on as the sweeps of age to age+rows-1
+void WaterfallPlot::drawRows(QCPPainter *painter, int row, int age, int rows)
+{
+    if(rows <= 0)
+    {
+        return;
+    }
+    // a reversed axis gives a negative scale, that mirrors the image as well
+    QPointF from = coordsToPixels(m_keyFrom - halfCell(), age - 0.5);
+    QPointF to = coordsToPixels(m_keyTo + halfCell(), age + rows - 0.5);
+    painter->save();
+    painter->translate(from);
+    painter->scale((to.x() - from.x())/m_points, (to.y() - from.y())/rows);
+    painter->drawImage(QPointF(0, 0), m_image, QRectF(0, row, m_points, rows));
+    painter->restore();
+}
+
+void WaterfallPlot::draw(QCPPainter *painter)
+{
+    if((m_count == 0) || !mKeyAxis || !mValueAxis)
+    {
+        return;
+    }
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+    int first = qMin(m_count, m_rows - m_head);
+    drawRows(painter, m_head, 0, first);
+    drawRows(painter, 0, first, m_count - first);
+}
+
+void WaterfallPlot::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+{
+    Q_UNUSED(painter)
+    Q_UNUSED(rect)
+}
+
+QCPRange WaterfallPlot::getKeyRange(bool &foundRange, SignDomain inSignDomain) const
+{
+    Q_UNUSED(inSignDomain)
+    foundRange = (m_count > 0);
+    return QCPRange(m_keyFrom - halfCell(), m_keyTo + halfCell());
+}
+
+QCPRange WaterfallPlot::getValueRange(bool &foundRange, SignDomain inSignDomain) const
+{
+    Q_UNUSED(inSignDomain)
+    foundRange = (m_count > 0);
+    return QCPRange(-0.5, m_count - 0.5);
+}
+
+WaterfallDialog::WaterfallDialog(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::WaterfallDialog),
+    m_Z0(50)
+{
+    ui->setupUi(this);
+
+    QCustomPlot *widget = ui->waterfallWidget;
+    m_plot = new WaterfallPlot(widget->xAxis, widget->yAxis);
+    widget->addPlottable(m_plot);
+    widget->xAxis->setLabel(tr("Frequency, kHz"));
+    widget->yAxis->setLabel(tr("Sweeps ago"));
+    widget->yAxis->setRangeReversed(true);
+    widget->yAxis->setRange(-0.5, WATERFALL_ROWS - 0.5);
+    widget->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    widget->axisRect()->setRangeZoom(Qt::Vertical);
+    widget->axisRect()->setRangeDrag(Qt::Vertical);
+
+    m_colorScale = new QCPColorScale(widget);
+    m_colorScale->setGradient(QCPColorGradient::gpJet);
+    widget->plotLayout()->addElement(0, 1, m_colorScale);
+    QCPMarginGroup *margins = new QCPMarginGroup(widget);
+    widget->axisRect()->setMarginGroup(QCP::msBottom | QCP::msTop, margins);
+    m_colorScale->setMarginGroup(QCP::msBottom | QCP::msTop, margins);
+
+    QString path = Settings::setIniFile();
+    m_settings = new QSettings(path, QSettings::IniFormat);
+    m_settings->beginGroup("Waterfall");
+    QRect rect = m_settings->value("geometry", 0).toRect();
+    if(rect.x() != 0)
+    {
+        this->setGeometry(rect);
+    }
+    ui->quantityBox->setCurrentIndex(m_settings->value("quantity", QuantitySwr).toInt());
+    m_settings->endGroup();
+    on_quantityBox_currentIndexChanged(ui->quantityBox->currentIndex());
+}
+
+WaterfallDialog::~WaterfallDialog()
+{
+    m_settings->beginGroup("Waterfall");
+    m_settings->setValue("geometry", this->geometry());
+    m_settings->setValue("quantity", ui->quantityBox->currentIndex());
+    m_settings->endGroup();
+    delete m_settings;
+
+    delete ui;
+}
+
+void WaterfallDialog::on_continuousSweep(const QVector<rawData> &data)
+{
+    int count = data.size();
+    if(count == 0)
+    {
+        return;
+    }
+    m_values.resize(count);
+    bool swr = (ui->quantityBox->currentIndex() == QuantitySwr);
+    for(int i = 0; i < count; ++i)
+    {
+        const rawData &point = data.at(i);
+        if(swr)
+        {
+            if(!SweepMath::swr(m_Z0, point.r, point.x, &m_values[i], NULL))
+            {
+                m_values[i] = qQNaN();
+            }
+        }else
+        {
+            double re, im;
+            SweepMath::reflection(m_Z0, point.r, point.x, re, im);
+            m_values[i] = sqrt(re*re + im*im);
+        }
+    }
+    double keyFrom = data.first().fq*1000;
+    double keyTo = data.last().fq*1000;
+    m_plot->add(m_values.constData(), count, keyFrom, keyTo);
+    // the first row of a new grid
+    if(m_plot->count() == 1)
+    {
+        ui->waterfallWidget->xAxis->setRange(keyFrom, keyTo);
+    }
+    if(isVisible())
+    {
+        ui->waterfallWidget->replot();
+    }
+}
+
+void WaterfallDialog::on_quantityBox_currentIndexChanged(int index)
+{
+    // the rows are coloured once, another quantity starts a new waterfall
+    QCPRange range = (index == QuantitySwr) ? QCPRange(1, 5) : QCPRange(0, 1);
+    m_plot->setDataRange(range);
+    m_plot->clearData();
+    m_colorScale->setDataRange(range);
+    m_colorScale->setLabel(ui->quantityBox->currentText());
+    ui->waterfallWidget->replot();
+}
+
+void WaterfallDialog::on_clearBtn_clicked()
+{
+    m_plot->clearData();
+    ui->waterfallWidget->replot();
+}
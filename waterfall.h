@@ -0,0 +1,89 @@
+#ifndef WATERFALL_H
+#define WATERFALL_H
+
+#include <QDialog>
+#include <QImage>
+#include <QSettings>
+#include <qcustomplot.h>
+#include <core/rawdata.h>
+
+#define WATERFALL_ROWS 1000     // sweeps kept by the waterfall
+
+namespace Ui {
+class WaterfallDialog;
+}
+
+// Continuous sweeps as a raster for QCustomPlot, one image row per sweep in
+// a ring with the newest row on top. add() colours just the new row and
+// draw() blits the ring in two parts split at the newest row, so the image
+// is never rebuilt however long the measurement runs. Keys are kHz as on the
+// other graphs, values the age of the sweep, 0 is the newest one.
+class WaterfallPlot : public QCPAbstractPlottable
+{
+    Q_OBJECT
+public:
+    WaterfallPlot(QCPAxis *keyAxis, QCPAxis *valueAxis, int rows = WATERFALL_ROWS);
+
+    // a sweep of another grid than the last one drops the stored rows
+    void add(const double *values, int count, double keyFrom, double keyTo);
+    int rows() const { return m_rows; }
+    int count() const { return m_count; }
+
+    // both apply to the rows added afterwards
+    void setGradient(const QCPColorGradient &gradient) { m_gradient = gradient; }
+    void setDataRange(const QCPRange &range) { m_dataRange = range; }
+
+    virtual void clearData();
+    virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const;
+
+protected:
+    virtual void draw(QCPPainter *painter);
+    virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const;
+    virtual QCPRange getKeyRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
+    virtual QCPRange getValueRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
+
+private:
+    int m_rows;
+    int m_points;
+    int m_head;                 // image row of the newest sweep
+    int m_count;
+    double m_keyFrom;
+    double m_keyTo;
+    QCPColorGradient m_gradient;
+    QCPRange m_dataRange;
+    QImage m_image;             // m_rows x m_points
+    QVector <double> m_row;
+
+    double halfCell() const;
+    void drawRows(QCPPainter *painter, int row, int age, int rows);
+};
+
+// Waterfall of the SWR or |rho| of the continuous sweeps, fed by
+// Measurements::continuousSweep().
+class WaterfallDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit WaterfallDialog(QWidget *parent = 0);
+    ~WaterfallDialog();
+
+    void setZ0(double Z0) { m_Z0 = Z0; }
+
+public slots:
+    void on_continuousSweep(const QVector<rawData> &data);
+
+private:
+    Ui::WaterfallDialog *ui;
+    WaterfallPlot *m_plot;
+    QCPColorScale *m_colorScale;
+    QSettings *m_settings;
+    QVector <double> m_values;
+    double m_Z0;
+
+private slots:
+    void on_quantityBox_currentIndexChanged(int index);
+    void on_clearBtn_clicked();
+};
+
+#endif // WATERFALL_H